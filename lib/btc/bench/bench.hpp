@@ -0,0 +1,91 @@
+// Bitcoin Info - Benchmarks - Microbenchmark Harness
+//
+// Copyright (c) 2022 Alex Dale
+// This project is licensed under the terms of the MIT license.
+// See LICENSE for details.
+#ifndef _BTC_BENCH_BENCH_HPP_
+#define _BTC_BENCH_BENCH_HPP_
+
+#include <vector>
+
+#include "btc/cc/base.h"
+#include "btc/cc/classy.hpp"
+
+namespace btc {
+namespace bench {
+// Per-run state passed to a benchmark function.  The function performs
+// any setup, then calls KeepRunning() around the measured operation:
+//
+//   void BM_Thing(State *state) {
+//     const auto input = MakeInput(state->size());
+//     while (state->KeepRunning()) Thing(input);
+//     state->SetBytesPerOp(state->size());
+//   }
+//
+// One operation is one call of the loop body; batch operations set the
+// number of items or bytes each operation processes.
+class State {
+public:
+  BTC_DISALLOW_COPY_AND_MOVE(State);
+  State(size_t size, size_t threads, uint64_t min_time_ns);
+
+  // Benchmark parameters.
+  size_t size() const { return _size; }
+  size_t threads() const { return _threads; }
+
+  bool KeepRunning();
+
+  void SetItemsPerOp(uint64_t items) { _items_per_op = items; }
+  void SetBytesPerOp(uint64_t bytes) { _bytes_per_op = bytes; }
+  // Excludes setup within the loop from the measurement.
+  void PauseTiming();
+  void ResumeTiming();
+
+  uint64_t iterations() const { return _iterations; }
+  uint64_t elapsed_ns() const { return _elapsed_ns; }
+  uint64_t items_per_op() const { return _items_per_op; }
+  uint64_t bytes_per_op() const { return _bytes_per_op; }
+
+private:
+  size_t _size;
+  size_t _threads;
+  uint64_t _min_time_ns;
+  uint64_t _iterations = 0;
+  uint64_t _batch_remaining = 0;
+  uint64_t _batch_size = 1;
+  uint64_t _start_ns = 0;
+  uint64_t _elapsed_ns = 0;
+  uint64_t _items_per_op = 1;
+  uint64_t _bytes_per_op = 0;
+  bool _running = false;
+};  // class State
+
+using BenchmarkFunction = void (*)(State *state);
+
+// Registers |function| to run once for each combination of |sizes| and
+// |threads|.  Returns true so it can initialize a static.
+bool RegisterBenchmark(
+    const char *name, BenchmarkFunction function,
+    const std::vector<size_t> &sizes,
+    const std::vector<size_t> &threads = {1});
+
+// Prevents the compiler from optimizing away a result.
+template<typename Type>
+inline void DoNotOptimize(const Type &value) {
+  asm volatile("" : : "r,m"(value) : "memory");
+}
+}  // namespace bench
+}  // namespace btc
+
+#define BTC_BENCH_CONCAT_(a, b) a##b
+#define BTC_BENCH_CONCAT(a, b) BTC_BENCH_CONCAT_(a, b)
+
+// BTC_BENCHMARK(function, sizes [, threads])
+//   BTC_BENCHMARK(BM_HexEncode, {32, 1024, 1 << 20});
+//   BTC_BENCHMARK(BM_Base58EncodeBatch, {25}, {1, 2, 4});
+#define BTC_BENCHMARK(function, ...)                            \
+  static const bool BTC_BENCH_CONCAT(_btc_bench_, __LINE__)     \
+      __attribute__((unused)) = ::btc::bench::RegisterBenchmark( \
+          #function, function, __VA_ARGS__)
+
+#endif  // _BTC_BENCH_BENCH_HPP_
@@ -0,0 +1,177 @@
+// Bitcoin Info - Benchmarks - Core Benchmark Main
+//
+// Copyright (c) 2022 Alex Dale
+// This project is licensed under the terms of the MIT license.
+// See LICENSE for details.
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <iostream>
+#include <string>
+
+#include "btc/bench/bench.hpp"
+#include "btc/cc/platform.h"
+
+namespace btc {
+namespace bench {
+namespace {
+constexpr uint64_t kNsPerSecond = 1000000000;
+constexpr uint64_t kDefaultMinTimeMs = 200;
+// Caps batch growth so that slow operations do not overshoot the
+// minimum time by much.
+constexpr uint64_t kMaxBatchSize = 1 << 20;
+
+struct Benchmark {
+  std::string name;
+  BenchmarkFunction function;
+  std::vector<size_t> sizes;
+  std::vector<size_t> threads;
+};
+
+std::vector<Benchmark> &Registry() {
+  static std::vector<Benchmark> registry;
+  return registry;
+}
+
+uint64_t NowNs() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return static_cast<uint64_t>(ts.tv_sec) * kNsPerSecond +
+         static_cast<uint64_t>(ts.tv_nsec);
+}
+
+struct Options {
+  std::string filter = "";
+  uint64_t min_time_ns = kDefaultMinTimeMs * 1000000;
+  bool list = false;
+};
+
+bool ParseOptions(int argc, char **argv, Options *options) {
+  for (int i = 1; i < argc; i++) {
+    const char *arg = argv[i];
+    if (strncmp(arg, "--filter=", 9) == 0) {
+      options->filter = arg + 9;
+    } else if (strncmp(arg, "--min_time_ms=", 14) == 0) {
+      options->min_time_ns = strtoull(arg + 14, nullptr, 10) * 1000000;
+    } else if (strcmp(arg, "--list") == 0) {
+      options->list = true;
+    } else {
+      std::cerr << "Usage: " << argv[0]
+                << " [--filter=<substring>] [--min_time_ms=<ms>] [--list]"
+                << std::endl;
+      return false;
+    }
+  }
+  return true;
+}
+
+void PrintBuildInfo() {
+  std::cout << "  \"build\": {"
+            << "\"cc\": \"" << BTC_CC << "\", "
+            << "\"os\": \"" << BTC_OS << "\", "
+            << "\"arch\": \"" << BTC_ARCH << "\", "
+            << "\"time\": \"" << BTC_BUILD_TIME << "\", "
+            << "\"debug\": " << (BTC_DEBUG_BUILD ? "true" : "false")
+            << "}," << std::endl;
+}
+
+void PrintResult(
+    const Benchmark &benchmark, const State &state, bool first) {
+  const double seconds =
+      static_cast<double>(state.elapsed_ns()) / kNsPerSecond;
+  const double ops = static_cast<double>(state.iterations());
+  const double ops_per_s = seconds > 0 ? ops / seconds : 0;
+  std::cout << (first ? "" : ",\n") << "    {"
+            << "\"name\": \"" << benchmark.name << "\", "
+            << "\"size\": " << state.size() << ", "
+            << "\"threads\": " << state.threads() << ", "
+            << "\"iterations\": " << state.iterations() << ", "
+            << "\"ns_per_op\": "
+            << (ops > 0 ? static_cast<double>(state.elapsed_ns()) / ops : 0)
+            << ", "
+            << "\"ops_per_s\": " << ops_per_s << ", "
+            << "\"items_per_s\": " << ops_per_s * state.items_per_op()
+            << ", "
+            << "\"bytes_per_s\": " << ops_per_s * state.bytes_per_op()
+            << "}";
+}
+}  // namespace
+
+State::State(size_t size, size_t threads, uint64_t min_time_ns):
+    _size(size), _threads(threads), _min_time_ns(min_time_ns) {}
+
+bool State::KeepRunning() {
+  if (_batch_remaining > 0) {
+    _batch_remaining--;
+    _iterations++;
+    return true;
+  }
+  if (_running) {
+    _elapsed_ns += NowNs() - _start_ns;
+    if (_elapsed_ns >= _min_time_ns) {
+      _running = false;
+      return false;
+    }
+    if (_batch_size < kMaxBatchSize) _batch_size *= 2;
+  }
+  _running = true;
+  _batch_remaining = _batch_size - 1;
+  _iterations++;
+  _start_ns = NowNs();
+  return true;
+}
+
+void State::PauseTiming() {
+  _elapsed_ns += NowNs() - _start_ns;
+}
+
+void State::ResumeTiming() {
+  _start_ns = NowNs();
+}
+
+bool RegisterBenchmark(
+    const char *name, BenchmarkFunction function,
+    const std::vector<size_t> &sizes, const std::vector<size_t> &threads) {
+  Registry().push_back({name, function, sizes, threads});
+  return true;
+}
+}  // namespace bench
+}  // namespace btc
+
+int main(int argc, char **argv) {
+  using ::btc::bench::Benchmark;
+  using ::btc::bench::Options;
+  using ::btc::bench::State;
+  Options options;
+  if (!::btc::bench::ParseOptions(argc, argv, &options)) return EXIT_FAILURE;
+
+  std::vector<const Benchmark *> selected;
+  for (const Benchmark &benchmark : ::btc::bench::Registry()) {
+    if (benchmark.name.find(options.filter) == std::string::npos) continue;
+    selected.push_back(&benchmark);
+  }
+  if (options.list) {
+    for (const Benchmark *benchmark : selected) {
+      std::cout << benchmark->name << std::endl;
+    }
+    return EXIT_SUCCESS;
+  }
+
+  std::cout << "{" << std::endl;
+  ::btc::bench::PrintBuildInfo();
+  std::cout << "  \"benchmarks\": [" << std::endl;
+  bool first = true;
+  for (const Benchmark *benchmark : selected) {
+    for (const size_t size : benchmark->sizes) {
+      for (const size_t threads : benchmark->threads) {
+        State state(size, threads, options.min_time_ns);
+        benchmark->function(&state);
+        ::btc::bench::PrintResult(*benchmark, state, first);
+        first = false;
+      }
+    }
+  }
+  std::cout << "\n  ]\n}" << std::endl;
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,85 @@
+// Bitcoin Info - Block - Merkle Tree - Benchmarks
+//
+// Copyright (c) 2022 Alex Dale
+// This project is licensed under the terms of the MIT license.
+// See LICENSE for details.
+#include <vector>
+
+#include "btc/bench/bench.hpp"
+#include "btc/block/merkle.hpp"
+#include "btc/encode/batch.hpp"
+#include "btc/test/test_data.hpp"
+
+namespace btc {
+namespace block {
+namespace bench {
+namespace {
+using ::btc::bench::DoNotOptimize;
+using ::btc::bench::State;
+using ::btc::encode::BatchBitmapWords;
+using ::btc::test::MakeTestData;
+
+std::vector<uint8_t> MakeLeaves(size_t count) {
+  return MakeTestData(count * kMerkleHashLength);
+}
+
+// Root of a block with |size| transactions.
+void BM_MerkleRoot(State *state) {
+  const std::vector<uint8_t> leaves = MakeLeaves(state->size());
+  uint8_t root[kMerkleHashLength];
+  while (state->KeepRunning()) {
+    DoNotOptimize(MerkleRoot(
+        leaves.data(), state->size(), root, nullptr, state->threads()));
+  }
+  state->SetItemsPerOp(state->size());
+}
+
+// Branches of every transaction of a block with |size| transactions.
+void BM_MerkleBranches(State *state) {
+  const size_t count = state->size();
+  const std::vector<uint8_t> leaves = MakeLeaves(count);
+  std::vector<size_t> indices(count);
+  for (size_t i = 0; i < count; i++) indices[i] = i;
+  std::vector<uint8_t> branches(
+      count * MerkleBranchLength(count) * kMerkleHashLength);
+  while (state->KeepRunning()) {
+    DoNotOptimize(MerkleBranches(
+        leaves.data(), count, indices.data(), count, branches.data()));
+  }
+  state->SetItemsPerOp(count);
+}
+
+// Verifies a proof of every transaction of a block with |size|
+// transactions.
+void BM_VerifyMerkleProofBatch(State *state) {
+  const size_t count = state->size();
+  const std::vector<uint8_t> leaves = MakeLeaves(count);
+  std::vector<size_t> indices(count);
+  for (size_t i = 0; i < count; i++) indices[i] = i;
+  const size_t branch_length = MerkleBranchLength(count);
+  std::vector<uint8_t> branches(count * branch_length * kMerkleHashLength);
+  uint8_t root[kMerkleHashLength];
+  MerkleBranches(
+      leaves.data(), count, indices.data(), count, branches.data(), root);
+  std::vector<MerkleProof> proofs(count);
+  for (size_t i = 0; i < count; i++) {
+    proofs[i] = {
+        leaves.data() + i * kMerkleHashLength, i,
+        branches.data() + i * branch_length * kMerkleHashLength,
+        branch_length, root};
+  }
+  std::vector<uint64_t> valid(BatchBitmapWords(count));
+  while (state->KeepRunning()) {
+    DoNotOptimize(VerifyMerkleProofBatch(
+        proofs.data(), count, valid.data(), state->threads()));
+  }
+  state->SetItemsPerOp(count);
+}
+}  // namespace
+
+BTC_BENCHMARK(BM_MerkleRoot, {2000, 1 << 16}, {1, 4});
+BTC_BENCHMARK(BM_MerkleBranches, {2000});
+BTC_BENCHMARK(BM_VerifyMerkleProofBatch, {2000}, {1, 4});
+}  // namespace bench
+}  // namespace block
+}  // namespace btc
@@ -0,0 +1,41 @@
+// Bitcoin Info - Block - Proof of Work - Benchmarks
+//
+// Copyright (c) 2022 Alex Dale
+// This project is licensed under the terms of the MIT license.
+// See LICENSE for details.
+#include <array>
+
+#include "btc/bench/bench.hpp"
+#include "btc/block/pow.hpp"
+
+namespace btc {
+namespace block {
+namespace bench {
+namespace {
+using ::btc::bench::DoNotOptimize;
+using ::btc::bench::State;
+using ::btc::crypto::Hash256;
+
+// Sweeps |size| nonces of a header with an unreachable target, the
+// header hash rate.
+void BM_SearchProofOfWork(State *state) {
+  std::array<uint8_t, kBlockHeaderLength> header = {};
+  header[0] = 1;
+  Hash256 target;
+  target[0] = 1;
+  PowSearchOptions options;
+  options.nonce_count = state->size();
+  options.threads = state->threads();
+  PowSearchResult result;
+  while (state->KeepRunning()) {
+    DoNotOptimize(SearchProofOfWork(header.data(), target, options, &result));
+    options.nonce_start += static_cast<uint32_t>(state->size());
+  }
+  state->SetItemsPerOp(state->size());
+}
+}  // namespace
+
+BTC_BENCHMARK(BM_SearchProofOfWork, {1 << 20}, {1, 2, 4, 8});
+}  // namespace bench
+}  // namespace block
+}  // namespace btc
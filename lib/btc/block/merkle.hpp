@@ -0,0 +1,88 @@
+// Bitcoin Info - Block - Merkle Tree
+//
+// Copyright (c) 2022 Alex Dale
+// This project is licensed under the terms of the MIT license.
+// See LICENSE for details.
+#ifndef _BTC_BLOCK_MERKLE_HPP_
+#define _BTC_BLOCK_MERKLE_HPP_
+
+#include <vector>
+
+#include "btc/cc/attr.h"
+#include "btc/cc/base.h"
+#include "btc/crypto/digest.hpp"
+
+namespace btc {
+namespace block {
+// Merkle trees of transaction IDs.  Hashes are 32 bytes, stored
+// consecutively in internal byte order (the reverse of the usual hex
+// display).  A node is the SHA-256-SHA-256 of its two children; the
+// last node of a level with an odd number of nodes is paired with
+// itself.
+constexpr size_t kMerkleHashLength = ::btc::crypto::kSha256DigestLength;
+
+// Levels of the tree above the |leaf_count| leaves, which is the number
+// of hashes in a merkle branch.  A single leaf is its own root.
+size_t MerkleBranchLength(size_t leaf_count);
+
+// Computes the merkle root of |count| leaf |hashes|.  The levels are
+// computed in place, |hashes| is overwritten.
+// If |mutated| is set, it is set to whether any level contains two
+// identical sibling nodes.  Because of the odd node rule, such a tree
+// has the same root as the tree with the duplicated nodes removed
+// (CVE-2012-2459); a block with a mutated tree must be rejected.
+// Levels with enough nodes are split across |threads| threads (0 for
+// the default), which requires one scratch buffer of half the leaves.
+// Fails if |count| is 0.
+bool MerkleRootInPlace(
+    uint8_t *hashes, size_t count, uint8_t *root, bool *mutated = nullptr,
+    size_t threads = 1) __NOT_NULL(3);
+// Same, without modifying |hashes|.
+bool MerkleRoot(
+    const uint8_t *hashes, size_t count, uint8_t *root,
+    bool *mutated = nullptr, size_t threads = 1) __NOT_NULL(3);
+std::vector<uint8_t> MerkleRoot(
+    const std::vector<uint8_t> &hashes, bool *mutated = nullptr,
+    size_t threads = 1);
+
+// Builds the merkle branches of leaves |indices| in one pass over the
+// tree.  Branch |k| is the MerkleBranchLength(count) sibling hashes of
+// leaf |indices[k]|, bottom up, written to |branches| +
+// k * MerkleBranchLength(count) * kMerkleHashLength.  The root is also
+// written to |root| if not null.
+// Fails if |count| is 0 or an index is out of range.
+bool MerkleBranches(
+    const uint8_t *hashes, size_t count, const size_t *indices,
+    size_t index_count, uint8_t *branches, uint8_t *root = nullptr,
+    size_t threads = 1);
+
+// Computes the root of the tree containing |leaf| at |index| from its
+// merkle branch of |branch_length| hashes.
+// Fails if |index| does not fit in a tree of that depth.
+bool MerkleBranchRoot(
+    const uint8_t *leaf, size_t index, const uint8_t *branch,
+    size_t branch_length, uint8_t *root) __NOT_NULL(1, 5);
+
+// An inclusion proof: |leaf| is the |index| leaf of the tree with the
+// merkle |root|, |branch| holds |branch_length| hashes.
+struct MerkleProof {
+  const uint8_t *leaf;
+  size_t index;
+  const uint8_t *branch;
+  size_t branch_length;
+  const uint8_t *root;
+};  // struct MerkleProof
+
+bool VerifyMerkleProof(const MerkleProof &proof);
+// Verifies |count| proofs; the levels of many proofs are hashed
+// together with the multi-lane double SHA-256.  Bit |i| of |valid|
+// (BatchBitmapWords(count) words, see btc/encode/batch.hpp) is set if
+// proof |i| is valid.  The work is split across |threads| threads (0
+// for the default).  Returns the number of valid proofs.
+size_t VerifyMerkleProofBatch(
+    const MerkleProof *proofs, size_t count, uint64_t *valid,
+    size_t threads = 1);
+}  // namespace block
+}  // namespace btc
+
+#endif  // _BTC_BLOCK_MERKLE_HPP_
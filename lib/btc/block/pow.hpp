@@ -0,0 +1,93 @@
+// Bitcoin Info - Block - Proof of Work
+//
+// Copyright (c) 2022 Alex Dale
+// This project is licensed under the terms of the MIT license.
+// See LICENSE for details.
+#ifndef _BTC_BLOCK_POW_HPP_
+#define _BTC_BLOCK_POW_HPP_
+
+#include <array>
+#include <functional>
+
+#include "btc/cc/attr.h"
+#include "btc/cc/base.h"
+#include "btc/crypto/hash.hpp"
+
+namespace btc {
+namespace block {
+// Block headers are 80 bytes: version (4), previous block hash (32),
+// merkle root (32), time (4), compact target "bits" (4) and nonce (4),
+// integers little endian.  The proof of work is the SHA-256-SHA-256 of
+// the header, read as a 256 bit little endian number, which must not
+// exceed the target.  Targets are stored as hashes are, in internal
+// byte order.
+constexpr size_t kBlockHeaderLength = 80;
+constexpr size_t kBlockHeaderTimeOffset = 68;
+constexpr size_t kBlockHeaderBitsOffset = 72;
+constexpr size_t kBlockHeaderNonceOffset = 76;
+// Nonces of a single header.
+constexpr uint64_t kNonceRange = static_cast<uint64_t>(1) << 32;
+
+// Expands the compact "bits" of a header into a target.
+// Fails if the target is negative, zero or larger than 256 bits.
+bool CompactToTarget(uint32_t bits, ::btc::crypto::Hash256 *target)
+    __NOT_NULL(2);
+
+// Whether |hash| is at most |target|.
+bool CheckProofOfWork(
+    const ::btc::crypto::Hash256 &hash, const ::btc::crypto::Hash256 &target);
+
+// Writes extra nonce |extra_nonce| into the 80 byte |header|, such as
+// by rebuilding the coinbase and merkle root.  Called from the search
+// threads, with a copy of the header for each thread.
+using ExtraNonceFunction =
+    std::function<bool(uint64_t extra_nonce, uint8_t *header)>;
+
+struct PowSearchOptions {
+  // Nonces tried for each extra nonce, up to kNonceRange.
+  uint32_t nonce_start = 0;
+  uint64_t nonce_count = kNonceRange;
+  uint64_t extra_nonce_start = 0;
+  uint64_t extra_nonce_count = 1;
+  // By default, the extra nonce is added to the header time, the
+  // usual way to extend the search on a chain with no coinbase to
+  // update.
+  ExtraNonceFunction extra_nonce = nullptr;
+  // 0 for the default.
+  size_t threads = 1;
+};  // struct PowSearchOptions
+
+struct PowSearchResult {
+  bool found = false;
+  // The header with the extra nonce and nonce found.
+  std::array<uint8_t, kBlockHeaderLength> header = {};
+  uint64_t extra_nonce = 0;
+  uint32_t nonce = 0;
+  ::btc::crypto::Hash256 hash = ::btc::crypto::Hash256();
+  // Headers hashed and wall time of the search.
+  uint64_t hashes = 0;
+  uint64_t elapsed_ns = 0;
+
+  double HashesPerSecond() const;
+};  // struct PowSearchResult
+
+// Searches for a nonce and extra nonce which give the 80 byte |header|
+// a hash of at most |target|, such as for mining blocks of a local
+// regtest chain.  The midstate of the first 64 bytes of the header is
+// computed once for each extra nonce; each nonce then costs two
+// SHA-256 compressions, run in parallel lanes by Sha256D80Nonces().
+// Nonces are swept in chunks across |options.threads| threads, in
+// order of extra nonce then nonce.  The search stops at the first
+// header in that order which meets the target, so the result does not
+// depend on the number of threads.  Sets |result|, with found false
+// if the ranges are exhausted.
+// Fails if a range is empty or too large, or the extra nonce function
+// fails for an extra nonce before that of the first hit.
+bool SearchProofOfWork(
+    const uint8_t *header, const ::btc::crypto::Hash256 &target,
+    const PowSearchOptions &options, PowSearchResult *result)
+    __NOT_NULL(1, 4);
+}  // namespace block
+}  // namespace btc
+
+#endif  // _BTC_BLOCK_POW_HPP_
@@ -0,0 +1,316 @@
+// Bitcoin Info - Block - Merkle Tree
+//
+// Copyright (c) 2022 Alex Dale
+// This project is licensed under the terms of the MIT license.
+// See LICENSE for details.
+#include <string.h>
+
+#include <algorithm>
+#include <atomic>
+
+#include "btc/block/merkle.hpp"
+#include "btc/cc/debug.h"
+#include "btc/encode/batch.hpp"
+#include "btc/log.h"
+#include "btc/task/parallel.hpp"
+
+namespace btc {
+namespace block {
+namespace {
+using ::btc::crypto::Sha256D64;
+using ::btc::encode::BatchBitmapWords;
+using ::btc::encode::kBatchBitmapWordBits;
+using ::btc::task::DefaultThreadCount;
+using ::btc::task::ParallelFor;
+
+constexpr size_t kPairLength = kMerkleHashLength * 2;
+// Pairs hashed by each worker of a level split across threads.  Smaller
+// levels are not worth the threads.
+constexpr size_t kParallelLevelGrain = 4096;
+// Proofs verified together, bounds the scratch buffers of a worker.
+constexpr size_t kProofGroupSize = 256;
+
+const uint8_t *Node(const uint8_t *nodes, size_t index) {
+  return nodes + index * kMerkleHashLength;
+}
+
+bool HasIdenticalSiblings(const uint8_t *nodes, size_t count) {
+  for (size_t i = 0; i + 1 < count; i += 2) {
+    if (memcmp(Node(nodes, i), Node(nodes, i + 1), kMerkleHashLength) == 0) {
+      return true;
+    }
+  }
+  return false;
+}
+
+// Hashes the |count| nodes of a level into the (|count| + 1) / 2 nodes
+// of the next level.  |next| may be |nodes| if |threads| is 1.
+void HashLevel(
+    const uint8_t *nodes, size_t count, uint8_t *next, size_t threads) {
+  const size_t pairs = count / 2;
+  const bool odd = count % 2 == 1;
+  uint8_t last[kPairLength];
+  if (odd) {
+    memcpy(last, Node(nodes, count - 1), kMerkleHashLength);
+    memcpy(last + kMerkleHashLength, last, kMerkleHashLength);
+  }
+  if (threads == 1) {
+    Sha256D64(nodes, pairs, next);
+  } else {
+    ParallelFor(pairs, threads, [&](size_t begin, size_t end) {
+      Sha256D64(
+          nodes + begin * kPairLength, end - begin,
+          next + begin * kMerkleHashLength);
+    }, kParallelLevelGrain);
+  }
+  if (odd) Sha256D64(last, 1, next + pairs * kMerkleHashLength);
+}
+
+// Reduces the |count| leaf |hashes| to the root, level by level.
+// |visit(level, nodes, count)| is called with each level before it is
+// hashed.  Levels are hashed in place; levels split across threads are
+// hashed into a scratch buffer, alternating with |hashes|.
+template<typename Visitor>
+void ReduceMerkleTree(
+    uint8_t *hashes, size_t count, uint8_t *root, bool *mutated,
+    size_t threads, const Visitor &visit) {
+  DASSERT(count > 0);
+  if (threads == 0) threads = DefaultThreadCount();
+  std::vector<uint8_t> scratch;
+  uint8_t *nodes = hashes;
+  bool identical = false;
+  for (size_t level = 0; count > 1; level++) {
+    visit(level, static_cast<const uint8_t *>(nodes), count);
+    if (mutated != nullptr && !identical) {
+      identical = HasIdenticalSiblings(nodes, count);
+    }
+    uint8_t *next = nodes;
+    size_t level_threads = 1;
+    if (threads > 1 && count / 2 > kParallelLevelGrain) {
+      // The first such level is the largest.
+      if (scratch.empty()) scratch.resize((count + 1) / 2 * kMerkleHashLength);
+      next = nodes == hashes ? scratch.data() : hashes;
+      level_threads = threads;
+    }
+    HashLevel(nodes, count, next, level_threads);
+    nodes = next;
+    count = (count + 1) / 2;
+  }
+  memmove(root, nodes, kMerkleHashLength);
+  if (mutated != nullptr) *mutated = identical;
+}
+
+void IgnoreLevel(size_t, const uint8_t *, size_t) {}
+
+bool IsValidTree(const uint8_t *hashes, size_t count) {
+  if (count == 0) {
+    LOG_ERROR("Merkle tree has no leaves");
+    return false;
+  }
+  if (hashes == nullptr) {
+    LOG_ERROR("Input |hashes| is null");
+    return false;
+  }
+  return true;
+}
+
+bool IsWellFormedProof(const MerkleProof &proof) {
+  if (proof.leaf == nullptr || proof.root == nullptr) return false;
+  if (proof.branch == nullptr && proof.branch_length > 0) return false;
+  // The index selects one leaf of the 2^|branch_length| leaves.
+  if (proof.branch_length < sizeof(size_t) * 8 &&
+      (proof.index >> proof.branch_length) != 0) {
+    return false;
+  }
+  return true;
+}
+
+// Writes the two children of the node on the path of |index| at
+// |level| to |pair|, ordered by the position of the path node.
+void MakeBranchPair(
+    const uint8_t *node, size_t index, const uint8_t *sibling, size_t level,
+    uint8_t *pair) {
+  const bool right = ((index >> level) & 1) == 1;
+  memcpy(pair + (right ? kMerkleHashLength : 0), node, kMerkleHashLength);
+  memcpy(pair + (right ? 0 : kMerkleHashLength), sibling, kMerkleHashLength);
+}
+
+// Verifies |proofs| group by group; each level of a group is hashed with
+// one Sha256D64() call.
+size_t VerifyMerkleProofRange(
+    const MerkleProof *proofs, size_t count, uint64_t *valid,
+    size_t offset) {
+  const size_t group_capacity = std::min(count, kProofGroupSize);
+  std::vector<uint8_t> nodes(group_capacity * kMerkleHashLength);
+  std::vector<uint8_t> pairs(group_capacity * kPairLength);
+  std::vector<size_t> active(group_capacity);
+  std::vector<bool> well_formed(group_capacity);
+  size_t valid_count = 0;
+  for (size_t group = 0; group < count; group += group_capacity) {
+    const size_t group_size = std::min(group_capacity, count - group);
+    const MerkleProof *group_proofs = proofs + group;
+    size_t depth = 0;
+    for (size_t i = 0; i < group_size; i++) {
+      well_formed[i] = IsWellFormedProof(group_proofs[i]);
+      if (!well_formed[i]) continue;
+      memcpy(
+          &nodes[i * kMerkleHashLength], group_proofs[i].leaf,
+          kMerkleHashLength);
+      depth = std::max(depth, group_proofs[i].branch_length);
+    }
+    for (size_t level = 0; level < depth; level++) {
+      size_t active_count = 0;
+      for (size_t i = 0; i < group_size; i++) {
+        const MerkleProof &proof = group_proofs[i];
+        if (!well_formed[i] || proof.branch_length <= level) continue;
+        MakeBranchPair(
+            &nodes[i * kMerkleHashLength], proof.index,
+            Node(proof.branch, level), level,
+            &pairs[active_count * kPairLength]);
+        active[active_count++] = i;
+      }
+      Sha256D64(pairs.data(), active_count, pairs.data());
+      for (size_t j = 0; j < active_count; j++) {
+        memcpy(
+            &nodes[active[j] * kMerkleHashLength],
+            &pairs[j * kMerkleHashLength], kMerkleHashLength);
+      }
+    }
+    for (size_t i = 0; i < group_size; i++) {
+      if (!well_formed[i]) continue;
+      if (memcmp(
+              &nodes[i * kMerkleHashLength], group_proofs[i].root,
+              kMerkleHashLength) != 0) {
+        continue;
+      }
+      const size_t index = offset + group + i;
+      valid[index / kBatchBitmapWordBits] |=
+          uint64_t(1) << (index % kBatchBitmapWordBits);
+      valid_count++;
+    }
+  }
+  return valid_count;
+}
+}  // namespace
+
+size_t MerkleBranchLength(size_t leaf_count) {
+  size_t length = 0;
+  while (leaf_count > 1) {
+    leaf_count = (leaf_count + 1) / 2;
+    length++;
+  }
+  return length;
+}
+
+bool MerkleRootInPlace(
+    uint8_t *hashes, size_t count, uint8_t *root, bool *mutated,
+    size_t threads) {
+  if (!IsValidTree(hashes, count)) return false;
+  ReduceMerkleTree(hashes, count, root, mutated, threads, IgnoreLevel);
+  return true;
+}
+
+bool MerkleRoot(
+    const uint8_t *hashes, size_t count, uint8_t *root, bool *mutated,
+    size_t threads) {
+  if (!IsValidTree(hashes, count)) return false;
+  std::vector<uint8_t> nodes(hashes, hashes + count * kMerkleHashLength);
+  ReduceMerkleTree(nodes.data(), count, root, mutated, threads, IgnoreLevel);
+  return true;
+}
+
+std::vector<uint8_t> MerkleRoot(
+    const std::vector<uint8_t> &hashes, bool *mutated, size_t threads) {
+  if (hashes.size() % kMerkleHashLength != 0) {
+    LOG_ERROR(
+        "Merkle leaves are not a multiple of %zu bytes: %zu",
+        kMerkleHashLength, hashes.size());
+    return {};
+  }
+  std::vector<uint8_t> root(kMerkleHashLength);
+  if (!MerkleRoot(
+          hashes.data(), hashes.size() / kMerkleHashLength, root.data(),
+          mutated, threads)) {
+    return {};
+  }
+  return root;
+}
+
+bool MerkleBranches(
+    const uint8_t *hashes, size_t count, const size_t *indices,
+    size_t index_count, uint8_t *branches, uint8_t *root, size_t threads) {
+  if (!IsValidTree(hashes, count)) return false;
+  if (index_count > 0 && (indices == nullptr || branches == nullptr)) {
+    LOG_ERROR("Input |indices| or output |branches| is null");
+    return false;
+  }
+  for (size_t k = 0; k < index_count; k++) {
+    if (indices[k] >= count) {
+      LOG_ERROR(
+          "Merkle leaf index out of range: %zu >= %zu", indices[k], count);
+      return false;
+    }
+  }
+  const size_t branch_length = MerkleBranchLength(count);
+  std::vector<uint8_t> nodes(hashes, hashes + count * kMerkleHashLength);
+  uint8_t tree_root[kMerkleHashLength];
+  ReduceMerkleTree(
+      nodes.data(), count, tree_root, nullptr, threads,
+      [&](size_t level, const uint8_t *level_nodes, size_t level_count) {
+        for (size_t k = 0; k < index_count; k++) {
+          // The odd last node is its own sibling.
+          const size_t sibling = std::min(
+              (indices[k] >> level) ^ 1, level_count - 1);
+          memcpy(
+              branches + (k * branch_length + level) * kMerkleHashLength,
+              Node(level_nodes, sibling), kMerkleHashLength);
+        }
+      });
+  if (root != nullptr) memcpy(root, tree_root, kMerkleHashLength);
+  return true;
+}
+
+bool MerkleBranchRoot(
+    const uint8_t *leaf, size_t index, const uint8_t *branch,
+    size_t branch_length, uint8_t *root) {
+  const MerkleProof proof = {leaf, index, branch, branch_length, root};
+  if (!IsWellFormedProof(proof)) {
+    LOG_ERROR(
+        "Invalid merkle branch: index %zu, length %zu", index, branch_length);
+    return false;
+  }
+  uint8_t node[kMerkleHashLength];
+  memcpy(node, leaf, kMerkleHashLength);
+  uint8_t pair[kPairLength];
+  for (size_t level = 0; level < branch_length; level++) {
+    MakeBranchPair(node, index, Node(branch, level), level, pair);
+    Sha256D64(pair, 1, node);
+  }
+  memcpy(root, node, kMerkleHashLength);
+  return true;
+}
+
+bool VerifyMerkleProof(const MerkleProof &proof) {
+  if (!IsWellFormedProof(proof)) return false;
+  uint8_t root[kMerkleHashLength];
+  MerkleBranchRoot(
+      proof.leaf, proof.index, proof.branch, proof.branch_length, root);
+  return memcmp(root, proof.root, kMerkleHashLength) == 0;
+}
+
+size_t VerifyMerkleProofBatch(
+    const MerkleProof *proofs, size_t count, uint64_t *valid,
+    size_t threads) {
+  DASSERT(proofs != nullptr || count == 0);
+  DASSERT(valid != nullptr || count == 0);
+  std::fill_n(valid, BatchBitmapWords(count), 0);
+  std::atomic<size_t> valid_count(0);
+  // Workers own whole bitmap words.
+  ParallelFor(count, threads, [&](size_t begin, size_t end) {
+    valid_count += VerifyMerkleProofRange(
+        proofs + begin, end - begin, valid, begin);
+  }, kBatchBitmapWordBits);
+  return valid_count.load();
+}
+}  // namespace block
+}  // namespace btc
@@ -0,0 +1,295 @@
+// Bitcoin Info - Block - Proof of Work
+//
+// Copyright (c) 2022 Alex Dale
+// This project is licensed under the terms of the MIT license.
+// See LICENSE for details.
+#include <string.h>
+#include <time.h>
+
+#include <algorithm>
+#include <atomic>
+#include <limits>
+#include <mutex>
+
+#include "btc/block/pow.hpp"
+#include "btc/cc/classy.hpp"
+#include "btc/cc/debug.h"
+#include "btc/crypto/digest.hpp"
+#include "btc/crypto/digester.hpp"
+#include "btc/log.h"
+#include "btc/task/parallel.hpp"
+
+namespace btc {
+namespace block {
+namespace {
+using ::btc::crypto::Digester;
+using ::btc::crypto::Hash256;
+using ::btc::crypto::kSha256DigestLength;
+using ::btc::crypto::PooledDigester;
+using ::btc::crypto::Sha256D80Nonces;
+using ::btc::crypto::Sha256Midstate;
+using ::btc::task::DefaultThreadCount;
+using ::btc::task::ParallelFor;
+
+constexpr uint64_t kNsPerSecond = 1000000000;
+constexpr size_t kMidstateLength = 64;
+// Nonces claimed by a thread at a time.  Small enough that the threads
+// finishing the chunks before a hit do not delay the result by much.
+constexpr uint64_t kNonceChunk = 1 << 16;
+// Nonces hashed between target checks, sized for the stack.
+constexpr size_t kNonceBatch = 256;
+constexpr uint64_t kNoChunk = std::numeric_limits<uint64_t>::max();
+
+uint64_t NowNs() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return static_cast<uint64_t>(ts.tv_sec) * kNsPerSecond +
+         static_cast<uint64_t>(ts.tv_nsec);
+}
+
+uint32_t ReadUint32(const uint8_t *data) {
+  return static_cast<uint32_t>(data[0]) |
+         static_cast<uint32_t>(data[1]) << 8 |
+         static_cast<uint32_t>(data[2]) << 16 |
+         static_cast<uint32_t>(data[3]) << 24;
+}
+
+void WriteUint32(uint32_t value, uint8_t *data) {
+  for (size_t i = 0; i < 4; i++) {
+    data[i] = static_cast<uint8_t>(value >> (i * 8));
+  }
+}
+
+// |hash| <= |target|, both 32 byte little endian numbers.
+bool IsAtMostTarget(const uint8_t *hash, const uint8_t *target) {
+  for (size_t i = Hash256::size(); i-- > 0;) {
+    if (hash[i] != target[i]) return hash[i] < target[i];
+  }
+  return true;
+}
+
+// Lowers |value| to |candidate| if it is smaller.
+void StoreMin(std::atomic<uint64_t> *value, uint64_t candidate) {
+  uint64_t current = value->load();
+  while (candidate < current &&
+         !value->compare_exchange_weak(current, candidate)) {
+  }
+}
+
+bool RollTime(uint64_t extra_nonce, uint8_t *header) {
+  const uint32_t time = ReadUint32(header + kBlockHeaderTimeOffset);
+  WriteUint32(
+      time + static_cast<uint32_t>(extra_nonce),
+      header + kBlockHeaderTimeOffset);
+  return true;
+}
+
+bool IsValidSearch(const PowSearchOptions &options) {
+  if (options.nonce_count == 0 || options.nonce_count > kNonceRange) {
+    LOG_ERROR(
+        "Nonce count must be 1 to %zu: %zu", static_cast<size_t>(kNonceRange),
+        static_cast<size_t>(options.nonce_count));
+    return false;
+  }
+  if (options.extra_nonce_count == 0) {
+    LOG_ERROR("Extra nonce count is 0");
+    return false;
+  }
+  const uint64_t chunks =
+      (options.nonce_count + kNonceChunk - 1) / kNonceChunk;
+  if (options.extra_nonce_count > kNoChunk / chunks) {
+    LOG_ERROR(
+        "Extra nonce count too large: %zu",
+        static_cast<size_t>(options.extra_nonce_count));
+    return false;
+  }
+  return true;
+}
+
+// Shared by the search threads.  Chunk |c| covers extra nonce
+// |c| / |chunks_per_extra_nonce| and the nonces of chunk
+// |c| % |chunks_per_extra_nonce|, so chunks are claimed in search
+// order.
+class PowSearch {
+public:
+  BTC_DISALLOW_COPY_AND_MOVE(PowSearch);
+  PowSearch(
+      const uint8_t *header, const Hash256 &target,
+      const PowSearchOptions &options, PowSearchResult *result):
+      _header(header), _target(target), _options(options),
+      _extra_nonce(options.extra_nonce ? options.extra_nonce : RollTime),
+      _chunks_per_extra_nonce(
+          (options.nonce_count + kNonceChunk - 1) / kNonceChunk),
+      _chunk_count(_chunks_per_extra_nonce * options.extra_nonce_count),
+      _result(result) {}
+
+  void Run(size_t threads) {
+    ParallelFor(threads, threads, [this](size_t begin, size_t end) {
+      for (size_t worker = begin; worker < end; worker++) Work();
+    });
+  }
+
+  uint64_t hashes() const { return _hashes.load(); }
+  // Only a failure before the first hit counts; a single thread would
+  // never have reached the later chunks.
+  bool failed() const { return _fail_chunk.load() < _hit_chunk.load(); }
+
+private:
+  // The current extra nonce of a thread.
+  struct ThreadState {
+    uint64_t extra_nonce = kNoChunk;
+    uint8_t header[kBlockHeaderLength] = {};
+    Sha256Midstate midstate = {};
+  };  // struct ThreadState
+
+  // Stops claiming chunks once a hit is found or the extra nonce
+  // function fails, and abandons the current chunk once either happens
+  // in an earlier one.  Chunks before it are still searched, so the
+  // outcome does not depend on the order in which threads get there.
+  bool IsSuperseded(uint64_t chunk) const {
+    return chunk > std::min(
+                       _hit_chunk.load(std::memory_order_relaxed),
+                       _fail_chunk.load(std::memory_order_relaxed));
+  }
+
+  bool LoadExtraNonce(uint64_t extra_nonce, ThreadState *work) {
+    memcpy(work->header, _header, kBlockHeaderLength);
+    if (!_extra_nonce(extra_nonce, work->header)) {
+      LOG_ERROR(
+          "Extra nonce function failed: %zu",
+          static_cast<size_t>(extra_nonce));
+      return false;
+    }
+    PooledDigester digester = Digester::Acquire(::btc::crypto::kSha256);
+    if (!digester || !digester->Update(work->header, kMidstateLength) ||
+        !digester->SaveMidstate(&work->midstate)) {
+      return false;
+    }
+    work->extra_nonce = extra_nonce;
+    return true;
+  }
+
+  void Work() {
+    ThreadState work;
+    uint8_t digests[kNonceBatch * kSha256DigestLength];
+    uint64_t hashes = 0;
+    while (true) {
+      const uint64_t chunk = _next_chunk.fetch_add(1);
+      if (chunk >= _chunk_count || IsSuperseded(chunk)) break;
+      const uint64_t extra_nonce =
+          _options.extra_nonce_start + chunk / _chunks_per_extra_nonce;
+      if (work.extra_nonce != extra_nonce &&
+          !LoadExtraNonce(extra_nonce, &work)) {
+        StoreMin(&_fail_chunk, chunk);
+        break;
+      }
+      const uint64_t begin =
+          (chunk % _chunks_per_extra_nonce) * kNonceChunk;
+      const uint64_t end = std::min(begin + kNonceChunk, _options.nonce_count);
+      for (uint64_t offset = begin; offset < end; offset += kNonceBatch) {
+        if (IsSuperseded(chunk)) break;
+        const size_t count =
+            static_cast<size_t>(std::min<uint64_t>(kNonceBatch, end - offset));
+        const uint32_t nonce =
+            _options.nonce_start + static_cast<uint32_t>(offset);
+        Sha256D80Nonces(work.midstate, work.header, nonce, count, digests);
+        hashes += count;
+        for (size_t i = 0; i < count; i++) {
+          const uint8_t *digest = digests + i * kSha256DigestLength;
+          if (!IsAtMostTarget(digest, _target.data())) continue;
+          Hit(chunk, work, nonce + static_cast<uint32_t>(i), digest);
+          offset = end;
+          break;
+        }
+      }
+    }
+    _hashes.fetch_add(hashes);
+  }
+
+  void Hit(
+      uint64_t chunk, const ThreadState &work, uint32_t nonce,
+      const uint8_t *digest) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    if (chunk >= _hit_chunk.load()) return;
+    _hit_chunk.store(chunk);
+    _result->found = true;
+    memcpy(_result->header.data(), work.header, kBlockHeaderLength);
+    WriteUint32(nonce, _result->header.data() + kBlockHeaderNonceOffset);
+    _result->extra_nonce = work.extra_nonce;
+    _result->nonce = nonce;
+    _result->hash = Hash256(digest);
+  }
+
+  const uint8_t *const _header;
+  const Hash256 &_target;
+  const PowSearchOptions &_options;
+  const ExtraNonceFunction _extra_nonce;
+  const uint64_t _chunks_per_extra_nonce;
+  const uint64_t _chunk_count;
+  PowSearchResult *const _result;
+
+  std::atomic<uint64_t> _next_chunk{0};
+  std::atomic<uint64_t> _hit_chunk{kNoChunk};
+  std::atomic<uint64_t> _hashes{0};
+  std::atomic<uint64_t> _fail_chunk{kNoChunk};
+  std::mutex _mutex = {};
+};  // class PowSearch
+}  // namespace
+
+bool CompactToTarget(uint32_t bits, Hash256 *target) {
+  DASSERT(target != nullptr);
+  const uint32_t exponent = bits >> 24;
+  const uint32_t mantissa = bits & 0x007fffff;
+  if (mantissa != 0 && (bits & 0x00800000) != 0) {
+    LOG_ERROR("Target is negative: %08x", bits);
+    return false;
+  }
+  if (mantissa != 0 && (exponent > 34 || (mantissa > 0xff && exponent > 33) ||
+                        (mantissa > 0xffff && exponent > 32))) {
+    LOG_ERROR("Target overflows: %08x", bits);
+    return false;
+  }
+  // |mantissa| * 256^(|exponent| - 3), the bytes shifted below the
+  // first are dropped.
+  *target = Hash256();
+  for (uint32_t i = 0; i < 3; i++) {
+    if (exponent + i < 3) continue;
+    const uint32_t index = exponent + i - 3;
+    if (index >= Hash256::size()) continue;
+    (*target)[index] = static_cast<uint8_t>(mantissa >> (i * 8));
+  }
+  if (target->IsZero()) {
+    LOG_ERROR("Target is zero: %08x", bits);
+    return false;
+  }
+  return true;
+}
+
+bool CheckProofOfWork(const Hash256 &hash, const Hash256 &target) {
+  return IsAtMostTarget(hash.data(), target.data());
+}
+
+double PowSearchResult::HashesPerSecond() const {
+  if (elapsed_ns == 0) return 0.0;
+  return static_cast<double>(hashes) * kNsPerSecond /
+         static_cast<double>(elapsed_ns);
+}
+
+bool SearchProofOfWork(
+    const uint8_t *header, const Hash256 &target,
+    const PowSearchOptions &options, PowSearchResult *result) {
+  DASSERT(header != nullptr);
+  DASSERT(result != nullptr);
+  if (!IsValidSearch(options)) return false;
+  const uint64_t start_ns = NowNs();
+  *result = PowSearchResult();
+  size_t threads = options.threads;
+  if (threads == 0) threads = DefaultThreadCount();
+  PowSearch search(header, target, options, result);
+  search.Run(threads);
+  result->hashes = search.hashes();
+  result->elapsed_ns = NowNs() - start_ns;
+  return !search.failed();
+}
+}  // namespace block
+}  // namespace btc
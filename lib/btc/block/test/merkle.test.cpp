@@ -0,0 +1,247 @@
+// Bitcoin Info - Block - Merkle Tree - Unittest
+//
+// Copyright (c) 2022 Alex Dale
+// This project is licensed under the terms of the MIT license.
+// See LICENSE for details.
+#include <gtest/gtest.h>
+
+#include "btc/block/merkle.hpp"
+#include "btc/crypto/digest.hpp"
+#include "btc/encode/batch.hpp"
+#include "btc/encode/hex.hpp"
+
+namespace btc {
+namespace block {
+namespace test {
+using ::btc::crypto::Sha256Sha256;
+using ::btc::encode::BatchBitmapWords;
+using ::btc::encode::HexDecode;
+using ::btc::encode::IsBatchItemValid;
+namespace {
+using Hashes = std::vector<std::vector<uint8_t>>;
+
+Hashes MakeLeaves(size_t count) {
+  Hashes leaves;
+  for (size_t i = 0; i < count; i++) {
+    leaves.push_back(Sha256Sha256(std::to_string(i)));
+  }
+  return leaves;
+}
+
+std::vector<uint8_t> Flatten(const Hashes &hashes) {
+  std::vector<uint8_t> flat;
+  for (const auto &hash : hashes) {
+    flat.insert(flat.end(), hash.begin(), hash.end());
+  }
+  return flat;
+}
+
+// Straightforward root, one vector per level.
+std::vector<uint8_t> ReferenceRoot(Hashes level) {
+  while (level.size() > 1) {
+    if (level.size() % 2 == 1) level.push_back(level.back());
+    Hashes next;
+    for (size_t i = 0; i < level.size(); i += 2) {
+      std::vector<uint8_t> pair = level[i];
+      pair.insert(pair.end(), level[i + 1].begin(), level[i + 1].end());
+      next.push_back(Sha256Sha256(pair));
+    }
+    level = next;
+  }
+  return level.front();
+}
+}  // namespace
+
+TEST(MerkleTest, BranchLength) {
+  EXPECT_EQ(MerkleBranchLength(0), 0);
+  EXPECT_EQ(MerkleBranchLength(1), 0);
+  EXPECT_EQ(MerkleBranchLength(2), 1);
+  EXPECT_EQ(MerkleBranchLength(3), 2);
+  EXPECT_EQ(MerkleBranchLength(4), 2);
+  EXPECT_EQ(MerkleBranchLength(5), 3);
+  EXPECT_EQ(MerkleBranchLength(1024), 10);
+  EXPECT_EQ(MerkleBranchLength(1025), 11);
+}
+
+TEST(MerkleTest, Block100000) {
+  // Transaction IDs and merkle root of block 100000, display order.
+  const char *const kTxids[] = {
+      "8c14f0db3df150123e6f3dbbf30f8b955a8249b62ac1d1ff16284aefa3d06d87",
+      "fff2525b8931402dd09222c50775608f75787bd2b87e56995a7bdd30f79702c4",
+      "6359f0868171b1d194cbee1af2f16ea598ae8fad666d9b012c8ed2b79a236ec4",
+      "e9a66845e05d5abc0ad04ec80f774a7e585c6e8db975962d069a522137b80c1d"};
+  const std::vector<uint8_t> kRoot = HexDecode(
+      "f3e94742aca4b5ef85488dc37c06c3282295ffec960994b2c0d5ac2a25a95766",
+      /* reverse = */ true);
+  Hashes leaves;
+  for (const char *txid : kTxids) leaves.push_back(HexDecode(txid, true));
+  bool mutated = true;
+  EXPECT_EQ(MerkleRoot(Flatten(leaves), &mutated), kRoot);
+  EXPECT_FALSE(mutated);
+}
+
+TEST(MerkleTest, Root) {
+  for (size_t count = 1; count <= 70; count++) {
+    const Hashes leaves = MakeLeaves(count);
+    const std::vector<uint8_t> expected = ReferenceRoot(leaves);
+    EXPECT_EQ(MerkleRoot(Flatten(leaves)), expected) << count;
+
+    std::vector<uint8_t> flat = Flatten(leaves);
+    uint8_t root[kMerkleHashLength];
+    bool mutated = true;
+    ASSERT_TRUE(MerkleRootInPlace(flat.data(), count, root, &mutated));
+    EXPECT_EQ(std::vector<uint8_t>(root, root + kMerkleHashLength), expected);
+    EXPECT_FALSE(mutated);
+  }
+}
+
+TEST(MerkleTest, Root_Parallel) {
+  // Large enough for the first levels to be split across threads.
+  const size_t kCount = 20001;
+  const std::vector<uint8_t> flat = Flatten(MakeLeaves(kCount));
+  uint8_t expected[kMerkleHashLength];
+  ASSERT_TRUE(MerkleRoot(flat.data(), kCount, expected));
+  for (const size_t threads : {0, 2, 3}) {
+    uint8_t root[kMerkleHashLength];
+    bool mutated = true;
+    ASSERT_TRUE(MerkleRoot(flat.data(), kCount, root, &mutated, threads));
+    EXPECT_EQ(memcmp(root, expected, kMerkleHashLength), 0) << threads;
+    EXPECT_FALSE(mutated);
+  }
+}
+
+TEST(MerkleTest, Root_Invalid) {
+  uint8_t root[kMerkleHashLength];
+  uint8_t hash[kMerkleHashLength] = {};
+  EXPECT_FALSE(MerkleRoot(hash, 0, root));
+  EXPECT_FALSE(MerkleRoot(nullptr, 1, root));
+  EXPECT_TRUE(MerkleRoot(std::vector<uint8_t>()).empty());
+  EXPECT_TRUE(MerkleRoot(std::vector<uint8_t>(33)).empty());
+}
+
+TEST(MerkleTest, Mutated) {
+  // CVE-2012-2459: duplicating the odd last transaction yields a
+  // different block with the same root.
+  Hashes leaves = MakeLeaves(5);
+  bool mutated = true;
+  const std::vector<uint8_t> root = MerkleRoot(Flatten(leaves), &mutated);
+  EXPECT_FALSE(mutated);
+  leaves.push_back(leaves.back());
+  EXPECT_EQ(MerkleRoot(Flatten(leaves), &mutated), root);
+  EXPECT_TRUE(mutated);
+
+  // Identical siblings on an upper level.
+  leaves = MakeLeaves(6);
+  leaves.push_back(leaves[4]);
+  leaves.push_back(leaves[5]);
+  const std::vector<uint8_t> flat = Flatten(leaves);
+  EXPECT_EQ(
+      MerkleRoot(flat, &mutated),
+      MerkleRoot(std::vector<uint8_t>(flat.begin(), flat.end() - 64)));
+  EXPECT_TRUE(mutated);
+
+  // Identical leaves which are not siblings are not a mutation.
+  leaves = MakeLeaves(3);
+  leaves[2] = leaves[1];
+  MerkleRoot(Flatten(leaves), &mutated);
+  EXPECT_FALSE(mutated);
+}
+
+TEST(MerkleTest, Branches) {
+  for (const size_t count : {1, 2, 3, 7, 8, 33}) {
+    const Hashes leaves = MakeLeaves(count);
+    const std::vector<uint8_t> flat = Flatten(leaves);
+    const std::vector<uint8_t> expected_root = ReferenceRoot(leaves);
+    const size_t branch_length = MerkleBranchLength(count);
+    std::vector<size_t> indices;
+    for (size_t i = 0; i < count; i++) indices.push_back(i);
+    std::vector<uint8_t> branches(
+        count * branch_length * kMerkleHashLength + 1);
+    uint8_t root[kMerkleHashLength];
+    ASSERT_TRUE(MerkleBranches(
+        flat.data(), count, indices.data(), indices.size(), branches.data(),
+        root));
+    EXPECT_EQ(memcmp(root, expected_root.data(), kMerkleHashLength), 0);
+
+    std::vector<MerkleProof> proofs;
+    for (size_t i = 0; i < count; i++) {
+      const uint8_t *branch =
+          branches.data() + i * branch_length * kMerkleHashLength;
+      uint8_t branch_root[kMerkleHashLength];
+      ASSERT_TRUE(MerkleBranchRoot(
+          leaves[i].data(), i, branch, branch_length, branch_root));
+      EXPECT_EQ(memcmp(branch_root, root, kMerkleHashLength), 0) << i;
+      proofs.push_back({leaves[i].data(), i, branch, branch_length, root});
+      EXPECT_TRUE(VerifyMerkleProof(proofs.back()));
+    }
+    std::vector<uint64_t> valid(BatchBitmapWords(count));
+    EXPECT_EQ(
+        VerifyMerkleProofBatch(proofs.data(), count, valid.data()), count);
+  }
+}
+
+TEST(MerkleTest, Branches_Invalid) {
+  const std::vector<uint8_t> flat = Flatten(MakeLeaves(4));
+  const size_t kIndex = 4;
+  uint8_t branch[2 * kMerkleHashLength];
+  EXPECT_FALSE(MerkleBranches(flat.data(), 4, &kIndex, 1, branch));
+  EXPECT_FALSE(MerkleBranches(flat.data(), 0, nullptr, 0, nullptr));
+  uint8_t root[kMerkleHashLength];
+  EXPECT_FALSE(MerkleBranchRoot(flat.data(), 4, branch, 2, root));
+  EXPECT_FALSE(MerkleBranchRoot(flat.data(), 0, nullptr, 2, root));
+}
+
+TEST(MerkleTest, VerifyBatch) {
+  const size_t kCount = 300;
+  const Hashes leaves = MakeLeaves(kCount);
+  const std::vector<uint8_t> flat = Flatten(leaves);
+  const size_t branch_length = MerkleBranchLength(kCount);
+  std::vector<size_t> indices;
+  for (size_t i = 0; i < kCount; i++) indices.push_back(i);
+  std::vector<uint8_t> branches(kCount * branch_length * kMerkleHashLength);
+  uint8_t root[kMerkleHashLength];
+  ASSERT_TRUE(MerkleBranches(
+      flat.data(), kCount, indices.data(), kCount, branches.data(), root));
+
+  // A mix of proofs against this tree and small trees, every third one
+  // broken.
+  std::vector<MerkleProof> proofs;
+  std::vector<bool> expected;
+  const Hashes pair = MakeLeaves(2);
+  const std::vector<uint8_t> pair_root = ReferenceRoot(pair);
+  for (size_t i = 0; i < kCount; i++) {
+    MerkleProof proof = {
+        leaves[i].data(), i,
+        branches.data() + i * branch_length * kMerkleHashLength,
+        branch_length, root};
+    if (i % 5 == 0) {
+      proof = {pair[1].data(), 1, pair[0].data(), 1, pair_root.data()};
+    }
+    const bool broken = i % 3 == 0;
+    if (broken) proof.index ^= 1;
+    proofs.push_back(proof);
+    expected.push_back(!broken);
+  }
+  // Index beyond the depth of the branch.
+  proofs.push_back(
+      {leaves[0].data(), size_t(1) << branch_length, branches.data(),
+       branch_length, root});
+  expected.push_back(false);
+
+  size_t expected_count = 0;
+  for (const bool ok : expected) expected_count += ok;
+  for (const size_t threads : {1, 0, 3}) {
+    std::vector<uint64_t> valid(BatchBitmapWords(proofs.size()), ~0ull);
+    EXPECT_EQ(
+        VerifyMerkleProofBatch(
+            proofs.data(), proofs.size(), valid.data(), threads),
+        expected_count);
+    for (size_t i = 0; i < proofs.size(); i++) {
+      EXPECT_EQ(IsBatchItemValid(valid.data(), i), expected[i]) << i;
+      EXPECT_EQ(VerifyMerkleProof(proofs[i]), expected[i]) << i;
+    }
+  }
+}
+}  // namespace test
+}  // namespace block
+}  // namespace btc
@@ -0,0 +1,261 @@
+// Bitcoin Info - Block - Proof of Work - Unittest
+//
+// Copyright (c) 2022 Alex Dale
+// This project is licensed under the terms of the MIT license.
+// See LICENSE for details.
+#include <gtest/gtest.h>
+
+#include <array>
+
+#include "btc/block/pow.hpp"
+#include "btc/crypto/digest.hpp"
+#include "btc/encode/hex.literal.hpp"
+
+namespace btc {
+namespace block {
+namespace test {
+using ::btc::crypto::Hash256;
+using ::btc::crypto::Sha256Sha256Hash;
+using namespace ::btc::encode::literals;
+namespace {
+using Header = std::array<uint8_t, kBlockHeaderLength>;
+
+// The main network genesis block header.
+constexpr Header kGenesisHeader =
+    "0100000000000000000000000000000000000000000000000000000000000000"
+    "000000003ba3edfd7a7b12b27ac72c3e67768f617fc81bc3888a51323a9fb8aa"
+    "4b1e5e4a29ab5f49ffff001d1dac2b7c"_hex;
+constexpr uint32_t kGenesisNonce = 2083236893;
+constexpr uint32_t kGenesisBits = 0x1d00ffff;
+// The regtest genesis block header, nonce 2.
+constexpr Header kRegtestGenesisHeader =
+    "0100000000000000000000000000000000000000000000000000000000000000"
+    "000000003ba3edfd7a7b12b27ac72c3e67768f617fc81bc3888a51323a9fb8aa"
+    "4b1e5e4adae5494dffff7f2002000000"_hex;
+constexpr uint32_t kRegtestBits = 0x207fffff;
+
+Hash256 Target(uint32_t bits) {
+  Hash256 target;
+  EXPECT_TRUE(CompactToTarget(bits, &target));
+  return target;
+}
+
+uint32_t ReadUint32(const uint8_t *data) {
+  return static_cast<uint32_t>(data[0]) |
+         static_cast<uint32_t>(data[1]) << 8 |
+         static_cast<uint32_t>(data[2]) << 16 |
+         static_cast<uint32_t>(data[3]) << 24;
+}
+
+// Checks that |result| is a valid header of the search from |header|.
+void ExpectValidResult(
+    const Header &header, const Hash256 &target,
+    const PowSearchResult &result) {
+  ASSERT_TRUE(result.found);
+  EXPECT_EQ(Sha256Sha256Hash(result.header.data(), kBlockHeaderLength),
+            result.hash);
+  EXPECT_TRUE(CheckProofOfWork(result.hash, target));
+  EXPECT_EQ(
+      ReadUint32(result.header.data() + kBlockHeaderNonceOffset),
+      result.nonce);
+  // Only the time and nonce are changed by default.
+  EXPECT_TRUE(std::equal(
+      header.begin(), header.begin() + kBlockHeaderTimeOffset,
+      result.header.begin()));
+  EXPECT_EQ(
+      ReadUint32(result.header.data() + kBlockHeaderTimeOffset),
+      ReadUint32(header.data() + kBlockHeaderTimeOffset) +
+          static_cast<uint32_t>(result.extra_nonce));
+}
+}  // namespace
+
+TEST(PowTest, CompactToTarget) {
+  EXPECT_EQ(
+      Target(kGenesisBits).ToHex(),
+      "00000000ffff0000000000000000000000000000000000000000000000000000");
+  EXPECT_EQ(
+      Target(kRegtestBits).ToHex(),
+      "7fffff0000000000000000000000000000000000000000000000000000000000");
+  // Small exponents shift the mantissa down.
+  EXPECT_EQ(Target(0x02123400)[0], 0x34);
+  EXPECT_EQ(Target(0x02123400)[1], 0x12);
+  EXPECT_EQ(Target(0x01120000)[0], 0x12);
+
+  Hash256 target;
+  // Zero, negative and overflowing.
+  EXPECT_FALSE(CompactToTarget(0x1d000000, &target));
+  EXPECT_FALSE(CompactToTarget(0x01003456, &target));
+  EXPECT_FALSE(CompactToTarget(0x04923456, &target));
+  EXPECT_FALSE(CompactToTarget(0x21010000, &target));
+  EXPECT_FALSE(CompactToTarget(0xff123456, &target));
+}
+
+TEST(PowTest, CheckProofOfWork) {
+  const Hash256 hash =
+      Sha256Sha256Hash(kGenesisHeader.data(), kBlockHeaderLength);
+  EXPECT_EQ(
+      hash.ToHex(),
+      "000000000019d6689c085ae165831e934ff763ae46a2a6c172b3f1b60a8ce26f");
+  EXPECT_TRUE(CheckProofOfWork(hash, Target(kGenesisBits)));
+  EXPECT_TRUE(CheckProofOfWork(hash, hash));
+  EXPECT_FALSE(CheckProofOfWork(hash, Target(0x1b00ffff)));
+}
+
+TEST(PowTest, SearchGenesis) {
+  const Hash256 target = Target(kGenesisBits);
+  PowSearchOptions options;
+  options.nonce_start = kGenesisNonce - 100000;
+  options.nonce_count = 200000;
+  for (const size_t threads : {1, 4}) {
+    options.threads = threads;
+    PowSearchResult result;
+    ASSERT_TRUE(SearchProofOfWork(
+        kGenesisHeader.data(), target, options, &result));
+    ExpectValidResult(kGenesisHeader, target, result);
+    EXPECT_EQ(result.header, kGenesisHeader);
+    EXPECT_EQ(result.nonce, kGenesisNonce);
+    EXPECT_EQ(result.extra_nonce, 0u);
+    EXPECT_GT(result.hashes, 100000u);
+    EXPECT_GT(result.HashesPerSecond(), 0.0);
+  }
+}
+
+TEST(PowTest, SearchRegtest) {
+  const Hash256 target = Target(kRegtestBits);
+  PowSearchOptions options;
+  options.nonce_start = 2;
+  options.nonce_count = 1;
+  PowSearchResult result;
+  ASSERT_TRUE(SearchProofOfWork(
+      kRegtestGenesisHeader.data(), target, options, &result));
+  ExpectValidResult(kRegtestGenesisHeader, target, result);
+  EXPECT_EQ(result.header, kRegtestGenesisHeader);
+
+  // The first nonce which meets the target.
+  Header header = kRegtestGenesisHeader;
+  uint32_t nonce = 0;
+  for (;; nonce++) {
+    for (size_t i = 0; i < 4; i++) {
+      header[kBlockHeaderNonceOffset + i] =
+          static_cast<uint8_t>(nonce >> (i * 8));
+    }
+    if (CheckProofOfWork(
+            Sha256Sha256Hash(header.data(), kBlockHeaderLength), target)) {
+      break;
+    }
+  }
+  options = PowSearchOptions();
+  ASSERT_TRUE(SearchProofOfWork(
+      kRegtestGenesisHeader.data(), target, options, &result));
+  ExpectValidResult(kRegtestGenesisHeader, target, result);
+  EXPECT_EQ(result.nonce, nonce);
+  EXPECT_EQ(result.header, header);
+}
+
+TEST(PowTest, SearchExtraNonce) {
+  // About 1 in 2^16 headers meet the target, far fewer than the nonces
+  // of each extra nonce.
+  const Hash256 target = Target(0x1f00ffff);
+  PowSearchOptions options;
+  options.nonce_count = 1000;
+  options.extra_nonce_start = 7;
+  options.extra_nonce_count = 1000;
+  PowSearchResult expected;
+  ASSERT_TRUE(SearchProofOfWork(
+      kRegtestGenesisHeader.data(), target, options, &expected));
+  ExpectValidResult(kRegtestGenesisHeader, target, expected);
+  EXPECT_GT(expected.extra_nonce, 7u);
+  EXPECT_LT(expected.nonce, 1000u);
+  // Nonces are hashed in batches, some past the hit.
+  const uint64_t hashes_to_hit =
+      (expected.extra_nonce - 7) * 1000 + expected.nonce + 1;
+  EXPECT_GE(expected.hashes, hashes_to_hit);
+  EXPECT_LT(expected.hashes, hashes_to_hit + 256);
+  // The first hit does not depend on the number of threads.
+  for (const size_t threads : {2, 3, 8, 0}) {
+    options.threads = threads;
+    PowSearchResult result;
+    ASSERT_TRUE(SearchProofOfWork(
+        kRegtestGenesisHeader.data(), target, options, &result));
+    EXPECT_EQ(result.header, expected.header) << threads;
+    EXPECT_EQ(result.extra_nonce, expected.extra_nonce);
+    EXPECT_EQ(result.nonce, expected.nonce);
+  }
+
+  // A custom extra nonce, in the merkle root.
+  options.extra_nonce = [](uint64_t extra_nonce, uint8_t *header) {
+    header[36] = static_cast<uint8_t>(extra_nonce);
+    header[37] = static_cast<uint8_t>(extra_nonce >> 8);
+    return true;
+  };
+  options.threads = 4;
+  PowSearchResult result;
+  ASSERT_TRUE(SearchProofOfWork(
+      kRegtestGenesisHeader.data(), target, options, &result));
+  ASSERT_TRUE(result.found);
+  EXPECT_EQ(result.header[36], static_cast<uint8_t>(result.extra_nonce));
+  EXPECT_EQ(
+      Sha256Sha256Hash(result.header.data(), kBlockHeaderLength),
+      result.hash);
+  EXPECT_TRUE(CheckProofOfWork(result.hash, target));
+
+  options.extra_nonce = [](uint64_t, uint8_t *) { return false; };
+  EXPECT_FALSE(SearchProofOfWork(
+      kRegtestGenesisHeader.data(), target, options, &result));
+
+  // Failures past the first hit are never reached in search order, so
+  // they do not fail the search, whichever thread gets there first.
+  const Hash256 easy_target = Target(kRegtestBits);
+  options.nonce_count = 1 << 16;
+  options.extra_nonce_start = 0;
+  options.extra_nonce = [](uint64_t extra_nonce, uint8_t *) {
+    return extra_nonce < 1;
+  };
+  options.threads = 1;
+  PowSearchResult first;
+  ASSERT_TRUE(SearchProofOfWork(
+      kRegtestGenesisHeader.data(), easy_target, options, &first));
+  for (const size_t threads : {1, 8}) {
+    options.threads = threads;
+    for (size_t run = 0; run < 50; run++) {
+      ASSERT_TRUE(SearchProofOfWork(
+          kRegtestGenesisHeader.data(), easy_target, options, &result))
+          << threads;
+      ASSERT_TRUE(result.found);
+      EXPECT_EQ(result.extra_nonce, 0u);
+      EXPECT_EQ(result.header, first.header);
+    }
+  }
+}
+
+TEST(PowTest, SearchExhausted) {
+  // Lowest possible target.
+  Hash256 target;
+  target[0] = 1;
+  PowSearchOptions options;
+  options.nonce_count = 300;
+  options.extra_nonce_count = 3;
+  for (const size_t threads : {1, 4}) {
+    options.threads = threads;
+    PowSearchResult result;
+    ASSERT_TRUE(SearchProofOfWork(
+        kGenesisHeader.data(), target, options, &result));
+    EXPECT_FALSE(result.found);
+    EXPECT_EQ(result.hashes, 900u);
+  }
+
+  PowSearchResult result;
+  options.nonce_count = 0;
+  EXPECT_FALSE(
+      SearchProofOfWork(kGenesisHeader.data(), target, options, &result));
+  options.nonce_count = kNonceRange + 1;
+  EXPECT_FALSE(
+      SearchProofOfWork(kGenesisHeader.data(), target, options, &result));
+  options.nonce_count = 1;
+  options.extra_nonce_count = 0;
+  EXPECT_FALSE(
+      SearchProofOfWork(kGenesisHeader.data(), target, options, &result));
+}
+}  // namespace test
+}  // namespace block
+}  // namespace btc
@@ -11,6 +11,9 @@
 // Function and variable attributes.
 #if defined(BTC_CC_GCC) || defined(BTC_CC_CLANG)
 #  define __ALL_NOT_NULL __attribute__((nonnull))
+// Inlined even into callers compiled with __TARGET, so that the body
+// is generated for the caller's instruction set.
+#  define __ALWAYS_INLINE __attribute__((always_inline))
 #  define __COLD __attribute__((cold))
 #  define __CONST __attribute__((const))
 #  ifndef __DEPRECATED
@@ -24,10 +27,14 @@
     __attribute__((format(printf, fmt_idx, arg_idx)))
 #  define __RETURN_NOT_NULL __attribute__((returns_nonnull))
 #  define __SETUP __attribute__((constructor))
+// Compiles a function for an instruction set extension which is not
+// enabled for the whole build.  Callers must check for CPU support.
+#  define __TARGET(isa) __attribute__((target(isa)))
 #  define __TEARDOWN __attribute__((destructor))
 #  define __UNUSED __attribute__((unused))
 #else
 #  define __ALL_NOT_NULL
+#  define __ALWAYS_INLINE
 #  define __COLD
 #  define __CONST
 #  define __DEPRECATED
@@ -38,6 +45,7 @@
 #  define __PRINTF(fmt_idx, arg_idx)
 #  define __RETURN_NOT_NULL
 #  define __SETUP
+#  define __TARGET(isa)
 #  define __TEARDOWN
 #  define __UNUSED
 #endif
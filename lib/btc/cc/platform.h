@@ -47,6 +47,23 @@
 #  error Cannot determine OS
 #endif
 
+// Architecture
+#if defined(__x86_64__) || defined(_M_X64)
+#  define BTC_ARCH_X86
+#  define BTC_ARCH_X86_64
+#  define BTC_ARCH "x86_64"
+#elif defined(__i386__) || defined(_M_IX86)
+#  define BTC_ARCH_X86
+#  define BTC_ARCH_X86_32
+#  define BTC_ARCH "x86"
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#  define BTC_ARCH_ARM64
+#  define BTC_ARCH "arm64"
+#else
+#  define BTC_ARCH_UNKNOWN
+#  define BTC_ARCH "unknown"
+#endif
+
 // Language
 #if defined(__cplusplus)
 #  if __cplusplus >= 201703L
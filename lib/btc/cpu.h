@@ -0,0 +1,39 @@
+// Bitcoin Info - CPU Features
+//
+// Copyright (c) 2022 Alex Dale
+// This project is licensed under the terms of the MIT license.
+// See LICENSE for details.
+#ifndef _BTC_CPU_H_
+#define _BTC_CPU_H_
+
+#include "btc/cc/attr.h"
+#include "btc/cc/base.h"
+
+__C_SECTION_BEGIN;
+// Instruction set extensions which have specialized implementations
+// somewhere in the library.  A feature is only reported if both the
+// CPU and the OS (for extended register state) support it.
+typedef enum {
+  BTC_CPU_SSSE3 = 1 << 0,
+  BTC_CPU_SSE41 = 1 << 1,
+  BTC_CPU_AVX = 1 << 2,
+  BTC_CPU_AVX2 = 1 << 3,
+  BTC_CPU_BMI2 = 1 << 4,
+  BTC_CPU_AVX512F = 1 << 5,
+  BTC_CPU_AVX512BW = 1 << 6,
+  BTC_CPU_AVX512VL = 1 << 7,
+  BTC_CPU_SHA = 1 << 8
+} btc_cpu_feature_t;
+
+// Bit set of all btc_cpu_feature_t supported by the running CPU.
+// Detection is performed once, the result is cached.
+uint32_t btc_cpu_features(void);
+
+bool btc_cpu_has(btc_cpu_feature_t feature);
+bool btc_cpu_has_all(uint32_t features);
+
+const char *btc_cpu_feature_to_string(btc_cpu_feature_t feature)
+    __RETURN_NOT_NULL;
+__C_SECTION_END;
+
+#endif  // _BTC_CPU_H_
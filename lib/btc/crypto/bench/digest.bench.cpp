@@ -0,0 +1,274 @@
+// Bitcoin Info - Crypto - Digest - Benchmarks
+//
+// Copyright (c) 2022 Alex Dale
+// This project is licensed under the terms of the MIT license.
+// See LICENSE for details.
+#include <string>
+#include <vector>
+
+#include "btc/bench/bench.hpp"
+#include "btc/crypto/digest.hpp"
+#include "btc/crypto/digester.hpp"
+#include "btc/test/test_data.hpp"
+
+namespace btc {
+namespace crypto {
+namespace bench {
+namespace {
+using ::btc::bench::DoNotOptimize;
+using ::btc::bench::State;
+using ::btc::test::MakeTestData;
+
+using DigestFunction = bool (*)(const uint8_t *, size_t, uint8_t *);
+
+template<DigestFunction kFunction>
+void BM_Digest(State *state) {
+  const std::vector<uint8_t> data = MakeTestData(state->size());
+  uint8_t digest[kSha256DigestLength];
+  while (state->KeepRunning()) {
+    DoNotOptimize(kFunction(data.data(), data.size(), digest));
+  }
+  state->SetBytesPerOp(data.size());
+}
+
+void BM_Sha256(State *state) { BM_Digest<Sha256>(state); }
+void BM_Sha256Sha256(State *state) { BM_Digest<Sha256Sha256>(state); }
+void BM_RipeMd160(State *state) { BM_Digest<RipeMd160>(state); }
+void BM_Sha256RipeMd160(State *state) { BM_Digest<Sha256RipeMd160>(state); }
+
+// SHA-256 with a specific kernel, skipped if not supported.
+template<Sha256Kernel kKernel>
+void BM_Sha256Kernel(State *state) {
+  const Sha256Kernel initial_kernel = GetSha256Kernel();
+  if (!SetSha256Kernel(kKernel)) return;
+  BM_Digest<Sha256>(state);
+  SetSha256Kernel(initial_kernel);
+}
+
+void BM_Sha256Generic(State *state) {
+  BM_Sha256Kernel<kSha256KernelGeneric>(state);
+}
+void BM_Sha256Avx2(State *state) { BM_Sha256Kernel<kSha256KernelAvx2>(state); }
+void BM_Sha256ShaNi(State *state) {
+  BM_Sha256Kernel<kSha256KernelShaNi>(state);
+}
+
+// Batch digests of |kBatchCount| messages of the given size, with a
+// specific batch kernel.
+constexpr size_t kBatchCount = 256;
+
+using BatchFunction = bool (*)(const DigestInput *, size_t, uint8_t *);
+
+template<BatchFunction kFunction, Sha256BatchKernel kKernel>
+void BM_BatchKernel(State *state) {
+  const Sha256BatchKernel initial_kernel = GetSha256BatchKernel();
+  if (!SetSha256BatchKernel(kKernel)) return;
+  const std::vector<uint8_t> data = MakeTestData(state->size() * kBatchCount);
+  std::vector<DigestInput> inputs(kBatchCount);
+  for (size_t i = 0; i < kBatchCount; i++) {
+    inputs[i] = {data.data() + i * state->size(), state->size()};
+  }
+  std::vector<uint8_t> digests(kBatchCount * kSha256DigestLength);
+  while (state->KeepRunning()) {
+    DoNotOptimize(kFunction(inputs.data(), inputs.size(), digests.data()));
+  }
+  state->SetItemsPerOp(kBatchCount);
+  state->SetBytesPerOp(data.size());
+  SetSha256BatchKernel(initial_kernel);
+}
+
+void BM_Sha256Sha256BatchScalar(State *state) {
+  BM_BatchKernel<Sha256Sha256Batch, kSha256BatchKernelScalar>(state);
+}
+void BM_Sha256Sha256BatchAvx2(State *state) {
+  BM_BatchKernel<Sha256Sha256Batch, kSha256BatchKernelAvx2>(state);
+}
+void BM_Sha256Sha256BatchAvx512(State *state) {
+  BM_BatchKernel<Sha256Sha256Batch, kSha256BatchKernelAvx512>(state);
+}
+
+// Public key hashes.
+void BM_Sha256RipeMd160BatchScalar(State *state) {
+  BM_BatchKernel<Sha256RipeMd160Batch, kSha256BatchKernelScalar>(state);
+}
+void BM_Sha256RipeMd160BatchAvx2(State *state) {
+  BM_BatchKernel<Sha256RipeMd160Batch, kSha256BatchKernelAvx2>(state);
+}
+void BM_Sha256RipeMd160BatchAvx512(State *state) {
+  BM_BatchKernel<Sha256RipeMd160Batch, kSha256BatchKernelAvx512>(state);
+}
+
+// SHA-256-SHA-256 of |kBatchCount| 64 byte messages, the
+// merkle tree node case.
+template<Sha256BatchKernel kKernel>
+void BM_Sha256D64Kernel(State *state) {
+  const Sha256BatchKernel initial_kernel = GetSha256BatchKernel();
+  if (!SetSha256BatchKernel(kKernel)) return;
+  const std::vector<uint8_t> data = MakeTestData(64 * kBatchCount);
+  std::vector<uint8_t> digests(kBatchCount * kSha256DigestLength);
+  while (state->KeepRunning()) {
+    Sha256D64(data.data(), kBatchCount, digests.data());
+    DoNotOptimize(digests[0]);
+  }
+  state->SetItemsPerOp(kBatchCount);
+  state->SetBytesPerOp(data.size());
+  SetSha256BatchKernel(initial_kernel);
+}
+
+void BM_Sha256D64Scalar(State *state) {
+  BM_Sha256D64Kernel<kSha256BatchKernelScalar>(state);
+}
+void BM_Sha256D64Avx2(State *state) {
+  BM_Sha256D64Kernel<kSha256BatchKernelAvx2>(state);
+}
+void BM_Sha256D64Avx512(State *state) {
+  BM_Sha256D64Kernel<kSha256BatchKernelAvx512>(state);
+}
+
+// SHA-256-SHA-256 of an 80 byte header and a payload of the given
+// size, as segments and copied together.
+void BM_Sha256Sha256V(State *state) {
+  const std::vector<uint8_t> header = MakeTestData(80);
+  const std::vector<uint8_t> payload = MakeTestData(state->size());
+  uint8_t digest[kSha256DigestLength];
+  while (state->KeepRunning()) {
+    DoNotOptimize(Sha256Sha256V(
+        {{header.data(), header.size()}, {payload.data(), payload.size()}},
+        digest));
+  }
+  state->SetBytesPerOp(header.size() + payload.size());
+}
+
+void BM_Sha256Sha256Concat(State *state) {
+  const std::vector<uint8_t> header = MakeTestData(80);
+  const std::vector<uint8_t> payload = MakeTestData(state->size());
+  uint8_t digest[kSha256DigestLength];
+  while (state->KeepRunning()) {
+    std::vector<uint8_t> message(header);
+    message.insert(message.end(), payload.begin(), payload.end());
+    DoNotOptimize(Sha256Sha256(message, digest));
+  }
+  state->SetBytesPerOp(header.size() + payload.size());
+}
+
+// Tagged hashes of a built in tag, a cached tag, and hashing the tag
+// prefix each time.
+void BM_TaggedSha256(State *state) {
+  const std::vector<uint8_t> data = MakeTestData(state->size());
+  uint8_t digest[kSha256DigestLength];
+  while (state->KeepRunning()) {
+    DoNotOptimize(
+        TaggedSha256(kTagTapSighash, data.data(), data.size(), digest));
+  }
+  state->SetBytesPerOp(data.size());
+}
+
+void BM_TaggedSha256Cached(State *state) {
+  const std::vector<uint8_t> data = MakeTestData(state->size());
+  const std::string tag = "BIP0340/nonce";
+  uint8_t digest[kSha256DigestLength];
+  while (state->KeepRunning()) {
+    DoNotOptimize(TaggedSha256(tag, data.data(), data.size(), digest));
+  }
+  state->SetBytesPerOp(data.size());
+}
+
+void BM_TaggedSha256Prefix(State *state) {
+  const std::vector<uint8_t> data = MakeTestData(state->size());
+  const std::vector<uint8_t> tag_hash = Sha256("TapSighash");
+  std::vector<uint8_t> preimage;
+  uint8_t digest[kSha256DigestLength];
+  while (state->KeepRunning()) {
+    preimage.assign(tag_hash.begin(), tag_hash.end());
+    preimage.insert(preimage.end(), tag_hash.begin(), tag_hash.end());
+    preimage.insert(preimage.end(), data.begin(), data.end());
+    DoNotOptimize(Sha256(preimage, digest));
+  }
+  state->SetBytesPerOp(data.size());
+}
+
+// Reset, Update and Finalize on a reused digester.
+void BM_DigesterSha256Sha256(State *state) {
+  const std::vector<uint8_t> data = MakeTestData(state->size());
+  auto digester = Digester::New(kSha256Sha256);
+  if (!digester) return;
+  uint8_t digest[kSha256DigestLength];
+  while (state->KeepRunning()) {
+    digester->Reset();
+    digester->Update(data.data(), data.size());
+    DoNotOptimize(digester->Finalize(digest));
+  }
+  state->SetBytesPerOp(data.size());
+}
+
+// As above, resuming the midstate of all whole blocks of the message;
+// compare with BM_DigesterSha256Sha256 at 80 bytes (a block header).
+void BM_DigesterMidstate(State *state) {
+  const std::vector<uint8_t> data = MakeTestData(state->size());
+  auto digester = Digester::New(kSha256Sha256);
+  if (!digester) return;
+  const size_t prefix_size = data.size() - data.size() % 64;
+  Sha256Midstate midstate;
+  digester->Update(data.data(), prefix_size);
+  if (!digester->SaveMidstate(&midstate)) return;
+  uint8_t digest[kSha256DigestLength];
+  while (state->KeepRunning()) {
+    digester->LoadMidstate(midstate);
+    digester->Update(data.data() + prefix_size, data.size() - prefix_size);
+    DoNotOptimize(digester->Finalize(digest));
+  }
+  state->SetBytesPerOp(data.size());
+}
+
+// Acquire, Update and FinalizeAndReset from the thread's pool.
+void BM_DigesterAcquire(State *state) {
+  const std::vector<uint8_t> data = MakeTestData(state->size());
+  uint8_t digest[kSha256DigestLength];
+  while (state->KeepRunning()) {
+    PooledDigester digester = Digester::Acquire(kSha256Sha256);
+    digester->Update(data.data(), data.size());
+    DoNotOptimize(digester->FinalizeAndReset(digest));
+  }
+  state->SetBytesPerOp(data.size());
+}
+
+void BM_DigesterClone(State *state) {
+  auto digester = Digester::New(kSha256);
+  if (!digester) return;
+  while (state->KeepRunning()) DoNotOptimize(digester->Clone());
+}
+
+void BM_DigesterNew(State *state) {
+  while (state->KeepRunning()) DoNotOptimize(Digester::New(kSha256));
+}
+}  // namespace
+
+BTC_BENCHMARK(BM_Sha256, {32, 64, 1024, 1 << 20});
+BTC_BENCHMARK(BM_Sha256Sha256, {32, 64, 1024, 1 << 20});
+BTC_BENCHMARK(BM_Sha256Generic, {64, 1024});
+BTC_BENCHMARK(BM_Sha256Avx2, {64, 1024});
+BTC_BENCHMARK(BM_Sha256ShaNi, {64, 1024});
+BTC_BENCHMARK(BM_Sha256Sha256BatchScalar, {32, 64, 250});
+BTC_BENCHMARK(BM_Sha256Sha256BatchAvx2, {32, 64, 250});
+BTC_BENCHMARK(BM_Sha256Sha256BatchAvx512, {32, 64, 250});
+BTC_BENCHMARK(BM_Sha256D64Scalar, {64});
+BTC_BENCHMARK(BM_Sha256D64Avx2, {64});
+BTC_BENCHMARK(BM_Sha256D64Avx512, {64});
+BTC_BENCHMARK(BM_RipeMd160, {32, 1024});
+BTC_BENCHMARK(BM_Sha256RipeMd160, {33, 65});
+BTC_BENCHMARK(BM_Sha256RipeMd160BatchScalar, {33, 65});
+BTC_BENCHMARK(BM_Sha256RipeMd160BatchAvx2, {33, 65});
+BTC_BENCHMARK(BM_Sha256RipeMd160BatchAvx512, {33, 65});
+BTC_BENCHMARK(BM_Sha256Sha256V, {250, 4000});
+BTC_BENCHMARK(BM_Sha256Sha256Concat, {250, 4000});
+BTC_BENCHMARK(BM_TaggedSha256, {32, 200});
+BTC_BENCHMARK(BM_TaggedSha256Cached, {32, 200});
+BTC_BENCHMARK(BM_TaggedSha256Prefix, {32, 200});
+BTC_BENCHMARK(BM_DigesterSha256Sha256, {21, 80, 1024});
+BTC_BENCHMARK(BM_DigesterMidstate, {80});
+BTC_BENCHMARK(BM_DigesterAcquire, {21, 80});
+BTC_BENCHMARK(BM_DigesterClone, {0});
+BTC_BENCHMARK(BM_DigesterNew, {0});
+}  // namespace bench
+}  // namespace crypto
+}  // namespace btc
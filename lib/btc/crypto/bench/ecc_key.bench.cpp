@@ -0,0 +1,63 @@
+// Bitcoin Info - Crypto - ECC Keys - Benchmarks
+//
+// Copyright (c) 2022 Alex Dale
+// This project is licensed under the terms of the MIT license.
+// See LICENSE for details.
+#include <vector>
+
+#include "btc/bench/bench.hpp"
+#include "btc/crypto/ecc_key.hpp"
+
+namespace btc {
+namespace crypto {
+namespace bench {
+namespace {
+using ::btc::bench::DoNotOptimize;
+using ::btc::bench::State;
+
+const std::vector<uint8_t> kMessage(32, 0x5a);
+
+void BM_EccGenerateSignature(State *state) {
+  const auto key = EccPrivateKey::New();
+  if (!key) return;
+  while (state->KeepRunning()) {
+    DoNotOptimize(key->GenerateSignature(kMessage));
+  }
+}
+
+void BM_EccVerifySignature(State *state) {
+  const auto key = EccPrivateKey::New();
+  if (!key) return;
+  const std::vector<uint8_t> signature = key->GenerateSignature(kMessage);
+  while (state->KeepRunning()) {
+    DoNotOptimize(key->VerifySignature(kMessage, signature));
+  }
+}
+
+// size() is the length of the encoded point, 33 or 65.
+void BM_EccLoadAsPoint(State *state) {
+  const auto key = EccPrivateKey::New();
+  if (!key) return;
+  const std::vector<uint8_t> point =
+      key->SerializeAsPublicPoint(state->size() == 33);
+  while (state->KeepRunning()) {
+    DoNotOptimize(EccPublicKey::LoadAsPoint(point));
+  }
+}
+
+void BM_EccSerializeAsPublicPoint(State *state) {
+  const auto key = EccPrivateKey::New();
+  if (!key) return;
+  while (state->KeepRunning()) {
+    DoNotOptimize(key->SerializeAsPublicPoint(state->size() == 33));
+  }
+}
+}  // namespace
+
+BTC_BENCHMARK(BM_EccGenerateSignature, {32});
+BTC_BENCHMARK(BM_EccVerifySignature, {32});
+BTC_BENCHMARK(BM_EccLoadAsPoint, {33, 65});
+BTC_BENCHMARK(BM_EccSerializeAsPublicPoint, {33, 65});
+}  // namespace bench
+}  // namespace crypto
+}  // namespace btc
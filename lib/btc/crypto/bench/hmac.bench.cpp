@@ -0,0 +1,103 @@
+// Bitcoin Info - Crypto - HMAC and PBKDF2 - Benchmarks
+//
+// Copyright (c) 2022 Alex Dale
+// This project is licensed under the terms of the MIT license.
+// See LICENSE for details.
+#include <string>
+#include <vector>
+
+#include "btc/bench/bench.hpp"
+#include "btc/crypto/digest.hpp"
+#include "btc/crypto/hmac.hpp"
+#include "btc/test/test_data.hpp"
+
+namespace btc {
+namespace crypto {
+namespace bench {
+namespace {
+using ::btc::bench::DoNotOptimize;
+using ::btc::bench::State;
+using ::btc::test::MakeTestData;
+
+// BIP39 seed parameters.
+const std::string kMnemonic =
+    "abandon abandon abandon abandon abandon abandon abandon abandon "
+    "abandon abandon abandon about";
+const std::string kSalt = "mnemonicTREZOR";
+constexpr size_t kBip39Iterations = 2048;
+
+const uint8_t *Bytes(const std::string &data) {
+  return reinterpret_cast<const uint8_t *>(data.data());
+}
+
+void BM_HmacSha256(State *state) {
+  HmacSha256Key key;
+  key.SetKey(MakeTestData(32));
+  const std::vector<uint8_t> data = MakeTestData(state->size());
+  uint8_t mac[kSha256DigestLength];
+  while (state->KeepRunning()) {
+    DoNotOptimize(key.Mac(data.data(), data.size(), mac));
+  }
+  state->SetBytesPerOp(data.size());
+}
+
+void BM_HmacSha512(State *state) {
+  HmacSha512Key key;
+  key.SetKey(MakeTestData(32));
+  const std::vector<uint8_t> data = MakeTestData(state->size());
+  uint8_t mac[kSha512DigestLength];
+  while (state->KeepRunning()) {
+    DoNotOptimize(key.Mac(data.data(), data.size(), mac));
+  }
+  state->SetBytesPerOp(data.size());
+}
+
+// One BIP39 seed.
+void BM_Bip39Seed(State *state) {
+  uint8_t seed[kSha512DigestLength];
+  while (state->KeepRunning()) {
+    DoNotOptimize(Pbkdf2HmacSha512(
+        Bytes(kMnemonic), kMnemonic.size(), Bytes(kSalt), kSalt.size(),
+        kBip39Iterations, seed, sizeof(seed)));
+  }
+  state->SetItemsPerOp(1);
+}
+
+// |state->size()| BIP39 seeds with a specific batch kernel.
+template<Sha512BatchKernel kKernel>
+void BM_Bip39SeedBatch(State *state) {
+  const Sha512BatchKernel initial_kernel = GetSha512BatchKernel();
+  if (!SetSha512BatchKernel(kKernel)) return;
+  const std::vector<Pbkdf2Input> inputs(
+      state->size(),
+      {Bytes(kMnemonic), kMnemonic.size(), Bytes(kSalt), kSalt.size()});
+  std::vector<uint8_t> seeds(inputs.size() * kSha512DigestLength);
+  while (state->KeepRunning()) {
+    DoNotOptimize(Pbkdf2HmacSha512Batch(
+        inputs.data(), inputs.size(), kBip39Iterations, seeds.data(),
+        kSha512DigestLength, state->threads()));
+  }
+  state->SetItemsPerOp(inputs.size());
+  SetSha512BatchKernel(initial_kernel);
+}
+
+void BM_Bip39SeedBatchScalar(State *state) {
+  BM_Bip39SeedBatch<kSha512BatchKernelScalar>(state);
+}
+void BM_Bip39SeedBatchAvx2(State *state) {
+  BM_Bip39SeedBatch<kSha512BatchKernelAvx2>(state);
+}
+void BM_Bip39SeedBatchAvx512(State *state) {
+  BM_Bip39SeedBatch<kSha512BatchKernelAvx512>(state);
+}
+}  // namespace
+
+BTC_BENCHMARK(BM_HmacSha256, {32, 1024});
+BTC_BENCHMARK(BM_HmacSha512, {32, 1024});
+BTC_BENCHMARK(BM_Bip39Seed, {1});
+BTC_BENCHMARK(BM_Bip39SeedBatchScalar, {16}, {1, 4});
+BTC_BENCHMARK(BM_Bip39SeedBatchAvx2, {16}, {1, 4});
+BTC_BENCHMARK(BM_Bip39SeedBatchAvx512, {16}, {1, 4});
+}  // namespace bench
+}  // namespace crypto
+}  // namespace btc
@@ -3,14 +3,16 @@
 // Copyright (c) 2022 Alex Dale
 // This project is licensed under the terms of the MIT license.
 // See LICENSE for details.
-#ifndef _BTC_CRYPTO_HASH_HPP_
-#define _BTC_CRYPTO_HASH_HPP_
+#ifndef _BTC_CRYPTO_DIGEST_HPP_
+#define _BTC_CRYPTO_DIGEST_HPP_
 
+#include <initializer_list>
 #include <string>
 #include <vector>
 
 #include "btc/cc/attr.h"
 #include "btc/cc/base.h"
+#include "btc/crypto/hash.hpp"
 
 namespace btc {
 namespace crypto {
@@ -38,10 +40,75 @@ std::vector<uint8_t> Digest(DigestAlgorithm algorithm, const std::string &data);
 std::vector<uint8_t> Digest(
     DigestAlgorithm algorithm, const std::vector<uint8_t> &data);
 
+// A message for the batch digests, or a segment of a message for the
+// scatter-gather digests.
+struct DigestInput {
+  const uint8_t *data;
+  size_t size;
+};  // struct DigestInput
+
+// Scatter-gather digests of the concatenation of |count| |segments|,
+// such as a header and its payload, or a transaction serialized around
+// its witnesses, without copying them together first.  Segments are
+// fed to the compression function in place; only blocks which straddle
+// segments are copied.  Fail if any segment has null data and a
+// non-zero size.
+std::vector<uint8_t> DigestV(
+    DigestAlgorithm algorithm, const DigestInput *segments, size_t count);
+std::vector<uint8_t> DigestV(
+    DigestAlgorithm algorithm, std::initializer_list<DigestInput> segments);
+
 // SHA-256
 
 constexpr size_t kSha256DigestLength = 32;
 
+// Implementations of the SHA-256 compression function.  The fastest
+// kernel supported by the CPU is selected the first time SHA-256 is
+// used.
+enum Sha256Kernel {
+  // Portable C++, one block at a time.
+  kSha256KernelGeneric = 0,
+  // x86 AVX2 message schedule, two blocks at a time, BMI2 rounds.
+  kSha256KernelAvx2 = 1,
+  // x86 SHA extensions.
+  kSha256KernelShaNi = 2,
+};  // enum Sha256Kernel
+
+const char *Sha256KernelToString(Sha256Kernel kernel) __RETURN_NOT_NULL;
+bool IsSha256KernelSupported(Sha256Kernel kernel);
+// Currently active kernel.
+Sha256Kernel GetSha256Kernel();
+// Overrides the automatically selected kernel.  Intended for testing
+// and benchmarking.  Fails if the kernel is not supported by the CPU.
+bool SetSha256Kernel(Sha256Kernel kernel);
+
+// Implementations of the batch SHA-256 digests.  Selected on first use;
+// with the SHA extensions, one message at a time is faster than eight
+// AVX2 lanes, but not sixteen AVX-512 lanes.
+enum Sha256BatchKernel {
+  // One message at a time with the active Sha256Kernel.
+  kSha256BatchKernelScalar = 0,
+  // x86 AVX2, 8 messages at a time.
+  kSha256BatchKernelAvx2 = 1,
+  // x86 AVX-512, 16 messages at a time.
+  kSha256BatchKernelAvx512 = 2,
+};  // enum Sha256BatchKernel
+
+const char *Sha256BatchKernelToString(Sha256BatchKernel kernel)
+    __RETURN_NOT_NULL;
+bool IsSha256BatchKernelSupported(Sha256BatchKernel kernel);
+Sha256BatchKernel GetSha256BatchKernel();
+bool SetSha256BatchKernel(Sha256BatchKernel kernel);
+
+// SHA-256 state between 64 byte blocks.  The midstate of a shared
+// prefix, such as the first 64 bytes of a block header, can be saved
+// once and resumed for every message which extends it.
+struct Sha256Midstate {
+  uint32_t state[8];
+  // Bytes digested, a multiple of 64.
+  uint64_t count;
+};  // struct Sha256Midstate
+
 bool Sha256(const uint8_t *data, size_t data_size, uint8_t *digest)
     __NOT_NULL(3);
 bool Sha256(const std::string &data, uint8_t *digest) __NOT_NULL(2);
@@ -49,6 +116,23 @@ bool Sha256(const std::vector<uint8_t> &data, uint8_t *digest) __NOT_NULL(2);
 std::vector<uint8_t> Sha256(const uint8_t *data, size_t data_size);
 std::vector<uint8_t> Sha256(const std::string &data);
 std::vector<uint8_t> Sha256(const std::vector<uint8_t> &data);
+// By value; fail with an error log and return a zero hash.
+Hash256 Sha256Hash(const uint8_t *data, size_t data_size);
+Hash256 Sha256Hash(const std::string &data);
+Hash256 Sha256Hash(const std::vector<uint8_t> &data);
+// Scatter-gather, see DigestV().
+bool Sha256V(const DigestInput *segments, size_t count, uint8_t *digest)
+    __NOT_NULL(3);
+bool Sha256V(std::initializer_list<DigestInput> segments, uint8_t *digest)
+    __NOT_NULL(2);
+
+// Digests |count| independent messages, writing the digest of
+// |inputs[i]| to |digests| + i * kSha256DigestLength.  Messages are
+// hashed in parallel lanes, each lane moving on to the next message as
+// soon as its current one is done, so lengths may differ.
+// Fails if any input has null data and a non-zero size.
+bool Sha256Batch(const DigestInput *inputs, size_t count, uint8_t *digests)
+    __NOT_NULL(3);
 
 // SHA-256-SHA-256
 
@@ -60,6 +144,86 @@ bool Sha256Sha256(const std::vector<uint8_t> &data, uint8_t *digest)
 std::vector<uint8_t> Sha256Sha256(const uint8_t *data, size_t data_size);
 std::vector<uint8_t> Sha256Sha256(const std::string &data);
 std::vector<uint8_t> Sha256Sha256(const std::vector<uint8_t> &data);
+Hash256 Sha256Sha256Hash(const uint8_t *data, size_t data_size);
+Hash256 Sha256Sha256Hash(const std::string &data);
+Hash256 Sha256Sha256Hash(const std::vector<uint8_t> &data);
+// Scatter-gather, see DigestV().
+bool Sha256Sha256V(const DigestInput *segments, size_t count, uint8_t *digest)
+    __NOT_NULL(3);
+bool Sha256Sha256V(
+    std::initializer_list<DigestInput> segments, uint8_t *digest)
+    __NOT_NULL(2);
+Hash256 Sha256Sha256HashV(const DigestInput *segments, size_t count);
+Hash256 Sha256Sha256HashV(std::initializer_list<DigestInput> segments);
+
+// Batch SHA-256-SHA-256, see Sha256Batch().
+bool Sha256Sha256Batch(
+    const DigestInput *inputs, size_t count, uint8_t *digests) __NOT_NULL(3);
+
+// SHA-256-SHA-256 of |count| consecutive 64 byte messages, such as the
+// pairs of child hashes of a merkle tree level, writing |count|
+// consecutive digests.  The padding and the second pass are constant
+// for this size and are precomputed.  |digests| may be |data|, which
+// computes the next merkle tree level in place.
+void Sha256D64(const uint8_t *data, size_t count, uint8_t *digests)
+    __NOT_NULL(1, 3);
+
+// SHA-256-SHA-256 of |count| 80 byte messages which differ only in
+// their last 4 bytes, a little endian counter: the block header nonce.
+// Message |i| is |message| with the counter set to |nonce| + i
+// (wrapping), its digest is written to |digests| + i *
+// kSha256DigestLength.  |midstate| must be the midstate after the
+// first 64 bytes of |message|; each message then costs two
+// compressions, hashed in parallel lanes.  The last 4 bytes of
+// |message| are ignored.
+// Fails if |midstate| is not after exactly one block.
+bool Sha256D80Nonces(
+    const Sha256Midstate &midstate, const uint8_t *message, uint32_t nonce,
+    size_t count, uint8_t *digests) __NOT_NULL(2, 5);
+
+// Tagged SHA-256 (BIP340)
+
+// SHA-256(SHA-256(tag) || SHA-256(tag) || message), as used by Schnorr
+// signatures and Taproot.  The 64 byte tag prefix is exactly one
+// block, so a tag reduces to the midstate after it and each tagged
+// hash starts from there.  The midstates of the tags below are built
+// in; those of other tags are computed on first use and cached per
+// thread.
+enum TaggedHashTag {
+  // "BIP0340/challenge"
+  kTagBip340Challenge = 0,
+  // "TapLeaf"
+  kTagTapLeaf = 1,
+  // "TapBranch"
+  kTagTapBranch = 2,
+  // "TapTweak"
+  kTagTapTweak = 3,
+  // "TapSighash"
+  kTagTapSighash = 4,
+};  // enum TaggedHashTag
+
+// The tag itself.
+const char *TaggedHashTagToString(TaggedHashTag tag) __RETURN_NOT_NULL;
+
+// Midstate after the tag prefix, for resuming with a Digester.
+bool TaggedHashMidstate(TaggedHashTag tag, Sha256Midstate *midstate)
+    __NOT_NULL(2);
+bool TaggedHashMidstate(const std::string &tag, Sha256Midstate *midstate)
+    __NOT_NULL(2);
+
+bool TaggedSha256(
+    TaggedHashTag tag, const uint8_t *data, size_t data_size, uint8_t *digest)
+    __NOT_NULL(4);
+bool TaggedSha256(
+    const std::string &tag, const uint8_t *data, size_t data_size,
+    uint8_t *digest) __NOT_NULL(4);
+Hash256 TaggedSha256Hash(
+    TaggedHashTag tag, const uint8_t *data, size_t data_size);
+Hash256 TaggedSha256Hash(TaggedHashTag tag, const std::vector<uint8_t> &data);
+Hash256 TaggedSha256Hash(
+    const std::string &tag, const uint8_t *data, size_t data_size);
+Hash256 TaggedSha256Hash(
+    const std::string &tag, const std::vector<uint8_t> &data);
 
 // RIPEMD-160
 
@@ -72,6 +236,9 @@ bool RipeMd160(const std::vector<uint8_t> &data, uint8_t *digest) __NOT_NULL(2);
 std::vector<uint8_t> RipeMd160(const uint8_t *data, size_t data_size);
 std::vector<uint8_t> RipeMd160(const std::string &data);
 std::vector<uint8_t> RipeMd160(const std::vector<uint8_t> &data);
+Hash160 RipeMd160Hash(const uint8_t *data, size_t data_size);
+Hash160 RipeMd160Hash(const std::string &data);
+Hash160 RipeMd160Hash(const std::vector<uint8_t> &data);
 
 // SHA-256-RIPEMD-160
 
@@ -83,7 +250,70 @@ bool Sha256RipeMd160(const std::vector<uint8_t> &data, uint8_t *digest)
 std::vector<uint8_t> Sha256RipeMd160(const uint8_t *data, size_t data_size);
 std::vector<uint8_t> Sha256RipeMd160(const std::string &data);
 std::vector<uint8_t> Sha256RipeMd160(const std::vector<uint8_t> &data);
+Hash160 Sha256RipeMd160Hash(const uint8_t *data, size_t data_size);
+Hash160 Sha256RipeMd160Hash(const std::string &data);
+Hash160 Sha256RipeMd160Hash(const std::vector<uint8_t> &data);
+
+// Batch SHA-256-RIPEMD-160, see Sha256Batch().  Intended for deriving
+// the key hashes of many public keys.
+bool Sha256RipeMd160Batch(
+    const DigestInput *inputs, size_t count, uint8_t *digests) __NOT_NULL(3);
+
+// Implementations of the RIPEMD-160 pass of Sha256RipeMd160Batch().
+// Selected on first use from the vector extensions alone; there are no
+// RIPEMD-160 instructions to prefer.
+enum RipeMd160BatchKernel {
+  // One message at a time.
+  kRipeMd160BatchKernelScalar = 0,
+  // x86 AVX2, 8 messages at a time.
+  kRipeMd160BatchKernelAvx2 = 1,
+  // x86 AVX-512, 16 messages at a time.
+  kRipeMd160BatchKernelAvx512 = 2,
+};  // enum RipeMd160BatchKernel
+
+const char *RipeMd160BatchKernelToString(RipeMd160BatchKernel kernel)
+    __RETURN_NOT_NULL;
+bool IsRipeMd160BatchKernelSupported(RipeMd160BatchKernel kernel);
+RipeMd160BatchKernel GetRipeMd160BatchKernel();
+bool SetRipeMd160BatchKernel(RipeMd160BatchKernel kernel);
+
+// SHA-512
+
+constexpr size_t kSha512DigestLength = 64;
+
+// SHA-512 state between 128 byte blocks, see Sha256Midstate.
+struct Sha512Midstate {
+  uint64_t state[8];
+  // Bytes digested, a multiple of 128.
+  uint64_t count;
+};  // struct Sha512Midstate
+
+// Implementations of the parallel lanes of Pbkdf2HmacSha512Batch().
+// Selected on first use from the vector extensions alone; the SHA
+// extensions do not cover SHA-512.
+enum Sha512BatchKernel {
+  // One block at a time.
+  kSha512BatchKernelScalar = 0,
+  // x86 AVX2, 4 blocks at a time.
+  kSha512BatchKernelAvx2 = 1,
+  // x86 AVX-512, 8 blocks at a time.
+  kSha512BatchKernelAvx512 = 2,
+};  // enum Sha512BatchKernel
+
+const char *Sha512BatchKernelToString(Sha512BatchKernel kernel)
+    __RETURN_NOT_NULL;
+bool IsSha512BatchKernelSupported(Sha512BatchKernel kernel);
+Sha512BatchKernel GetSha512BatchKernel();
+bool SetSha512BatchKernel(Sha512BatchKernel kernel);
+
+bool Sha512(const uint8_t *data, size_t data_size, uint8_t *digest)
+    __NOT_NULL(3);
+bool Sha512(const std::string &data, uint8_t *digest) __NOT_NULL(2);
+bool Sha512(const std::vector<uint8_t> &data, uint8_t *digest) __NOT_NULL(2);
+std::vector<uint8_t> Sha512(const uint8_t *data, size_t data_size);
+std::vector<uint8_t> Sha512(const std::string &data);
+std::vector<uint8_t> Sha512(const std::vector<uint8_t> &data);
 }  // namespace crypto
 }  // namespace btc
 
-#endif  // _BTC_CRYPTO_HASH_HPP_
+#endif  // _BTC_CRYPTO_DIGEST_HPP_
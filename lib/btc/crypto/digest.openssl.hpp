@@ -0,0 +1,57 @@
+// Bitcoin Info - Cryptography - OpenSSL Digest Algorithm
+//
+// Copyright (c) 2022 Alex Dale
+// This project is licensed under the terms of the MIT license.
+// See LICENSE for details.
+#ifndef _BTC_CRYPTO_OPENSSL_DIGEST_HPP_
+#define _BTC_CRYPTO_OPENSSL_DIGEST_HPP_
+
+#ifndef _BTC_CRYPTO_DIGEST_INTERNAL_
+#  error Header should only be included internally
+#endif  // _BTC_CRYPTO_DIGEST_INTERNAL_
+
+#include <openssl/evp.h>
+
+#include "btc/cc/attr.h"
+#include "btc/cc/base.h"
+
+namespace btc {
+namespace crypto {
+namespace internal {
+enum OpenSslDigest {
+  kOpenSslSha256 = 0,
+  kOpenSslRipeMd160 = 1,
+  kOpenSslSha512 = 2,
+};  // enum OpenSslDigest
+constexpr size_t kOpenSslDigestCount = 3;
+constexpr size_t kOpenSslSha512DigestLength = 64;
+
+// Process-wide EVP_MD handles.  OpenSSL 3 looks up the provider of
+// an algorithm (and takes its locks) each time EVP_sha256() and the
+// like are used to initialize a context; these are fetched once, on
+// first use or by InitDigestAlgorithms(), and held until
+// TeardownDigestAlgorithms().  Returns null if the algorithm is not
+// available.
+const EVP_MD *GetOpenSslDigest(OpenSslDigest digest);
+
+// Fetches every handle up front.  These only serve the OpenSSL
+// reference digests, which the native kernels are tested against; an
+// unavailable one is logged and fetched again on next use.
+void InitDigestAlgorithms();
+// Releases the handles, for leak checkers and library unloading.  No
+// OpenSSL digest may be in progress; later use fetches them again.
+void TeardownDigestAlgorithms();
+
+// One-shot digests using OpenSSL.  All three are computed natively,
+// the OpenSSL versions serve as oracles for the native kernels.
+bool OpenSslSha256(const uint8_t *data, size_t data_size, uint8_t *digest)
+    __NOT_NULL(3);
+bool OpenSslRipeMd160(const uint8_t *data, size_t data_size, uint8_t *digest)
+    __NOT_NULL(3);
+bool OpenSslSha512(const uint8_t *data, size_t data_size, uint8_t *digest)
+    __NOT_NULL(3);
+}  // namespace internal
+}  // namespace crypto
+}  // namespace btc
+
+#endif  // _BTC_CRYPTO_OPENSSL_DIGEST_HPP_
@@ -0,0 +1,68 @@
+// Bitcoin Info - Cryptography - File Digests
+//
+// Copyright (c) 2022 Alex Dale
+// This project is licensed under the terms of the MIT license.
+// See LICENSE for details.
+#ifndef _BTC_CRYPTO_DIGEST_FILE_HPP_
+#define _BTC_CRYPTO_DIGEST_FILE_HPP_
+
+#include <string>
+#include <vector>
+
+#include "btc/cc/attr.h"
+#include "btc/cc/base.h"
+#include "btc/crypto/digest.hpp"
+
+namespace btc {
+namespace crypto {
+// How a file is read for digesting.
+enum FileReadMode {
+  // Maps the file with sequential read ahead.  Falls back to buffered
+  // reads for files which cannot be mapped, such as pipes.
+  kFileReadMmap = 0,
+  // Large page aligned read()s into a reused buffer.
+  kFileReadBuffered = 1,
+};  // enum FileReadMode
+
+const char *FileReadModeToString(FileReadMode mode) __RETURN_NOT_NULL;
+
+// Digests the contents of the file at |path|, with any algorithm
+// supported by Digester.  Sets |size| (if provided) to the number of
+// bytes digested.
+bool DigestFile(
+    DigestAlgorithm algorithm, const std::string &path,
+    std::vector<uint8_t> *digest, uint64_t *size = nullptr,
+    FileReadMode mode = kFileReadMmap) __NOT_NULL(3);
+
+struct FileDigest {
+  std::string path = "";
+  // False if the file could not be read, the digest is then empty.
+  bool ok = false;
+  uint64_t size = 0;
+  std::vector<uint8_t> digest = {};
+};  // struct FileDigest
+
+struct FileDigestStats {
+  // Files digested and files which could not be read.
+  uint64_t files = 0;
+  uint64_t failed = 0;
+  uint64_t bytes = 0;
+  // Wall time of the whole run.
+  uint64_t elapsed_ns = 0;
+
+  double BytesPerSecond() const;
+};  // struct FileDigestStats
+
+// Digests each of |paths|, such as the blk*.dat files of a node, up to
+// |threads| files at a time (0 for the default).  Files are handed out
+// one at a time as threads become free, so files of uneven size still
+// keep every thread busy.  Returns one result per path, in order, and
+// sets |stats| (if provided) to the totals of the run.
+std::vector<FileDigest> DigestFiles(
+    DigestAlgorithm algorithm, const std::vector<std::string> &paths,
+    size_t threads = 1, FileDigestStats *stats = nullptr,
+    FileReadMode mode = kFileReadMmap);
+}  // namespace crypto
+}  // namespace btc
+
+#endif  // _BTC_CRYPTO_DIGEST_FILE_HPP_
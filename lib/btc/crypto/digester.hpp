@@ -18,15 +18,34 @@ namespace btc {
 namespace crypto {
 
 namespace internal {
-class NativeDigester;
+class Sha256Context;
 }  // namespace internal
 
+class Digester;
+
+// Returns a digester to the pool of the current thread.
+struct DigesterRecycler {
+  void operator()(Digester *digester) const;
+};  // struct DigesterRecycler
+
+using PooledDigester = std::unique_ptr<Digester, DigesterRecycler>;
+
 class Digester {
 public:
   BTC_DISALLOW_COPY_AND_MOVE(Digester);
   ~Digester();
 
   static std::unique_ptr<Digester> New(DigestAlgorithm algorithm);
+  // An empty digester from a small pool kept by each thread.  The
+  // digester returns to the pool when released, so once the pool is
+  // warm, acquiring one does not allocate.
+  static PooledDigester Acquire(DigestAlgorithm algorithm);
+  // A digester which has already digested the prefix of |midstate|.
+  static std::unique_ptr<Digester> FromMidstate(
+      DigestAlgorithm algorithm, const Sha256Midstate &midstate);
+
+  // Independent copy of the digester and its state.
+  std::unique_ptr<Digester> Clone() const;
 
   DigestAlgorithm algorithm() const { return _algorithm; }
 
@@ -39,6 +58,13 @@ public:
   // Reset the digester to empty.
   void Reset();
 
+  // Midstates can only be saved between 64 byte blocks; fails if
+  // Count() is not a multiple of 64.
+  bool SaveMidstate(Sha256Midstate *midstate) const;
+  // Resets the digester to |midstate|, without allocating.  Cheaper
+  // than Clone() for branching a prefix into many messages.
+  bool LoadMidstate(const Sha256Midstate &midstate);
+
   bool Update(uint8_t datum);
   bool Update(const std::string &data);
   bool Update(const std::vector<uint8_t> &data);
@@ -46,16 +72,24 @@ public:
 
   bool Finalize(uint8_t *digest);
   std::vector<uint8_t> Finalize();
+  // Fails if |digest| is not the length of the algorithm's digest.
+  bool Finalize(Hash256 *digest);
+  bool Finalize(Hash160 *digest);
+  // Finalizes without first copying the state, then resets the
+  // digester.  For when no more data follows.
+  bool FinalizeAndReset(uint8_t *digest);
+  bool FinalizeAndReset(Hash256 *digest);
+  bool FinalizeAndReset(Hash160 *digest);
 
 private:
   Digester(
       DigestAlgorithm algorithm,
-      std::unique_ptr<internal::NativeDigester> &&native_digester);
+      std::unique_ptr<internal::Sha256Context> &&context);
 
   const DigestAlgorithm _algorithm;
   const size_t _digest_length;
   size_t _byte_count = 0;
-  std::unique_ptr<internal::NativeDigester> _digester;
+  std::unique_ptr<internal::Sha256Context> _context;
 };  // class Digester
 }  // namespace crypto
 }  // namespace btc
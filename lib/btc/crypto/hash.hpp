@@ -0,0 +1,111 @@
+// Bitcoin Info - Cryptography - Hash Values
+//
+// Copyright (c) 2022 Alex Dale
+// This project is licensed under the terms of the MIT license.
+// See LICENSE for details.
+#ifndef _BTC_CRYPTO_HASH_HPP_
+#define _BTC_CRYPTO_HASH_HPP_
+
+#include <string.h>
+
+#include <array>
+#include <string>
+#include <vector>
+
+#include "btc/cc/attr.h"
+#include "btc/cc/base.h"
+#include "btc/cc/classy.hpp"
+#include "btc/cc/hash.hpp"
+
+namespace btc {
+namespace crypto {
+// A digest stored by value, for the many places where digests are
+// kept, compared and used as keys.  A std::vector<uint8_t> of the
+// same digest costs a heap block on top of a 24 byte header.
+// Default constructed hashes are all zero.  |kDisplayReversed| is
+// whether the hexadecimal form is in reverse byte order by default, as
+// with block and transaction IDs.
+template<size_t kLength, bool kDisplayReversed>
+class FixedHash {
+public:
+  BTC_DEFAULT_COPY_AND_MOVE(FixedHash);
+  constexpr FixedHash() {}
+  // Copies |kLength| bytes of |data|.
+  explicit FixedHash(const uint8_t *data) {
+    memcpy(_bytes.data(), data, kLength);
+  }
+  // Constant hashes, see btc/encode/hex.literal.hpp and
+  // btc/crypto/sha256.constexpr.hpp.
+  constexpr explicit FixedHash(const std::array<uint8_t, kLength> &bytes):
+      _bytes(bytes) {}
+
+  // Parses |kLength| * 2 hexadecimal digits, in reverse byte order if
+  // |reverse| is set.
+  static bool FromHex(
+      const std::string &hex, FixedHash *hash,
+      bool reverse = kDisplayReversed) __NOT_NULL(2);
+
+  static constexpr size_t size() { return kLength; }
+  uint8_t *data() { return _bytes.data(); }
+  const uint8_t *data() const { return _bytes.data(); }
+  uint8_t &operator[](size_t index) { return _bytes[index]; }
+  uint8_t operator[](size_t index) const { return _bytes[index]; }
+
+  using iterator = typename std::array<uint8_t, kLength>::iterator;
+  using const_iterator =
+      typename std::array<uint8_t, kLength>::const_iterator;
+  iterator begin() { return _bytes.begin(); }
+  iterator end() { return _bytes.end(); }
+  const_iterator begin() const { return _bytes.begin(); }
+  const_iterator end() const { return _bytes.end(); }
+
+  bool IsZero() const {
+    for (const uint8_t byte : _bytes) {
+      if (byte != 0) return false;
+    }
+    return true;
+  }
+
+  // Hexadecimal in display order, see FromHex().
+  std::string ToHex(bool reverse = kDisplayReversed) const;
+  std::vector<uint8_t> ToVector() const { return {begin(), end()}; }
+
+  // Digests are uniformly distributed, so their leading bytes are
+  // already a good hash.
+  size_t Hash() const {
+    size_t hash;
+    memcpy(&hash, _bytes.data(), sizeof(hash));
+    return hash;
+  }
+
+  bool Equals(const FixedHash &other) const {
+    return memcmp(_bytes.data(), other._bytes.data(), kLength) == 0;
+  }
+  // Byte wise order.
+  int Compare(const FixedHash &other) const {
+    return memcmp(_bytes.data(), other._bytes.data(), kLength);
+  }
+  BTC_EQUATABLE_TO(FixedHash);
+  BTC_COMPARABLE_TO(FixedHash);
+
+private:
+  std::array<uint8_t, kLength> _bytes = {};
+
+  static_assert(kLength >= sizeof(size_t), "Hash too short for Hash()");
+};  // class FixedHash
+
+// SHA-256 and SHA-256-SHA-256 digests, displayed reversed.
+using Hash256 = FixedHash<32, true>;
+// RIPEMD-160 and SHA-256-RIPEMD-160 digests, such as key hashes, which
+// are displayed in order.
+using Hash160 = FixedHash<20, false>;
+
+extern template class FixedHash<32, true>;
+extern template class FixedHash<20, false>;
+}  // namespace crypto
+}  // namespace btc
+
+__DEFINE_STD_HASH(btc::crypto::Hash256);
+__DEFINE_STD_HASH(btc::crypto::Hash160);
+
+#endif  // _BTC_CRYPTO_HASH_HPP_
@@ -0,0 +1,111 @@
+// Bitcoin Info - Cryptography - HMAC and PBKDF2
+//
+// Copyright (c) 2022 Alex Dale
+// This project is licensed under the terms of the MIT license.
+// See LICENSE for details.
+#ifndef _BTC_CRYPTO_HMAC_HPP_
+#define _BTC_CRYPTO_HMAC_HPP_
+
+#include <string>
+#include <vector>
+
+#include "btc/cc/attr.h"
+#include "btc/cc/base.h"
+#include "btc/cc/classy.hpp"
+#include "btc/crypto/digest.hpp"
+
+namespace btc {
+namespace crypto {
+// An HMAC (RFC 2104) key, held as the midstates of its inner and outer
+// pad blocks.  Each MAC resumes the midstates instead of compressing
+// the two pad blocks again.
+class HmacSha256Key {
+public:
+  BTC_DEFAULT_COPY_AND_MOVE(HmacSha256Key);
+  // The empty key.
+  HmacSha256Key();
+
+  // Keys longer than the 64 byte block are hashed first.
+  bool SetKey(const uint8_t *key, size_t key_size);
+  bool SetKey(const std::string &key);
+  bool SetKey(const std::vector<uint8_t> &key);
+
+  // Writes the kSha256DigestLength byte MAC of |data|.
+  bool Mac(const uint8_t *data, size_t data_size, uint8_t *mac) const
+      __NOT_NULL(4);
+
+  const Sha256Midstate &inner() const { return _inner; }
+  const Sha256Midstate &outer() const { return _outer; }
+
+private:
+  Sha256Midstate _inner = {};
+  Sha256Midstate _outer = {};
+};  // class HmacSha256Key
+
+// As above, over SHA-512 with 128 byte blocks.
+class HmacSha512Key {
+public:
+  BTC_DEFAULT_COPY_AND_MOVE(HmacSha512Key);
+  HmacSha512Key();
+
+  bool SetKey(const uint8_t *key, size_t key_size);
+  bool SetKey(const std::string &key);
+  bool SetKey(const std::vector<uint8_t> &key);
+
+  // Writes the kSha512DigestLength byte MAC of |data|.
+  bool Mac(const uint8_t *data, size_t data_size, uint8_t *mac) const
+      __NOT_NULL(4);
+
+  const Sha512Midstate &inner() const { return _inner; }
+  const Sha512Midstate &outer() const { return _outer; }
+
+private:
+  Sha512Midstate _inner = {};
+  Sha512Midstate _outer = {};
+};  // class HmacSha512Key
+
+// One-shot HMACs.
+bool HmacSha256(
+    const uint8_t *key, size_t key_size, const uint8_t *data,
+    size_t data_size, uint8_t *mac) __NOT_NULL(5);
+bool HmacSha512(
+    const uint8_t *key, size_t key_size, const uint8_t *data,
+    size_t data_size, uint8_t *mac) __NOT_NULL(5);
+
+// PBKDF2 (RFC 8018) with HMAC-SHA-256 or HMAC-SHA-512 as the PRF,
+// deriving |key_size| bytes into |key|.  |iterations| must be at least
+// one.  BIP39 seeds are PBKDF2-HMAC-SHA-512 of the mnemonic, salted
+// with "mnemonic" and the passphrase, with 2048 iterations and a 64
+// byte key.
+bool Pbkdf2HmacSha256(
+    const uint8_t *password, size_t password_size, const uint8_t *salt,
+    size_t salt_size, size_t iterations, uint8_t *key, size_t key_size)
+    __NOT_NULL(6);
+bool Pbkdf2HmacSha512(
+    const uint8_t *password, size_t password_size, const uint8_t *salt,
+    size_t salt_size, size_t iterations, uint8_t *key, size_t key_size)
+    __NOT_NULL(6);
+
+struct Pbkdf2Input {
+  const uint8_t *password;
+  size_t password_size;
+  const uint8_t *salt;
+  size_t salt_size;
+};  // struct Pbkdf2Input
+
+// Derives a |key_size| byte key from each of the |count| |inputs|,
+// writing the key of |inputs[i]| to |keys| + i * |key_size|.  The
+// iterations of several keys run together in the lanes of the active
+// SHA-256 or SHA-512 batch kernel (see SetSha256BatchKernel() and
+// SetSha512BatchKernel()), and the keys are split across up to
+// |threads| threads (0 for the default).
+bool Pbkdf2HmacSha256Batch(
+    const Pbkdf2Input *inputs, size_t count, size_t iterations,
+    uint8_t *keys, size_t key_size, size_t threads = 1) __NOT_NULL(4);
+bool Pbkdf2HmacSha512Batch(
+    const Pbkdf2Input *inputs, size_t count, size_t iterations,
+    uint8_t *keys, size_t key_size, size_t threads = 1) __NOT_NULL(4);
+}  // namespace crypto
+}  // namespace btc
+
+#endif  // _BTC_CRYPTO_HMAC_HPP_
@@ -0,0 +1,41 @@
+// Bitcoin Info - Cryptography - RIPEMD-160 Kernels
+//
+// Copyright (c) 2022 Alex Dale
+// This project is licensed under the terms of the MIT license.
+// See LICENSE for details.
+#ifndef _BTC_CRYPTO_RIPEMD160_KERNEL_HPP_
+#define _BTC_CRYPTO_RIPEMD160_KERNEL_HPP_
+
+#ifndef _BTC_CRYPTO_RIPEMD160_INTERNAL_
+#  error Header should only be included internally
+#endif  // _BTC_CRYPTO_RIPEMD160_INTERNAL_
+
+#include "btc/cc/attr.h"
+#include "btc/cc/base.h"
+#include "btc/crypto/digest.hpp"
+
+namespace btc {
+namespace crypto {
+namespace internal {
+constexpr size_t kRipeMd160BlockLength = 64;
+constexpr size_t kRipeMd160StateWords = 5;
+
+// One-shot RIPEMD-160.
+bool NativeRipeMd160(const uint8_t *data, size_t data_size, uint8_t *digest)
+    __NOT_NULL(3);
+
+// RIPEMD-160 of the concatenated |segments|.
+bool NativeRipeMd160V(
+    const DigestInput *segments, size_t count, uint8_t *digest) __NOT_NULL(3);
+
+// One-shot RIPEMD-160(SHA-256(x)).  Compressed (33 byte) and
+// uncompressed (65 byte) public keys are hashed with precomputed
+// padding, and the SHA-256 state is fed to RIPEMD-160 without an
+// intermediate digest.
+bool NativeSha256RipeMd160(
+    const uint8_t *data, size_t data_size, uint8_t *digest) __NOT_NULL(3);
+}  // namespace internal
+}  // namespace crypto
+}  // namespace btc
+
+#endif  // _BTC_CRYPTO_RIPEMD160_KERNEL_HPP_
@@ -0,0 +1,164 @@
+// Bitcoin Info - Cryptography - Compile Time SHA-256
+//
+// Copyright (c) 2022 Alex Dale
+// This project is licensed under the terms of the MIT license.
+// See LICENSE for details.
+#ifndef _BTC_CRYPTO_SHA256_CONSTEXPR_HPP_
+#define _BTC_CRYPTO_SHA256_CONSTEXPR_HPP_
+
+#include <array>
+#include <string_view>
+
+#include "btc/cc/base.h"
+#include "btc/crypto/digest.hpp"
+
+namespace btc {
+namespace crypto {
+namespace internal {
+inline constexpr uint32_t kSha256InitialState[8] = {
+    0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a,
+    0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19};
+
+inline constexpr uint32_t kSha256RoundConstants[64] = {
+    0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1,
+    0x923f82a4, 0xab1c5ed5, 0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3,
+    0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174, 0xe49b69c1, 0xefbe4786,
+    0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+    0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147,
+    0x06ca6351, 0x14292967, 0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13,
+    0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85, 0xa2bfe8a1, 0xa81a664b,
+    0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+    0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a,
+    0x5b9cca4f, 0x682e6ff3, 0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208,
+    0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2};
+
+constexpr uint32_t ConstexprRotateRight(uint32_t x, int n) {
+  return (x >> n) | (x << (32 - n));
+}
+}  // namespace internal
+
+// SHA-256 which the compiler can evaluate, for constants derived from
+// digests, such as tagged hash midstates.  The digests become static
+// data in the binary.  Much slower than Sha256() at run time.
+class ConstexprSha256 {
+public:
+  constexpr ConstexprSha256() {
+    for (size_t i = 0; i < 8; i++) {
+      _state[i] = internal::kSha256InitialState[i];
+    }
+  }
+  // |midstate| count must be a multiple of 64.
+  constexpr explicit ConstexprSha256(const Sha256Midstate &midstate) {
+    for (size_t i = 0; i < 8; i++) _state[i] = midstate.state[i];
+    _count = midstate.count;
+  }
+
+  constexpr ConstexprSha256 &Update(const uint8_t *data, size_t data_size) {
+    for (size_t i = 0; i < data_size; i++) Push(data[i]);
+    return *this;
+  }
+  constexpr ConstexprSha256 &Update(std::string_view data) {
+    for (const char c : data) Push(static_cast<uint8_t>(c));
+    return *this;
+  }
+
+  // Fails if a partial block is buffered.
+  constexpr bool SaveMidstate(Sha256Midstate *midstate) const {
+    if (_count % 64 != 0) return false;
+    for (size_t i = 0; i < 8; i++) midstate->state[i] = _state[i];
+    midstate->count = _count;
+    return true;
+  }
+
+  constexpr std::array<uint8_t, kSha256DigestLength> Finalize() const {
+    ConstexprSha256 context = *this;
+    const uint64_t bit_count = _count * 8;
+    context.Push(0x80);
+    while (context._count % 64 != 56) context.Push(0);
+    for (int shift = 56; shift >= 0; shift -= 8) {
+      context.Push(static_cast<uint8_t>(bit_count >> shift));
+    }
+    std::array<uint8_t, kSha256DigestLength> digest = {};
+    for (size_t i = 0; i < kSha256DigestLength; i++) {
+      digest[i] =
+          static_cast<uint8_t>(context._state[i / 4] >> (24 - (i % 4) * 8));
+    }
+    return digest;
+  }
+
+private:
+  constexpr void Push(uint8_t byte) {
+    _buffer[_count % 64] = byte;
+    _count++;
+    if (_count % 64 == 0) Compress();
+  }
+
+  constexpr void Compress() {
+    using internal::ConstexprRotateRight;
+    uint32_t w[64] = {};
+    for (size_t i = 0; i < 16; i++) {
+      w[i] = static_cast<uint32_t>(_buffer[i * 4]) << 24 |
+             static_cast<uint32_t>(_buffer[i * 4 + 1]) << 16 |
+             static_cast<uint32_t>(_buffer[i * 4 + 2]) << 8 |
+             static_cast<uint32_t>(_buffer[i * 4 + 3]);
+    }
+    for (size_t i = 16; i < 64; i++) {
+      const uint32_t s0 = ConstexprRotateRight(w[i - 15], 7) ^
+                          ConstexprRotateRight(w[i - 15], 18) ^
+                          (w[i - 15] >> 3);
+      const uint32_t s1 = ConstexprRotateRight(w[i - 2], 17) ^
+                          ConstexprRotateRight(w[i - 2], 19) ^
+                          (w[i - 2] >> 10);
+      w[i] = w[i - 16] + s0 + w[i - 7] + s1;
+    }
+    uint32_t v[8] = {};
+    for (size_t i = 0; i < 8; i++) v[i] = _state[i];
+    for (size_t i = 0; i < 64; i++) {
+      const uint32_t s1 = ConstexprRotateRight(v[4], 6) ^
+                          ConstexprRotateRight(v[4], 11) ^
+                          ConstexprRotateRight(v[4], 25);
+      const uint32_t ch = (v[4] & v[5]) ^ (~v[4] & v[6]);
+      const uint32_t t1 =
+          v[7] + s1 + ch + internal::kSha256RoundConstants[i] + w[i];
+      const uint32_t s0 = ConstexprRotateRight(v[0], 2) ^
+                          ConstexprRotateRight(v[0], 13) ^
+                          ConstexprRotateRight(v[0], 22);
+      const uint32_t maj = (v[0] & v[1]) ^ (v[0] & v[2]) ^ (v[1] & v[2]);
+      for (size_t j = 7; j > 0; j--) v[j] = v[j - 1];
+      v[4] += t1;
+      v[0] = t1 + s0 + maj;
+    }
+    for (size_t i = 0; i < 8; i++) _state[i] += v[i];
+  }
+
+  uint32_t _state[8] = {};
+  uint64_t _count = 0;
+  uint8_t _buffer[64] = {};
+};  // class ConstexprSha256
+
+constexpr std::array<uint8_t, kSha256DigestLength> ConstexprSha256Digest(
+    std::string_view data) {
+  return ConstexprSha256().Update(data).Finalize();
+}
+
+template<size_t kSize>
+constexpr std::array<uint8_t, kSha256DigestLength> ConstexprSha256Digest(
+    const std::array<uint8_t, kSize> &data) {
+  return ConstexprSha256().Update(data.data(), kSize).Finalize();
+}
+
+// Midstate after the BIP340 tag prefix, see TaggedSha256().
+constexpr Sha256Midstate ConstexprTaggedHashMidstate(std::string_view tag) {
+  const std::array<uint8_t, kSha256DigestLength> tag_hash =
+      ConstexprSha256Digest(tag);
+  Sha256Midstate midstate = {};
+  ConstexprSha256()
+      .Update(tag_hash.data(), tag_hash.size())
+      .Update(tag_hash.data(), tag_hash.size())
+      .SaveMidstate(&midstate);
+  return midstate;
+}
+}  // namespace crypto
+}  // namespace btc
+
+#endif  // _BTC_CRYPTO_SHA256_CONSTEXPR_HPP_
@@ -0,0 +1,126 @@
+// Bitcoin Info - Cryptography - SHA-256 Kernels
+//
+// Copyright (c) 2022 Alex Dale
+// This project is licensed under the terms of the MIT license.
+// See LICENSE for details.
+#ifndef _BTC_CRYPTO_SHA256_KERNEL_HPP_
+#define _BTC_CRYPTO_SHA256_KERNEL_HPP_
+
+#ifndef _BTC_CRYPTO_SHA256_INTERNAL_
+#  error Header should only be included internally
+#endif  // _BTC_CRYPTO_SHA256_INTERNAL_
+
+#include "btc/cc/attr.h"
+#include "btc/cc/base.h"
+#include "btc/crypto/digest.hpp"
+#include "btc/crypto/sha256.constexpr.hpp"
+
+namespace btc {
+namespace crypto {
+namespace internal {
+constexpr size_t kSha256BlockLength = 64;
+constexpr size_t kSha256StateWords = 8;
+static_assert(
+    sizeof(Sha256Midstate::state) == kSha256StateWords * sizeof(uint32_t),
+    "Midstate must hold the SHA-256 state");
+
+// kSha256InitialState and kSha256RoundConstants are shared with
+// ConstexprSha256.
+// Message schedule with the round constants added, W + K.
+struct Sha256Schedule {
+  uint32_t wk[64];
+};  // struct Sha256Schedule
+
+// Schedule of the padding block of a 64 byte message.
+extern const Sha256Schedule kSha256D64PaddingSchedule;
+// Bytes 32 to 63 of the second block of a SHA-256-SHA-256, the padding
+// of the 32 byte first digest.
+extern const uint8_t kSha256D64SecondPadding[32];
+
+// Compresses |block_count| consecutive 64 byte blocks of |blocks| into
+// |state|.
+using Sha256TransformKernel = void (*)(
+    uint32_t *state, const uint8_t *blocks, size_t block_count);
+
+// SHA-256-SHA-256 of a single 64 byte message.
+using Sha256D64Kernel = void (*)(const uint8_t *data, uint8_t *digest);
+
+struct Sha256KernelTable {
+  Sha256Kernel kernel;
+  Sha256TransformKernel transform;
+  Sha256D64Kernel d64;
+};  // struct Sha256KernelTable
+
+// Returns null if the |kernel| is not supported by the CPU.
+const Sha256KernelTable *GetSha256KernelTable(Sha256Kernel kernel);
+// Fastest supported kernel.
+const Sha256KernelTable *SelectSha256KernelTable() __RETURN_NOT_NULL;
+// Currently active kernel.
+const Sha256KernelTable *ActiveSha256KernelTable() __RETURN_NOT_NULL;
+
+// Compresses one 64 byte block per lane into |state|.  The state is
+// stored word major: word |i| of lane |l| is |state|[i * lanes + l].
+using Sha256LanesKernel = void (*)(
+    uint32_t *state, const uint8_t *const *blocks);
+
+// SHA-256-SHA-256 of one 64 byte message per lane, the messages and
+// digests are consecutive.  All messages are read before any digest
+// is written.
+using Sha256D64LanesKernel = void (*)(const uint8_t *data, uint8_t *digests);
+
+constexpr size_t kSha256MaxLanes = 16;
+
+struct Sha256BatchKernelTable {
+  Sha256BatchKernel kernel;
+  size_t lanes;
+  // Null for the scalar kernel.
+  Sha256LanesKernel transform;
+  Sha256D64LanesKernel d64;
+};  // struct Sha256BatchKernelTable
+
+const Sha256BatchKernelTable *GetSha256BatchKernelTable(
+    Sha256BatchKernel kernel);
+const Sha256BatchKernelTable *SelectSha256BatchKernelTable()
+    __RETURN_NOT_NULL;
+
+// Whether the |count| |inputs| of a batch digest are all readable.
+// Fails with an error log on a null input with a non-zero size.
+bool IsValidDigestBatch(const DigestInput *inputs, size_t count);
+
+// Incremental SHA-256 over the active kernel.  Plain value type; a
+// copy captures the state of the digest, which allows finalizing
+// without disturbing the original.
+class Sha256Context {
+public:
+  Sha256Context() { Reset(); }
+  explicit Sha256Context(const Sha256Midstate &midstate) {
+    LoadMidstate(midstate);
+  }
+
+  // Number of bytes digested.
+  uint64_t count() const { return _count; }
+
+  void Reset();
+  // Fails if a partial block is buffered.
+  bool SaveMidstate(Sha256Midstate *midstate) const __NOT_NULL(2);
+  // |midstate| count must be a multiple of the block length.
+  void LoadMidstate(const Sha256Midstate &midstate);
+  void Update(const uint8_t *data, size_t data_size);
+  // Pads the message and writes the digest.  The context must be reset
+  // before it is reused.
+  void Finalize(uint8_t *digest) __NOT_NULL(2);
+
+private:
+  uint32_t _state[kSha256StateWords] = {};
+  uint64_t _count = 0;
+  uint8_t _buffer[kSha256BlockLength] = {};
+};  // class Sha256Context
+
+// One-shot SHA-256 over the active kernel.
+bool NativeSha256(const uint8_t *data, size_t data_size, uint8_t *digest)
+    __NOT_NULL(3);
+}  // namespace internal
+}  // namespace crypto
+}  // namespace btc
+
+#endif  // _BTC_CRYPTO_SHA256_KERNEL_HPP_
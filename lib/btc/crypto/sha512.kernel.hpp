@@ -0,0 +1,80 @@
+// Bitcoin Info - Cryptography - SHA-512 Kernels
+//
+// Copyright (c) 2022 Alex Dale
+// This project is licensed under the terms of the MIT license.
+// See LICENSE for details.
+#ifndef _BTC_CRYPTO_SHA512_KERNEL_HPP_
+#define _BTC_CRYPTO_SHA512_KERNEL_HPP_
+
+#ifndef _BTC_CRYPTO_SHA512_INTERNAL_
+#  error Header should only be included internally
+#endif  // _BTC_CRYPTO_SHA512_INTERNAL_
+
+#include "btc/cc/attr.h"
+#include "btc/cc/base.h"
+#include "btc/crypto/digest.hpp"
+
+namespace btc {
+namespace crypto {
+namespace internal {
+constexpr size_t kSha512BlockLength = 128;
+constexpr size_t kSha512StateWords = 8;
+
+extern const uint64_t kSha512InitialState[kSha512StateWords];
+
+// Compresses |block_count| consecutive 128 byte blocks of |blocks|
+// into |state|.
+void Sha512Transform(
+    uint64_t *state, const uint8_t *blocks, size_t block_count);
+
+// Compresses one 128 byte block per lane into |state|, stored word
+// major as with Sha256LanesKernel.
+using Sha512LanesKernel = void (*)(
+    uint64_t *state, const uint8_t *const *blocks);
+
+constexpr size_t kSha512MaxLanes = 8;
+
+struct Sha512BatchKernelTable {
+  Sha512BatchKernel kernel;
+  size_t lanes;
+  // Null for the scalar kernel.
+  Sha512LanesKernel transform;
+};  // struct Sha512BatchKernelTable
+
+const Sha512BatchKernelTable *GetSha512BatchKernelTable(
+    Sha512BatchKernel kernel);
+const Sha512BatchKernelTable *ActiveSha512BatchKernelTable()
+    __RETURN_NOT_NULL;
+
+// Incremental SHA-512, see Sha256Context.
+class Sha512Context {
+public:
+  Sha512Context() { Reset(); }
+  explicit Sha512Context(const Sha512Midstate &midstate) {
+    LoadMidstate(midstate);
+  }
+
+  uint64_t count() const { return _count; }
+
+  void Reset();
+  bool SaveMidstate(Sha512Midstate *midstate) const __NOT_NULL(2);
+  void LoadMidstate(const Sha512Midstate &midstate);
+  void Update(const uint8_t *data, size_t data_size);
+  void Finalize(uint8_t *digest) __NOT_NULL(2);
+
+private:
+  uint64_t _state[kSha512StateWords] = {};
+  uint64_t _count = 0;
+  uint8_t _buffer[kSha512BlockLength] = {};
+};  // class Sha512Context
+
+// Writes the big endian |state| as a digest.
+void StoreSha512Digest(const uint64_t *state, uint8_t *digest);
+
+bool NativeSha512(const uint8_t *data, size_t data_size, uint8_t *digest)
+    __NOT_NULL(3);
+}  // namespace internal
+}  // namespace crypto
+}  // namespace btc
+
+#endif  // _BTC_CRYPTO_SHA512_KERNEL_HPP_
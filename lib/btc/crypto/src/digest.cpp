@@ -3,11 +3,134 @@
 // Copyright (c) 2022 Alex Dale
 // This project is licensed under the terms of the MIT license.
 // See LICENSE for details.
+#include "btc/cc/debug.h"
 #include "btc/crypto/digest.hpp"
 #include "btc/log.h"
 
+#define _BTC_CRYPTO_RIPEMD160_INTERNAL_
+#include "btc/crypto/ripemd160.kernel.hpp"
+#undef _BTC_CRYPTO_RIPEMD160_INTERNAL_
+
+#define _BTC_CRYPTO_SHA256_INTERNAL_
+#include "btc/crypto/sha256.kernel.hpp"
+#undef _BTC_CRYPTO_SHA256_INTERNAL_
+
+#define _BTC_CRYPTO_SHA512_INTERNAL_
+#include "btc/crypto/sha512.kernel.hpp"
+#undef _BTC_CRYPTO_SHA512_INTERNAL_
+
 namespace btc {
 namespace crypto {
+namespace {
+using internal::NativeRipeMd160;
+using internal::NativeSha256;
+using internal::NativeSha256RipeMd160;
+using internal::NativeRipeMd160V;
+using internal::NativeSha512;
+using internal::Sha256Context;
+
+using digest_function_t = bool (*)(const uint8_t *, size_t, uint8_t *);
+
+const uint8_t *StringData(const std::string &data) {
+  return reinterpret_cast<const uint8_t *>(data.data());
+}
+
+// Single pass digesters.
+
+template<digest_function_t DigestFunction>
+bool DigestImpl(const uint8_t *data, size_t data_size, uint8_t *digest) {
+  DASSERT(digest != nullptr);
+  if (data == nullptr && data_size > 0) return false;
+  return DigestFunction(data, data_size, digest);
+}
+
+template<digest_function_t DigestFunction, size_t kDigestLength>
+std::vector<uint8_t> DigestImpl(const uint8_t *data, size_t data_size) {
+  if (data == nullptr && data_size > 0) return {};
+  std::vector<uint8_t> digest(kDigestLength);
+  if (!DigestFunction(data, data_size, digest.data())) digest.clear();
+  return digest;
+}
+
+template<digest_function_t DigestFunction, typename HashType>
+HashType DigestImpl(const uint8_t *data, size_t data_size) {
+  HashType digest;
+  if (data == nullptr && data_size > 0) {
+    LOG_ERROR("Input |data| is null");
+    return digest;
+  }
+  DigestFunction(data, data_size, digest.data());
+  return digest;
+}
+
+// Double pass digesters.
+
+template<
+    digest_function_t FirstDigestFunction, size_t kFirstDigestLength,
+    digest_function_t SecondDigestFunction>
+bool DoubleDigestImpl(const uint8_t *data, size_t data_size, uint8_t *digest) {
+  DASSERT(digest != nullptr);
+  if (data == nullptr && data_size > 0) return false;
+  uint8_t first_digest[kFirstDigestLength];
+  if (!FirstDigestFunction(data, data_size, first_digest)) return false;
+  return SecondDigestFunction(first_digest, kFirstDigestLength, digest);
+}
+
+template<
+    digest_function_t FirstDigestFunction, size_t kFirstDigestLength,
+    digest_function_t SecondDigestFunction, typename HashType>
+HashType DoubleDigestImpl(const uint8_t *data, size_t data_size) {
+  HashType digest;
+  if (data == nullptr && data_size > 0) {
+    LOG_ERROR("Input |data| is null");
+    return digest;
+  }
+  DoubleDigestImpl<
+      FirstDigestFunction, kFirstDigestLength, SecondDigestFunction>(
+      data, data_size, digest.data());
+  return digest;
+}
+
+template<
+    digest_function_t FirstDigestFunction, size_t kFirstDigestLength,
+    digest_function_t SecondDigestFunction, size_t kSecondDigestLength>
+std::vector<uint8_t> DoubleDigestImpl(const uint8_t *data, size_t data_size) {
+  std::vector<uint8_t> digest(kSecondDigestLength);
+  if (!DoubleDigestImpl<
+          FirstDigestFunction, kFirstDigestLength, SecondDigestFunction>(
+          data, data_size, digest.data())) {
+    digest.clear();
+  }
+  return digest;
+}
+
+// Scatter-gather digesters.
+
+bool IsValidSegments(const DigestInput *segments, size_t count) {
+  if (count == 0) return true;
+  if (segments == nullptr) {
+    LOG_ERROR("Input |segments| is null");
+    return false;
+  }
+  for (size_t i = 0; i < count; i++) {
+    if (segments[i].data == nullptr && segments[i].size > 0) {
+      LOG_ERROR("Segment %zu data is null", i);
+      return false;
+    }
+  }
+  return true;
+}
+
+void Sha256Segments(
+    const DigestInput *segments, size_t count, uint8_t *digest) {
+  Sha256Context context;
+  for (size_t i = 0; i < count; i++) {
+    context.Update(segments[i].data, segments[i].size);
+  }
+  context.Finalize(digest);
+}
+}  // namespace
+
 const char *DigestAlgorithmToString(DigestAlgorithm algorithm) {
   switch (algorithm) {
     case kSha256:
@@ -78,5 +201,276 @@ std::vector<uint8_t> Digest(
   LOG_ERROR("Unsupported digest algorithm: %d", algorithm);
   return {};
 }
+
+std::vector<uint8_t> DigestV(
+    DigestAlgorithm algorithm, const DigestInput *segments, size_t count) {
+  if (!IsValidSegments(segments, count)) return {};
+  std::vector<uint8_t> digest;
+  switch (algorithm) {
+    case kSha256:
+      digest.resize(kSha256DigestLength);
+      Sha256Segments(segments, count, digest.data());
+      return digest;
+    case kRipeMd160:
+      digest.resize(kRipeMd160DigestLength);
+      NativeRipeMd160V(segments, count, digest.data());
+      return digest;
+    case kSha256Sha256:
+      digest.resize(kSha256DigestLength);
+      Sha256Sha256V(segments, count, digest.data());
+      return digest;
+    case kSha256RipeMd160: {
+      uint8_t first_digest[kSha256DigestLength];
+      Sha256Segments(segments, count, first_digest);
+      digest.resize(kRipeMd160DigestLength);
+      NativeRipeMd160(first_digest, sizeof(first_digest), digest.data());
+      return digest;
+    }
+    case kUnknownDigestAlgorithm:
+      break;
+  }
+  LOG_ERROR("Unsupported digest algorithm: %d", algorithm);
+  return {};
+}
+
+std::vector<uint8_t> DigestV(
+    DigestAlgorithm algorithm, std::initializer_list<DigestInput> segments) {
+  return DigestV(algorithm, segments.begin(), segments.size());
+}
+
+// SHA-256
+
+bool Sha256(const uint8_t *data, size_t data_size, uint8_t *digest) {
+  return DigestImpl<NativeSha256>(data, data_size, digest);
+}
+
+bool Sha256(const std::string &data, uint8_t *digest) {
+  return DigestImpl<NativeSha256>(StringData(data), data.size(), digest);
+}
+bool Sha256(const std::vector<uint8_t> &data, uint8_t *digest) {
+  return DigestImpl<NativeSha256>(data.data(), data.size(), digest);
+}
+
+std::vector<uint8_t> Sha256(const uint8_t *data, size_t data_size) {
+  return DigestImpl<NativeSha256, kSha256DigestLength>(data, data_size);
+}
+
+std::vector<uint8_t> Sha256(const std::string &data) {
+  return DigestImpl<NativeSha256, kSha256DigestLength>(
+      StringData(data), data.size());
+}
+
+std::vector<uint8_t> Sha256(const std::vector<uint8_t> &data) {
+  return DigestImpl<NativeSha256, kSha256DigestLength>(
+      data.data(), data.size());
+}
+
+Hash256 Sha256Hash(const uint8_t *data, size_t data_size) {
+  return DigestImpl<NativeSha256, Hash256>(data, data_size);
+}
+
+Hash256 Sha256Hash(const std::string &data) {
+  return DigestImpl<NativeSha256, Hash256>(StringData(data), data.size());
+}
+
+Hash256 Sha256Hash(const std::vector<uint8_t> &data) {
+  return DigestImpl<NativeSha256, Hash256>(data.data(), data.size());
+}
+
+bool Sha256V(const DigestInput *segments, size_t count, uint8_t *digest) {
+  DASSERT(digest != nullptr);
+  if (!IsValidSegments(segments, count)) return false;
+  Sha256Segments(segments, count, digest);
+  return true;
+}
+
+bool Sha256V(std::initializer_list<DigestInput> segments, uint8_t *digest) {
+  return Sha256V(segments.begin(), segments.size(), digest);
+}
+
+// RIPEMD-160
+
+bool RipeMd160(const uint8_t *data, size_t data_size, uint8_t *digest) {
+  return DigestImpl<NativeRipeMd160>(data, data_size, digest);
+}
+
+bool RipeMd160(const std::string &data, uint8_t *digest) {
+  return DigestImpl<NativeRipeMd160>(StringData(data), data.size(), digest);
+}
+bool RipeMd160(const std::vector<uint8_t> &data, uint8_t *digest) {
+  return DigestImpl<NativeRipeMd160>(data.data(), data.size(), digest);
+}
+
+std::vector<uint8_t> RipeMd160(const uint8_t *data, size_t data_size) {
+  return DigestImpl<NativeRipeMd160, kRipeMd160DigestLength>(
+      data, data_size);
+}
+
+std::vector<uint8_t> RipeMd160(const std::string &data) {
+  return DigestImpl<NativeRipeMd160, kRipeMd160DigestLength>(
+      StringData(data), data.size());
+}
+
+std::vector<uint8_t> RipeMd160(const std::vector<uint8_t> &data) {
+  return DigestImpl<NativeRipeMd160, kRipeMd160DigestLength>(
+      data.data(), data.size());
+}
+
+Hash160 RipeMd160Hash(const uint8_t *data, size_t data_size) {
+  return DigestImpl<NativeRipeMd160, Hash160>(data, data_size);
+}
+
+Hash160 RipeMd160Hash(const std::string &data) {
+  return DigestImpl<NativeRipeMd160, Hash160>(StringData(data), data.size());
+}
+
+Hash160 RipeMd160Hash(const std::vector<uint8_t> &data) {
+  return DigestImpl<NativeRipeMd160, Hash160>(data.data(), data.size());
+}
+
+// SHA-256-SHA-256
+
+bool Sha256Sha256(const uint8_t *data, size_t data_size, uint8_t *digest) {
+  return DoubleDigestImpl<NativeSha256, kSha256DigestLength, NativeSha256>(
+      data, data_size, digest);
+}
+
+bool Sha256Sha256(const std::string &data, uint8_t *digest) {
+  return DoubleDigestImpl<NativeSha256, kSha256DigestLength, NativeSha256>(
+      StringData(data), data.size(), digest);
+}
+bool Sha256Sha256(const std::vector<uint8_t> &data, uint8_t *digest) {
+  return DoubleDigestImpl<NativeSha256, kSha256DigestLength, NativeSha256>(
+      data.data(), data.size(), digest);
+}
+
+std::vector<uint8_t> Sha256Sha256(const uint8_t *data, size_t data_size) {
+  return DoubleDigestImpl<
+      NativeSha256, kSha256DigestLength, NativeSha256, kSha256DigestLength>(
+      data, data_size);
+}
+
+std::vector<uint8_t> Sha256Sha256(const std::string &data) {
+  return DoubleDigestImpl<
+      NativeSha256, kSha256DigestLength, NativeSha256, kSha256DigestLength>(
+      StringData(data), data.size());
+}
+
+std::vector<uint8_t> Sha256Sha256(const std::vector<uint8_t> &data) {
+  return DoubleDigestImpl<
+      NativeSha256, kSha256DigestLength, NativeSha256, kSha256DigestLength>(
+      data.data(), data.size());
+}
+
+Hash256 Sha256Sha256Hash(const uint8_t *data, size_t data_size) {
+  return DoubleDigestImpl<
+      NativeSha256, kSha256DigestLength, NativeSha256, Hash256>(
+      data, data_size);
+}
+
+Hash256 Sha256Sha256Hash(const std::string &data) {
+  return DoubleDigestImpl<
+      NativeSha256, kSha256DigestLength, NativeSha256, Hash256>(
+      StringData(data), data.size());
+}
+
+Hash256 Sha256Sha256Hash(const std::vector<uint8_t> &data) {
+  return DoubleDigestImpl<
+      NativeSha256, kSha256DigestLength, NativeSha256, Hash256>(
+      data.data(), data.size());
+}
+
+bool Sha256Sha256V(
+    const DigestInput *segments, size_t count, uint8_t *digest) {
+  DASSERT(digest != nullptr);
+  if (!IsValidSegments(segments, count)) return false;
+  uint8_t first_digest[kSha256DigestLength];
+  Sha256Segments(segments, count, first_digest);
+  return NativeSha256(first_digest, sizeof(first_digest), digest);
+}
+
+bool Sha256Sha256V(
+    std::initializer_list<DigestInput> segments, uint8_t *digest) {
+  return Sha256Sha256V(segments.begin(), segments.size(), digest);
+}
+
+Hash256 Sha256Sha256HashV(const DigestInput *segments, size_t count) {
+  Hash256 digest;
+  Sha256Sha256V(segments, count, digest.data());
+  return digest;
+}
+
+Hash256 Sha256Sha256HashV(std::initializer_list<DigestInput> segments) {
+  return Sha256Sha256HashV(segments.begin(), segments.size());
+}
+
+// SHA-256-RIPEMD-160
+
+bool Sha256RipeMd160(const uint8_t *data, size_t data_size, uint8_t *digest) {
+  return DigestImpl<NativeSha256RipeMd160>(data, data_size, digest);
+}
+
+bool Sha256RipeMd160(const std::string &data, uint8_t *digest) {
+  return DigestImpl<NativeSha256RipeMd160>(
+      StringData(data), data.size(), digest);
+}
+bool Sha256RipeMd160(const std::vector<uint8_t> &data, uint8_t *digest) {
+  return DigestImpl<NativeSha256RipeMd160>(data.data(), data.size(), digest);
+}
+
+std::vector<uint8_t> Sha256RipeMd160(const uint8_t *data, size_t data_size) {
+  return DigestImpl<NativeSha256RipeMd160, kRipeMd160DigestLength>(
+      data, data_size);
+}
+
+std::vector<uint8_t> Sha256RipeMd160(const std::string &data) {
+  return DigestImpl<NativeSha256RipeMd160, kRipeMd160DigestLength>(
+      StringData(data), data.size());
+}
+
+std::vector<uint8_t> Sha256RipeMd160(const std::vector<uint8_t> &data) {
+  return DigestImpl<NativeSha256RipeMd160, kRipeMd160DigestLength>(
+      data.data(), data.size());
+}
+
+Hash160 Sha256RipeMd160Hash(const uint8_t *data, size_t data_size) {
+  return DigestImpl<NativeSha256RipeMd160, Hash160>(data, data_size);
+}
+
+Hash160 Sha256RipeMd160Hash(const std::string &data) {
+  return DigestImpl<NativeSha256RipeMd160, Hash160>(
+      StringData(data), data.size());
+}
+
+Hash160 Sha256RipeMd160Hash(const std::vector<uint8_t> &data) {
+  return DigestImpl<NativeSha256RipeMd160, Hash160>(data.data(), data.size());
+}
+
+// SHA-512
+
+bool Sha512(const uint8_t *data, size_t data_size, uint8_t *digest) {
+  return DigestImpl<NativeSha512>(data, data_size, digest);
+}
+
+bool Sha512(const std::string &data, uint8_t *digest) {
+  return DigestImpl<NativeSha512>(StringData(data), data.size(), digest);
+}
+bool Sha512(const std::vector<uint8_t> &data, uint8_t *digest) {
+  return DigestImpl<NativeSha512>(data.data(), data.size(), digest);
+}
+
+std::vector<uint8_t> Sha512(const uint8_t *data, size_t data_size) {
+  return DigestImpl<NativeSha512, kSha512DigestLength>(data, data_size);
+}
+
+std::vector<uint8_t> Sha512(const std::string &data) {
+  return DigestImpl<NativeSha512, kSha512DigestLength>(
+      StringData(data), data.size());
+}
+
+std::vector<uint8_t> Sha512(const std::vector<uint8_t> &data) {
+  return DigestImpl<NativeSha512, kSha512DigestLength>(
+      data.data(), data.size());
+}
 }  // namespace crypto
 }  // namespace btc
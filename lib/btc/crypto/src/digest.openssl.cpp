@@ -3,277 +3,82 @@
 // Copyright (c) 2022 Alex Dale
 // This project is licensed under the terms of the MIT license.
 // See LICENSE for details.
-#include <openssl/ripemd.h>
-#include <openssl/sha.h>
+#include <atomic>
 
 #include "btc/cc/debug.h"
 #include "btc/crypto/digest.hpp"
 #include "btc/log.h"
 
+#define _BTC_CRYPTO_DIGEST_INTERNAL_
+#include "btc/crypto/digest.openssl.hpp"
+#undef _BTC_CRYPTO_DIGEST_INTERNAL_
+
 namespace btc {
 namespace crypto {
+namespace internal {
 namespace {
 const uint8_t kSpareByte = 0;
 const uint8_t *const kNullByteFill = &kSpareByte;
 
-using digester_t = uint8_t *(*) (const uint8_t *, size_t, uint8_t *);
-
-// Single pass digesters.
-
-template<digester_t Digester>
-bool DigestImpl(const uint8_t *data, size_t data_size, uint8_t *digest) {
-  DASSERT(digest != nullptr);
-  if (data == nullptr && data_size > 0) return false;
-  const uint8_t *res = Digester(data ? data : kNullByteFill, data_size, digest);
-  return res != nullptr;
-}
-
-template<digester_t Digester>
-bool DigestImpl(const std::string &data, uint8_t *digest) {
-  DASSERT(digest != nullptr);
-  const uint8_t *res = Digester(
-      data.empty() ? kNullByteFill
-                   : reinterpret_cast<const uint8_t *>(data.data()),
-      data.size(), digest);
-  return res != nullptr;
-}
-
-template<digester_t Digester>
-bool DigestImpl(const std::vector<uint8_t> &data, uint8_t *digest) {
-  DASSERT(digest != nullptr);
-  const uint8_t *res =
-      Digester(data.empty() ? kNullByteFill : data.data(), data.size(), digest);
-  return res != nullptr;
-}
-
-template<digester_t Digester, size_t kDigestLength>
-std::vector<uint8_t> DigestImpl(const uint8_t *data, size_t data_size) {
-  if (data == nullptr && data_size > 0) return {};
-  std::vector<uint8_t> digest(kDigestLength);
-  const uint8_t *res =
-      Digester(data ? data : kNullByteFill, data_size, digest.data());
-  if (res == nullptr) digest.clear();
-  return digest;
-}
-
-template<digester_t Digester, size_t kDigestLength>
-std::vector<uint8_t> DigestImpl(const std::string &data) {
-  std::vector<uint8_t> digest(kDigestLength);
-  const uint8_t *res = Digester(
-      data.empty() ? kNullByteFill
-                   : reinterpret_cast<const uint8_t *>(data.data()),
-      data.size(), digest.data());
-  if (res == nullptr) digest.clear();
-  return digest;
-}
-
-template<digester_t Digester, size_t kDigestLength>
-std::vector<uint8_t> DigestImpl(const std::vector<uint8_t> &data) {
-  std::vector<uint8_t> digest(kDigestLength);
-  const uint8_t *res = Digester(
-      data.empty() ? kNullByteFill : data.data(), data.size(), digest.data());
-  if (res == nullptr) digest.clear();
-  return digest;
-}
+const char *const kOpenSslDigestNames[kOpenSslDigestCount] = {
+    "SHA256", "RIPEMD160", "SHA512"};
 
-// Double pass digesters.
+std::atomic<EVP_MD *> g_openssl_digests[kOpenSslDigestCount] = {};
 
-template<
-    digester_t FirstDigester, size_t kFirstDigestLength,
-    digester_t SecondDigester>
-bool DoubleDigestImpl(const uint8_t *data, size_t data_size, uint8_t *digest) {
-  DASSERT(digest != nullptr);
+bool OpenSslDigestImpl(
+    OpenSslDigest algorithm, const uint8_t *data, size_t data_size,
+    uint8_t *digest) {
   if (data == nullptr && data_size > 0) return false;
-  uint8_t first_digest[kFirstDigestLength];
-  const uint8_t *res =
-      FirstDigester(data ? data : kNullByteFill, data_size, first_digest);
-  if (res == nullptr) return false;
-  res = SecondDigester(first_digest, kFirstDigestLength, digest);
-  return res != nullptr;
-}
-
-template<
-    digester_t FirstDigester, size_t kFirstDigestLength,
-    digester_t SecondDigester>
-bool DoubleDigestImpl(const std::string &data, uint8_t *digest) {
-  DASSERT(digest != nullptr);
-  uint8_t first_digest[kFirstDigestLength];
-  const uint8_t *res = FirstDigester(
-      data.empty() ? kNullByteFill
-                   : reinterpret_cast<const uint8_t *>(data.data()),
-      data.size(), first_digest);
-  if (res == nullptr) return false;
-  res = SecondDigester(first_digest, kFirstDigestLength, digest);
-  return res != nullptr;
-}
-
-template<
-    digester_t FirstDigester, size_t kFirstDigestLength,
-    digester_t SecondDigester>
-bool DoubleDigestImpl(const std::vector<uint8_t> &data, uint8_t *digest) {
-  DASSERT(digest != nullptr);
-  uint8_t first_digest[kFirstDigestLength];
-  const uint8_t *res = FirstDigester(
-      data.empty() ? kNullByteFill : data.data(), data.size(), first_digest);
-  if (res == nullptr) return false;
-  res = SecondDigester(first_digest, kFirstDigestLength, digest);
-  return res != nullptr;
-}
-
-template<
-    digester_t FirstDigester, size_t kFirstDigestLength,
-    digester_t SecondDigester, size_t kSecondDigestLength>
-std::vector<uint8_t> DoubleDigestImpl(const uint8_t *data, size_t data_size) {
-  if (data == nullptr && data_size > 0) return {};
-  uint8_t first_digest[kFirstDigestLength];
-  const uint8_t *res =
-      FirstDigester(data ? data : kNullByteFill, data_size, first_digest);
-  if (res == nullptr) return {};
-  std::vector<uint8_t> digest(kSecondDigestLength);
-  res = SecondDigester(first_digest, kFirstDigestLength, digest.data());
-  if (res == nullptr) digest.clear();
-  return digest;
-}
-
-template<
-    digester_t FirstDigester, size_t kFirstDigestLength,
-    digester_t SecondDigester, size_t kSecondDigestLength>
-std::vector<uint8_t> DoubleDigestImpl(const std::string &data) {
-  uint8_t first_digest[kFirstDigestLength];
-  const uint8_t *res = FirstDigester(
-      data.empty() ? kNullByteFill
-                   : reinterpret_cast<const uint8_t *>(data.data()),
-      data.size(), first_digest);
-  if (res == nullptr) return {};
-  std::vector<uint8_t> digest(kSecondDigestLength);
-  res = SecondDigester(first_digest, kFirstDigestLength, digest.data());
-  if (res == nullptr) digest.clear();
-  return digest;
-}
-
-template<
-    digester_t FirstDigester, size_t kFirstDigestLength,
-    digester_t SecondDigester, size_t kSecondDigestLength>
-std::vector<uint8_t> DoubleDigestImpl(const std::vector<uint8_t> &data) {
-  uint8_t first_digest[kFirstDigestLength];
-  const uint8_t *res = FirstDigester(
-      data.empty() ? kNullByteFill : data.data(), data.size(), first_digest);
-  if (res == nullptr) return {};
-  std::vector<uint8_t> digest(kSecondDigestLength);
-  res = SecondDigester(first_digest, kFirstDigestLength, digest.data());
-  if (res == nullptr) digest.clear();
-  return digest;
+  const EVP_MD *md = GetOpenSslDigest(algorithm);
+  if (md == nullptr) return false;
+  return EVP_Digest(
+             data ? data : kNullByteFill, data_size, digest, nullptr, md,
+             nullptr) == 1;
 }
 }  // namespace
 
-// SHA-256
-
-bool Sha256(const uint8_t *data, size_t data_size, uint8_t *digest) {
-  return DigestImpl<SHA256>(data, data_size, digest);
-}
-
-bool Sha256(const std::string &data, uint8_t *digest) {
-  return DigestImpl<SHA256>(data, digest);
-}
-bool Sha256(const std::vector<uint8_t> &data, uint8_t *digest) {
-  return DigestImpl<SHA256>(data, digest);
-}
-
-std::vector<uint8_t> Sha256(const uint8_t *data, size_t data_size) {
-  return DigestImpl<SHA256, kSha256DigestLength>(data, data_size);
+const EVP_MD *GetOpenSslDigest(OpenSslDigest digest) {
+  DASSERT(static_cast<size_t>(digest) < kOpenSslDigestCount);
+  std::atomic<EVP_MD *> &slot = g_openssl_digests[digest];
+  EVP_MD *md = slot.load(std::memory_order_acquire);
+  if (md != nullptr) return md;
+  EVP_MD *fetched = EVP_MD_fetch(nullptr, kOpenSslDigestNames[digest], nullptr);
+  if (fetched == nullptr) {
+    LOG_WARN(
+        "Failed to fetch OpenSSL digest: %s", kOpenSslDigestNames[digest]);
+    return nullptr;
+  }
+  // Another thread may have fetched it first.
+  if (!slot.compare_exchange_strong(md, fetched, std::memory_order_acq_rel)) {
+    EVP_MD_free(fetched);
+    return md;
+  }
+  return fetched;
 }
 
-std::vector<uint8_t> Sha256(const std::string &data) {
-  return DigestImpl<SHA256, kSha256DigestLength>(data);
+bool OpenSslSha256(const uint8_t *data, size_t data_size, uint8_t *digest) {
+  return OpenSslDigestImpl(kOpenSslSha256, data, data_size, digest);
 }
 
-std::vector<uint8_t> Sha256(const std::vector<uint8_t> &data) {
-  return DigestImpl<SHA256, kSha256DigestLength>(data);
-}
-
-// RIPEMD-160
-
-bool RipeMd160(const uint8_t *data, size_t data_size, uint8_t *digest) {
-  return DigestImpl<RIPEMD160>(data, data_size, digest);
-}
-
-bool RipeMd160(const std::string &data, uint8_t *digest) {
-  return DigestImpl<RIPEMD160>(data, digest);
-}
-bool RipeMd160(const std::vector<uint8_t> &data, uint8_t *digest) {
-  return DigestImpl<RIPEMD160>(data, digest);
-}
-
-std::vector<uint8_t> RipeMd160(const uint8_t *data, size_t data_size) {
-  return DigestImpl<RIPEMD160, kRipeMd160DigestLength>(data, data_size);
-}
-
-std::vector<uint8_t> RipeMd160(const std::string &data) {
-  return DigestImpl<RIPEMD160, kRipeMd160DigestLength>(data);
-}
-
-std::vector<uint8_t> RipeMd160(const std::vector<uint8_t> &data) {
-  return DigestImpl<RIPEMD160, kRipeMd160DigestLength>(data);
-}
-
-// SHA-256-SHA-256
-
-bool Sha256Sha256(const uint8_t *data, size_t data_size, uint8_t *digest) {
-  return DoubleDigestImpl<SHA256, kSha256DigestLength, SHA256>(
-      data, data_size, digest);
-}
-
-bool Sha256Sha256(const std::string &data, uint8_t *digest) {
-  return DoubleDigestImpl<SHA256, kSha256DigestLength, SHA256>(data, digest);
-}
-bool Sha256Sha256(const std::vector<uint8_t> &data, uint8_t *digest) {
-  return DoubleDigestImpl<SHA256, kSha256DigestLength, SHA256>(data, digest);
-}
-
-std::vector<uint8_t> Sha256Sha256(const uint8_t *data, size_t data_size) {
-  return DoubleDigestImpl<
-      SHA256, kSha256DigestLength, SHA256, kSha256DigestLength>(
-      data, data_size);
-}
-
-std::vector<uint8_t> Sha256Sha256(const std::string &data) {
-  return DoubleDigestImpl<
-      SHA256, kSha256DigestLength, SHA256, kSha256DigestLength>(data);
-}
-
-std::vector<uint8_t> Sha256Sha256(const std::vector<uint8_t> &data) {
-  return DoubleDigestImpl<
-      SHA256, kSha256DigestLength, SHA256, kSha256DigestLength>(data);
-}
-
-// SHA-256-RIPEMD-160
-
-bool Sha256RipeMd160(const uint8_t *data, size_t data_size, uint8_t *digest) {
-  return DoubleDigestImpl<SHA256, kSha256DigestLength, RIPEMD160>(
-      data, data_size, digest);
-}
-
-bool Sha256RipeMd160(const std::string &data, uint8_t *digest) {
-  return DoubleDigestImpl<SHA256, kSha256DigestLength, RIPEMD160>(data, digest);
-}
-bool Sha256RipeMd160(const std::vector<uint8_t> &data, uint8_t *digest) {
-  return DoubleDigestImpl<SHA256, kSha256DigestLength, RIPEMD160>(data, digest);
+bool OpenSslRipeMd160(const uint8_t *data, size_t data_size, uint8_t *digest) {
+  return OpenSslDigestImpl(kOpenSslRipeMd160, data, data_size, digest);
 }
 
-std::vector<uint8_t> Sha256RipeMd160(const uint8_t *data, size_t data_size) {
-  return DoubleDigestImpl<
-      SHA256, kSha256DigestLength, RIPEMD160, kRipeMd160DigestLength>(
-      data, data_size);
+bool OpenSslSha512(const uint8_t *data, size_t data_size, uint8_t *digest) {
+  return OpenSslDigestImpl(kOpenSslSha512, data, data_size, digest);
 }
 
-std::vector<uint8_t> Sha256RipeMd160(const std::string &data) {
-  return DoubleDigestImpl<
-      SHA256, kSha256DigestLength, RIPEMD160, kRipeMd160DigestLength>(data);
+void InitDigestAlgorithms() {
+  for (size_t i = 0; i < kOpenSslDigestCount; i++) {
+    GetOpenSslDigest(static_cast<OpenSslDigest>(i));
+  }
 }
 
-std::vector<uint8_t> Sha256RipeMd160(const std::vector<uint8_t> &data) {
-  return DoubleDigestImpl<
-      SHA256, kSha256DigestLength, RIPEMD160, kRipeMd160DigestLength>(data);
+void TeardownDigestAlgorithms() {
+  for (std::atomic<EVP_MD *> &slot : g_openssl_digests) {
+    EVP_MD_free(slot.exchange(nullptr, std::memory_order_acq_rel));
+  }
 }
+}  // namespace internal
 }  // namespace crypto
 }  // namespace btc
@@ -0,0 +1,220 @@
+// Bitcoin Info - Cryptography - File Digests
+//
+// Copyright (c) 2022 Alex Dale
+// This project is licensed under the terms of the MIT license.
+// See LICENSE for details.
+#include <errno.h>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+
+#include "btc/cc/classy.hpp"
+#include "btc/cc/debug.h"
+#include "btc/crypto/digest_file.hpp"
+#include "btc/crypto/digester.hpp"
+#include "btc/log.h"
+#include "btc/task/parallel.hpp"
+
+namespace btc {
+namespace crypto {
+namespace {
+using ::btc::task::DefaultThreadCount;
+using ::btc::task::ParallelFor;
+
+constexpr uint64_t kNsPerSecond = 1000000000;
+// Large enough to amortize the system calls, small enough to stay in
+// the L2 cache.
+constexpr size_t kReadBufferSize = 1 << 20;
+constexpr size_t kReadAlignment = 4096;
+
+uint64_t NowNs() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return static_cast<uint64_t>(ts.tv_sec) * kNsPerSecond +
+         static_cast<uint64_t>(ts.tv_nsec);
+}
+
+class ScopedFd {
+public:
+  BTC_DISALLOW_COPY_AND_MOVE(ScopedFd);
+  explicit ScopedFd(int fd): _fd(fd) {}
+  ~ScopedFd() {
+    if (_fd >= 0) close(_fd);
+  }
+
+  int get() const { return _fd; }
+
+private:
+  int _fd;
+};  // class ScopedFd
+
+class ScopedMapping {
+public:
+  BTC_DISALLOW_COPY_AND_MOVE(ScopedMapping);
+  ScopedMapping(void *data, size_t size): _data(data), _size(size) {}
+  ~ScopedMapping() {
+    if (_data != MAP_FAILED) munmap(_data, _size);
+  }
+
+  bool ok() const { return _data != MAP_FAILED; }
+  const uint8_t *data() const { return static_cast<const uint8_t *>(_data); }
+
+private:
+  void *_data;
+  size_t _size;
+};  // class ScopedMapping
+
+// Buffer for the buffered reads of the thread, page aligned for the
+// benefit of O_DIRECT capable file systems and the copy out of the
+// page cache.
+uint8_t *ThreadReadBuffer() {
+  struct BufferDeleter {
+    void operator()(uint8_t *buffer) const { free(buffer); }
+  };
+  thread_local std::unique_ptr<uint8_t, BufferDeleter> buffer(
+      static_cast<uint8_t *>(aligned_alloc(kReadAlignment, kReadBufferSize)));
+  return buffer.get();
+}
+
+bool DigestFd(
+    int fd, const std::string &path, Digester *digester, uint64_t *size) {
+  uint8_t *buffer = ThreadReadBuffer();
+  if (buffer == nullptr) {
+    LOG_ERROR("Failed to allocate read buffer");
+    return false;
+  }
+  uint64_t total = 0;
+  while (true) {
+    const ssize_t res = read(fd, buffer, kReadBufferSize);
+    if (res < 0) {
+      if (errno == EINTR) continue;
+      LOG_ERROR("Failed to read %s: %s", path.c_str(), strerror(errno));
+      return false;
+    }
+    if (res == 0) break;
+    digester->Update(buffer, static_cast<size_t>(res));
+    total += static_cast<uint64_t>(res);
+  }
+  *size = total;
+  return true;
+}
+
+// Returns false if the file cannot be mapped, without logging; the
+// caller falls back to reading it.
+bool DigestMapped(
+    int fd, uint64_t file_size, Digester *digester, uint64_t *size) {
+  const ScopedMapping mapping(
+      mmap(nullptr, file_size, PROT_READ, MAP_PRIVATE, fd, 0), file_size);
+  if (!mapping.ok()) return false;
+  // Advisory; read ahead aggressively and drop pages once passed.
+  madvise(
+      const_cast<uint8_t *>(mapping.data()), file_size, MADV_SEQUENTIAL);
+  digester->Update(mapping.data(), file_size);
+  *size = file_size;
+  return true;
+}
+
+bool DigestFileImpl(
+    Digester *digester, const std::string &path, uint64_t *size,
+    FileReadMode mode) {
+  const ScopedFd fd(open(path.c_str(), O_RDONLY | O_CLOEXEC));
+  if (fd.get() < 0) {
+    LOG_ERROR("Failed to open %s: %s", path.c_str(), strerror(errno));
+    return false;
+  }
+  if (mode == kFileReadMmap) {
+    struct stat st;
+    if (fstat(fd.get(), &st) == 0 && S_ISREG(st.st_mode) && st.st_size > 0 &&
+        DigestMapped(fd.get(), static_cast<uint64_t>(st.st_size), digester,
+                     size)) {
+      return true;
+    }
+    // Empty, special or unmappable files.
+    posix_fadvise(fd.get(), 0, 0, POSIX_FADV_SEQUENTIAL);
+  }
+  return DigestFd(fd.get(), path, digester, size);
+}
+}  // namespace
+
+const char *FileReadModeToString(FileReadMode mode) {
+  switch (mode) {
+    case kFileReadMmap:
+      return "mmap";
+    case kFileReadBuffered:
+      return "buffered";
+  }
+  LOG_ERROR("Unknown file read mode: %d", mode);
+  return "<error>";
+}
+
+double FileDigestStats::BytesPerSecond() const {
+  if (elapsed_ns == 0) return 0.0;
+  return static_cast<double>(bytes) * kNsPerSecond /
+         static_cast<double>(elapsed_ns);
+}
+
+bool DigestFile(
+    DigestAlgorithm algorithm, const std::string &path,
+    std::vector<uint8_t> *digest, uint64_t *size, FileReadMode mode) {
+  DASSERT(digest != nullptr);
+  PooledDigester digester = Digester::Acquire(algorithm);
+  if (!digester) return false;
+  uint64_t file_size = 0;
+  if (!DigestFileImpl(digester.get(), path, &file_size, mode)) {
+    return false;
+  }
+  digest->resize(digester->digest_length());
+  if (!digester->FinalizeAndReset(digest->data())) {
+    digest->clear();
+    return false;
+  }
+  if (size != nullptr) *size = file_size;
+  return true;
+}
+
+std::vector<FileDigest> DigestFiles(
+    DigestAlgorithm algorithm, const std::vector<std::string> &paths,
+    size_t threads, FileDigestStats *stats, FileReadMode mode) {
+  const uint64_t start_ns = NowNs();
+  std::vector<FileDigest> results(paths.size());
+  if (threads == 0) threads = DefaultThreadCount();
+  threads = std::min(threads, paths.size());
+  // Each worker claims the next file when it finishes one; a static
+  // split would leave threads idle behind a few large files.
+  std::atomic<size_t> next{0};
+  ParallelFor(threads, threads, [&](size_t begin, size_t end) {
+    for (size_t worker = begin; worker < end; worker++) {
+      while (true) {
+        const size_t i = next.fetch_add(1, std::memory_order_relaxed);
+        if (i >= paths.size()) break;
+        FileDigest &result = results[i];
+        result.path = paths[i];
+        result.ok = DigestFile(
+            algorithm, paths[i], &result.digest, &result.size, mode);
+      }
+    }
+  });
+  if (stats != nullptr) {
+    *stats = FileDigestStats();
+    for (const FileDigest &result : results) {
+      if (result.ok) {
+        stats->files++;
+        stats->bytes += result.size;
+      } else {
+        stats->failed++;
+      }
+    }
+    stats->elapsed_ns = NowNs() - start_ns;
+  }
+  return results;
+}
+}  // namespace crypto
+}  // namespace btc
@@ -0,0 +1,269 @@
+// Bitcoin Info - Cryptography - Digester
+//
+// Copyright (c) 2022 Alex Dale
+// This project is licensed under the terms of the MIT license.
+// See LICENSE for details.
+#include <utility>
+
+#include "btc/cc/debug.h"
+#include "btc/crypto/digest.hpp"
+#include "btc/crypto/digester.hpp"
+#include "btc/log.h"
+
+#define _BTC_CRYPTO_SHA256_INTERNAL_
+#include "btc/crypto/sha256.kernel.hpp"
+#undef _BTC_CRYPTO_SHA256_INTERNAL_
+
+namespace btc {
+namespace crypto {
+using internal::kSha256BlockLength;
+using internal::Sha256Context;
+namespace {
+using sha_256_digest_t = uint8_t[kSha256DigestLength];
+
+bool IsSupportedDigestAlgorithm(DigestAlgorithm algorithm) {
+  switch (algorithm) {
+    case kSha256:
+    case kSha256Sha256:
+    case kSha256RipeMd160:
+      return true;
+    case kRipeMd160:
+    case kUnknownDigestAlgorithm:
+      return false;
+  }
+  LOG_ERROR("Unknown digest algorithm: %d", algorithm);
+  return false;
+}
+
+bool IsValidMidstate(const Sha256Midstate &midstate) {
+  if (midstate.count % kSha256BlockLength != 0) {
+    LOG_ERROR(
+        "Midstate count is not a multiple of %zu: %zu", kSha256BlockLength,
+        static_cast<size_t>(midstate.count));
+    return false;
+  }
+  return true;
+}
+
+size_t GetDigestLength(DigestAlgorithm algorithm) {
+  switch (algorithm) {
+    case kSha256:
+    case kSha256Sha256:
+      return kSha256DigestLength;
+    case kSha256RipeMd160:
+      return kRipeMd160DigestLength;
+    case kRipeMd160:
+    case kUnknownDigestAlgorithm:
+      return 0;
+  }
+  LOG_ERROR("Unknown digest algorithm: %d", algorithm);
+  return 0;
+}
+
+// Finalizes |context| in place.
+bool FinalizeContext(
+    DigestAlgorithm algorithm, Sha256Context *context, uint8_t *digest) {
+  if (algorithm == kSha256) {
+    context->Finalize(digest);
+    return true;
+  }
+  sha_256_digest_t intermediate_digest;
+  context->Finalize(intermediate_digest);
+  if (algorithm == kSha256Sha256) {
+    return Sha256(intermediate_digest, kSha256DigestLength, digest);
+  }
+  DASSERT(algorithm == kSha256RipeMd160);
+  return RipeMd160(intermediate_digest, kSha256DigestLength, digest);
+}
+
+template<typename HashType>
+bool IsValidHashOutput(DigestAlgorithm algorithm, const HashType *digest) {
+  if (digest == nullptr) {
+    LOG_ERROR("Output |digest| is null");
+    return false;
+  }
+  if (GetDigestLength(algorithm) != HashType::size()) {
+    LOG_ERROR(
+        "Cannot finalize %s into a %zu-bit hash",
+        DigestAlgorithmToString(algorithm), HashType::size() * 8);
+    return false;
+  }
+  return true;
+}
+
+// Idle digesters of the thread, of any algorithm.  Bounded, as
+// digesters released on a thread return to that thread's pool.
+constexpr size_t kMaxPooledDigesters = 8;
+
+std::vector<std::unique_ptr<Digester>> &ThreadDigesterPool() {
+  thread_local std::vector<std::unique_ptr<Digester>> pool;
+  if (pool.capacity() == 0) pool.reserve(kMaxPooledDigesters);
+  return pool;
+}
+}  // namespace
+
+Digester::Digester(
+    DigestAlgorithm algorithm, std::unique_ptr<Sha256Context> &&context):
+    _algorithm(algorithm),
+    _digest_length(GetDigestLength(algorithm)),
+    _context(std::move(context)) {
+  DASSERT(_digest_length > 0);
+  DASSERT(_context);
+}
+
+Digester::~Digester() {}
+
+// static
+std::unique_ptr<Digester> Digester::New(DigestAlgorithm algorithm) {
+  if (!IsSupportedDigestAlgorithm(algorithm)) {
+    LOG_ERROR("Unsupport digest algorithm: %d", algorithm);
+    return nullptr;
+  }
+  return std::unique_ptr<Digester>(
+      new Digester(algorithm, std::unique_ptr<Sha256Context>(
+                                  new Sha256Context())));
+}
+
+// static
+PooledDigester Digester::Acquire(DigestAlgorithm algorithm) {
+  std::vector<std::unique_ptr<Digester>> &pool = ThreadDigesterPool();
+  for (size_t i = pool.size(); i > 0; i--) {
+    if (pool[i - 1]->algorithm() != algorithm) continue;
+    PooledDigester digester(pool[i - 1].release());
+    pool[i - 1] = std::move(pool.back());
+    pool.pop_back();
+    digester->Reset();
+    return digester;
+  }
+  return PooledDigester(New(algorithm).release());
+}
+
+// static
+std::unique_ptr<Digester> Digester::FromMidstate(
+    DigestAlgorithm algorithm, const Sha256Midstate &midstate) {
+  if (!IsValidMidstate(midstate)) return nullptr;
+  std::unique_ptr<Digester> digester = New(algorithm);
+  if (!digester) return nullptr;
+  digester->_context->LoadMidstate(midstate);
+  digester->_byte_count = midstate.count;
+  return digester;
+}
+
+std::unique_ptr<Digester> Digester::Clone() const {
+  std::unique_ptr<Digester> digester(new Digester(
+      _algorithm, std::unique_ptr<Sha256Context>(
+                      new Sha256Context(*_context))));
+  digester->_byte_count = _byte_count;
+  return digester;
+}
+
+void Digester::Reset() {
+  _context->Reset();
+  _byte_count = 0;
+}
+
+bool Digester::SaveMidstate(Sha256Midstate *midstate) const {
+  if (midstate == nullptr) {
+    LOG_ERROR("Output |midstate| is null");
+    return false;
+  }
+  if (!_context->SaveMidstate(midstate)) {
+    LOG_DEBUG(
+        "Cannot save midstate within a block: count = %zu", _byte_count);
+    return false;
+  }
+  return true;
+}
+
+bool Digester::LoadMidstate(const Sha256Midstate &midstate) {
+  if (!IsValidMidstate(midstate)) return false;
+  _context->LoadMidstate(midstate);
+  _byte_count = midstate.count;
+  return true;
+}
+
+bool Digester::Update(uint8_t datum) {
+  _context->Update(&datum, 1);
+  _byte_count++;
+  return true;
+}
+
+bool Digester::Update(const uint8_t *data, size_t data_size) {
+  if (data_size == 0) return true;
+  if (data == nullptr) {
+    LOG_ERROR("Input |data| is null");
+    return false;
+  }
+  _context->Update(data, data_size);
+  _byte_count += data_size;
+  return true;
+}
+
+bool Digester::Update(const std::string &data) {
+  return Update(reinterpret_cast<const uint8_t *>(data.data()), data.size());
+}
+
+bool Digester::Update(const std::vector<uint8_t> &data) {
+  return Update(data.data(), data.size());
+}
+
+bool Digester::Finalize(uint8_t *digest) {
+  if (digest == nullptr) {
+    LOG_ERROR("Output |digest| is null");
+    return false;
+  }
+  // Finalizing a copy leaves the digester open for further updates.
+  Sha256Context context = *_context;
+  return FinalizeContext(_algorithm, &context, digest);
+}
+
+std::vector<uint8_t> Digester::Finalize() {
+  std::vector<uint8_t> digest(_digest_length);
+  if (!Finalize(digest.data())) {
+    LOG_ERROR("Failed to finalize digest");
+    return {};
+  }
+  return digest;
+}
+
+bool Digester::Finalize(Hash256 *digest) {
+  if (!IsValidHashOutput(_algorithm, digest)) return false;
+  return Finalize(digest->data());
+}
+
+bool Digester::Finalize(Hash160 *digest) {
+  if (!IsValidHashOutput(_algorithm, digest)) return false;
+  return Finalize(digest->data());
+}
+
+bool Digester::FinalizeAndReset(uint8_t *digest) {
+  if (digest == nullptr) {
+    LOG_ERROR("Output |digest| is null");
+    return false;
+  }
+  const bool success = FinalizeContext(_algorithm, _context.get(), digest);
+  Reset();
+  return success;
+}
+
+bool Digester::FinalizeAndReset(Hash256 *digest) {
+  if (!IsValidHashOutput(_algorithm, digest)) return false;
+  return FinalizeAndReset(digest->data());
+}
+
+bool Digester::FinalizeAndReset(Hash160 *digest) {
+  if (!IsValidHashOutput(_algorithm, digest)) return false;
+  return FinalizeAndReset(digest->data());
+}
+
+void DigesterRecycler::operator()(Digester *digester) const {
+  if (digester == nullptr) return;
+  std::vector<std::unique_ptr<Digester>> &pool = ThreadDigesterPool();
+  if (pool.size() >= kMaxPooledDigesters) {
+    delete digester;
+    return;
+  }
+  pool.emplace_back(digester);
+}
+}  // namespace crypto
+}  // namespace btc
@@ -368,12 +368,12 @@ bool EccNativeKey::VerifySignature(
     return false;
   }
   // Step 1: Digest message.
-  const std::vector<uint8_t> digest = Sha256Sha256(data, data_size);
-  if (digest.empty()) {
+  Hash256 digest;
+  if (!Sha256Sha256(data, data_size, digest.data())) {
     LOG_ERROR("Failed to digest message");
     return false;
   }
-  DASSERT(digest.size() <= kMaxInt);
+  static_assert(Hash256::size() <= kMaxInt, "Digest too large");
   // Step 2: Verify message.
   const int res = ECDSA_verify(
       0, digest.data(), static_cast<int>(digest.size()), signature.data(),
@@ -391,12 +391,12 @@ std::vector<uint8_t> EccNativeKey::GenerateSignature(
   DASSERT(data != nullptr);
   DASSERT(data_size > 0);
   // Step 1: Digest message.
-  const std::vector<uint8_t> digest = Sha256Sha256(data, data_size);
-  if (digest.empty()) {
+  Hash256 digest;
+  if (!Sha256Sha256(data, data_size, digest.data())) {
     LOG_ERROR("Failed to digest message");
     return {};
   }
-  DASSERT(digest.size() <= kMaxInt);
+  static_assert(Hash256::size() <= kMaxInt, "Digest too large");
   // Step 2: Verify message.
   unsigned int signature_length = ECDSA_size(_key.Get());
   std::vector<uint8_t> signature(signature_length);
@@ -0,0 +1,68 @@
+// Bitcoin Info - Cryptography - Hash Values
+//
+// Copyright (c) 2022 Alex Dale
+// This project is licensed under the terms of the MIT license.
+// See LICENSE for details.
+#include "btc/crypto/hash.hpp"
+#include "btc/log.h"
+
+namespace btc {
+namespace crypto {
+namespace {
+// Hashes are too short to benefit from the hex kernels, and crypto
+// does not depend on encode.
+constexpr char kHexDigits[] = "0123456789abcdef";
+
+int HexDigitValue(char c) {
+  if (c >= '0' && c <= '9') return c - '0';
+  if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+  if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+  return -1;
+}
+
+// Byte |i| of the hexadecimal form.
+size_t ByteIndex(size_t i, size_t length, bool reverse) {
+  return reverse ? length - 1 - i : i;
+}
+}  // namespace
+
+// static
+template<size_t kLength, bool kDisplayReversed>
+bool FixedHash<kLength, kDisplayReversed>::FromHex(
+    const std::string &hex, FixedHash *hash, bool reverse) {
+  if (hex.size() != kLength * 2) {
+    LOG_DEBUG(
+        "Invalid hash length: expected = %zu, actual = %zu", kLength * 2,
+        hex.size());
+    return false;
+  }
+  FixedHash parsed;
+  for (size_t i = 0; i < kLength; i++) {
+    const int high = HexDigitValue(hex[i * 2]);
+    const int low = HexDigitValue(hex[i * 2 + 1]);
+    if (high < 0 || low < 0) {
+      LOG_DEBUG("Hash is not hexadecimal");
+      return false;
+    }
+    parsed[ByteIndex(i, kLength, reverse)] =
+        static_cast<uint8_t>(high << 4 | low);
+  }
+  *hash = parsed;
+  return true;
+}
+
+template<size_t kLength, bool kDisplayReversed>
+std::string FixedHash<kLength, kDisplayReversed>::ToHex(bool reverse) const {
+  std::string hex(kLength * 2, '0');
+  for (size_t i = 0; i < kLength; i++) {
+    const uint8_t byte = _bytes[ByteIndex(i, kLength, reverse)];
+    hex[i * 2] = kHexDigits[byte >> 4];
+    hex[i * 2 + 1] = kHexDigits[byte & 0x0f];
+  }
+  return hex;
+}
+
+template class FixedHash<32, true>;
+template class FixedHash<20, false>;
+}  // namespace crypto
+}  // namespace btc
@@ -0,0 +1,463 @@
+// Bitcoin Info - Cryptography - HMAC and PBKDF2
+//
+// Copyright (c) 2022 Alex Dale
+// This project is licensed under the terms of the MIT license.
+// See LICENSE for details.
+#include <endian.h>
+#include <string.h>
+
+#include <algorithm>
+#include <vector>
+
+#include "btc/cc/classy.hpp"
+#include "btc/cc/debug.h"
+#include "btc/crypto/digester.hpp"
+#include "btc/crypto/hmac.hpp"
+#include "btc/log.h"
+#include "btc/task/parallel.hpp"
+
+#define _BTC_CRYPTO_SHA256_INTERNAL_
+#include "btc/crypto/sha256.kernel.hpp"
+#undef _BTC_CRYPTO_SHA256_INTERNAL_
+
+#define _BTC_CRYPTO_SHA512_INTERNAL_
+#include "btc/crypto/sha512.kernel.hpp"
+#undef _BTC_CRYPTO_SHA512_INTERNAL_
+
+namespace btc {
+namespace crypto {
+namespace {
+using ::btc::task::ParallelFor;
+
+constexpr uint8_t kInnerPad = 0x36;
+constexpr uint8_t kOuterPad = 0x5c;
+
+const uint8_t *StringData(const std::string &data) {
+  return reinterpret_cast<const uint8_t *>(data.data());
+}
+
+// The context interface of the traits below, over a pooled SHA-256
+// Digester.  Digests always end the message, so finalizing resets.
+class Sha256DigesterContext {
+public:
+  BTC_DISALLOW_COPY_AND_MOVE(Sha256DigesterContext);
+  Sha256DigesterContext(): _digester(Digester::Acquire(kSha256)) {
+    DASSERT(_digester != nullptr);
+  }
+  explicit Sha256DigesterContext(const Sha256Midstate &midstate):
+      Sha256DigesterContext() {
+    LoadMidstate(midstate);
+  }
+
+  void Reset() { _digester->Reset(); }
+  void LoadMidstate(const Sha256Midstate &midstate) {
+    _digester->LoadMidstate(midstate);
+  }
+  // Only called after whole pad blocks.
+  void SaveMidstate(Sha256Midstate *midstate) const {
+    _digester->SaveMidstate(midstate);
+  }
+  void Update(const uint8_t *data, size_t data_size) {
+    _digester->Update(data, data_size);
+  }
+  void Finalize(uint8_t *digest) { _digester->FinalizeAndReset(digest); }
+
+private:
+  PooledDigester _digester;
+};  // class Sha256DigesterContext
+
+// The hash specific parts of HMAC and PBKDF2.  Both hashes have eight
+// big endian state words, which are the digest.
+
+struct Sha256Traits {
+  using Word = uint32_t;
+  using Midstate = Sha256Midstate;
+  using Context = Sha256DigesterContext;
+  using TransformKernel = internal::Sha256TransformKernel;
+  using LanesKernel = internal::Sha256LanesKernel;
+  static constexpr size_t kBlockLength = internal::kSha256BlockLength;
+  static constexpr size_t kDigestLength = kSha256DigestLength;
+  static constexpr size_t kMaxLanes = internal::kSha256MaxLanes;
+
+  static void Hash(const uint8_t *data, size_t data_size, uint8_t *digest) {
+    internal::NativeSha256(data, data_size, digest);
+  }
+  static TransformKernel GetTransform() {
+    return internal::ActiveSha256KernelTable()->transform;
+  }
+  // The scalar batch kernel has no lanes kernel.
+  static LanesKernel GetLanes(size_t *lanes) {
+    const internal::Sha256BatchKernelTable *table =
+        internal::GetSha256BatchKernelTable(GetSha256BatchKernel());
+    DASSERT(table != nullptr);
+    *lanes = table->lanes;
+    return table->transform;
+  }
+  static void StoreWord(uint32_t word, uint8_t *bytes) {
+    word = htobe32(word);
+    memcpy(bytes, &word, sizeof(word));
+  }
+};  // struct Sha256Traits
+
+struct Sha512Traits {
+  using Word = uint64_t;
+  using Midstate = Sha512Midstate;
+  using Context = internal::Sha512Context;
+  using TransformKernel = void (*)(uint64_t *, const uint8_t *, size_t);
+  using LanesKernel = internal::Sha512LanesKernel;
+  static constexpr size_t kBlockLength = internal::kSha512BlockLength;
+  static constexpr size_t kDigestLength = kSha512DigestLength;
+  static constexpr size_t kMaxLanes = internal::kSha512MaxLanes;
+
+  static void Hash(const uint8_t *data, size_t data_size, uint8_t *digest) {
+    internal::NativeSha512(data, data_size, digest);
+  }
+  static TransformKernel GetTransform() { return internal::Sha512Transform; }
+  static LanesKernel GetLanes(size_t *lanes) {
+    const internal::Sha512BatchKernelTable *table =
+        internal::ActiveSha512BatchKernelTable();
+    *lanes = table->lanes;
+    return table->transform;
+  }
+  static void StoreWord(uint64_t word, uint8_t *bytes) {
+    word = htobe64(word);
+    memcpy(bytes, &word, sizeof(word));
+  }
+};  // struct Sha512Traits
+
+constexpr size_t kStateWords = 8;
+
+// Writes the digest of lane |lane| of a word major state with |lanes|
+// lanes.
+template<typename H>
+void StoreLaneDigest(
+    const typename H::Word *state, size_t lanes, size_t lane,
+    uint8_t *digest) {
+  for (size_t i = 0; i < kStateWords; i++) {
+    H::StoreWord(state[i * lanes + lane], digest + i * sizeof(state[0]));
+  }
+}
+
+template<typename H>
+bool SetHmacKey(
+    const uint8_t *key, size_t key_size, typename H::Midstate *inner,
+    typename H::Midstate *outer) {
+  if (key == nullptr && key_size > 0) {
+    LOG_ERROR("Input |key| is null");
+    return false;
+  }
+  uint8_t block[H::kBlockLength] = {};
+  if (key_size > H::kBlockLength) {
+    H::Hash(key, key_size, block);
+  } else if (key_size > 0) {
+    memcpy(block, key, key_size);
+  }
+  for (uint8_t &byte : block) byte ^= kInnerPad;
+  typename H::Context context;
+  context.Update(block, H::kBlockLength);
+  context.SaveMidstate(inner);
+  for (uint8_t &byte : block) byte ^= kInnerPad ^ kOuterPad;
+  context.Reset();
+  context.Update(block, H::kBlockLength);
+  context.SaveMidstate(outer);
+  return true;
+}
+
+template<typename H>
+void ComputeHmac(
+    const typename H::Midstate &inner, const typename H::Midstate &outer,
+    const uint8_t *data, size_t data_size, uint8_t *mac) {
+  uint8_t inner_digest[H::kDigestLength];
+  typename H::Context context(inner);
+  context.Update(data, data_size);
+  context.Finalize(inner_digest);
+  context.LoadMidstate(outer);
+  context.Update(inner_digest, H::kDigestLength);
+  context.Finalize(mac);
+}
+
+// One block of a derived key, T_i of RFC 8018.
+template<typename H>
+struct Pbkdf2Block {
+  const Pbkdf2Input *input;
+  // One based index of the block within the key.
+  uint32_t index;
+  typename H::Midstate inner;
+  typename H::Midstate outer;
+  // U_j followed by the padding of a message of one block and one
+  // digest, which is the length of both the inner and the outer
+  // messages of an HMAC of U_j.
+  uint8_t message[H::kBlockLength];
+  // The sum of U_1 to U_j.
+  uint8_t sum[H::kDigestLength];
+};  // struct Pbkdf2Block
+
+// Sets up the pad midstates and U_1 of |block|.
+template<typename H>
+void StartPbkdf2Block(Pbkdf2Block<H> *block) {
+  const Pbkdf2Input &input = *block->input;
+  SetHmacKey<H>(
+      input.password, input.password_size, &block->inner, &block->outer);
+  // U_1 = HMAC(password, salt || INT(index))
+  uint8_t inner_digest[H::kDigestLength];
+  typename H::Context context(block->inner);
+  context.Update(input.salt, input.salt_size);
+  const uint32_t index = htobe32(block->index);
+  context.Update(reinterpret_cast<const uint8_t *>(&index), sizeof(index));
+  context.Finalize(inner_digest);
+  context.LoadMidstate(block->outer);
+  context.Update(inner_digest, H::kDigestLength);
+  context.Finalize(block->message);
+
+  memset(
+      block->message + H::kDigestLength, 0,
+      H::kBlockLength - H::kDigestLength);
+  block->message[H::kDigestLength] = 0x80;
+  const uint64_t bit_count =
+      htobe64((H::kBlockLength + H::kDigestLength) * 8);
+  memcpy(
+      block->message + H::kBlockLength - sizeof(bit_count), &bit_count,
+      sizeof(bit_count));
+  memcpy(block->sum, block->message, H::kDigestLength);
+}
+
+// Runs |rounds| further iterations of a single block.
+template<typename H>
+void IteratePbkdf2Block(size_t rounds, Pbkdf2Block<H> *block) {
+  const typename H::TransformKernel transform = H::GetTransform();
+  typename H::Word state[kStateWords];
+  for (size_t round = 0; round < rounds; round++) {
+    memcpy(state, block->inner.state, sizeof(state));
+    transform(state, block->message, 1);
+    StoreLaneDigest<H>(state, 1, 0, block->message);
+    memcpy(state, block->outer.state, sizeof(state));
+    transform(state, block->message, 1);
+    StoreLaneDigest<H>(state, 1, 0, block->message);
+    for (size_t i = 0; i < H::kDigestLength; i++) {
+      block->sum[i] ^= block->message[i];
+    }
+  }
+}
+
+// Runs |rounds| further iterations of one block per lane.  Blocks must
+// be distinct.
+template<typename H>
+void IteratePbkdf2Lanes(
+    typename H::LanesKernel kernel, size_t lanes, size_t rounds,
+    Pbkdf2Block<H> *const *blocks) {
+  DASSERT(lanes <= H::kMaxLanes);
+  typename H::Word inner[kStateWords * H::kMaxLanes];
+  typename H::Word outer[kStateWords * H::kMaxLanes];
+  typename H::Word state[kStateWords * H::kMaxLanes];
+  const uint8_t *messages[H::kMaxLanes];
+  for (size_t l = 0; l < lanes; l++) {
+    for (size_t i = 0; i < kStateWords; i++) {
+      inner[i * lanes + l] = blocks[l]->inner.state[i];
+      outer[i * lanes + l] = blocks[l]->outer.state[i];
+    }
+    messages[l] = blocks[l]->message;
+  }
+  const size_t state_size = kStateWords * lanes * sizeof(state[0]);
+  for (size_t round = 0; round < rounds; round++) {
+    memcpy(state, inner, state_size);
+    kernel(state, messages);
+    for (size_t l = 0; l < lanes; l++) {
+      StoreLaneDigest<H>(state, lanes, l, blocks[l]->message);
+    }
+    memcpy(state, outer, state_size);
+    kernel(state, messages);
+    for (size_t l = 0; l < lanes; l++) {
+      StoreLaneDigest<H>(state, lanes, l, blocks[l]->message);
+      for (size_t i = 0; i < H::kDigestLength; i++) {
+        blocks[l]->sum[i] ^= blocks[l]->message[i];
+      }
+    }
+  }
+}
+
+// Derives |count| consecutive blocks, in groups of |lanes|.
+template<typename H>
+void RunPbkdf2Blocks(
+    typename H::LanesKernel kernel, size_t lanes, size_t iterations,
+    Pbkdf2Block<H> *blocks, size_t count) {
+  for (size_t i = 0; i < count; i++) StartPbkdf2Block(&blocks[i]);
+  const size_t rounds = iterations - 1;
+  size_t i = 0;
+  if (kernel != nullptr) {
+    Pbkdf2Block<H> *group[H::kMaxLanes];
+    // Fills the unused lanes of the last group.
+    Pbkdf2Block<H> idle_block = blocks[0];
+    // Idle lanes run every iteration too, so as with Sha256Batch(), a
+    // short tail is cheaper one block at a time.
+    for (; i < count && (count - i) * 4 > lanes; i += lanes) {
+      for (size_t l = 0; l < lanes; l++) {
+        group[l] = i + l < count ? &blocks[i + l] : &idle_block;
+      }
+      IteratePbkdf2Lanes(kernel, lanes, rounds, group);
+    }
+  }
+  for (; i < count; i++) IteratePbkdf2Block(rounds, &blocks[i]);
+}
+
+template<typename H>
+bool Pbkdf2Batch(
+    const Pbkdf2Input *inputs, size_t count, size_t iterations,
+    uint8_t *keys, size_t key_size, size_t threads) {
+  if (keys == nullptr) {
+    LOG_ERROR("Output |keys| is null");
+    return false;
+  }
+  if (inputs == nullptr && count > 0) {
+    LOG_ERROR("Input |inputs| is null");
+    return false;
+  }
+  if (iterations == 0) {
+    LOG_ERROR("PBKDF2 requires at least one iteration");
+    return false;
+  }
+  const size_t blocks_per_key =
+      (key_size + H::kDigestLength - 1) / H::kDigestLength;
+  if (blocks_per_key > UINT32_MAX) {
+    LOG_ERROR("PBKDF2 key is too long: %zu", key_size);
+    return false;
+  }
+  for (size_t i = 0; i < count; i++) {
+    if ((inputs[i].password == nullptr && inputs[i].password_size > 0) ||
+        (inputs[i].salt == nullptr && inputs[i].salt_size > 0)) {
+      LOG_ERROR("Input %zu is null", i);
+      return false;
+    }
+  }
+  if (blocks_per_key == 0 || count == 0) return true;
+
+  std::vector<Pbkdf2Block<H>> blocks(count * blocks_per_key);
+  for (size_t i = 0; i < blocks.size(); i++) {
+    blocks[i].input = &inputs[i / blocks_per_key];
+    blocks[i].index = static_cast<uint32_t>(i % blocks_per_key + 1);
+  }
+  size_t lanes = 1;
+  const typename H::LanesKernel kernel = H::GetLanes(&lanes);
+  ParallelFor(blocks.size(), threads, [&](size_t begin, size_t end) {
+    RunPbkdf2Blocks(kernel, lanes, iterations, &blocks[begin], end - begin);
+  }, lanes);
+
+  for (size_t i = 0; i < blocks.size(); i++) {
+    const size_t offset = (i % blocks_per_key) * H::kDigestLength;
+    const size_t size = std::min(H::kDigestLength, key_size - offset);
+    memcpy(
+        keys + (i / blocks_per_key) * key_size + offset, blocks[i].sum,
+        size);
+  }
+  return true;
+}
+
+template<typename H>
+bool Pbkdf2(
+    const uint8_t *password, size_t password_size, const uint8_t *salt,
+    size_t salt_size, size_t iterations, uint8_t *key, size_t key_size) {
+  const Pbkdf2Input input = {password, password_size, salt, salt_size};
+  return Pbkdf2Batch<H>(&input, 1, iterations, key, key_size, 1);
+}
+}  // namespace
+
+// HMAC-SHA-256
+
+HmacSha256Key::HmacSha256Key() {
+  SetHmacKey<Sha256Traits>(nullptr, 0, &_inner, &_outer);
+}
+
+bool HmacSha256Key::SetKey(const uint8_t *key, size_t key_size) {
+  return SetHmacKey<Sha256Traits>(key, key_size, &_inner, &_outer);
+}
+
+bool HmacSha256Key::SetKey(const std::string &key) {
+  return SetKey(StringData(key), key.size());
+}
+
+bool HmacSha256Key::SetKey(const std::vector<uint8_t> &key) {
+  return SetKey(key.data(), key.size());
+}
+
+bool HmacSha256Key::Mac(
+    const uint8_t *data, size_t data_size, uint8_t *mac) const {
+  if (data == nullptr && data_size > 0) {
+    LOG_ERROR("Input |data| is null");
+    return false;
+  }
+  ComputeHmac<Sha256Traits>(_inner, _outer, data, data_size, mac);
+  return true;
+}
+
+// HMAC-SHA-512
+
+HmacSha512Key::HmacSha512Key() {
+  SetHmacKey<Sha512Traits>(nullptr, 0, &_inner, &_outer);
+}
+
+bool HmacSha512Key::SetKey(const uint8_t *key, size_t key_size) {
+  return SetHmacKey<Sha512Traits>(key, key_size, &_inner, &_outer);
+}
+
+bool HmacSha512Key::SetKey(const std::string &key) {
+  return SetKey(StringData(key), key.size());
+}
+
+bool HmacSha512Key::SetKey(const std::vector<uint8_t> &key) {
+  return SetKey(key.data(), key.size());
+}
+
+bool HmacSha512Key::Mac(
+    const uint8_t *data, size_t data_size, uint8_t *mac) const {
+  if (data == nullptr && data_size > 0) {
+    LOG_ERROR("Input |data| is null");
+    return false;
+  }
+  ComputeHmac<Sha512Traits>(_inner, _outer, data, data_size, mac);
+  return true;
+}
+
+bool HmacSha256(
+    const uint8_t *key, size_t key_size, const uint8_t *data,
+    size_t data_size, uint8_t *mac) {
+  HmacSha256Key hmac_key;
+  return hmac_key.SetKey(key, key_size) && hmac_key.Mac(data, data_size, mac);
+}
+
+bool HmacSha512(
+    const uint8_t *key, size_t key_size, const uint8_t *data,
+    size_t data_size, uint8_t *mac) {
+  HmacSha512Key hmac_key;
+  return hmac_key.SetKey(key, key_size) && hmac_key.Mac(data, data_size, mac);
+}
+
+// PBKDF2
+
+bool Pbkdf2HmacSha256(
+    const uint8_t *password, size_t password_size, const uint8_t *salt,
+    size_t salt_size, size_t iterations, uint8_t *key, size_t key_size) {
+  return Pbkdf2<Sha256Traits>(
+      password, password_size, salt, salt_size, iterations, key, key_size);
+}
+
+bool Pbkdf2HmacSha512(
+    const uint8_t *password, size_t password_size, const uint8_t *salt,
+    size_t salt_size, size_t iterations, uint8_t *key, size_t key_size) {
+  return Pbkdf2<Sha512Traits>(
+      password, password_size, salt, salt_size, iterations, key, key_size);
+}
+
+bool Pbkdf2HmacSha256Batch(
+    const Pbkdf2Input *inputs, size_t count, size_t iterations,
+    uint8_t *keys, size_t key_size, size_t threads) {
+  return Pbkdf2Batch<Sha256Traits>(
+      inputs, count, iterations, keys, key_size, threads);
+}
+
+bool Pbkdf2HmacSha512Batch(
+    const Pbkdf2Input *inputs, size_t count, size_t iterations,
+    uint8_t *keys, size_t key_size, size_t threads) {
+  return Pbkdf2Batch<Sha512Traits>(
+      inputs, count, iterations, keys, key_size, threads);
+}
+}  // namespace crypto
+}  // namespace btc
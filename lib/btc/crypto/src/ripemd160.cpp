@@ -0,0 +1,464 @@
+// Bitcoin Info - Cryptography - RIPEMD-160
+//
+// Copyright (c) 2022 Alex Dale
+// This project is licensed under the terms of the MIT license.
+// See LICENSE for details.
+#include <endian.h>
+#include <string.h>
+
+#include <algorithm>
+#include <atomic>
+
+#include "btc/cc/debug.h"
+#include "btc/cc/platform.h"
+#include "btc/cpu.h"
+#include "btc/crypto/digest.hpp"
+#include "btc/log.h"
+
+#define _BTC_CRYPTO_RIPEMD160_INTERNAL_
+#include "btc/crypto/ripemd160.kernel.hpp"
+#undef _BTC_CRYPTO_RIPEMD160_INTERNAL_
+
+#define _BTC_CRYPTO_SHA256_INTERNAL_
+#include "btc/crypto/sha256.kernel.hpp"
+#undef _BTC_CRYPTO_SHA256_INTERNAL_
+
+namespace btc {
+namespace crypto {
+namespace internal {
+namespace {
+constexpr uint32_t kRipeMd160InitialState[kRipeMd160StateWords] = {
+    0x67452301, 0xefcdab89, 0x98badcfe, 0x10325476, 0xc3d2e1f0};
+
+// Message word, rotation and constant of each step of the left and
+// right lines.
+constexpr int kLeftWord[80] = {
+    0,  1,  2,  3,  4,  5,  6,  7,  8,  9,  10, 11, 12, 13, 14, 15,
+    7,  4,  13, 1,  10, 6,  15, 3,  12, 0,  9,  5,  2,  14, 11, 8,
+    3,  10, 14, 4,  9,  15, 8,  1,  2,  7,  0,  6,  13, 11, 5,  12,
+    1,  9,  11, 10, 0,  8,  12, 4,  13, 3,  7,  15, 14, 5,  6,  2,
+    4,  0,  5,  9,  7,  12, 2,  10, 14, 1,  3,  8,  11, 6,  15, 13};
+constexpr int kRightWord[80] = {
+    5,  14, 7,  0,  9,  2,  11, 4,  13, 6,  15, 8,  1,  10, 3,  12,
+    6,  11, 3,  7,  0,  13, 5,  10, 14, 15, 8,  12, 4,  9,  1,  2,
+    15, 5,  1,  3,  7,  14, 6,  9,  11, 8,  12, 2,  10, 0,  4,  13,
+    8,  6,  4,  1,  3,  11, 15, 0,  5,  12, 2,  13, 9,  7,  10, 14,
+    12, 15, 10, 4,  1,  5,  8,  7,  6,  2,  13, 14, 0,  3,  9,  11};
+constexpr int kLeftShift[80] = {
+    11, 14, 15, 12, 5,  8,  7,  9,  11, 13, 14, 15, 6,  7,  9,  8,
+    7,  6,  8,  13, 11, 9,  7,  15, 7,  12, 15, 9,  11, 7,  13, 12,
+    11, 13, 6,  7,  14, 9,  13, 15, 14, 8,  13, 6,  5,  12, 7,  5,
+    11, 12, 14, 15, 14, 15, 9,  8,  9,  14, 5,  6,  8,  6,  5,  12,
+    9,  15, 5,  11, 6,  8,  13, 12, 5,  12, 13, 14, 11, 8,  5,  6};
+constexpr int kRightShift[80] = {
+    8,  9,  9,  11, 13, 15, 15, 5,  7,  7,  8,  11, 14, 14, 12, 6,
+    9,  13, 15, 7,  12, 8,  9,  11, 7,  7,  12, 7,  6,  15, 13, 11,
+    9,  7,  15, 11, 8,  6,  6,  14, 12, 13, 5,  14, 13, 13, 7,  5,
+    15, 5,  8,  11, 14, 14, 6,  14, 6,  9,  12, 9,  12, 5,  15, 8,
+    8,  5,  12, 9,  12, 5,  14, 6,  8,  13, 6,  5,  15, 13, 11, 11};
+constexpr uint32_t kLeftConstant[5] = {
+    0x00000000, 0x5a827999, 0x6ed9eba1, 0x8f1bbcdc, 0xa953fd4e};
+constexpr uint32_t kRightConstant[5] = {
+    0x50a28be6, 0x5c4dd124, 0x6d703ef3, 0x7a6d76e9, 0x00000000};
+
+// Message words 8 to 15 of a 32 byte message: the 0x80 terminator and
+// the length of 256 bits.
+constexpr uint32_t kD32PaddingWords[8] = {0x80, 0, 0, 0, 0, 0, 256, 0};
+
+// The compression function is written once for any |Word| type with
+// the integer operators of uint32_t: uint32_t for one message, or a
+// GCC vector of uint32_t for one message per element.  Vectors are
+// only passed by pointer or reference, which keeps the helpers free of
+// vector calling conventions until they are inlined into a kernel
+// compiled for the instruction set.  Fully unrolled, the step tables
+// fold into constants.
+
+// One step of a line.  The five working variables are rotated by
+// renaming, step |j| uses |v| starting at offset -|j|; |f| selects the
+// boolean function.
+template<typename Word>
+__ALWAYS_INLINE inline void RipeMd160Step(
+    Word *v, int j, int f, const Word &x, uint32_t k, int s) {
+  Word &a = v[(80 - j) % 5];
+  const Word &b = v[(81 - j) % 5];
+  Word &c = v[(82 - j) % 5];
+  const Word &d = v[(83 - j) % 5];
+  const Word &e = v[(84 - j) % 5];
+  Word t;
+  switch (f) {
+    case 0:
+      t = b ^ c ^ d;
+      break;
+    case 1:
+      t = (b & c) | (~b & d);
+      break;
+    case 2:
+      t = (b | ~c) ^ d;
+      break;
+    case 3:
+      t = (b & d) | (c & ~d);
+      break;
+    default:
+      t = b ^ (c | ~d);
+      break;
+  }
+  t = a + t + x + k;
+  a = ((t << s) | (t >> (32 - s))) + e;
+  c = (c << 10) | (c >> 22);
+}
+
+template<typename Word>
+__ALWAYS_INLINE inline void RipeMd160Compress(Word *state, const Word *x) {
+  Word left[kRipeMd160StateWords];
+  Word right[kRipeMd160StateWords];
+  for (size_t i = 0; i < kRipeMd160StateWords; i++) {
+    left[i] = state[i];
+    right[i] = state[i];
+  }
+#pragma GCC unroll 80
+  for (int j = 0; j < 80; j++) {
+    RipeMd160Step(
+        left, j, j / 16, x[kLeftWord[j]], kLeftConstant[j / 16],
+        kLeftShift[j]);
+    RipeMd160Step(
+        right, j, 4 - j / 16, x[kRightWord[j]], kRightConstant[j / 16],
+        kRightShift[j]);
+  }
+  // After 80 steps the renaming is back at offset 0.
+  const Word t = state[1] + left[2] + right[3];
+  state[1] = state[2] + left[3] + right[4];
+  state[2] = state[3] + left[4] + right[0];
+  state[3] = state[4] + left[0] + right[1];
+  state[4] = state[0] + left[1] + right[2];
+  state[0] = t;
+}
+
+inline uint32_t LoadLittleEndian32(const uint8_t *p) {
+  uint32_t x;
+  memcpy(&x, p, sizeof(x));
+  return le32toh(x);
+}
+
+inline void StoreLittleEndian32(uint8_t *p, uint32_t x) {
+  x = htole32(x);
+  memcpy(p, &x, sizeof(x));
+}
+
+void RipeMd160Transform(
+    uint32_t *state, const uint8_t *blocks, size_t block_count) {
+  for (size_t n = 0; n < block_count; n++, blocks += kRipeMd160BlockLength) {
+    uint32_t x[16];
+    for (size_t i = 0; i < 16; i++) x[i] = LoadLittleEndian32(blocks + i * 4);
+    RipeMd160Compress(state, x);
+  }
+}
+
+void StoreRipeMd160Digest(const uint32_t *state, uint8_t *digest) {
+  for (size_t i = 0; i < kRipeMd160StateWords; i++) {
+    StoreLittleEndian32(digest + i * 4, state[i]);
+  }
+}
+
+// RIPEMD-160 of a 32 byte message given as its first eight message
+// words.
+void RipeMd160D32Words(uint32_t *x, uint8_t *digest) {
+  memcpy(x + 8, kD32PaddingWords, sizeof(kD32PaddingWords));
+  uint32_t state[kRipeMd160StateWords];
+  memcpy(state, kRipeMd160InitialState, sizeof(state));
+  RipeMd160Compress(state, x);
+  StoreRipeMd160Digest(state, digest);
+}
+
+using RipeMd160D32Kernel = void (*)(const uint8_t *data, uint8_t *digests);
+
+void RipeMd160D32Scalar(const uint8_t *data, uint8_t *digest) {
+  uint32_t x[16];
+  for (size_t i = 0; i < 8; i++) x[i] = LoadLittleEndian32(data + i * 4);
+  RipeMd160D32Words(x, digest);
+}
+
+#ifdef BTC_ARCH_X86
+using Lanes8 = uint32_t __attribute__((vector_size(32)));
+using Lanes16 = uint32_t __attribute__((vector_size(64)));
+
+// RIPEMD-160 of |kLanes| consecutive 32 byte messages.
+template<typename Lanes, size_t kLanes>
+__ALWAYS_INLINE inline void RipeMd160D32Lanes(
+    const uint8_t *data, uint8_t *digests) {
+  Lanes x[16];
+  for (size_t j = 0; j < 8; j++) {
+    for (size_t l = 0; l < kLanes; l++) {
+      x[j][l] = LoadLittleEndian32(data + l * kSha256DigestLength + j * 4);
+    }
+  }
+  for (size_t j = 8; j < 16; j++) x[j] = Lanes{} + kD32PaddingWords[j - 8];
+  Lanes state[kRipeMd160StateWords];
+  for (size_t i = 0; i < kRipeMd160StateWords; i++) {
+    state[i] = Lanes{} + kRipeMd160InitialState[i];
+  }
+  RipeMd160Compress(state, x);
+  for (size_t l = 0; l < kLanes; l++) {
+    for (size_t i = 0; i < kRipeMd160StateWords; i++) {
+      StoreLittleEndian32(
+          digests + l * kRipeMd160DigestLength + i * 4, state[i][l]);
+    }
+  }
+}
+
+__TARGET("avx2")
+void RipeMd160D32Lanes8Avx2(const uint8_t *data, uint8_t *digests) {
+  RipeMd160D32Lanes<Lanes8, 8>(data, digests);
+}
+
+__TARGET("avx512f")
+void RipeMd160D32Lanes16Avx512(const uint8_t *data, uint8_t *digests) {
+  RipeMd160D32Lanes<Lanes16, 16>(data, digests);
+}
+#endif  // BTC_ARCH_X86
+
+struct RipeMd160BatchKernelTable {
+  RipeMd160BatchKernel kernel;
+  size_t lanes;
+  RipeMd160D32Kernel d32;
+};  // struct RipeMd160BatchKernelTable
+
+const RipeMd160BatchKernelTable kScalarTable = {
+    kRipeMd160BatchKernelScalar, 1, RipeMd160D32Scalar};
+#ifdef BTC_ARCH_X86
+const RipeMd160BatchKernelTable kAvx2Table = {
+    kRipeMd160BatchKernelAvx2, 8, RipeMd160D32Lanes8Avx2};
+const RipeMd160BatchKernelTable kAvx512Table = {
+    kRipeMd160BatchKernelAvx512, 16, RipeMd160D32Lanes16Avx512};
+#endif  // BTC_ARCH_X86
+
+std::atomic<const RipeMd160BatchKernelTable *> g_ripemd160_batch_kernel{
+    nullptr};
+
+const RipeMd160BatchKernelTable *GetRipeMd160BatchKernelTable(
+    RipeMd160BatchKernel kernel) {
+  switch (kernel) {
+    case kRipeMd160BatchKernelScalar:
+      return &kScalarTable;
+#ifdef BTC_ARCH_X86
+    case kRipeMd160BatchKernelAvx2:
+      return btc_cpu_has(BTC_CPU_AVX2) ? &kAvx2Table : nullptr;
+    case kRipeMd160BatchKernelAvx512:
+      return btc_cpu_has(BTC_CPU_AVX512F) ? &kAvx512Table : nullptr;
+#else
+    case kRipeMd160BatchKernelAvx2:
+    case kRipeMd160BatchKernelAvx512:
+      return nullptr;
+#endif  // BTC_ARCH_X86
+  }
+  return nullptr;
+}
+
+const RipeMd160BatchKernelTable *ActiveRipeMd160BatchKernelTable() {
+  const RipeMd160BatchKernelTable *table =
+      g_ripemd160_batch_kernel.load(std::memory_order_relaxed);
+  if (table != nullptr) return table;
+  // There are no RIPEMD-160 instructions, so the widest lanes win.
+  table = GetRipeMd160BatchKernelTable(kRipeMd160BatchKernelAvx512);
+  if (table == nullptr) {
+    table = GetRipeMd160BatchKernelTable(kRipeMd160BatchKernelAvx2);
+  }
+  if (table == nullptr) table = &kScalarTable;
+  g_ripemd160_batch_kernel.store(table, std::memory_order_relaxed);
+  return table;
+}
+
+// Final block of a SHA-256 message of |message_size| bytes, less than
+// 56 bytes of which are in the final block.
+struct Sha256TailBlock {
+  uint8_t bytes[kSha256BlockLength];
+};  // struct Sha256TailBlock
+
+constexpr Sha256TailBlock MakeSha256TailBlock(size_t message_size) {
+  Sha256TailBlock block = {};
+  block.bytes[message_size % kSha256BlockLength] = 0x80;
+  const uint64_t bit_count = static_cast<uint64_t>(message_size) * 8;
+  for (size_t i = 0; i < 8; i++) {
+    block.bytes[kSha256BlockLength - 1 - i] =
+        static_cast<uint8_t>(bit_count >> (i * 8));
+  }
+  return block;
+}
+
+constexpr size_t kCompressedKeyLength = 33;
+constexpr size_t kUncompressedKeyLength = 65;
+constexpr Sha256TailBlock kCompressedKeyTail =
+    MakeSha256TailBlock(kCompressedKeyLength);
+constexpr Sha256TailBlock kUncompressedKeyTail =
+    MakeSha256TailBlock(kUncompressedKeyLength);
+
+// SHA-256 state after a 33 or 65 byte public key.
+void Sha256PublicKey(const uint8_t *key, size_t key_size, uint32_t *state) {
+  DASSERT(
+      key_size == kCompressedKeyLength || key_size == kUncompressedKeyLength);
+  const Sha256TransformKernel transform = ActiveSha256KernelTable()->transform;
+  memcpy(state, kSha256InitialState, sizeof(kSha256InitialState));
+  Sha256TailBlock block = key_size == kCompressedKeyLength
+                              ? kCompressedKeyTail
+                              : kUncompressedKeyTail;
+  const size_t full_blocks = key_size / kSha256BlockLength;
+  if (full_blocks > 0) transform(state, key, full_blocks);
+  memcpy(
+      block.bytes, key + full_blocks * kSha256BlockLength,
+      key_size % kSha256BlockLength);
+  transform(state, block.bytes, 1);
+}
+
+// Pads the last |tail_size| (less than a block) bytes of a |data_size|
+// byte message and writes the digest.
+void FinishRipeMd160(
+    uint32_t *state, const uint8_t *tail, size_t tail_size, uint64_t data_size,
+    uint8_t *digest) {
+  DASSERT(tail_size < kRipeMd160BlockLength);
+  // The 0x80 terminator and 64-bit little endian bit count, one or two
+  // blocks.
+  uint8_t padding[kRipeMd160BlockLength * 2] = {};
+  if (tail_size > 0) memcpy(padding, tail, tail_size);
+  padding[tail_size] = 0x80;
+  const size_t block_count = tail_size < kRipeMd160BlockLength - 8 ? 1 : 2;
+  const uint64_t bit_count = htole64(data_size * 8);
+  memcpy(
+      padding + block_count * kRipeMd160BlockLength - sizeof(bit_count),
+      &bit_count, sizeof(bit_count));
+  RipeMd160Transform(state, padding, block_count);
+  StoreRipeMd160Digest(state, digest);
+}
+}  // namespace
+
+bool NativeRipeMd160(const uint8_t *data, size_t data_size, uint8_t *digest) {
+  DASSERT(data != nullptr || data_size == 0);
+  uint32_t state[kRipeMd160StateWords];
+  memcpy(state, kRipeMd160InitialState, sizeof(state));
+  const size_t full_blocks = data_size / kRipeMd160BlockLength;
+  RipeMd160Transform(state, data, full_blocks);
+  FinishRipeMd160(
+      state, data + full_blocks * kRipeMd160BlockLength,
+      data_size % kRipeMd160BlockLength, data_size, digest);
+  return true;
+}
+
+bool NativeRipeMd160V(
+    const DigestInput *segments, size_t count, uint8_t *digest) {
+  DASSERT(segments != nullptr || count == 0);
+  uint32_t state[kRipeMd160StateWords];
+  memcpy(state, kRipeMd160InitialState, sizeof(state));
+  // Only blocks which straddle segments are copied.
+  uint8_t buffer[kRipeMd160BlockLength];
+  size_t buffered = 0;
+  uint64_t data_size = 0;
+  for (size_t i = 0; i < count; i++) {
+    const uint8_t *data = segments[i].data;
+    size_t size = segments[i].size;
+    DASSERT(data != nullptr || size == 0);
+    data_size += size;
+    if (buffered > 0) {
+      const size_t take = std::min(kRipeMd160BlockLength - buffered, size);
+      memcpy(buffer + buffered, data, take);
+      buffered += take;
+      data += take;
+      size -= take;
+      if (buffered < kRipeMd160BlockLength) continue;
+      RipeMd160Transform(state, buffer, 1);
+      buffered = 0;
+    }
+    const size_t full_blocks = size / kRipeMd160BlockLength;
+    RipeMd160Transform(state, data, full_blocks);
+    data += full_blocks * kRipeMd160BlockLength;
+    size -= full_blocks * kRipeMd160BlockLength;
+    if (size > 0) memcpy(buffer, data, size);
+    buffered = size;
+  }
+  FinishRipeMd160(state, buffer, buffered, data_size, digest);
+  return true;
+}
+
+bool NativeSha256RipeMd160(
+    const uint8_t *data, size_t data_size, uint8_t *digest) {
+  uint32_t x[16];
+  if (data_size == kCompressedKeyLength ||
+      data_size == kUncompressedKeyLength) {
+    // The SHA-256 digest is the big endian state, RIPEMD-160 reads it
+    // as little endian words.
+    uint32_t state[kSha256StateWords];
+    Sha256PublicKey(data, data_size, state);
+    for (size_t i = 0; i < 8; i++) x[i] = __builtin_bswap32(state[i]);
+  } else {
+    uint8_t first_digest[kSha256DigestLength];
+    NativeSha256(data, data_size, first_digest);
+    for (size_t i = 0; i < 8; i++) {
+      x[i] = LoadLittleEndian32(first_digest + i * 4);
+    }
+  }
+  RipeMd160D32Words(x, digest);
+  return true;
+}
+}  // namespace internal
+
+const char *RipeMd160BatchKernelToString(RipeMd160BatchKernel kernel) {
+  switch (kernel) {
+    case kRipeMd160BatchKernelScalar:
+      return "scalar";
+    case kRipeMd160BatchKernelAvx2:
+      return "avx2";
+    case kRipeMd160BatchKernelAvx512:
+      return "avx512";
+  }
+  LOG_ERROR("Unknown RIPEMD-160 batch kernel: %d", kernel);
+  return "<error>";
+}
+
+bool IsRipeMd160BatchKernelSupported(RipeMd160BatchKernel kernel) {
+  return internal::GetRipeMd160BatchKernelTable(kernel) != nullptr;
+}
+
+RipeMd160BatchKernel GetRipeMd160BatchKernel() {
+  return internal::ActiveRipeMd160BatchKernelTable()->kernel;
+}
+
+bool SetRipeMd160BatchKernel(RipeMd160BatchKernel kernel) {
+  const internal::RipeMd160BatchKernelTable *table =
+      internal::GetRipeMd160BatchKernelTable(kernel);
+  if (table == nullptr) {
+    LOG_WARN(
+        "RIPEMD-160 batch kernel not supported: %s",
+        RipeMd160BatchKernelToString(kernel));
+    return false;
+  }
+  internal::g_ripemd160_batch_kernel.store(table, std::memory_order_relaxed);
+  return true;
+}
+
+bool Sha256RipeMd160Batch(
+    const DigestInput *inputs, size_t count, uint8_t *digests) {
+  // Checked up front, so that no digest is written on failure.
+  if (!internal::IsValidDigestBatch(inputs, count)) return false;
+  // The SHA-256 pass of a chunk fills a buffer which the RIPEMD-160
+  // pass reads in lane sized groups.
+  constexpr size_t kChunkSize = 256;
+  uint8_t first_digests[kChunkSize * kSha256DigestLength];
+  const internal::RipeMd160BatchKernelTable *table =
+      internal::ActiveRipeMd160BatchKernelTable();
+  for (size_t offset = 0; offset < count; offset += kChunkSize) {
+    const size_t chunk_size = std::min(kChunkSize, count - offset);
+    Sha256Batch(inputs + offset, chunk_size, first_digests);
+    uint8_t *chunk_digests = digests + offset * kRipeMd160DigestLength;
+    size_t i = 0;
+    for (; i + table->lanes <= chunk_size; i += table->lanes) {
+      table->d32(
+          first_digests + i * kSha256DigestLength,
+          chunk_digests + i * kRipeMd160DigestLength);
+    }
+    for (; i < chunk_size; i++) {
+      internal::RipeMd160D32Scalar(
+          first_digests + i * kSha256DigestLength,
+          chunk_digests + i * kRipeMd160DigestLength);
+    }
+  }
+  return true;
+}
+}  // namespace crypto
+}  // namespace btc
@@ -0,0 +1,380 @@
+// Bitcoin Info - Cryptography - Batch SHA-256
+//
+// Copyright (c) 2022 Alex Dale
+// This project is licensed under the terms of the MIT license.
+// See LICENSE for details.
+#include <endian.h>
+#include <string.h>
+
+#include <algorithm>
+#include <atomic>
+
+#include "btc/cc/debug.h"
+#include "btc/crypto/digest.hpp"
+#include "btc/log.h"
+
+#define _BTC_CRYPTO_SHA256_INTERNAL_
+#include "btc/crypto/sha256.kernel.hpp"
+#undef _BTC_CRYPTO_SHA256_INTERNAL_
+
+namespace btc {
+namespace crypto {
+namespace {
+using internal::kSha256BlockLength;
+using internal::kSha256InitialState;
+using internal::kSha256MaxLanes;
+using internal::kSha256StateWords;
+using internal::Sha256BatchKernelTable;
+
+std::atomic<const Sha256BatchKernelTable *> g_sha256_batch_kernel{nullptr};
+
+const Sha256BatchKernelTable *ActiveSha256BatchKernel() {
+  const Sha256BatchKernelTable *table =
+      g_sha256_batch_kernel.load(std::memory_order_relaxed);
+  if (table != nullptr) return table;
+  table = internal::SelectSha256BatchKernelTable();
+  g_sha256_batch_kernel.store(table, std::memory_order_relaxed);
+  return table;
+}
+
+constexpr size_t kIdleLane = static_cast<size_t>(-1);
+
+// Fed to lanes with no message, the result is discarded.
+const uint8_t kIdleBlock[kSha256BlockLength] = {};
+
+// The blocks of one message: the full blocks are read in place, the
+// final partial block and padding are copied into |tail|.
+struct Sha256Lane {
+  size_t index = kIdleLane;
+  const uint8_t *data = nullptr;
+  size_t full_blocks = 0;
+  size_t tail_blocks = 0;
+  size_t tail_offset = 0;
+  uint8_t tail[kSha256BlockLength * 2] = {};
+
+  void Load(const DigestInput &input, size_t input_index) {
+    index = input_index;
+    data = input.data;
+    full_blocks = input.size / kSha256BlockLength;
+    const size_t remaining = input.size % kSha256BlockLength;
+    memset(tail, 0, sizeof(tail));
+    if (remaining > 0) {
+      memcpy(tail, data + full_blocks * kSha256BlockLength, remaining);
+    }
+    tail[remaining] = 0x80;
+    tail_blocks = remaining < kSha256BlockLength - 8 ? 1 : 2;
+    tail_offset = 0;
+    const uint64_t bit_count = htobe64(static_cast<uint64_t>(input.size) * 8);
+    memcpy(
+        tail + tail_blocks * kSha256BlockLength - sizeof(bit_count),
+        &bit_count, sizeof(bit_count));
+  }
+
+  bool done() const { return full_blocks == 0 && tail_offset == tail_blocks; }
+
+  const uint8_t *NextBlock() {
+    if (full_blocks > 0) {
+      const uint8_t *block = data;
+      data += kSha256BlockLength;
+      full_blocks--;
+      return block;
+    }
+    return tail + kSha256BlockLength * tail_offset++;
+  }
+};  // struct Sha256Lane
+
+void WriteDigest(const uint32_t *state, size_t stride, uint8_t *digest) {
+  for (size_t i = 0; i < kSha256StateWords; i++) {
+    const uint32_t word = htobe32(state[i * stride]);
+    memcpy(digest + i * 4, &word, sizeof(word));
+  }
+}
+
+// Runs the last few messages through the single buffer kernel once
+// too many lanes would be idle.
+void FinishLane(
+    Sha256Lane *lane, const uint32_t *lane_state, size_t lanes,
+    uint8_t *digests) {
+  uint32_t state[kSha256StateWords];
+  for (size_t i = 0; i < kSha256StateWords; i++) {
+    state[i] = lane_state[i * lanes];
+  }
+  const internal::Sha256TransformKernel transform =
+      internal::ActiveSha256KernelTable()->transform;
+  if (lane->full_blocks > 0) transform(state, lane->data, lane->full_blocks);
+  if (lane->tail_offset < lane->tail_blocks) {
+    transform(
+        state, lane->tail + kSha256BlockLength * lane->tail_offset,
+        lane->tail_blocks - lane->tail_offset);
+  }
+  WriteDigest(state, 1, digests + lane->index * kSha256DigestLength);
+}
+
+void Sha256Lanes(
+    const Sha256BatchKernelTable *table, const DigestInput *inputs,
+    size_t count, uint8_t *digests) {
+  const size_t lanes = table->lanes;
+  DASSERT(lanes <= kSha256MaxLanes);
+  Sha256Lane lane[kSha256MaxLanes];
+  alignas(64) uint32_t state[kSha256StateWords * kSha256MaxLanes];
+  const uint8_t *blocks[kSha256MaxLanes];
+
+  size_t next = 0;
+  size_t active = 0;
+  const auto load_next = [&](size_t l) {
+    lane[l].Load(inputs[next], next);
+    next++;
+    for (size_t i = 0; i < kSha256StateWords; i++) {
+      state[i * lanes + l] = kSha256InitialState[i];
+    }
+  };
+  for (size_t l = 0; l < lanes && next < count; l++) {
+    load_next(l);
+    active++;
+  }
+
+  while (active > 0) {
+    if (next == count && active * 4 <= lanes) {
+      for (size_t l = 0; l < lanes; l++) {
+        if (lane[l].index == kIdleLane) continue;
+        FinishLane(&lane[l], state + l, lanes, digests);
+      }
+      return;
+    }
+    for (size_t l = 0; l < lanes; l++) {
+      blocks[l] =
+          lane[l].index == kIdleLane ? kIdleBlock : lane[l].NextBlock();
+    }
+    table->transform(state, blocks);
+    for (size_t l = 0; l < lanes; l++) {
+      if (lane[l].index == kIdleLane || !lane[l].done()) continue;
+      WriteDigest(
+          state + l, lanes, digests + lane[l].index * kSha256DigestLength);
+      if (next < count) {
+        load_next(l);
+      } else {
+        lane[l].index = kIdleLane;
+        active--;
+      }
+    }
+  }
+}
+
+// Layout of the second block of an 80 byte message.
+constexpr size_t kD80TailLength = 80 - kSha256BlockLength;
+constexpr size_t kD80NonceOffset = kD80TailLength - sizeof(uint32_t);
+
+// Padded final block of a message of |length| bytes, of which the
+// first |length| % 64 bytes are left for the caller.
+void PadBlock(uint64_t length, uint8_t *block) {
+  const size_t used = length % kSha256BlockLength;
+  memset(block + used, 0, kSha256BlockLength - used);
+  block[used] = 0x80;
+  const uint64_t bit_count = htobe64(length * 8);
+  memcpy(
+      block + kSha256BlockLength - sizeof(bit_count), &bit_count,
+      sizeof(bit_count));
+}
+
+void SetD80Nonce(uint8_t *block, uint32_t nonce) {
+  const uint32_t le_nonce = htole32(nonce);
+  memcpy(block + kD80NonceOffset, &le_nonce, sizeof(le_nonce));
+}
+
+// Second block of each message, then first digest and padding.
+void Sha256D80NoncesScalar(
+    const Sha256Midstate &midstate, const uint8_t *tail_block,
+    uint32_t nonce, size_t count, uint8_t *digests) {
+  const internal::Sha256TransformKernel transform =
+      internal::ActiveSha256KernelTable()->transform;
+  uint8_t block[kSha256BlockLength];
+  uint8_t second[kSha256BlockLength];
+  memcpy(block, tail_block, kSha256BlockLength);
+  PadBlock(kSha256DigestLength, second);
+  uint32_t state[kSha256StateWords];
+  for (size_t i = 0; i < count; i++) {
+    SetD80Nonce(block, nonce + static_cast<uint32_t>(i));
+    memcpy(state, midstate.state, sizeof(state));
+    transform(state, block, 1);
+    WriteDigest(state, 1, second);
+    memcpy(state, kSha256InitialState, sizeof(state));
+    transform(state, second, 1);
+    WriteDigest(state, 1, digests + i * kSha256DigestLength);
+  }
+}
+
+void Sha256D80NoncesLanes(
+    const Sha256BatchKernelTable *table, const Sha256Midstate &midstate,
+    const uint8_t *tail_block, uint32_t nonce, size_t count,
+    uint8_t *digests) {
+  const size_t lanes = table->lanes;
+  DASSERT(lanes <= kSha256MaxLanes);
+  alignas(64) uint32_t state[kSha256StateWords * kSha256MaxLanes];
+  alignas(64) uint8_t block[kSha256MaxLanes][kSha256BlockLength];
+  alignas(64) uint8_t second[kSha256MaxLanes][kSha256BlockLength];
+  const uint8_t *blocks[kSha256MaxLanes];
+  const uint8_t *seconds[kSha256MaxLanes];
+  for (size_t l = 0; l < lanes; l++) {
+    memcpy(block[l], tail_block, kSha256BlockLength);
+    PadBlock(kSha256DigestLength, second[l]);
+    blocks[l] = block[l];
+    seconds[l] = second[l];
+  }
+  for (size_t i = 0; i < count; i += lanes) {
+    // The lanes past the last message hash nonces which are discarded.
+    const size_t active = std::min(lanes, count - i);
+    for (size_t l = 0; l < lanes; l++) {
+      SetD80Nonce(block[l], nonce + static_cast<uint32_t>(i + l));
+      for (size_t w = 0; w < kSha256StateWords; w++) {
+        state[w * lanes + l] = midstate.state[w];
+      }
+    }
+    table->transform(state, blocks);
+    for (size_t l = 0; l < lanes; l++) {
+      WriteDigest(state + l, lanes, second[l]);
+      for (size_t w = 0; w < kSha256StateWords; w++) {
+        state[w * lanes + l] = kSha256InitialState[w];
+      }
+    }
+    table->transform(state, seconds);
+    for (size_t l = 0; l < active; l++) {
+      WriteDigest(
+          state + l, lanes, digests + (i + l) * kSha256DigestLength);
+    }
+  }
+}
+
+void Sha256BatchInternal(
+    const DigestInput *inputs, size_t count, uint8_t *digests) {
+  const Sha256BatchKernelTable *table = ActiveSha256BatchKernel();
+  if (table->transform == nullptr || count * 4 <= table->lanes) {
+    for (size_t i = 0; i < count; i++) {
+      internal::NativeSha256(
+          inputs[i].data, inputs[i].size, digests + i * kSha256DigestLength);
+    }
+    return;
+  }
+  Sha256Lanes(table, inputs, count, digests);
+}
+}  // namespace
+
+namespace internal {
+bool IsValidDigestBatch(const DigestInput *inputs, size_t count) {
+  if (count == 0) return true;
+  if (inputs == nullptr) {
+    LOG_ERROR("Input |inputs| is null");
+    return false;
+  }
+  for (size_t i = 0; i < count; i++) {
+    if (inputs[i].data == nullptr && inputs[i].size > 0) {
+      LOG_ERROR("Input %zu data is null", i);
+      return false;
+    }
+  }
+  return true;
+}
+}  // namespace internal
+
+const char *Sha256BatchKernelToString(Sha256BatchKernel kernel) {
+  switch (kernel) {
+    case kSha256BatchKernelScalar:
+      return "scalar";
+    case kSha256BatchKernelAvx2:
+      return "avx2";
+    case kSha256BatchKernelAvx512:
+      return "avx512";
+  }
+  LOG_ERROR("Unknown SHA-256 batch kernel: %d", kernel);
+  return "<error>";
+}
+
+bool IsSha256BatchKernelSupported(Sha256BatchKernel kernel) {
+  return internal::GetSha256BatchKernelTable(kernel) != nullptr;
+}
+
+Sha256BatchKernel GetSha256BatchKernel() {
+  return ActiveSha256BatchKernel()->kernel;
+}
+
+bool SetSha256BatchKernel(Sha256BatchKernel kernel) {
+  const Sha256BatchKernelTable *table =
+      internal::GetSha256BatchKernelTable(kernel);
+  if (table == nullptr) {
+    LOG_WARN(
+        "SHA-256 batch kernel not supported: %s",
+        Sha256BatchKernelToString(kernel));
+    return false;
+  }
+  g_sha256_batch_kernel.store(table, std::memory_order_relaxed);
+  return true;
+}
+
+bool Sha256Batch(const DigestInput *inputs, size_t count, uint8_t *digests) {
+  if (!internal::IsValidDigestBatch(inputs, count)) return false;
+  Sha256BatchInternal(inputs, count, digests);
+  return true;
+}
+
+bool Sha256Sha256Batch(
+    const DigestInput *inputs, size_t count, uint8_t *digests) {
+  if (!internal::IsValidDigestBatch(inputs, count)) return false;
+  Sha256BatchInternal(inputs, count, digests);
+  // The second pass reads each first digest before its slot is
+  // overwritten; a lane copies its whole (single block) message when
+  // it is loaded.
+  constexpr size_t kChunkSize = 256;
+  DigestInput second[kChunkSize];
+  for (size_t offset = 0; offset < count; offset += kChunkSize) {
+    const size_t chunk_size = std::min(kChunkSize, count - offset);
+    uint8_t *chunk_digests = digests + offset * kSha256DigestLength;
+    for (size_t i = 0; i < chunk_size; i++) {
+      second[i] = {
+          chunk_digests + i * kSha256DigestLength, kSha256DigestLength};
+    }
+    Sha256BatchInternal(second, chunk_size, chunk_digests);
+  }
+  return true;
+}
+
+void Sha256D64(const uint8_t *data, size_t count, uint8_t *digests) {
+  // Writing the digests of a group of lanes only overwrites messages
+  // of the same or earlier groups, all of which have been read.
+  const Sha256BatchKernelTable *table = ActiveSha256BatchKernel();
+  constexpr size_t kMessageLength = kSha256BlockLength;
+  size_t i = 0;
+  if (table->d64 != nullptr) {
+    for (; i + table->lanes <= count; i += table->lanes) {
+      table->d64(data + i * kMessageLength, digests + i * kSha256DigestLength);
+    }
+  }
+  const internal::Sha256D64Kernel d64 =
+      internal::ActiveSha256KernelTable()->d64;
+  for (; i < count; i++) {
+    d64(data + i * kMessageLength, digests + i * kSha256DigestLength);
+  }
+}
+
+bool Sha256D80Nonces(
+    const Sha256Midstate &midstate, const uint8_t *message, uint32_t nonce,
+    size_t count, uint8_t *digests) {
+  DASSERT(message != nullptr);
+  if (midstate.count != kSha256BlockLength) {
+    LOG_ERROR(
+        "Midstate count is not %zu: %zu", kSha256BlockLength,
+        static_cast<size_t>(midstate.count));
+    return false;
+  }
+  uint8_t tail_block[kSha256BlockLength];
+  memcpy(tail_block, message + kSha256BlockLength, kD80TailLength);
+  PadBlock(kSha256BlockLength + kD80TailLength, tail_block);
+  const Sha256BatchKernelTable *table = ActiveSha256BatchKernel();
+  if (table->transform == nullptr) {
+    Sha256D80NoncesScalar(midstate, tail_block, nonce, count, digests);
+  } else {
+    Sha256D80NoncesLanes(
+        table, midstate, tail_block, nonce, count, digests);
+  }
+  return true;
+}
+}  // namespace crypto
+}  // namespace btc
@@ -0,0 +1,140 @@
+// Bitcoin Info - Cryptography - SHA-256
+//
+// Copyright (c) 2022 Alex Dale
+// This project is licensed under the terms of the MIT license.
+// See LICENSE for details.
+#include <endian.h>
+#include <string.h>
+
+#include <algorithm>
+#include <atomic>
+
+#include "btc/cc/debug.h"
+#include "btc/crypto/digest.hpp"
+#include "btc/log.h"
+
+#define _BTC_CRYPTO_SHA256_INTERNAL_
+#include "btc/crypto/sha256.kernel.hpp"
+#undef _BTC_CRYPTO_SHA256_INTERNAL_
+
+namespace btc {
+namespace crypto {
+namespace internal {
+namespace {
+// Selected lazily; constant initialized so that digests may be used
+// during static initialization of other modules.
+std::atomic<const Sha256KernelTable *> g_sha256_kernel{nullptr};
+}  // namespace
+
+const Sha256KernelTable *ActiveSha256KernelTable() {
+  const Sha256KernelTable *table =
+      g_sha256_kernel.load(std::memory_order_relaxed);
+  if (table != nullptr) return table;
+  table = SelectSha256KernelTable();
+  g_sha256_kernel.store(table, std::memory_order_relaxed);
+  return table;
+}
+
+void Sha256Context::Reset() {
+  memcpy(_state, kSha256InitialState, sizeof(_state));
+  _count = 0;
+}
+
+bool Sha256Context::SaveMidstate(Sha256Midstate *midstate) const {
+  DASSERT(midstate != nullptr);
+  if (_count % kSha256BlockLength != 0) return false;
+  memcpy(midstate->state, _state, sizeof(_state));
+  midstate->count = _count;
+  return true;
+}
+
+void Sha256Context::LoadMidstate(const Sha256Midstate &midstate) {
+  DASSERT(midstate.count % kSha256BlockLength == 0);
+  memcpy(_state, midstate.state, sizeof(_state));
+  _count = midstate.count;
+}
+
+void Sha256Context::Update(const uint8_t *data, size_t data_size) {
+  if (data_size == 0) return;
+  DASSERT(data != nullptr);
+  const Sha256TransformKernel transform = ActiveSha256KernelTable()->transform;
+  size_t buffered = _count % kSha256BlockLength;
+  _count += data_size;
+  if (buffered > 0) {
+    const size_t fill = std::min(kSha256BlockLength - buffered, data_size);
+    memcpy(_buffer + buffered, data, fill);
+    if (buffered + fill < kSha256BlockLength) return;
+    transform(_state, _buffer, 1);
+    data += fill;
+    data_size -= fill;
+  }
+  const size_t block_count = data_size / kSha256BlockLength;
+  if (block_count > 0) {
+    transform(_state, data, block_count);
+    data += block_count * kSha256BlockLength;
+    data_size -= block_count * kSha256BlockLength;
+  }
+  if (data_size > 0) memcpy(_buffer, data, data_size);
+}
+
+void Sha256Context::Finalize(uint8_t *digest) {
+  // The 0x80 terminator and 64-bit bit count, one or two blocks.
+  uint8_t padding[kSha256BlockLength * 2] = {};
+  const size_t buffered = _count % kSha256BlockLength;
+  memcpy(padding, _buffer, buffered);
+  padding[buffered] = 0x80;
+  const size_t block_count = buffered < kSha256BlockLength - 8 ? 1 : 2;
+  const uint64_t bit_count = htobe64(_count * 8);
+  memcpy(
+      padding + block_count * kSha256BlockLength - sizeof(bit_count),
+      &bit_count, sizeof(bit_count));
+  ActiveSha256KernelTable()->transform(_state, padding, block_count);
+  for (size_t i = 0; i < kSha256StateWords; i++) {
+    const uint32_t word = htobe32(_state[i]);
+    memcpy(digest + i * 4, &word, sizeof(word));
+  }
+}
+
+bool NativeSha256(const uint8_t *data, size_t data_size, uint8_t *digest) {
+  DASSERT(data != nullptr || data_size == 0);
+  Sha256Context context;
+  context.Update(data, data_size);
+  context.Finalize(digest);
+  return true;
+}
+}  // namespace internal
+
+using internal::Sha256KernelTable;
+
+const char *Sha256KernelToString(Sha256Kernel kernel) {
+  switch (kernel) {
+    case kSha256KernelGeneric:
+      return "generic";
+    case kSha256KernelAvx2:
+      return "avx2";
+    case kSha256KernelShaNi:
+      return "sha-ni";
+  }
+  LOG_ERROR("Unknown SHA-256 kernel: %d", kernel);
+  return "<error>";
+}
+
+bool IsSha256KernelSupported(Sha256Kernel kernel) {
+  return internal::GetSha256KernelTable(kernel) != nullptr;
+}
+
+Sha256Kernel GetSha256Kernel() {
+  return internal::ActiveSha256KernelTable()->kernel;
+}
+
+bool SetSha256Kernel(Sha256Kernel kernel) {
+  const Sha256KernelTable *table = internal::GetSha256KernelTable(kernel);
+  if (table == nullptr) {
+    LOG_WARN("SHA-256 kernel not supported: %s", Sha256KernelToString(kernel));
+    return false;
+  }
+  internal::g_sha256_kernel.store(table, std::memory_order_relaxed);
+  return true;
+}
+}  // namespace crypto
+}  // namespace btc
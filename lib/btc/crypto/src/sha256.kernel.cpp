@@ -0,0 +1,381 @@
+// Bitcoin Info - Cryptography - SHA-256 Kernels
+//
+// Copyright (c) 2022 Alex Dale
+// This project is licensed under the terms of the MIT license.
+// See LICENSE for details.
+#include <endian.h>
+#include <string.h>
+
+#include "btc/cc/debug.h"
+#include "btc/cc/platform.h"
+#include "btc/cpu.h"
+
+#define _BTC_CRYPTO_SHA256_INTERNAL_
+#include "btc/crypto/sha256.kernel.hpp"
+#undef _BTC_CRYPTO_SHA256_INTERNAL_
+
+#ifdef BTC_ARCH_X86
+#  include <immintrin.h>
+#endif
+
+namespace btc {
+namespace crypto {
+namespace internal {
+namespace {
+constexpr Sha256Schedule MakeD64PaddingSchedule() {
+  // 0x80 terminator, then the length of 512 bits.
+  uint32_t w[64] = {0x80000000};
+  w[15] = 512;
+  for (size_t i = 16; i < 64; i++) {
+    const uint32_t s0 = ConstexprRotateRight(w[i - 15], 7) ^
+                        ConstexprRotateRight(w[i - 15], 18) ^ (w[i - 15] >> 3);
+    const uint32_t s1 = ConstexprRotateRight(w[i - 2], 17) ^
+                        ConstexprRotateRight(w[i - 2], 19) ^ (w[i - 2] >> 10);
+    w[i] = w[i - 16] + s0 + w[i - 7] + s1;
+  }
+  Sha256Schedule schedule = {};
+  for (size_t i = 0; i < 64; i++) {
+    schedule.wk[i] = w[i] + kSha256RoundConstants[i];
+  }
+  return schedule;
+}
+
+}  // namespace
+
+constexpr Sha256Schedule kSha256D64PaddingSchedule = MakeD64PaddingSchedule();
+
+const uint8_t kSha256D64SecondPadding[32] = {
+    0x80, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0,    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 0};
+
+namespace {
+__ALWAYS_INLINE inline uint32_t RotateRight(uint32_t x, int n) {
+  return (x >> n) | (x << (32 - n));
+}
+
+inline uint32_t LoadBigEndian32(const uint8_t *p) {
+  uint32_t x;
+  memcpy(&x, p, sizeof(x));
+  return be32toh(x);
+}
+
+inline void StoreBigEndian32(uint8_t *p, uint32_t x) {
+  x = htobe32(x);
+  memcpy(p, &x, sizeof(x));
+}
+
+// The padding block of a 64 byte message.
+const uint8_t kD64PaddingBlock[kSha256BlockLength] = {
+    0x80, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0,    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0,    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0,    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 2, 0};
+
+// The eight working variables are rotated by renaming rather than by
+// moving values; round |i| of a group of eight uses the variables
+// starting at offset -|i|.
+#define SHA256_ROUND(a, b, c, d, e, f, g, h, wk)                      \
+  do {                                                                \
+    const uint32_t t1 = h + (RotateRight(e, 6) ^ RotateRight(e, 11) ^ \
+                             RotateRight(e, 25)) +                    \
+                        ((e & f) ^ (~e & g)) + (wk);                  \
+    const uint32_t t2 = (RotateRight(a, 2) ^ RotateRight(a, 13) ^     \
+                         RotateRight(a, 22)) +                        \
+                        ((a & b) ^ (a & c) ^ (b & c));                \
+    d += t1;                                                          \
+    h = t1 + t2;                                                      \
+  } while (0)
+
+// Runs the 64 rounds over a fully expanded W + K schedule.
+__ALWAYS_INLINE inline void Sha256Rounds(uint32_t *state, const uint32_t *wk) {
+  uint32_t a = state[0], b = state[1], c = state[2], d = state[3];
+  uint32_t e = state[4], f = state[5], g = state[6], h = state[7];
+  for (size_t i = 0; i < 64; i += 8) {
+    SHA256_ROUND(a, b, c, d, e, f, g, h, wk[i + 0]);
+    SHA256_ROUND(h, a, b, c, d, e, f, g, wk[i + 1]);
+    SHA256_ROUND(g, h, a, b, c, d, e, f, wk[i + 2]);
+    SHA256_ROUND(f, g, h, a, b, c, d, e, wk[i + 3]);
+    SHA256_ROUND(e, f, g, h, a, b, c, d, wk[i + 4]);
+    SHA256_ROUND(d, e, f, g, h, a, b, c, wk[i + 5]);
+    SHA256_ROUND(c, d, e, f, g, h, a, b, wk[i + 6]);
+    SHA256_ROUND(b, c, d, e, f, g, h, a, wk[i + 7]);
+  }
+  state[0] += a;
+  state[1] += b;
+  state[2] += c;
+  state[3] += d;
+  state[4] += e;
+  state[5] += f;
+  state[6] += g;
+  state[7] += h;
+}
+
+// Second pass of a SHA-256-SHA-256 of 64 bytes, |state| holds the
+// first digest.  The second message is a single block.
+template<Sha256TransformKernel kTransform>
+__ALWAYS_INLINE inline void Sha256D64Finish(uint32_t *state, uint8_t *digest) {
+  uint8_t block[kSha256BlockLength];
+  for (size_t i = 0; i < kSha256StateWords; i++) {
+    StoreBigEndian32(block + i * 4, state[i]);
+  }
+  memcpy(block + 32, kSha256D64SecondPadding, sizeof(kSha256D64SecondPadding));
+  memcpy(state, kSha256InitialState, sizeof(kSha256InitialState));
+  kTransform(state, block, 1);
+  for (size_t i = 0; i < kSha256StateWords; i++) {
+    StoreBigEndian32(digest + i * 4, state[i]);
+  }
+}
+
+// Generic.
+
+void Sha256TransformGeneric(
+    uint32_t *state, const uint8_t *blocks, size_t block_count) {
+  uint32_t wk[64];
+  for (size_t n = 0; n < block_count; n++, blocks += kSha256BlockLength) {
+    uint32_t w[64];
+    for (size_t i = 0; i < 16; i++) {
+      w[i] = LoadBigEndian32(blocks + i * 4);
+    }
+    for (size_t i = 16; i < 64; i++) {
+      const uint32_t s0 = RotateRight(w[i - 15], 7) ^
+                          RotateRight(w[i - 15], 18) ^ (w[i - 15] >> 3);
+      const uint32_t s1 = RotateRight(w[i - 2], 17) ^
+                          RotateRight(w[i - 2], 19) ^ (w[i - 2] >> 10);
+      w[i] = w[i - 16] + s0 + w[i - 7] + s1;
+    }
+    for (size_t i = 0; i < 64; i++) {
+      wk[i] = w[i] + kSha256RoundConstants[i];
+    }
+    Sha256Rounds(state, wk);
+  }
+}
+
+void Sha256D64Generic(const uint8_t *data, uint8_t *digest) {
+  uint32_t state[kSha256StateWords];
+  memcpy(state, kSha256InitialState, sizeof(state));
+  Sha256TransformGeneric(state, data, 1);
+  Sha256Rounds(state, kSha256D64PaddingSchedule.wk);
+  Sha256D64Finish<Sha256TransformGeneric>(state, digest);
+}
+
+#ifdef BTC_ARCH_X86
+// AVX2 + BMI2.
+//
+// The message schedule is expanded four words at a time for two blocks
+// at once, one block per 128-bit lane.  The rounds are scalar; with
+// BMI2 the rotations compile to RORX which leaves the flags alone and
+// does not overwrite its source.
+
+__TARGET("avx2,bmi2")
+inline __m256i Sha256Sigma0Avx2(__m256i x) {
+  return _mm256_xor_si256(
+      _mm256_xor_si256(
+          _mm256_or_si256(_mm256_srli_epi32(x, 7), _mm256_slli_epi32(x, 25)),
+          _mm256_or_si256(_mm256_srli_epi32(x, 18), _mm256_slli_epi32(x, 14))),
+      _mm256_srli_epi32(x, 3));
+}
+
+__TARGET("avx2,bmi2")
+inline __m256i Sha256Sigma1Avx2(__m256i x) {
+  return _mm256_xor_si256(
+      _mm256_xor_si256(
+          _mm256_or_si256(_mm256_srli_epi32(x, 17), _mm256_slli_epi32(x, 15)),
+          _mm256_or_si256(_mm256_srli_epi32(x, 19), _mm256_slli_epi32(x, 13))),
+      _mm256_srli_epi32(x, 10));
+}
+
+// Given the previous sixteen words of both lanes, returns the next
+// four.
+__TARGET("avx2,bmi2")
+inline __m256i Sha256ScheduleAvx2(
+    __m256i x0, __m256i x1, __m256i x2, __m256i x3) {
+  // W[t-16] + s0(W[t-15]) + W[t-7]
+  __m256i w = _mm256_add_epi32(
+      _mm256_add_epi32(x0, Sha256Sigma0Avx2(_mm256_alignr_epi8(x1, x0, 4))),
+      _mm256_alignr_epi8(x3, x2, 4));
+  // s1(W[t-2]) only exists for the first two words, the second two
+  // depend on the first.
+  const __m256i low = _mm256_set_epi32(0, 0, -1, -1, 0, 0, -1, -1);
+  w = _mm256_add_epi32(
+      w, _mm256_and_si256(
+             Sha256Sigma1Avx2(_mm256_shuffle_epi32(x3, 0xfe)), low));
+  return _mm256_add_epi32(
+      w, _mm256_andnot_si256(
+             low, Sha256Sigma1Avx2(_mm256_shuffle_epi32(w, 0x40))));
+}
+
+__TARGET("avx2,bmi2")
+void Sha256TransformAvx2(
+    uint32_t *state, const uint8_t *blocks, size_t block_count) {
+  const __m256i byte_swap = _mm256_set_epi8(
+      12, 13, 14, 15, 8, 9, 10, 11, 4, 5, 6, 7, 0, 1, 2, 3,
+      12, 13, 14, 15, 8, 9, 10, 11, 4, 5, 6, 7, 0, 1, 2, 3);
+  alignas(16) uint32_t wk[2][64];
+  while (block_count > 0) {
+    const uint8_t *second =
+        block_count > 1 ? blocks + kSha256BlockLength : blocks;
+    __m256i x[4];
+    for (size_t i = 0; i < 4; i++) {
+      const __m128i lo = _mm_loadu_si128(
+          reinterpret_cast<const __m128i *>(blocks + i * 16));
+      const __m128i hi = _mm_loadu_si128(
+          reinterpret_cast<const __m128i *>(second + i * 16));
+      x[i] = _mm256_shuffle_epi8(
+          _mm256_inserti128_si256(_mm256_castsi128_si256(lo), hi, 1),
+          byte_swap);
+    }
+    for (size_t q = 0; q < 16; q++) {
+      const __m256i current = x[q & 3];
+      const __m256i sum = _mm256_add_epi32(
+          current,
+          _mm256_broadcastsi128_si256(
+              _mm_loadu_si128(reinterpret_cast<const __m128i *>(
+                  kSha256RoundConstants + q * 4))));
+      _mm_store_si128(
+          reinterpret_cast<__m128i *>(wk[0] + q * 4),
+          _mm256_castsi256_si128(sum));
+      _mm_store_si128(
+          reinterpret_cast<__m128i *>(wk[1] + q * 4),
+          _mm256_extracti128_si256(sum, 1));
+      if (q < 12) {
+        x[q & 3] = Sha256ScheduleAvx2(
+            current, x[(q + 1) & 3], x[(q + 2) & 3], x[(q + 3) & 3]);
+      }
+    }
+    Sha256Rounds(state, wk[0]);
+    if (block_count == 1) break;
+    Sha256Rounds(state, wk[1]);
+    blocks += kSha256BlockLength * 2;
+    block_count -= 2;
+  }
+}
+
+__TARGET("avx2,bmi2")
+void Sha256D64Avx2(const uint8_t *data, uint8_t *digest) {
+  uint32_t state[kSha256StateWords];
+  memcpy(state, kSha256InitialState, sizeof(state));
+  Sha256TransformAvx2(state, data, 1);
+  Sha256Rounds(state, kSha256D64PaddingSchedule.wk);
+  Sha256D64Finish<Sha256TransformAvx2>(state, digest);
+}
+
+// SHA extensions.
+//
+// SHA256RNDS2 performs two rounds on a state split as ABEF and CDGH.
+// The message is expanded with SHA256MSG1 and SHA256MSG2 in groups of
+// four words, kept in a rolling window of four registers.
+
+__TARGET("sha,sse4.1,ssse3")
+void Sha256TransformShaNi(
+    uint32_t *state, const uint8_t *blocks, size_t block_count) {
+  const __m128i byte_swap =
+      _mm_set_epi64x(0x0c0d0e0f08090a0bull, 0x0405060700010203ull);
+  // Reorder from ABCD / EFGH to ABEF / CDGH.
+  __m128i tmp = _mm_shuffle_epi32(
+      _mm_loadu_si128(reinterpret_cast<const __m128i *>(state)), 0xb1);
+  __m128i state1 = _mm_shuffle_epi32(
+      _mm_loadu_si128(reinterpret_cast<const __m128i *>(state + 4)), 0x1b);
+  __m128i state0 = _mm_alignr_epi8(tmp, state1, 8);
+  state1 = _mm_blend_epi16(state1, tmp, 0xf0);
+
+  for (size_t n = 0; n < block_count; n++, blocks += kSha256BlockLength) {
+    const __m128i abef = state0;
+    const __m128i cdgh = state1;
+    __m128i msg[4];
+#pragma GCC unroll 16
+    for (size_t q = 0; q < 16; q++) {
+      if (q < 4) {
+        msg[q] = _mm_shuffle_epi8(
+            _mm_loadu_si128(
+                reinterpret_cast<const __m128i *>(blocks + q * 16)),
+            byte_swap);
+      }
+      const __m128i current = msg[q & 3];
+      __m128i wk = _mm_add_epi32(
+          current,
+          _mm_loadu_si128(reinterpret_cast<const __m128i *>(
+              kSha256RoundConstants + q * 4)));
+      state1 = _mm_sha256rnds2_epu32(state1, state0, wk);
+      if (q >= 3 && q < 15) {
+        // Finish the next group: + W[t-7] and the s1 terms.
+        __m128i &next = msg[(q + 1) & 3];
+        next = _mm_add_epi32(
+            next, _mm_alignr_epi8(current, msg[(q + 3) & 3], 4));
+        next = _mm_sha256msg2_epu32(next, current);
+      }
+      wk = _mm_shuffle_epi32(wk, 0x0e);
+      state0 = _mm_sha256rnds2_epu32(state0, state1, wk);
+      if (q >= 1 && q < 13) {
+        // Start the group three ahead: W[t-16] + s0(W[t-15]).
+        __m128i &later = msg[(q + 3) & 3];
+        later = _mm_sha256msg1_epu32(later, current);
+      }
+    }
+    state0 = _mm_add_epi32(state0, abef);
+    state1 = _mm_add_epi32(state1, cdgh);
+  }
+
+  // Back to ABCD / EFGH.
+  tmp = _mm_shuffle_epi32(state0, 0x1b);
+  state1 = _mm_shuffle_epi32(state1, 0xb1);
+  _mm_storeu_si128(
+      reinterpret_cast<__m128i *>(state), _mm_blend_epi16(tmp, state1, 0xf0));
+  _mm_storeu_si128(
+      reinterpret_cast<__m128i *>(state + 4), _mm_alignr_epi8(state1, tmp, 8));
+}
+
+// The hardware message schedule is nearly free, so the padding block
+// goes through the transform rather than the precomputed schedule.
+__TARGET("sha,sse4.1,ssse3")
+void Sha256D64ShaNi(const uint8_t *data, uint8_t *digest) {
+  uint32_t state[kSha256StateWords];
+  memcpy(state, kSha256InitialState, sizeof(state));
+  Sha256TransformShaNi(state, data, 1);
+  Sha256TransformShaNi(state, kD64PaddingBlock, 1);
+  Sha256D64Finish<Sha256TransformShaNi>(state, digest);
+}
+#endif  // BTC_ARCH_X86
+
+#undef SHA256_ROUND
+
+const Sha256KernelTable kGenericTable = {
+    kSha256KernelGeneric, Sha256TransformGeneric, Sha256D64Generic};
+#ifdef BTC_ARCH_X86
+const Sha256KernelTable kAvx2Table = {
+    kSha256KernelAvx2, Sha256TransformAvx2, Sha256D64Avx2};
+const Sha256KernelTable kShaNiTable = {
+    kSha256KernelShaNi, Sha256TransformShaNi, Sha256D64ShaNi};
+#endif  // BTC_ARCH_X86
+}  // namespace
+
+const Sha256KernelTable *GetSha256KernelTable(Sha256Kernel kernel) {
+  switch (kernel) {
+    case kSha256KernelGeneric:
+      return &kGenericTable;
+#ifdef BTC_ARCH_X86
+    case kSha256KernelAvx2:
+      return btc_cpu_has_all(BTC_CPU_AVX2 | BTC_CPU_BMI2) ? &kAvx2Table
+                                                          : nullptr;
+    case kSha256KernelShaNi:
+      return btc_cpu_has_all(BTC_CPU_SHA | BTC_CPU_SSE41 | BTC_CPU_SSSE3)
+                 ? &kShaNiTable
+                 : nullptr;
+#else
+    case kSha256KernelAvx2:
+    case kSha256KernelShaNi:
+      return nullptr;
+#endif  // BTC_ARCH_X86
+  }
+  return nullptr;
+}
+
+const Sha256KernelTable *SelectSha256KernelTable() {
+  for (const Sha256Kernel kernel : {kSha256KernelShaNi, kSha256KernelAvx2}) {
+    const Sha256KernelTable *table = GetSha256KernelTable(kernel);
+    if (table != nullptr) return table;
+  }
+  return &kGenericTable;
+}
+}  // namespace internal
+}  // namespace crypto
+}  // namespace btc
@@ -0,0 +1,359 @@
+// Bitcoin Info - Cryptography - SHA-256 Multi-Lane Kernels
+//
+// Copyright (c) 2022 Alex Dale
+// This project is licensed under the terms of the MIT license.
+// See LICENSE for details.
+#include <endian.h>
+#include <string.h>
+
+#include "btc/cc/debug.h"
+#include "btc/cc/platform.h"
+#include "btc/cpu.h"
+
+#define _BTC_CRYPTO_SHA256_INTERNAL_
+#include "btc/crypto/sha256.kernel.hpp"
+#undef _BTC_CRYPTO_SHA256_INTERNAL_
+
+#ifdef BTC_ARCH_X86
+#  include <immintrin.h>
+#endif
+
+namespace btc {
+namespace crypto {
+namespace internal {
+namespace {
+#ifdef BTC_ARCH_X86
+// Each lane holds a different message; vector element |l| of every
+// working variable belongs to lane |l|, so the rounds are the scalar
+// rounds applied element wise.  The working variables are rotated by
+// renaming, round |i| uses |v| starting at offset -|i|; with the loops
+// fully unrolled they stay in registers.
+
+// Transposes the message words of one block per lane into |words|,
+// word |j| of lane |l| at |words|[j * kLanes + l].
+template<size_t kLanes>
+inline void LoadLaneWords(const uint8_t *const *blocks, uint32_t *words) {
+  for (size_t l = 0; l < kLanes; l++) {
+    for (size_t j = 0; j < 16; j++) {
+      uint32_t word;
+      memcpy(&word, blocks[l] + j * 4, sizeof(word));
+      words[j * kLanes + l] = be32toh(word);
+    }
+  }
+}
+
+// Same for |kLanes| consecutive 64 byte messages.
+template<size_t kLanes>
+inline void LoadConsecutiveLaneWords(const uint8_t *data, uint32_t *words) {
+  const uint8_t *blocks[kLanes];
+  for (size_t l = 0; l < kLanes; l++) blocks[l] = data + l * 64;
+  LoadLaneWords<kLanes>(blocks, words);
+}
+
+// Writes the big endian digest of each lane from a word major state.
+template<size_t kLanes>
+inline void StoreLaneDigests(const uint32_t *state, uint8_t *digests) {
+  for (size_t l = 0; l < kLanes; l++) {
+    for (size_t i = 0; i < kSha256StateWords; i++) {
+      const uint32_t word = htobe32(state[i * kLanes + l]);
+      memcpy(digests + l * kSha256DigestLength + i * 4, &word, sizeof(word));
+    }
+  }
+}
+
+// AVX2, 8 lanes.
+
+__TARGET("avx2")
+__ALWAYS_INLINE inline __m256i Ror8(__m256i x, int n) {
+  return _mm256_or_si256(
+      _mm256_srli_epi32(x, n), _mm256_slli_epi32(x, 32 - n));
+}
+
+__TARGET("avx2")
+__ALWAYS_INLINE inline void Sha256RoundAvx2(
+    __m256i *v, size_t i, __m256i wk) {
+  const __m256i a = v[(0 - i) & 7], b = v[(1 - i) & 7], c = v[(2 - i) & 7];
+  const __m256i e = v[(4 - i) & 7], f = v[(5 - i) & 7], g = v[(6 - i) & 7];
+  const __m256i big_sigma1 = _mm256_xor_si256(
+      _mm256_xor_si256(Ror8(e, 6), Ror8(e, 11)), Ror8(e, 25));
+  const __m256i choose =
+      _mm256_xor_si256(_mm256_and_si256(e, f), _mm256_andnot_si256(e, g));
+  const __m256i t1 = _mm256_add_epi32(
+      _mm256_add_epi32(v[(7 - i) & 7], big_sigma1),
+      _mm256_add_epi32(choose, wk));
+  const __m256i big_sigma0 = _mm256_xor_si256(
+      _mm256_xor_si256(Ror8(a, 2), Ror8(a, 13)), Ror8(a, 22));
+  const __m256i majority = _mm256_or_si256(
+      _mm256_and_si256(a, b), _mm256_and_si256(c, _mm256_or_si256(a, b)));
+  v[(3 - i) & 7] = _mm256_add_epi32(v[(3 - i) & 7], t1);
+  v[(7 - i) & 7] = _mm256_add_epi32(t1, _mm256_add_epi32(big_sigma0, majority));
+}
+
+// Compresses the sixteen message words |w| into |state|, |w| is
+// overwritten by the schedule.
+__TARGET("avx2")
+__ALWAYS_INLINE inline void Sha256CompressAvx2(__m256i *state, __m256i *w) {
+  __m256i v[8];
+  for (size_t i = 0; i < 8; i++) v[i] = state[i];
+#pragma GCC unroll 64
+  for (size_t i = 0; i < 64; i++) {
+    if (i >= 16) {
+      const __m256i w15 = w[(i + 1) & 15];
+      const __m256i w2 = w[(i + 14) & 15];
+      const __m256i s0 = _mm256_xor_si256(
+          _mm256_xor_si256(Ror8(w15, 7), Ror8(w15, 18)),
+          _mm256_srli_epi32(w15, 3));
+      const __m256i s1 = _mm256_xor_si256(
+          _mm256_xor_si256(Ror8(w2, 17), Ror8(w2, 19)),
+          _mm256_srli_epi32(w2, 10));
+      w[i & 15] = _mm256_add_epi32(
+          _mm256_add_epi32(w[i & 15], s0),
+          _mm256_add_epi32(w[(i + 9) & 15], s1));
+    }
+    Sha256RoundAvx2(
+        v, i,
+        _mm256_add_epi32(
+            w[i & 15],
+            _mm256_set1_epi32(static_cast<int>(kSha256RoundConstants[i]))));
+  }
+  for (size_t i = 0; i < 8; i++) state[i] = _mm256_add_epi32(state[i], v[i]);
+}
+
+// Compresses a block with a precomputed schedule into |state|.
+__TARGET("avx2")
+__ALWAYS_INLINE inline void Sha256CompressScheduleAvx2(
+    __m256i *state, const Sha256Schedule &schedule) {
+  __m256i v[8];
+  for (size_t i = 0; i < 8; i++) v[i] = state[i];
+#pragma GCC unroll 64
+  for (size_t i = 0; i < 64; i++) {
+    Sha256RoundAvx2(
+        v, i, _mm256_set1_epi32(static_cast<int>(schedule.wk[i])));
+  }
+  for (size_t i = 0; i < 8; i++) state[i] = _mm256_add_epi32(state[i], v[i]);
+}
+
+__TARGET("avx2")
+__ALWAYS_INLINE inline void Sha256InitAvx2(__m256i *state) {
+  for (size_t i = 0; i < 8; i++) {
+    state[i] = _mm256_set1_epi32(static_cast<int>(kSha256InitialState[i]));
+  }
+}
+
+__TARGET("avx2")
+__ALWAYS_INLINE inline void Sha256LoadWordsAvx2(
+    const uint32_t *words, __m256i *w) {
+  for (size_t j = 0; j < 16; j++) {
+    w[j] =
+        _mm256_load_si256(reinterpret_cast<const __m256i *>(words + j * 8));
+  }
+}
+
+__TARGET("avx2")
+void Sha256Lanes8Avx2(uint32_t *state, const uint8_t *const *blocks) {
+  alignas(32) uint32_t words[16 * 8];
+  LoadLaneWords<8>(blocks, words);
+  __m256i w[16];
+  Sha256LoadWordsAvx2(words, w);
+  __m256i v[8];
+  for (size_t i = 0; i < 8; i++) {
+    v[i] =
+        _mm256_loadu_si256(reinterpret_cast<const __m256i *>(state + i * 8));
+  }
+  Sha256CompressAvx2(v, w);
+  for (size_t i = 0; i < 8; i++) {
+    _mm256_storeu_si256(reinterpret_cast<__m256i *>(state + i * 8), v[i]);
+  }
+}
+
+__TARGET("avx2")
+void Sha256D64Lanes8Avx2(const uint8_t *data, uint8_t *digests) {
+  alignas(32) uint32_t words[16 * 8];
+  LoadConsecutiveLaneWords<8>(data, words);
+  __m256i w[16];
+  Sha256LoadWordsAvx2(words, w);
+  __m256i v[8];
+  Sha256InitAvx2(v);
+  Sha256CompressAvx2(v, w);
+  Sha256CompressScheduleAvx2(v, kSha256D64PaddingSchedule);
+  // The first digest followed by its padding.
+  for (size_t i = 0; i < 8; i++) w[i] = v[i];
+  w[8] = _mm256_set1_epi32(static_cast<int>(0x80000000));
+  for (size_t i = 9; i < 15; i++) w[i] = _mm256_setzero_si256();
+  w[15] = _mm256_set1_epi32(256);
+  Sha256InitAvx2(v);
+  Sha256CompressAvx2(v, w);
+  for (size_t i = 0; i < 8; i++) {
+    _mm256_store_si256(reinterpret_cast<__m256i *>(words + i * 8), v[i]);
+  }
+  StoreLaneDigests<8>(words, digests);
+}
+
+// AVX-512, 16 lanes.  Native rotates, and three input logic functions
+// in a single ternary logic instruction.
+
+// The unmasked shifts and rotates trip GCC's uninitialized warnings on
+// their undefined pass-through operand, the zero masked forms do not.
+constexpr __mmask16 kAllLanes = 0xffff;
+
+template<int kBits>
+__TARGET("avx512f")
+__ALWAYS_INLINE inline __m512i Ror16(__m512i x) {
+  return _mm512_maskz_ror_epi32(kAllLanes, x, kBits);
+}
+
+template<int kBits>
+__TARGET("avx512f")
+__ALWAYS_INLINE inline __m512i Shr16(__m512i x) {
+  return _mm512_maskz_srli_epi32(kAllLanes, x, kBits);
+}
+
+__TARGET("avx512f")
+__ALWAYS_INLINE inline __m512i Xor3(__m512i x, __m512i y, __m512i z) {
+  return _mm512_ternarylogic_epi32(x, y, z, 0x96);
+}
+
+__TARGET("avx512f")
+__ALWAYS_INLINE inline void Sha256RoundAvx512(
+    __m512i *v, size_t i, __m512i wk) {
+  const __m512i a = v[(0 - i) & 7], b = v[(1 - i) & 7], c = v[(2 - i) & 7];
+  const __m512i e = v[(4 - i) & 7], f = v[(5 - i) & 7], g = v[(6 - i) & 7];
+  // Choose: e ? f : g.
+  const __m512i choose = _mm512_ternarylogic_epi32(e, f, g, 0xca);
+  const __m512i t1 = _mm512_add_epi32(
+      _mm512_add_epi32(
+          v[(7 - i) & 7], Xor3(Ror16<6>(e), Ror16<11>(e), Ror16<25>(e))),
+      _mm512_add_epi32(choose, wk));
+  // Majority of a, b and c.
+  const __m512i majority = _mm512_ternarylogic_epi32(a, b, c, 0xe8);
+  const __m512i t2 = _mm512_add_epi32(
+      Xor3(Ror16<2>(a), Ror16<13>(a), Ror16<22>(a)), majority);
+  v[(3 - i) & 7] = _mm512_add_epi32(v[(3 - i) & 7], t1);
+  v[(7 - i) & 7] = _mm512_add_epi32(t1, t2);
+}
+
+__TARGET("avx512f")
+__ALWAYS_INLINE inline void Sha256CompressAvx512(__m512i *state, __m512i *w) {
+  __m512i v[8];
+  for (size_t i = 0; i < 8; i++) v[i] = state[i];
+#pragma GCC unroll 64
+  for (size_t i = 0; i < 64; i++) {
+    if (i >= 16) {
+      const __m512i w15 = w[(i + 1) & 15];
+      const __m512i w2 = w[(i + 14) & 15];
+      const __m512i s0 = Xor3(Ror16<7>(w15), Ror16<18>(w15), Shr16<3>(w15));
+      const __m512i s1 = Xor3(Ror16<17>(w2), Ror16<19>(w2), Shr16<10>(w2));
+      w[i & 15] = _mm512_add_epi32(
+          _mm512_add_epi32(w[i & 15], s0),
+          _mm512_add_epi32(w[(i + 9) & 15], s1));
+    }
+    Sha256RoundAvx512(
+        v, i,
+        _mm512_add_epi32(
+            w[i & 15],
+            _mm512_set1_epi32(static_cast<int>(kSha256RoundConstants[i]))));
+  }
+  for (size_t i = 0; i < 8; i++) state[i] = _mm512_add_epi32(state[i], v[i]);
+}
+
+__TARGET("avx512f")
+__ALWAYS_INLINE inline void Sha256CompressScheduleAvx512(
+    __m512i *state, const Sha256Schedule &schedule) {
+  __m512i v[8];
+  for (size_t i = 0; i < 8; i++) v[i] = state[i];
+#pragma GCC unroll 64
+  for (size_t i = 0; i < 64; i++) {
+    Sha256RoundAvx512(
+        v, i, _mm512_set1_epi32(static_cast<int>(schedule.wk[i])));
+  }
+  for (size_t i = 0; i < 8; i++) state[i] = _mm512_add_epi32(state[i], v[i]);
+}
+
+__TARGET("avx512f")
+__ALWAYS_INLINE inline void Sha256InitAvx512(__m512i *state) {
+  for (size_t i = 0; i < 8; i++) {
+    state[i] = _mm512_set1_epi32(static_cast<int>(kSha256InitialState[i]));
+  }
+}
+
+__TARGET("avx512f")
+__ALWAYS_INLINE inline void Sha256LoadWordsAvx512(
+    const uint32_t *words, __m512i *w) {
+  for (size_t j = 0; j < 16; j++) w[j] = _mm512_load_si512(words + j * 16);
+}
+
+__TARGET("avx512f")
+void Sha256Lanes16Avx512(uint32_t *state, const uint8_t *const *blocks) {
+  alignas(64) uint32_t words[16 * 16];
+  LoadLaneWords<16>(blocks, words);
+  __m512i w[16];
+  Sha256LoadWordsAvx512(words, w);
+  __m512i v[8];
+  for (size_t i = 0; i < 8; i++) v[i] = _mm512_loadu_si512(state + i * 16);
+  Sha256CompressAvx512(v, w);
+  for (size_t i = 0; i < 8; i++) _mm512_storeu_si512(state + i * 16, v[i]);
+}
+
+__TARGET("avx512f")
+void Sha256D64Lanes16Avx512(const uint8_t *data, uint8_t *digests) {
+  alignas(64) uint32_t words[16 * 16];
+  LoadConsecutiveLaneWords<16>(data, words);
+  __m512i w[16];
+  Sha256LoadWordsAvx512(words, w);
+  __m512i v[8];
+  Sha256InitAvx512(v);
+  Sha256CompressAvx512(v, w);
+  Sha256CompressScheduleAvx512(v, kSha256D64PaddingSchedule);
+  for (size_t i = 0; i < 8; i++) w[i] = v[i];
+  w[8] = _mm512_set1_epi32(static_cast<int>(0x80000000));
+  for (size_t i = 9; i < 15; i++) w[i] = _mm512_setzero_si512();
+  w[15] = _mm512_set1_epi32(256);
+  Sha256InitAvx512(v);
+  Sha256CompressAvx512(v, w);
+  for (size_t i = 0; i < 8; i++) _mm512_store_si512(words + i * 16, v[i]);
+  StoreLaneDigests<16>(words, digests);
+}
+#endif  // BTC_ARCH_X86
+
+const Sha256BatchKernelTable kScalarTable = {
+    kSha256BatchKernelScalar, 1, nullptr, nullptr};
+#ifdef BTC_ARCH_X86
+const Sha256BatchKernelTable kAvx2Table = {
+    kSha256BatchKernelAvx2, 8, Sha256Lanes8Avx2, Sha256D64Lanes8Avx2};
+const Sha256BatchKernelTable kAvx512Table = {
+    kSha256BatchKernelAvx512, 16, Sha256Lanes16Avx512,
+    Sha256D64Lanes16Avx512};
+#endif  // BTC_ARCH_X86
+}  // namespace
+
+const Sha256BatchKernelTable *GetSha256BatchKernelTable(
+    Sha256BatchKernel kernel) {
+  switch (kernel) {
+    case kSha256BatchKernelScalar:
+      return &kScalarTable;
+#ifdef BTC_ARCH_X86
+    case kSha256BatchKernelAvx2:
+      return btc_cpu_has(BTC_CPU_AVX2) ? &kAvx2Table : nullptr;
+    case kSha256BatchKernelAvx512:
+      return btc_cpu_has(BTC_CPU_AVX512F) ? &kAvx512Table : nullptr;
+#else
+    case kSha256BatchKernelAvx2:
+    case kSha256BatchKernelAvx512:
+      return nullptr;
+#endif  // BTC_ARCH_X86
+  }
+  return nullptr;
+}
+
+const Sha256BatchKernelTable *SelectSha256BatchKernelTable() {
+  // Sixteen lanes beat the SHA extensions, eight do not.
+  const Sha256BatchKernelTable *table =
+      GetSha256BatchKernelTable(kSha256BatchKernelAvx512);
+  if (table != nullptr) return table;
+  if (IsSha256KernelSupported(kSha256KernelShaNi)) return &kScalarTable;
+  table = GetSha256BatchKernelTable(kSha256BatchKernelAvx2);
+  return table != nullptr ? table : &kScalarTable;
+}
+}  // namespace internal
+}  // namespace crypto
+}  // namespace btc
@@ -0,0 +1,307 @@
+// Bitcoin Info - Cryptography - SHA-512
+//
+// Copyright (c) 2022 Alex Dale
+// This project is licensed under the terms of the MIT license.
+// See LICENSE for details.
+#include <endian.h>
+#include <string.h>
+
+#include <algorithm>
+#include <atomic>
+
+#include "btc/cc/debug.h"
+#include "btc/cc/platform.h"
+#include "btc/cpu.h"
+#include "btc/crypto/digest.hpp"
+#include "btc/log.h"
+
+#define _BTC_CRYPTO_SHA512_INTERNAL_
+#include "btc/crypto/sha512.kernel.hpp"
+#undef _BTC_CRYPTO_SHA512_INTERNAL_
+
+namespace btc {
+namespace crypto {
+namespace internal {
+const uint64_t kSha512InitialState[kSha512StateWords] = {
+    0x6a09e667f3bcc908, 0xbb67ae8584caa73b, 0x3c6ef372fe94f82b,
+    0xa54ff53a5f1d36f1, 0x510e527fade682d1, 0x9b05688c2b3e6c1f,
+    0x1f83d9abfb41bd6b, 0x5be0cd19137e2179};
+
+namespace {
+constexpr uint64_t kSha512RoundConstants[80] = {
+    0x428a2f98d728ae22, 0x7137449123ef65cd, 0xb5c0fbcfec4d3b2f,
+    0xe9b5dba58189dbbc, 0x3956c25bf348b538, 0x59f111f1b605d019,
+    0x923f82a4af194f9b, 0xab1c5ed5da6d8118, 0xd807aa98a3030242,
+    0x12835b0145706fbe, 0x243185be4ee4b28c, 0x550c7dc3d5ffb4e2,
+    0x72be5d74f27b896f, 0x80deb1fe3b1696b1, 0x9bdc06a725c71235,
+    0xc19bf174cf692694, 0xe49b69c19ef14ad2, 0xefbe4786384f25e3,
+    0x0fc19dc68b8cd5b5, 0x240ca1cc77ac9c65, 0x2de92c6f592b0275,
+    0x4a7484aa6ea6e483, 0x5cb0a9dcbd41fbd4, 0x76f988da831153b5,
+    0x983e5152ee66dfab, 0xa831c66d2db43210, 0xb00327c898fb213f,
+    0xbf597fc7beef0ee4, 0xc6e00bf33da88fc2, 0xd5a79147930aa725,
+    0x06ca6351e003826f, 0x142929670a0e6e70, 0x27b70a8546d22ffc,
+    0x2e1b21385c26c926, 0x4d2c6dfc5ac42aed, 0x53380d139d95b3df,
+    0x650a73548baf63de, 0x766a0abb3c77b2a8, 0x81c2c92e47edaee6,
+    0x92722c851482353b, 0xa2bfe8a14cf10364, 0xa81a664bbc423001,
+    0xc24b8b70d0f89791, 0xc76c51a30654be30, 0xd192e819d6ef5218,
+    0xd69906245565a910, 0xf40e35855771202a, 0x106aa07032bbd1b8,
+    0x19a4c116b8d2d0c8, 0x1e376c085141ab53, 0x2748774cdf8eeb99,
+    0x34b0bcb5e19b48a8, 0x391c0cb3c5c95a63, 0x4ed8aa4ae3418acb,
+    0x5b9cca4f7763e373, 0x682e6ff3d6b2b8a3, 0x748f82ee5defb2fc,
+    0x78a5636f43172f60, 0x84c87814a1f0ab72, 0x8cc702081a6439ec,
+    0x90befffa23631e28, 0xa4506cebde82bde9, 0xbef9a3f7b2c67915,
+    0xc67178f2e372532b, 0xca273eceea26619c, 0xd186b8c721c0c207,
+    0xeada7dd6cde0eb1e, 0xf57d4f7fee6ed178, 0x06f067aa72176fba,
+    0x0a637dc5a2c898a6, 0x113f9804bef90dae, 0x1b710b35131c471b,
+    0x28db77f523047d84, 0x32caab7b40c72493, 0x3c9ebe0a15c9bebc,
+    0x431d67c49c100d4c, 0x4cc5d4becb3e42b6, 0x597f299cfc657e2a,
+    0x5fcb6fab3ad6faec, 0x6c44198c4a475817};
+
+// As with RIPEMD-160, the compression function is written once for
+// any |Word| with the integer operators of uint64_t: uint64_t for one
+// message, or a GCC vector of uint64_t for one message per element.
+// Vectors are only passed by pointer or reference.
+
+// One round.  The working variables are rotated by renaming, round |i|
+// uses |v| starting at offset -|i|.
+template<typename Word>
+__ALWAYS_INLINE inline void Sha512Round(
+    Word *v, int i, const Word &w, uint64_t k) {
+  const Word &a = v[(80 - i) % 8];
+  const Word &b = v[(81 - i) % 8];
+  const Word &c = v[(82 - i) % 8];
+  Word &d = v[(83 - i) % 8];
+  const Word &e = v[(84 - i) % 8];
+  const Word &f = v[(85 - i) % 8];
+  const Word &g = v[(86 - i) % 8];
+  Word &h = v[(87 - i) % 8];
+  const Word t1 = h +
+                  ((e >> 14 | e << 50) ^ (e >> 18 | e << 46) ^
+                   (e >> 41 | e << 23)) +
+                  ((e & f) ^ (~e & g)) + k + w;
+  const Word t2 = ((a >> 28 | a << 36) ^ (a >> 34 | a << 30) ^
+                   (a >> 39 | a << 25)) +
+                  ((a & b) ^ (a & c) ^ (b & c));
+  d += t1;
+  h = t1 + t2;
+}
+
+// Compresses the message words |w| into |state|; |w| is used as the
+// rolling message schedule.
+template<typename Word>
+__ALWAYS_INLINE inline void Sha512Compress(Word *state, Word *w) {
+  Word v[kSha512StateWords];
+  for (size_t i = 0; i < kSha512StateWords; i++) v[i] = state[i];
+#pragma GCC unroll 80
+  for (int i = 0; i < 80; i++) {
+    if (i >= 16) {
+      const Word &w2 = w[(i - 2) % 16];
+      const Word &w15 = w[(i - 15) % 16];
+      w[i % 16] +=
+          ((w2 >> 19 | w2 << 45) ^ (w2 >> 61 | w2 << 3) ^ (w2 >> 6)) +
+          w[(i - 7) % 16] +
+          ((w15 >> 1 | w15 << 63) ^ (w15 >> 8 | w15 << 56) ^ (w15 >> 7));
+    }
+    Sha512Round(v, i, w[i % 16], kSha512RoundConstants[i]);
+  }
+  for (size_t i = 0; i < kSha512StateWords; i++) state[i] += v[i];
+}
+
+inline uint64_t LoadBigEndian64(const uint8_t *p) {
+  uint64_t x;
+  memcpy(&x, p, sizeof(x));
+  return be64toh(x);
+}
+
+#ifdef BTC_ARCH_X86
+using Lanes4 = uint64_t __attribute__((vector_size(32)));
+using Lanes8 = uint64_t __attribute__((vector_size(64)));
+
+template<typename Lanes, size_t kLanes>
+__ALWAYS_INLINE inline void Sha512Lanes(
+    uint64_t *state, const uint8_t *const *blocks) {
+  Lanes w[16];
+  for (size_t j = 0; j < 16; j++) {
+    for (size_t l = 0; l < kLanes; l++) {
+      w[j][l] = LoadBigEndian64(blocks[l] + j * 8);
+    }
+  }
+  Lanes v[kSha512StateWords];
+  memcpy(v, state, sizeof(v));
+  Sha512Compress(v, w);
+  memcpy(state, v, sizeof(v));
+}
+
+__TARGET("avx2")
+void Sha512Lanes4Avx2(uint64_t *state, const uint8_t *const *blocks) {
+  Sha512Lanes<Lanes4, 4>(state, blocks);
+}
+
+__TARGET("avx512f")
+void Sha512Lanes8Avx512(uint64_t *state, const uint8_t *const *blocks) {
+  Sha512Lanes<Lanes8, 8>(state, blocks);
+}
+#endif  // BTC_ARCH_X86
+
+const Sha512BatchKernelTable kScalarTable = {
+    kSha512BatchKernelScalar, 1, nullptr};
+#ifdef BTC_ARCH_X86
+const Sha512BatchKernelTable kAvx2Table = {
+    kSha512BatchKernelAvx2, 4, Sha512Lanes4Avx2};
+const Sha512BatchKernelTable kAvx512Table = {
+    kSha512BatchKernelAvx512, 8, Sha512Lanes8Avx512};
+#endif  // BTC_ARCH_X86
+
+std::atomic<const Sha512BatchKernelTable *> g_sha512_batch_kernel{nullptr};
+}  // namespace
+
+void Sha512Transform(
+    uint64_t *state, const uint8_t *blocks, size_t block_count) {
+  for (size_t n = 0; n < block_count; n++, blocks += kSha512BlockLength) {
+    uint64_t w[16];
+    for (size_t j = 0; j < 16; j++) w[j] = LoadBigEndian64(blocks + j * 8);
+    Sha512Compress(state, w);
+  }
+}
+
+const Sha512BatchKernelTable *GetSha512BatchKernelTable(
+    Sha512BatchKernel kernel) {
+  switch (kernel) {
+    case kSha512BatchKernelScalar:
+      return &kScalarTable;
+#ifdef BTC_ARCH_X86
+    case kSha512BatchKernelAvx2:
+      return btc_cpu_has(BTC_CPU_AVX2) ? &kAvx2Table : nullptr;
+    case kSha512BatchKernelAvx512:
+      return btc_cpu_has(BTC_CPU_AVX512F) ? &kAvx512Table : nullptr;
+#else
+    case kSha512BatchKernelAvx2:
+    case kSha512BatchKernelAvx512:
+      return nullptr;
+#endif  // BTC_ARCH_X86
+  }
+  return nullptr;
+}
+
+const Sha512BatchKernelTable *ActiveSha512BatchKernelTable() {
+  const Sha512BatchKernelTable *table =
+      g_sha512_batch_kernel.load(std::memory_order_relaxed);
+  if (table != nullptr) return table;
+  // The SHA extensions do not cover SHA-512, so the widest lanes win.
+  table = GetSha512BatchKernelTable(kSha512BatchKernelAvx512);
+  if (table == nullptr) {
+    table = GetSha512BatchKernelTable(kSha512BatchKernelAvx2);
+  }
+  if (table == nullptr) table = &kScalarTable;
+  g_sha512_batch_kernel.store(table, std::memory_order_relaxed);
+  return table;
+}
+
+void Sha512Context::Reset() {
+  memcpy(_state, kSha512InitialState, sizeof(_state));
+  _count = 0;
+}
+
+bool Sha512Context::SaveMidstate(Sha512Midstate *midstate) const {
+  DASSERT(midstate != nullptr);
+  if (_count % kSha512BlockLength != 0) return false;
+  memcpy(midstate->state, _state, sizeof(_state));
+  midstate->count = _count;
+  return true;
+}
+
+void Sha512Context::LoadMidstate(const Sha512Midstate &midstate) {
+  DASSERT(midstate.count % kSha512BlockLength == 0);
+  memcpy(_state, midstate.state, sizeof(_state));
+  _count = midstate.count;
+}
+
+void Sha512Context::Update(const uint8_t *data, size_t data_size) {
+  if (data_size == 0) return;
+  DASSERT(data != nullptr);
+  size_t buffered = _count % kSha512BlockLength;
+  _count += data_size;
+  if (buffered > 0) {
+    const size_t fill = std::min(kSha512BlockLength - buffered, data_size);
+    memcpy(_buffer + buffered, data, fill);
+    if (buffered + fill < kSha512BlockLength) return;
+    Sha512Transform(_state, _buffer, 1);
+    data += fill;
+    data_size -= fill;
+  }
+  const size_t block_count = data_size / kSha512BlockLength;
+  if (block_count > 0) {
+    Sha512Transform(_state, data, block_count);
+    data += block_count * kSha512BlockLength;
+    data_size -= block_count * kSha512BlockLength;
+  }
+  if (data_size > 0) memcpy(_buffer, data, data_size);
+}
+
+void Sha512Context::Finalize(uint8_t *digest) {
+  // The 0x80 terminator and 128-bit bit count, one or two blocks.
+  uint8_t padding[kSha512BlockLength * 2] = {};
+  const size_t buffered = _count % kSha512BlockLength;
+  memcpy(padding, _buffer, buffered);
+  padding[buffered] = 0x80;
+  const size_t block_count = buffered < kSha512BlockLength - 16 ? 1 : 2;
+  uint8_t *const length = padding + block_count * kSha512BlockLength - 16;
+  const uint64_t high_bit_count = htobe64(_count >> 61);
+  const uint64_t low_bit_count = htobe64(_count << 3);
+  memcpy(length, &high_bit_count, sizeof(high_bit_count));
+  memcpy(length + 8, &low_bit_count, sizeof(low_bit_count));
+  Sha512Transform(_state, padding, block_count);
+  StoreSha512Digest(_state, digest);
+}
+
+void StoreSha512Digest(const uint64_t *state, uint8_t *digest) {
+  for (size_t i = 0; i < kSha512StateWords; i++) {
+    const uint64_t word = htobe64(state[i]);
+    memcpy(digest + i * 8, &word, sizeof(word));
+  }
+}
+
+bool NativeSha512(const uint8_t *data, size_t data_size, uint8_t *digest) {
+  DASSERT(data != nullptr || data_size == 0);
+  Sha512Context context;
+  context.Update(data, data_size);
+  context.Finalize(digest);
+  return true;
+}
+}  // namespace internal
+
+const char *Sha512BatchKernelToString(Sha512BatchKernel kernel) {
+  switch (kernel) {
+    case kSha512BatchKernelScalar:
+      return "scalar";
+    case kSha512BatchKernelAvx2:
+      return "avx2";
+    case kSha512BatchKernelAvx512:
+      return "avx512";
+  }
+  LOG_ERROR("Unknown SHA-512 batch kernel: %d", kernel);
+  return "<error>";
+}
+
+bool IsSha512BatchKernelSupported(Sha512BatchKernel kernel) {
+  return internal::GetSha512BatchKernelTable(kernel) != nullptr;
+}
+
+Sha512BatchKernel GetSha512BatchKernel() {
+  return internal::ActiveSha512BatchKernelTable()->kernel;
+}
+
+bool SetSha512BatchKernel(Sha512BatchKernel kernel) {
+  const internal::Sha512BatchKernelTable *table =
+      internal::GetSha512BatchKernelTable(kernel);
+  if (table == nullptr) {
+    LOG_WARN(
+        "SHA-512 batch kernel not supported: %s",
+        Sha512BatchKernelToString(kernel));
+    return false;
+  }
+  internal::g_sha512_batch_kernel.store(table, std::memory_order_relaxed);
+  return true;
+}
+}  // namespace crypto
+}  // namespace btc
@@ -0,0 +1,185 @@
+// Bitcoin Info - Cryptography - Tagged SHA-256
+//
+// Copyright (c) 2022 Alex Dale
+// This project is licensed under the terms of the MIT license.
+// See LICENSE for details.
+#include <string.h>
+
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "btc/cc/debug.h"
+#include "btc/crypto/digest.hpp"
+#include "btc/crypto/sha256.constexpr.hpp"
+#include "btc/log.h"
+
+#define _BTC_CRYPTO_SHA256_INTERNAL_
+#include "btc/crypto/sha256.kernel.hpp"
+#undef _BTC_CRYPTO_SHA256_INTERNAL_
+
+namespace btc {
+namespace crypto {
+namespace {
+using internal::kSha256BlockLength;
+using internal::NativeSha256;
+using internal::Sha256Context;
+
+constexpr size_t kTaggedHashTagCount = 5;
+
+struct TaggedHashTagInfo {
+  const char *name;
+  Sha256Midstate midstate;
+};  // struct TaggedHashTagInfo
+
+constexpr TaggedHashTagInfo MakeTaggedHashTagInfo(const char *name) {
+  return {name, ConstexprTaggedHashMidstate(name)};
+}
+
+// Indexed by TaggedHashTag.  The midstates are computed by the
+// compiler.
+constexpr TaggedHashTagInfo kTaggedHashTags[kTaggedHashTagCount] = {
+    MakeTaggedHashTagInfo("BIP0340/challenge"),
+    MakeTaggedHashTagInfo("TapLeaf"),
+    MakeTaggedHashTagInfo("TapBranch"),
+    MakeTaggedHashTagInfo("TapTweak"),
+    MakeTaggedHashTagInfo("TapSighash"),
+};
+static_assert(
+    kTaggedHashTags[kTagTapLeaf].midstate.state[0] == 0x9ce0e4e6 &&
+        kTaggedHashTags[kTagTapLeaf].midstate.count == kSha256BlockLength,
+    "Unexpected TapLeaf midstate");
+
+const TaggedHashTagInfo *GetTaggedHashTagInfo(TaggedHashTag tag) {
+  const size_t index = static_cast<size_t>(tag);
+  if (index >= kTaggedHashTagCount) return nullptr;
+  return &kTaggedHashTags[index];
+}
+
+// Midstates of other tags, most recently computed last.  Tags are
+// few and fixed per application, so a short list is enough.
+constexpr size_t kMaxCachedTags = 16;
+
+using CachedTag = std::pair<std::string, Sha256Midstate>;
+
+std::vector<CachedTag> &ThreadTagCache() {
+  thread_local std::vector<CachedTag> cache;
+  if (cache.capacity() == 0) cache.reserve(kMaxCachedTags);
+  return cache;
+}
+
+void ComputeTaggedHashMidstate(
+    const std::string &tag, Sha256Midstate *midstate) {
+  uint8_t prefix[kSha256BlockLength];
+  NativeSha256(
+      reinterpret_cast<const uint8_t *>(tag.data()), tag.size(), prefix);
+  memcpy(prefix + kSha256DigestLength, prefix, kSha256DigestLength);
+  Sha256Context context;
+  context.Update(prefix, sizeof(prefix));
+  context.SaveMidstate(midstate);
+}
+
+const Sha256Midstate &LookupTaggedHashMidstate(const std::string &tag) {
+  for (const TaggedHashTagInfo &info : kTaggedHashTags) {
+    if (tag == info.name) return info.midstate;
+  }
+  std::vector<CachedTag> &cache = ThreadTagCache();
+  for (const CachedTag &cached : cache) {
+    if (cached.first == tag) return cached.second;
+  }
+  if (cache.size() == kMaxCachedTags) cache.erase(cache.begin());
+  cache.emplace_back(tag, Sha256Midstate{});
+  ComputeTaggedHashMidstate(tag, &cache.back().second);
+  return cache.back().second;
+}
+
+void TaggedSha256Impl(
+    const Sha256Midstate &midstate, const uint8_t *data, size_t data_size,
+    uint8_t *digest) {
+  Sha256Context context(midstate);
+  context.Update(data, data_size);
+  context.Finalize(digest);
+}
+}  // namespace
+
+const char *TaggedHashTagToString(TaggedHashTag tag) {
+  const TaggedHashTagInfo *info = GetTaggedHashTagInfo(tag);
+  if (info == nullptr) {
+    LOG_ERROR("Unknown tagged hash tag: %d", tag);
+    return "<error>";
+  }
+  return info->name;
+}
+
+bool TaggedHashMidstate(TaggedHashTag tag, Sha256Midstate *midstate) {
+  DASSERT(midstate != nullptr);
+  const TaggedHashTagInfo *info = GetTaggedHashTagInfo(tag);
+  if (info == nullptr) {
+    LOG_ERROR("Unknown tagged hash tag: %d", tag);
+    return false;
+  }
+  *midstate = info->midstate;
+  return true;
+}
+
+bool TaggedHashMidstate(const std::string &tag, Sha256Midstate *midstate) {
+  DASSERT(midstate != nullptr);
+  *midstate = LookupTaggedHashMidstate(tag);
+  return true;
+}
+
+bool TaggedSha256(
+    TaggedHashTag tag, const uint8_t *data, size_t data_size,
+    uint8_t *digest) {
+  DASSERT(digest != nullptr);
+  if (data == nullptr && data_size > 0) return false;
+  const TaggedHashTagInfo *info = GetTaggedHashTagInfo(tag);
+  if (info == nullptr) {
+    LOG_ERROR("Unknown tagged hash tag: %d", tag);
+    return false;
+  }
+  TaggedSha256Impl(info->midstate, data, data_size, digest);
+  return true;
+}
+
+bool TaggedSha256(
+    const std::string &tag, const uint8_t *data, size_t data_size,
+    uint8_t *digest) {
+  DASSERT(digest != nullptr);
+  if (data == nullptr && data_size > 0) return false;
+  TaggedSha256Impl(LookupTaggedHashMidstate(tag), data, data_size, digest);
+  return true;
+}
+
+Hash256 TaggedSha256Hash(
+    TaggedHashTag tag, const uint8_t *data, size_t data_size) {
+  Hash256 digest;
+  if (data == nullptr && data_size > 0) {
+    LOG_ERROR("Input |data| is null");
+    return digest;
+  }
+  TaggedSha256(tag, data, data_size, digest.data());
+  return digest;
+}
+
+Hash256 TaggedSha256Hash(TaggedHashTag tag, const std::vector<uint8_t> &data) {
+  return TaggedSha256Hash(tag, data.data(), data.size());
+}
+
+Hash256 TaggedSha256Hash(
+    const std::string &tag, const uint8_t *data, size_t data_size) {
+  Hash256 digest;
+  if (data == nullptr && data_size > 0) {
+    LOG_ERROR("Input |data| is null");
+    return digest;
+  }
+  TaggedSha256(tag, data, data_size, digest.data());
+  return digest;
+}
+
+Hash256 TaggedSha256Hash(
+    const std::string &tag, const std::vector<uint8_t> &data) {
+  return TaggedSha256Hash(tag, data.data(), data.size());
+}
+}  // namespace crypto
+}  // namespace btc
@@ -5,16 +5,77 @@
 // See LICENSE for details.
 #include <gtest/gtest.h>
 
+#include <string.h>
+
 #include "btc/crypto/digest.hpp"
+#include "btc/crypto/sha256.constexpr.hpp"
 #include "btc/encode/hex.hpp"
+#include "btc/encode/hex.literal.hpp"
+#include "btc/test/test_data.hpp"
+
+#define _BTC_CRYPTO_DIGEST_INTERNAL_
+#include "btc/crypto/digest.openssl.hpp"
+#undef _BTC_CRYPTO_DIGEST_INTERNAL_
 
 namespace btc {
 namespace crypto {
 namespace test {
 using ::btc::encode::HexDecode;
+using ::btc::test::MakeTestData;
+using internal::GetOpenSslDigest;
+using internal::InitDigestAlgorithms;
+using internal::kOpenSslRipeMd160;
+using internal::kOpenSslSha256;
+using internal::kOpenSslSha512;
+using internal::kOpenSslSha512DigestLength;
+using internal::OpenSslRipeMd160;
+using internal::OpenSslSha256;
+using internal::OpenSslSha512;
+using internal::TeardownDigestAlgorithms;
 namespace {
 const std::vector<uint8_t> kEmptyVector;
+
+// std::array comparisons are not constexpr until C++20.
+template<size_t kSize>
+constexpr bool ConstexprEqual(
+    const std::array<uint8_t, kSize> &a, const std::array<uint8_t, kSize> &b) {
+  for (size_t i = 0; i < kSize; i++) {
+    if (a[i] != b[i]) return false;
+  }
+  return true;
+}
 const std::string kEmptyString;
+
+const Sha256Kernel kAllSha256Kernels[] = {
+    kSha256KernelGeneric, kSha256KernelAvx2, kSha256KernelShaNi};
+
+const Sha256BatchKernel kAllSha256BatchKernels[] = {
+    kSha256BatchKernelScalar, kSha256BatchKernelAvx2,
+    kSha256BatchKernelAvx512};
+
+const RipeMd160BatchKernel kAllRipeMd160BatchKernels[] = {
+    kRipeMd160BatchKernelScalar, kRipeMd160BatchKernelAvx2,
+    kRipeMd160BatchKernelAvx512};
+
+// Restores the automatically selected kernels.
+class Sha256KernelTest: public ::testing::Test {
+protected:
+  void SetUp() override {
+    _kernel = GetSha256Kernel();
+    _batch_kernel = GetSha256BatchKernel();
+    _ripemd160_batch_kernel = GetRipeMd160BatchKernel();
+  }
+  void TearDown() override {
+    SetSha256Kernel(_kernel);
+    SetSha256BatchKernel(_batch_kernel);
+    SetRipeMd160BatchKernel(_ripemd160_batch_kernel);
+  }
+
+private:
+  Sha256Kernel _kernel = kSha256KernelGeneric;
+  Sha256BatchKernel _batch_kernel = kSha256BatchKernelScalar;
+  RipeMd160BatchKernel _ripemd160_batch_kernel = kRipeMd160BatchKernelScalar;
+};
 }  // namespace
 
 TEST(DigestTest, Sha256) {
@@ -141,6 +202,478 @@ TEST(DigestTest, Sha256RipeMd160) {
   const std::vector<uint8_t> digest = Sha256RipeMd160("hello");
   EXPECT_EQ(digest, kHelloDigest);
 }
+
+TEST(DigestTest, ScatterGather) {
+  std::vector<uint8_t> data(300);
+  for (size_t i = 0; i < data.size(); i++) data[i] = i * 31 + 7;
+  // Segment sizes: empty segments, single bytes, segments within,
+  // across and spanning blocks.
+  const std::vector<std::vector<size_t>> splits = {
+      {}, {0}, {300}, {1, 299}, {63, 1, 236}, {64, 0, 236}, {80, 220},
+      {10, 10, 280}, {130, 170}, {55, 2, 1, 1, 241}};
+  const DigestAlgorithm algorithms[] = {
+      kSha256, kRipeMd160, kSha256Sha256, kSha256RipeMd160};
+  for (const std::vector<size_t> &split : splits) {
+    std::vector<DigestInput> segments;
+    size_t offset = 0;
+    for (const size_t size : split) {
+      segments.push_back({data.data() + offset, size});
+      offset += size;
+    }
+    for (const DigestAlgorithm algorithm : algorithms) {
+      EXPECT_EQ(
+          DigestV(algorithm, segments.data(), segments.size()),
+          Digest(algorithm, data.data(), offset))
+          << DigestAlgorithmToString(algorithm) << ", " << segments.size();
+    }
+    uint8_t digest[kSha256DigestLength];
+    ASSERT_TRUE(Sha256V(segments.data(), segments.size(), digest));
+    EXPECT_EQ(
+        std::vector<uint8_t>(digest, digest + sizeof(digest)),
+        Sha256(data.data(), offset));
+    ASSERT_TRUE(Sha256Sha256V(segments.data(), segments.size(), digest));
+    EXPECT_EQ(
+        Sha256Sha256HashV(segments.data(), segments.size()),
+        Sha256Sha256Hash(data.data(), offset));
+    EXPECT_EQ(
+        std::vector<uint8_t>(digest, digest + sizeof(digest)),
+        Sha256Sha256(data.data(), offset));
+  }
+
+  // Header and payload.
+  EXPECT_EQ(
+      Sha256Sha256HashV({{data.data(), 80}, {data.data() + 80, 220}}),
+      Sha256Sha256Hash(data));
+  EXPECT_EQ(
+      DigestV(kSha256RipeMd160, {{data.data(), 33}}),
+      Sha256RipeMd160(data.data(), 33));
+
+  uint8_t digest[kSha256DigestLength];
+  EXPECT_TRUE(Sha256V(nullptr, 0, digest));
+  EXPECT_FALSE(Sha256V(nullptr, 1, digest));
+  EXPECT_FALSE(Sha256Sha256V({{data.data(), 10}, {nullptr, 1}}, digest));
+  EXPECT_TRUE(Sha256Sha256HashV({{nullptr, 1}}).IsZero());
+  EXPECT_TRUE(DigestV(kRipeMd160, {{nullptr, 1}}).empty());
+  EXPECT_TRUE(DigestV(kUnknownDigestAlgorithm, nullptr, 0).empty());
+}
+
+TEST(DigestTest, TaggedSha256) {
+  // Leaf hash of the script OP_TRUE, leaf version 0xc0.
+  const std::vector<uint8_t> kOpTrueLeaf = {0xc0, 0x01, 0x51};
+  EXPECT_EQ(
+      TaggedSha256Hash(kTagTapLeaf, kOpTrueLeaf).ToVector(),
+      HexDecode(
+          "a85b2107f791b26a84e7586c28cec7cb61202ed3d01944d832500f363782d675"));
+
+  // Built in tags, by value and by name, and other tags, against the
+  // definition.
+  const std::vector<std::string> tags = {
+      TaggedHashTagToString(kTagBip340Challenge),
+      TaggedHashTagToString(kTagTapLeaf),
+      TaggedHashTagToString(kTagTapBranch),
+      TaggedHashTagToString(kTagTapTweak),
+      TaggedHashTagToString(kTagTapSighash),
+      "BIP0340/aux",
+      "BIP0340/nonce",
+      "",
+      std::string(100, 't')};
+  const std::vector<uint8_t> message(100, 0xab);
+  for (size_t i = 0; i < tags.size(); i++) {
+    std::vector<uint8_t> preimage = Sha256(tags[i]);
+    preimage.insert(preimage.end(), preimage.begin(), preimage.end());
+    preimage.insert(preimage.end(), message.begin(), message.end());
+    const std::vector<uint8_t> expected = Sha256(preimage);
+    EXPECT_EQ(TaggedSha256Hash(tags[i], message).ToVector(), expected)
+        << tags[i];
+    uint8_t digest[kSha256DigestLength];
+    ASSERT_TRUE(
+        TaggedSha256(tags[i], message.data(), message.size(), digest));
+    EXPECT_EQ(std::vector<uint8_t>(digest, digest + sizeof(digest)), expected);
+    if (i < 5) {
+      const TaggedHashTag tag = static_cast<TaggedHashTag>(i);
+      EXPECT_EQ(TaggedSha256Hash(tag, message).ToVector(), expected);
+      Sha256Midstate built_in;
+      Sha256Midstate by_name;
+      ASSERT_TRUE(TaggedHashMidstate(tag, &built_in));
+      ASSERT_TRUE(TaggedHashMidstate(tags[i], &by_name));
+      EXPECT_EQ(built_in.count, 64);
+      EXPECT_EQ(
+          memcmp(built_in.state, by_name.state, sizeof(built_in.state)), 0);
+    }
+  }
+
+  // Past the per thread cache.
+  for (size_t i = 0; i < 40; i++) {
+    const std::string tag = "tag" + std::to_string(i % 20);
+    std::vector<uint8_t> preimage = Sha256(tag);
+    preimage.insert(preimage.end(), preimage.begin(), preimage.end());
+    EXPECT_EQ(TaggedSha256Hash(tag, nullptr, 0).ToVector(), Sha256(preimage));
+  }
+
+  uint8_t digest[kSha256DigestLength];
+  EXPECT_FALSE(TaggedSha256(kTagTapLeaf, nullptr, 1, digest));
+  EXPECT_FALSE(TaggedSha256(static_cast<TaggedHashTag>(5), nullptr, 0, digest));
+  EXPECT_TRUE(TaggedSha256Hash("TapLeaf", nullptr, 1).IsZero());
+}
+
+TEST(DigestTest, ConstexprSha256) {
+  using namespace ::btc::encode::literals;
+  constexpr auto kAbcDigest =
+      "ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad"_hex;
+  constexpr auto kEmptyDigest =
+      "e3b0c44298fc1c149afbf4c8996fb92427ae41e4649b934ca495991b7852b855"_hex;
+  static_assert(
+      ConstexprEqual(ConstexprSha256Digest("abc"), kAbcDigest),
+      "SHA-256 of \"abc\"");
+  static_assert(
+      ConstexprEqual(ConstexprSha256Digest(""_hex), kEmptyDigest),
+      "SHA-256 of nothing");
+
+  // Across the padding and block boundaries, against the run time
+  // digest.
+  std::vector<uint8_t> data(200);
+  for (size_t i = 0; i < data.size(); i++) data[i] = i * 13;
+  for (const size_t size : {0, 1, 55, 56, 63, 64, 65, 119, 128, 200}) {
+    ConstexprSha256 context;
+    context.Update(data.data(), size);
+    const auto digest = context.Finalize();
+    EXPECT_EQ(
+        std::vector<uint8_t>(digest.begin(), digest.end()),
+        Sha256(data.data(), size))
+        << size;
+  }
+
+  // Midstates.
+  Sha256Midstate midstate = {};
+  ConstexprSha256 context;
+  context.Update(data.data(), 100);
+  EXPECT_FALSE(context.SaveMidstate(&midstate));
+  context = ConstexprSha256();
+  context.Update(data.data(), 128);
+  ASSERT_TRUE(context.SaveMidstate(&midstate));
+  const auto resumed =
+      ConstexprSha256(midstate).Update(data.data() + 128, 72).Finalize();
+  EXPECT_EQ(
+      std::vector<uint8_t>(resumed.begin(), resumed.end()), Sha256(data));
+
+  Sha256Midstate tagged = {};
+  ASSERT_TRUE(TaggedHashMidstate("BIP0340/nonce", &tagged));
+  constexpr Sha256Midstate kNonceMidstate =
+      ConstexprTaggedHashMidstate("BIP0340/nonce");
+  EXPECT_EQ(kNonceMidstate.count, tagged.count);
+  EXPECT_EQ(
+      memcmp(kNonceMidstate.state, tagged.state, sizeof(tagged.state)), 0);
+}
+
+TEST(DigestTest, OpenSslDigests) {
+  InitDigestAlgorithms();
+  const EVP_MD *sha256 = GetOpenSslDigest(kOpenSslSha256);
+  ASSERT_NE(sha256, nullptr);
+  // Fetched once.
+  EXPECT_EQ(GetOpenSslDigest(kOpenSslSha256), sha256);
+  EXPECT_NE(GetOpenSslDigest(kOpenSslRipeMd160), nullptr);
+  EXPECT_NE(GetOpenSslDigest(kOpenSslSha512), nullptr);
+
+  uint8_t digest[kOpenSslSha512DigestLength];
+  ASSERT_TRUE(
+      OpenSslSha512(reinterpret_cast<const uint8_t *>("abc"), 3, digest));
+  EXPECT_EQ(
+      std::vector<uint8_t>(digest, digest + kOpenSslSha512DigestLength),
+      HexDecode(
+          "ddaf35a193617abacc417349ae20413112e6fa4e89a97ea20a9eeee64b55d39a"
+          "2192992a274fc1a836ba3c23a3feebbd454d4423643ce80e2a9ac94fa54ca49f"));
+
+  // Fetched again after a teardown.
+  TeardownDigestAlgorithms();
+  ASSERT_TRUE(OpenSslSha256(nullptr, 0, digest));
+  EXPECT_EQ(
+      std::vector<uint8_t>(digest, digest + kSha256DigestLength),
+      Sha256(kEmptyVector));
+  EXPECT_NE(GetOpenSslDigest(kOpenSslSha256), nullptr);
+}
+
+TEST(DigestTest, Sha512) {
+  EXPECT_EQ(
+      Sha512("abc"),
+      HexDecode(
+          "ddaf35a193617abacc417349ae20413112e6fa4e89a97ea20a9eeee64b55d39a"
+          "2192992a274fc1a836ba3c23a3feebbd454d4423643ce80e2a9ac94fa54ca49f"));
+  // Lengths around the 112 byte padding boundary and the 128 byte block.
+  std::vector<uint8_t> data(300);
+  for (size_t i = 0; i < data.size(); i++) data[i] = i * 7;
+  for (const size_t size : {0, 1, 111, 112, 127, 128, 129, 300}) {
+    uint8_t expected[kOpenSslSha512DigestLength];
+    ASSERT_TRUE(OpenSslSha512(data.data(), size, expected));
+    EXPECT_EQ(
+        Sha512(data.data(), size),
+        std::vector<uint8_t>(expected, expected + kSha512DigestLength))
+        << size;
+  }
+  EXPECT_TRUE(Sha512(nullptr, 1).empty());
+}
+
+TEST_F(Sha256KernelTest, Supported) {
+  EXPECT_TRUE(IsSha256KernelSupported(kSha256KernelGeneric));
+  EXPECT_TRUE(IsSha256KernelSupported(GetSha256Kernel()));
+  for (const Sha256Kernel kernel : kAllSha256Kernels) {
+    EXPECT_EQ(IsSha256KernelSupported(kernel), SetSha256Kernel(kernel))
+        << Sha256KernelToString(kernel);
+  }
+}
+
+TEST_F(Sha256KernelTest, MatchesOpenSsl) {
+  // Every padding case, multi-block inputs and one large input.
+  const std::vector<uint8_t> data = MakeTestData(1 << 16);
+  std::vector<size_t> sizes;
+  for (size_t size = 0; size <= 300; size++) sizes.push_back(size);
+  sizes.push_back(data.size() - 1);
+  for (const Sha256Kernel kernel : kAllSha256Kernels) {
+    if (!IsSha256KernelSupported(kernel)) continue;
+    ASSERT_TRUE(SetSha256Kernel(kernel));
+    for (const size_t size : sizes) {
+      uint8_t expected[kSha256DigestLength];
+      ASSERT_TRUE(OpenSslSha256(data.data(), size, expected));
+      uint8_t digest[kSha256DigestLength];
+      ASSERT_TRUE(Sha256(data.data(), size, digest));
+      ASSERT_EQ(
+          std::vector<uint8_t>(expected, expected + kSha256DigestLength),
+          std::vector<uint8_t>(digest, digest + kSha256DigestLength))
+          << Sha256KernelToString(kernel) << ": size = " << size;
+      // Second pass of SHA-256-SHA-256.
+      ASSERT_TRUE(OpenSslSha256(expected, kSha256DigestLength, expected));
+      ASSERT_TRUE(Sha256Sha256(data.data(), size, digest));
+      ASSERT_EQ(
+          std::vector<uint8_t>(expected, expected + kSha256DigestLength),
+          std::vector<uint8_t>(digest, digest + kSha256DigestLength))
+          << Sha256KernelToString(kernel) << ": size = " << size;
+    }
+  }
+}
+
+TEST_F(Sha256KernelTest, RipeMd160MatchesOpenSsl) {
+  const std::vector<uint8_t> data = MakeTestData(1 << 16);
+  std::vector<size_t> sizes;
+  for (size_t size = 0; size <= 300; size++) sizes.push_back(size);
+  sizes.push_back(data.size() - 1);
+  for (const size_t size : sizes) {
+    uint8_t expected[kRipeMd160DigestLength];
+    ASSERT_TRUE(OpenSslRipeMd160(data.data(), size, expected));
+    uint8_t digest[kRipeMd160DigestLength];
+    ASSERT_TRUE(RipeMd160(data.data(), size, digest));
+    ASSERT_EQ(
+        std::vector<uint8_t>(expected, expected + kRipeMd160DigestLength),
+        std::vector<uint8_t>(digest, digest + kRipeMd160DigestLength))
+        << "size = " << size;
+  }
+  // Includes the public key sizes, which have their own path.
+  for (const Sha256Kernel kernel : kAllSha256Kernels) {
+    if (!IsSha256KernelSupported(kernel)) continue;
+    ASSERT_TRUE(SetSha256Kernel(kernel));
+    for (size_t size = 0; size <= 130; size++) {
+      uint8_t first_digest[kSha256DigestLength];
+      ASSERT_TRUE(OpenSslSha256(data.data(), size, first_digest));
+      uint8_t expected[kRipeMd160DigestLength];
+      ASSERT_TRUE(
+          OpenSslRipeMd160(first_digest, kSha256DigestLength, expected));
+      uint8_t digest[kRipeMd160DigestLength];
+      ASSERT_TRUE(Sha256RipeMd160(data.data(), size, digest));
+      ASSERT_EQ(
+          std::vector<uint8_t>(expected, expected + kRipeMd160DigestLength),
+          std::vector<uint8_t>(digest, digest + kRipeMd160DigestLength))
+          << Sha256KernelToString(kernel) << ": size = " << size;
+    }
+  }
+}
+
+TEST_F(Sha256KernelTest, BatchSupported) {
+  EXPECT_TRUE(IsSha256BatchKernelSupported(kSha256BatchKernelScalar));
+  EXPECT_TRUE(IsSha256BatchKernelSupported(GetSha256BatchKernel()));
+  for (const Sha256BatchKernel kernel : kAllSha256BatchKernels) {
+    EXPECT_EQ(
+        IsSha256BatchKernelSupported(kernel), SetSha256BatchKernel(kernel))
+        << Sha256BatchKernelToString(kernel);
+  }
+}
+
+TEST_F(Sha256KernelTest, Batch) {
+  // Messages of varying length, so that lanes finish out of step.
+  const std::vector<uint8_t> data = MakeTestData(1 << 12);
+  std::vector<DigestInput> inputs;
+  for (size_t i = 0; i < 300; i++) {
+    const size_t size = (i * 37) % 300;
+    inputs.push_back({data.data() + i, size});
+  }
+  inputs[5] = {nullptr, 0};
+  inputs[6] = {data.data(), data.size()};
+  for (const Sha256BatchKernel kernel : kAllSha256BatchKernels) {
+    if (!IsSha256BatchKernelSupported(kernel)) continue;
+    ASSERT_TRUE(SetSha256BatchKernel(kernel));
+    for (const size_t count : {0, 1, 3, 8, 17, 150, 300}) {
+      std::vector<uint8_t> digests(count * kSha256DigestLength);
+      std::vector<uint8_t> double_digests(count * kSha256DigestLength);
+      ASSERT_TRUE(Sha256Batch(inputs.data(), count, digests.data()));
+      ASSERT_TRUE(
+          Sha256Sha256Batch(inputs.data(), count, double_digests.data()));
+      for (size_t i = 0; i < count; i++) {
+        const auto digest = digests.begin() + i * kSha256DigestLength;
+        EXPECT_EQ(
+            Sha256(inputs[i].data, inputs[i].size),
+            std::vector<uint8_t>(digest, digest + kSha256DigestLength))
+            << Sha256BatchKernelToString(kernel) << ": count = " << count
+            << ", i = " << i;
+        const auto double_digest =
+            double_digests.begin() + i * kSha256DigestLength;
+        EXPECT_EQ(
+            Sha256Sha256(inputs[i].data, inputs[i].size),
+            std::vector<uint8_t>(
+                double_digest, double_digest + kSha256DigestLength))
+            << Sha256BatchKernelToString(kernel) << ": count = " << count
+            << ", i = " << i;
+      }
+    }
+  }
+  // Null data.
+  inputs[7] = {nullptr, 1};
+  std::vector<uint8_t> digests(inputs.size() * kSha256DigestLength);
+  EXPECT_FALSE(Sha256Batch(inputs.data(), inputs.size(), digests.data()));
+}
+
+TEST_F(Sha256KernelTest, Sha256RipeMd160Batch) {
+  // Compressed and uncompressed public keys, more than one chunk.
+  const std::vector<uint8_t> data = MakeTestData(1 << 12);
+  std::vector<DigestInput> inputs;
+  for (size_t i = 0; i < 300; i++) {
+    inputs.push_back({data.data() + i * 7, i % 3 == 0 ? 65u : 33u});
+  }
+  inputs[4] = {data.data(), 100};
+  for (const Sha256BatchKernel kernel : kAllSha256BatchKernels) {
+    if (!IsSha256BatchKernelSupported(kernel)) continue;
+    ASSERT_TRUE(SetSha256BatchKernel(kernel));
+    for (const RipeMd160BatchKernel ripemd160_kernel :
+         kAllRipeMd160BatchKernels) {
+      if (!IsRipeMd160BatchKernelSupported(ripemd160_kernel)) continue;
+      ASSERT_TRUE(SetRipeMd160BatchKernel(ripemd160_kernel));
+      for (const size_t count : {0, 1, 7, 16, 17, 300}) {
+        std::vector<uint8_t> digests(count * kRipeMd160DigestLength);
+        ASSERT_TRUE(
+            Sha256RipeMd160Batch(inputs.data(), count, digests.data()));
+        for (size_t i = 0; i < count; i++) {
+          const auto digest = digests.begin() + i * kRipeMd160DigestLength;
+          EXPECT_EQ(
+              Sha256RipeMd160(inputs[i].data, inputs[i].size),
+              std::vector<uint8_t>(digest, digest + kRipeMd160DigestLength))
+              << Sha256BatchKernelToString(kernel) << ", "
+              << RipeMd160BatchKernelToString(ripemd160_kernel)
+              << ": count = " << count << ", i = " << i;
+        }
+      }
+    }
+  }
+  // A null input past the first chunk writes no digests.
+  inputs[299] = {nullptr, 1};
+  std::vector<uint8_t> digests(inputs.size() * kRipeMd160DigestLength, 0xff);
+  EXPECT_FALSE(
+      Sha256RipeMd160Batch(inputs.data(), inputs.size(), digests.data()));
+  EXPECT_EQ(
+      digests,
+      std::vector<uint8_t>(inputs.size() * kRipeMd160DigestLength, 0xff));
+}
+
+TEST_F(Sha256KernelTest, RipeMd160BatchSupported) {
+  EXPECT_TRUE(IsRipeMd160BatchKernelSupported(kRipeMd160BatchKernelScalar));
+  EXPECT_TRUE(IsRipeMd160BatchKernelSupported(GetRipeMd160BatchKernel()));
+  for (const RipeMd160BatchKernel kernel : kAllRipeMd160BatchKernels) {
+    EXPECT_EQ(
+        IsRipeMd160BatchKernelSupported(kernel),
+        SetRipeMd160BatchKernel(kernel))
+        << RipeMd160BatchKernelToString(kernel);
+  }
+}
+
+TEST_F(Sha256KernelTest, D64) {
+  const std::vector<uint8_t> data = MakeTestData(64 * 40);
+  std::vector<uint8_t> expected(32 * 40);
+  for (size_t i = 0; i < 40; i++) {
+    ASSERT_TRUE(Sha256Sha256(data.data() + i * 64, 64, &expected[i * 32]));
+  }
+  for (const Sha256Kernel kernel : kAllSha256Kernels) {
+    if (!SetSha256Kernel(kernel)) continue;
+    for (const Sha256BatchKernel batch_kernel : kAllSha256BatchKernels) {
+      if (!SetSha256BatchKernel(batch_kernel)) continue;
+      // Whole groups of lanes and remainders.
+      for (const size_t count : {0, 1, 8, 16, 21, 40}) {
+        std::vector<uint8_t> digests(count * 32);
+        Sha256D64(data.data(), count, digests.data());
+        EXPECT_TRUE(
+            std::equal(digests.begin(), digests.end(), expected.begin()))
+            << Sha256KernelToString(kernel) << ", "
+            << Sha256BatchKernelToString(batch_kernel) << ": " << count;
+      }
+      // In place.
+      std::vector<uint8_t> buffer = data;
+      Sha256D64(buffer.data(), 40, buffer.data());
+      EXPECT_TRUE(std::equal(expected.begin(), expected.end(), buffer.begin()))
+          << Sha256KernelToString(kernel) << ", "
+          << Sha256BatchKernelToString(batch_kernel);
+    }
+  }
+}
+
+TEST_F(Sha256KernelTest, D80Nonces) {
+  // The genesis block header, nonce 2083236893.
+  using namespace ::btc::encode::literals;
+  constexpr auto kGenesisHeader =
+      "0100000000000000000000000000000000000000000000000000000000000000"
+      "000000003ba3edfd7a7b12b27ac72c3e67768f617fc81bc3888a51323a9fb8aa"
+      "4b1e5e4a29ab5f49ffff001d1dac2b7c"_hex;
+  constexpr uint32_t kGenesisNonce = 2083236893;
+  const Hash256 genesis_hash(
+      "000000000019d6689c085ae165831e934ff763ae46a2a6c172b3f1b60a8ce26f"_rhex);
+  Sha256Midstate midstate;
+  ASSERT_TRUE(
+      ConstexprSha256().Update(kGenesisHeader.data(), 64).SaveMidstate(
+          &midstate));
+
+  std::array<uint8_t, 80> header = kGenesisHeader;
+  const auto set_nonce = [&header](uint32_t nonce) {
+    for (size_t i = 0; i < 4; i++) {
+      header[76 + i] = static_cast<uint8_t>(nonce >> (i * 8));
+    }
+  };
+  std::vector<uint8_t> expected(32 * 40);
+  for (size_t i = 0; i < 40; i++) {
+    set_nonce(kGenesisNonce - 17 + static_cast<uint32_t>(i));
+    ASSERT_TRUE(Sha256Sha256(header.data(), header.size(), &expected[i * 32]));
+  }
+  EXPECT_EQ(Hash256(&expected[17 * 32]), genesis_hash);
+  for (const Sha256Kernel kernel : kAllSha256Kernels) {
+    if (!SetSha256Kernel(kernel)) continue;
+    for (const Sha256BatchKernel batch_kernel : kAllSha256BatchKernels) {
+      if (!SetSha256BatchKernel(batch_kernel)) continue;
+      for (const size_t count : {0, 1, 8, 16, 21, 40}) {
+        std::vector<uint8_t> digests(count * 32);
+        ASSERT_TRUE(Sha256D80Nonces(
+            midstate, kGenesisHeader.data(), kGenesisNonce - 17, count,
+            digests.data()));
+        EXPECT_TRUE(
+            std::equal(digests.begin(), digests.end(), expected.begin()))
+            << Sha256KernelToString(kernel) << ", "
+            << Sha256BatchKernelToString(batch_kernel) << ": " << count;
+      }
+    }
+  }
+  // Nonces wrap.
+  uint8_t digests[2 * 32];
+  ASSERT_TRUE(
+      Sha256D80Nonces(midstate, header.data(), 0xffffffff, 2, digests));
+  set_nonce(0xffffffff);
+  EXPECT_EQ(Sha256Sha256Hash(header.data(), 80), Hash256(digests));
+  set_nonce(0);
+  EXPECT_EQ(Sha256Sha256Hash(header.data(), 80), Hash256(digests + 32));
+
+  midstate.count = 128;
+  EXPECT_FALSE(Sha256D80Nonces(midstate, header.data(), 0, 1, digests));
+}
 }  // namespace test
 }  // namespace crypto
 }  // namespace btc
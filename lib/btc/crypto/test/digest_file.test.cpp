@@ -0,0 +1,131 @@
+// Bitcoin Info - Cryptography - File Digests - Unittest
+//
+// Copyright (c) 2022 Alex Dale
+// This project is licensed under the terms of the MIT license.
+// See LICENSE for details.
+#include <gtest/gtest.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "btc/crypto/digest.hpp"
+#include "btc/crypto/digest_file.hpp"
+#include "btc/test/test_data.hpp"
+
+namespace btc {
+namespace crypto {
+namespace test {
+using ::btc::test::MakeTestData;
+namespace {
+constexpr FileReadMode kAllFileReadModes[] = {
+    kFileReadMmap, kFileReadBuffered};
+constexpr DigestAlgorithm kFileDigestAlgorithms[] = {
+    kSha256, kSha256Sha256, kSha256RipeMd160};
+
+// Temporary file, removed when the test completes.
+class TempFile {
+public:
+  explicit TempFile(const std::vector<uint8_t> &data): _path() {
+    char path[] = "/tmp/btc.digest_file.XXXXXX";
+    const int fd = mkstemp(path);
+    EXPECT_GE(fd, 0);
+    if (fd < 0) return;
+    _path = path;
+    size_t offset = 0;
+    while (offset < data.size()) {
+      const ssize_t res =
+          write(fd, data.data() + offset, data.size() - offset);
+      EXPECT_GT(res, 0);
+      if (res <= 0) break;
+      offset += static_cast<size_t>(res);
+    }
+    close(fd);
+  }
+  ~TempFile() {
+    if (!_path.empty()) unlink(_path.c_str());
+  }
+
+  const std::string &path() const { return _path; }
+
+private:
+  std::string _path;
+};  // class TempFile
+}  // namespace
+
+TEST(DigestFileTest, DigestFile) {
+  // Empty, less than a page, more than the read buffer and not a
+  // multiple of the block size.
+  const size_t kSizes[] = {0, 1, 4095, 4096, (3 << 20) + 13};
+  for (const size_t size : kSizes) {
+    const std::vector<uint8_t> data = MakeTestData(size, size);
+    const TempFile file(data);
+    for (const DigestAlgorithm algorithm : kFileDigestAlgorithms) {
+      const std::vector<uint8_t> expected = Digest(algorithm, data);
+      for (const FileReadMode mode : kAllFileReadModes) {
+        std::vector<uint8_t> digest;
+        uint64_t file_size = 1;
+        ASSERT_TRUE(
+            DigestFile(algorithm, file.path(), &digest, &file_size, mode))
+            << FileReadModeToString(mode);
+        EXPECT_EQ(digest, expected)
+            << DigestAlgorithmToString(algorithm) << ", size " << size
+            << ", " << FileReadModeToString(mode);
+        EXPECT_EQ(file_size, size);
+      }
+    }
+  }
+}
+
+TEST(DigestFileTest, InvalidFile) {
+  std::vector<uint8_t> digest;
+  EXPECT_FALSE(DigestFile(kSha256, "/nonexistent/btc/blk00000.dat", &digest));
+  // Directories cannot be read.
+  EXPECT_FALSE(DigestFile(kSha256, "/tmp", &digest));
+  EXPECT_FALSE(DigestFile(kRipeMd160, "/dev/null", &digest));
+  // Special files fall back to reading.
+  EXPECT_TRUE(DigestFile(kSha256, "/dev/null", &digest));
+  EXPECT_EQ(digest, Sha256(nullptr, 0));
+}
+
+TEST(DigestFileTest, DigestFiles) {
+  constexpr size_t kFileCount = 9;
+  std::vector<std::vector<uint8_t>> datas;
+  std::vector<std::unique_ptr<TempFile>> files;
+  std::vector<std::string> paths;
+  uint64_t total_size = 0;
+  for (size_t i = 0; i < kFileCount; i++) {
+    // Uneven sizes, as with the last blk*.dat file of a node.
+    datas.push_back(MakeTestData((i % 3) * 300000 + i, i));
+    files.emplace_back(new TempFile(datas.back()));
+    paths.push_back(files.back()->path());
+    total_size += datas.back().size();
+  }
+  paths.push_back("/nonexistent/btc/blk00000.dat");
+
+  for (const size_t threads : {1, 2, 4, 16, 0}) {
+    FileDigestStats stats;
+    const std::vector<FileDigest> results =
+        DigestFiles(kSha256Sha256, paths, threads, &stats);
+    ASSERT_EQ(results.size(), paths.size());
+    for (size_t i = 0; i < kFileCount; i++) {
+      EXPECT_EQ(results[i].path, paths[i]);
+      EXPECT_TRUE(results[i].ok) << paths[i];
+      EXPECT_EQ(results[i].size, datas[i].size());
+      EXPECT_EQ(results[i].digest, Sha256Sha256(datas[i]))
+          << "file " << i << ", threads " << threads;
+    }
+    EXPECT_FALSE(results.back().ok);
+    EXPECT_TRUE(results.back().digest.empty());
+    EXPECT_EQ(stats.files, kFileCount);
+    EXPECT_EQ(stats.failed, 1u);
+    EXPECT_EQ(stats.bytes, total_size);
+  }
+
+  EXPECT_TRUE(DigestFiles(kSha256, {}, 4).empty());
+}
+}  // namespace test
+}  // namespace crypto
+}  // namespace btc
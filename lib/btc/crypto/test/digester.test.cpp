@@ -7,12 +7,14 @@
 
 #include "btc/crypto/digester.hpp"
 #include "btc/encode/hex.hpp"
+#include "btc/test/test_data.hpp"
 
 namespace btc {
 namespace crypto {
 namespace test {
 using ::btc::encode::HexDecode;
 using ::btc::encode::HexEncode;
+using ::btc::test::MakeTestData;
 namespace {
 const std::vector<uint8_t> kEmptyVector;
 const std::string kEmptyString;
@@ -200,6 +202,151 @@ TEST(DigesterTest, Sha256RipeMd160) {
       "f9be0e104ef2ed83a7ddb4765780951405e56ba4";
   EXPECT_EQ(hex_digest, kOneMillionADigestHex);
 }
+
+TEST(DigesterTest, Sha256_Chunked) {
+  // Chunk sizes which straddle the 64 byte block boundaries.
+  const std::vector<uint8_t> data = MakeTestData(1000);
+  const std::vector<uint8_t> expected = Sha256(data);
+  const Sha256Kernel initial_kernel = GetSha256Kernel();
+  for (const Sha256Kernel kernel :
+       {kSha256KernelGeneric, kSha256KernelAvx2, kSha256KernelShaNi}) {
+    if (!SetSha256Kernel(kernel)) continue;
+    for (const size_t chunk_size : {1, 7, 63, 64, 65, 200}) {
+      auto digester = Digester::New(kSha256);
+      ASSERT_TRUE(digester);
+      for (size_t offset = 0; offset < data.size(); offset += chunk_size) {
+        const size_t size = std::min(chunk_size, data.size() - offset);
+        ASSERT_TRUE(digester->Update(data.data() + offset, size));
+        // Finalizing does not disturb the running digest.
+        digester->Finalize();
+      }
+      EXPECT_EQ(digester->Count(), data.size());
+      EXPECT_EQ(digester->Finalize(), expected)
+          << Sha256KernelToString(kernel) << ": chunk = " << chunk_size;
+    }
+  }
+  SetSha256Kernel(initial_kernel);
+}
+
+TEST(DigesterTest, Midstate) {
+  // Block header: a fixed 64 byte prefix and a 16 byte tail.
+  const std::vector<uint8_t> header = MakeTestData(80);
+  auto digester = Digester::New(kSha256Sha256);
+  ASSERT_TRUE(digester);
+  Sha256Midstate midstate;
+  EXPECT_TRUE(digester->SaveMidstate(&midstate));
+  EXPECT_EQ(midstate.count, 0);
+  ASSERT_TRUE(digester->Update(header.data(), 63));
+  EXPECT_FALSE(digester->SaveMidstate(&midstate));
+  ASSERT_TRUE(digester->Update(header[63]));
+  ASSERT_TRUE(digester->SaveMidstate(&midstate));
+  EXPECT_EQ(midstate.count, 64);
+
+  for (const DigestAlgorithm algorithm :
+       {kSha256, kSha256Sha256, kSha256RipeMd160}) {
+    auto resumed = Digester::FromMidstate(algorithm, midstate);
+    ASSERT_TRUE(resumed);
+    EXPECT_EQ(resumed->algorithm(), algorithm);
+    EXPECT_EQ(resumed->Count(), 64);
+    ASSERT_TRUE(resumed->Update(header.data() + 64, 16));
+    EXPECT_EQ(resumed->Finalize(), Digest(algorithm, header));
+  }
+
+  // Branching the prefix into many tails, reusing one digester.
+  auto branch = Digester::New(kSha256Sha256);
+  ASSERT_TRUE(branch);
+  std::vector<uint8_t> message = header;
+  for (uint8_t nonce = 0; nonce < 4; nonce++) {
+    message[76] = nonce;
+    ASSERT_TRUE(branch->LoadMidstate(midstate));
+    ASSERT_TRUE(branch->Update(message.data() + 64, 16));
+    EXPECT_EQ(branch->Count(), 80);
+    EXPECT_EQ(branch->Finalize(), Sha256Sha256(message));
+  }
+}
+
+TEST(DigesterTest, Midstate_Invalid) {
+  Sha256Midstate midstate = {};
+  midstate.count = 65;
+  EXPECT_FALSE(Digester::FromMidstate(kSha256, midstate));
+  auto digester = Digester::New(kSha256);
+  ASSERT_TRUE(digester);
+  EXPECT_FALSE(digester->LoadMidstate(midstate));
+  EXPECT_FALSE(digester->SaveMidstate(nullptr));
+  midstate.count = 64;
+  EXPECT_FALSE(Digester::FromMidstate(kRipeMd160, midstate));
+}
+
+TEST(DigesterTest, Clone) {
+  const std::vector<uint8_t> data = MakeTestData(100);
+  auto digester = Digester::New(kSha256RipeMd160);
+  ASSERT_TRUE(digester);
+  // Partial block buffered.
+  ASSERT_TRUE(digester->Update(data.data(), 70));
+  auto clone = digester->Clone();
+  ASSERT_TRUE(clone);
+  EXPECT_EQ(clone->algorithm(), kSha256RipeMd160);
+  EXPECT_EQ(clone->Count(), 70);
+  ASSERT_TRUE(clone->Update(data.data() + 70, 30));
+  EXPECT_EQ(clone->Finalize(), Sha256RipeMd160(data));
+  // The original is unaffected.
+  EXPECT_EQ(digester->Count(), 70);
+  EXPECT_EQ(
+      digester->Finalize(), Sha256RipeMd160(data.data(), 70));
+}
+
+TEST(DigesterTest, FinalizeAndReset) {
+  const std::vector<uint8_t> data = MakeTestData(100);
+  for (const DigestAlgorithm algorithm :
+       {kSha256, kSha256Sha256, kSha256RipeMd160}) {
+    auto digester = Digester::New(algorithm);
+    ASSERT_TRUE(digester);
+    for (size_t round = 0; round < 2; round++) {
+      ASSERT_TRUE(digester->Update(data));
+      std::vector<uint8_t> digest(digester->digest_length());
+      ASSERT_TRUE(digester->FinalizeAndReset(digest.data()));
+      EXPECT_EQ(digest, Digest(algorithm, data));
+      EXPECT_EQ(digester->Count(), 0);
+    }
+  }
+  auto digester = Digester::New(kSha256);
+  ASSERT_TRUE(digester);
+  Hash256 digest;
+  ASSERT_TRUE(digester->Update("abc"));
+  ASSERT_TRUE(digester->FinalizeAndReset(&digest));
+  EXPECT_EQ(digest, Sha256Hash("abc"));
+  Hash160 wrong_length;
+  EXPECT_FALSE(digester->FinalizeAndReset(&wrong_length));
+  EXPECT_FALSE(digester->FinalizeAndReset(static_cast<uint8_t *>(nullptr)));
+}
+
+TEST(DigesterTest, Acquire) {
+  const Digester *first = nullptr;
+  {
+    PooledDigester digester = Digester::Acquire(kSha256Sha256);
+    ASSERT_TRUE(digester);
+    EXPECT_EQ(digester->algorithm(), kSha256Sha256);
+    ASSERT_TRUE(digester->Update("abc"));
+    first = digester.get();
+  }
+  {
+    // Reused, and reset.
+    PooledDigester digester = Digester::Acquire(kSha256Sha256);
+    ASSERT_TRUE(digester);
+    EXPECT_EQ(digester.get(), first);
+    EXPECT_EQ(digester->Count(), 0);
+    // Held digesters are not handed out twice.
+    PooledDigester other = Digester::Acquire(kSha256Sha256);
+    ASSERT_TRUE(other);
+    EXPECT_NE(other.get(), digester.get());
+    PooledDigester key_digester = Digester::Acquire(kSha256RipeMd160);
+    ASSERT_TRUE(key_digester);
+    EXPECT_EQ(key_digester->algorithm(), kSha256RipeMd160);
+    ASSERT_TRUE(digester->Update("abc"));
+    EXPECT_EQ(digester->Finalize(), Sha256Sha256("abc"));
+  }
+  EXPECT_FALSE(Digester::Acquire(kRipeMd160));
+}
 }  // namespace test
 }  // namespace crypto
 }  // namespace btc
@@ -0,0 +1,155 @@
+// Bitcoin Info - Cryptography - Hash Values - Unittest
+//
+// Copyright (c) 2022 Alex Dale
+// This project is licensed under the terms of the MIT license.
+// See LICENSE for details.
+#include <gtest/gtest.h>
+
+#include <unordered_set>
+
+#include "btc/crypto/digest.hpp"
+#include "btc/crypto/digester.hpp"
+#include "btc/crypto/hash.hpp"
+#include "btc/encode/hex.hpp"
+#include "btc/encode/hex.literal.hpp"
+
+namespace btc {
+namespace crypto {
+namespace test {
+using ::btc::encode::HexEncode;
+namespace {
+// Block hash of the genesis block, display order.
+constexpr char kGenesisHash[] =
+    "000000000019d6689c085ae165831e934ff763ae46a2a6c172b3f1b60a8ce26f";
+}  // namespace
+
+TEST(HashTest, Default) {
+  const Hash256 hash;
+  EXPECT_TRUE(hash.IsZero());
+  EXPECT_EQ(Hash256::size(), 32);
+  EXPECT_EQ(Hash160::size(), 20);
+  EXPECT_EQ(sizeof(Hash256), 32);
+  EXPECT_EQ(sizeof(Hash160), 20);
+  EXPECT_EQ(hash.ToHex(), std::string(64, '0'));
+}
+
+TEST(HashTest, Hex) {
+  Hash256 hash;
+  ASSERT_TRUE(Hash256::FromHex(kGenesisHash, &hash));
+  EXPECT_FALSE(hash.IsZero());
+  // Stored in internal byte order.
+  EXPECT_EQ(hash[0], 0x6f);
+  EXPECT_EQ(hash[31], 0x00);
+  EXPECT_EQ(hash.ToHex(), kGenesisHash);
+  EXPECT_EQ(
+      hash.ToHex(/* reverse = */ false),
+      HexEncode(hash.data(), hash.size()));
+
+  Hash256 in_order;
+  ASSERT_TRUE(Hash256::FromHex(
+      hash.ToHex(/* reverse = */ false), &in_order, /* reverse = */ false));
+  EXPECT_EQ(in_order, hash);
+
+  // Key hashes are displayed in order.
+  const Hash160 key_hash = Sha256RipeMd160Hash("abc");
+  EXPECT_EQ(key_hash.ToHex(), HexEncode(key_hash.data(), key_hash.size()));
+  Hash160 parsed_key_hash;
+  ASSERT_TRUE(Hash160::FromHex(key_hash.ToHex(), &parsed_key_hash));
+  EXPECT_EQ(parsed_key_hash, key_hash);
+}
+
+TEST(HashTest, Constant) {
+  using namespace ::btc::encode::literals;
+  static constexpr Hash256 kGenesis(
+      "000000000019d6689c085ae165831e934ff763ae46a2a6c172b3f1b60a8ce26f"_rhex);
+  Hash256 parsed;
+  ASSERT_TRUE(Hash256::FromHex(kGenesisHash, &parsed));
+  EXPECT_EQ(kGenesis, parsed);
+}
+
+TEST(HashTest, Hex_Invalid) {
+  Hash256 hash;
+  ASSERT_TRUE(Hash256::FromHex(kGenesisHash, &hash));
+  const Hash256 original = hash;
+  EXPECT_FALSE(Hash256::FromHex("", &hash));
+  EXPECT_FALSE(Hash256::FromHex("00", &hash));
+  EXPECT_FALSE(Hash256::FromHex(std::string(kGenesisHash) + "00", &hash));
+  std::string bad_digit = kGenesisHash;
+  bad_digit[10] = 'x';
+  EXPECT_FALSE(Hash256::FromHex(bad_digit, &hash));
+  // Left unchanged on failure.
+  EXPECT_EQ(hash, original);
+  Hash160 short_hash;
+  EXPECT_FALSE(Hash160::FromHex(kGenesisHash, &short_hash));
+}
+
+TEST(HashTest, Ordering) {
+  Hash256 low;
+  Hash256 high;
+  high[0] = 1;
+  EXPECT_EQ(low, Hash256());
+  EXPECT_NE(low, high);
+  EXPECT_LT(low, high);
+  EXPECT_GT(high, low);
+  EXPECT_LE(low, low);
+  // Ordered by the first byte in memory, not in display order.
+  Hash256 last;
+  last[31] = 0xff;
+  EXPECT_LT(last, high);
+}
+
+TEST(HashTest, StdHash) {
+  std::unordered_set<Hash256> hashes;
+  for (size_t i = 0; i < 100; i++) {
+    hashes.insert(Sha256Sha256Hash(std::to_string(i)));
+  }
+  EXPECT_EQ(hashes.size(), 100);
+  EXPECT_EQ(hashes.count(Sha256Sha256Hash("42")), 1);
+  EXPECT_EQ(hashes.count(Sha256Sha256Hash("100")), 0);
+  std::unordered_set<Hash160> key_hashes = {
+      Sha256RipeMd160Hash("a"), Sha256RipeMd160Hash("a")};
+  EXPECT_EQ(key_hashes.size(), 1);
+}
+
+TEST(HashTest, DigestValues) {
+  for (const std::string &data :
+       {std::string(), std::string("abc"), std::string(200, 'x')}) {
+    const std::vector<uint8_t> bytes(data.begin(), data.end());
+    EXPECT_EQ(Sha256Hash(data).ToVector(), Sha256(data));
+    EXPECT_EQ(Sha256Hash(bytes), Sha256Hash(data));
+    EXPECT_EQ(Sha256Sha256Hash(data).ToVector(), Sha256Sha256(data));
+    EXPECT_EQ(Sha256Sha256Hash(bytes), Sha256Sha256Hash(data));
+    EXPECT_EQ(RipeMd160Hash(data).ToVector(), RipeMd160(data));
+    EXPECT_EQ(RipeMd160Hash(bytes), RipeMd160Hash(data));
+    EXPECT_EQ(Sha256RipeMd160Hash(data).ToVector(), Sha256RipeMd160(data));
+    EXPECT_EQ(
+        Sha256RipeMd160Hash(bytes.data(), bytes.size()),
+        Sha256RipeMd160Hash(data));
+  }
+  EXPECT_TRUE(Sha256Hash(nullptr, 1).IsZero());
+  EXPECT_TRUE(Sha256Sha256Hash(nullptr, 1).IsZero());
+  EXPECT_TRUE(RipeMd160Hash(nullptr, 1).IsZero());
+  EXPECT_TRUE(Sha256RipeMd160Hash(nullptr, 1).IsZero());
+}
+
+TEST(HashTest, DigesterFinalize) {
+  auto digester = Digester::New(kSha256Sha256);
+  ASSERT_TRUE(digester);
+  ASSERT_TRUE(digester->Update("abc"));
+  Hash256 digest;
+  ASSERT_TRUE(digester->Finalize(&digest));
+  EXPECT_EQ(digest, Sha256Sha256Hash("abc"));
+  Hash160 wrong_length;
+  EXPECT_FALSE(digester->Finalize(&wrong_length));
+
+  digester = Digester::New(kSha256RipeMd160);
+  ASSERT_TRUE(digester);
+  ASSERT_TRUE(digester->Update("abc"));
+  Hash160 key_hash;
+  ASSERT_TRUE(digester->Finalize(&key_hash));
+  EXPECT_EQ(key_hash, Sha256RipeMd160Hash("abc"));
+  EXPECT_FALSE(digester->Finalize(&digest));
+}
+}  // namespace test
+}  // namespace crypto
+}  // namespace btc
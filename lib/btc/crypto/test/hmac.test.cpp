@@ -0,0 +1,254 @@
+// Bitcoin Info - Cryptography - HMAC and PBKDF2 - Unittest
+//
+// Copyright (c) 2022 Alex Dale
+// This project is licensed under the terms of the MIT license.
+// See LICENSE for details.
+#include <gtest/gtest.h>
+
+#include <openssl/evp.h>
+#include <openssl/hmac.h>
+
+#include "btc/crypto/digest.hpp"
+#include "btc/crypto/hmac.hpp"
+#include "btc/encode/hex.hpp"
+#include "btc/test/test_data.hpp"
+
+namespace btc {
+namespace crypto {
+namespace test {
+using ::btc::encode::HexEncode;
+using ::btc::test::MakeTestData;
+namespace {
+const Sha256BatchKernel kAllSha256BatchKernels[] = {
+    kSha256BatchKernelScalar, kSha256BatchKernelAvx2,
+    kSha256BatchKernelAvx512};
+const Sha512BatchKernel kAllSha512BatchKernels[] = {
+    kSha512BatchKernelScalar, kSha512BatchKernelAvx2,
+    kSha512BatchKernelAvx512};
+
+const uint8_t *Bytes(const std::string &data) {
+  return reinterpret_cast<const uint8_t *>(data.data());
+}
+
+std::vector<uint8_t> OpenSslPbkdf2(
+    const EVP_MD *md, const std::vector<uint8_t> &password,
+    const std::vector<uint8_t> &salt, size_t iterations, size_t key_size) {
+  std::vector<uint8_t> key(key_size);
+  EXPECT_EQ(
+      PKCS5_PBKDF2_HMAC(
+          reinterpret_cast<const char *>(password.data()),
+          static_cast<int>(password.size()), salt.data(),
+          static_cast<int>(salt.size()), static_cast<int>(iterations), md,
+          static_cast<int>(key_size), key.data()),
+      1);
+  return key;
+}
+
+// Restores the automatically selected batch kernels.
+class HmacTest: public ::testing::Test {
+protected:
+  void SetUp() override {
+    _batch_kernel = GetSha256BatchKernel();
+    _sha512_batch_kernel = GetSha512BatchKernel();
+  }
+  void TearDown() override {
+    SetSha256BatchKernel(_batch_kernel);
+    SetSha512BatchKernel(_sha512_batch_kernel);
+  }
+
+private:
+  Sha256BatchKernel _batch_kernel = kSha256BatchKernelScalar;
+  Sha512BatchKernel _sha512_batch_kernel = kSha512BatchKernelScalar;
+};
+}  // namespace
+
+TEST_F(HmacTest, Rfc4231) {
+  // Test case 2.
+  const std::string key = "Jefe";
+  const std::string data = "what do ya want for nothing?";
+  uint8_t mac[kSha512DigestLength];
+  ASSERT_TRUE(
+      HmacSha256(Bytes(key), key.size(), Bytes(data), data.size(), mac));
+  EXPECT_EQ(
+      HexEncode(mac, kSha256DigestLength),
+      "5bdcc146bf60754e6a042426089575c75a003f089d2739839dec58b964ec3843");
+  ASSERT_TRUE(
+      HmacSha512(Bytes(key), key.size(), Bytes(data), data.size(), mac));
+  EXPECT_EQ(
+      HexEncode(mac, kSha512DigestLength),
+      "164b7a7bfcf819e2e395fbe73b56e0a387bd64222e831fd610270cd7ea250554"
+      "9758bf75c05a994a6d034f65f8f0e6fdcaeab1a34d4a6b4b636e070a38bce737");
+}
+
+TEST_F(HmacTest, MatchesOpenSsl) {
+  // Empty keys, keys around the block lengths and keys which are
+  // hashed first.
+  for (const size_t key_size : {0, 1, 32, 63, 64, 65, 127, 128, 129, 300}) {
+    const std::vector<uint8_t> key = MakeTestData(key_size, 1);
+    // OpenSSL rejects a null key, even if empty.
+    const uint8_t empty = 0;
+    const uint8_t *key_data = key.empty() ? &empty : key.data();
+    HmacSha256Key sha256_key;
+    HmacSha512Key sha512_key;
+    ASSERT_TRUE(sha256_key.SetKey(key));
+    ASSERT_TRUE(sha512_key.SetKey(key));
+    for (const size_t data_size : {0, 1, 55, 64, 111, 128, 1000}) {
+      const std::vector<uint8_t> data = MakeTestData(data_size, 2);
+      uint8_t expected[EVP_MAX_MD_SIZE];
+      unsigned int expected_size = 0;
+      uint8_t mac[kSha512DigestLength];
+
+      ASSERT_NE(
+          HMAC(
+              EVP_sha256(), key_data, static_cast<int>(key.size()),
+              data.data(), data.size(), expected, &expected_size),
+          nullptr);
+      ASSERT_TRUE(sha256_key.Mac(data.data(), data.size(), mac));
+      EXPECT_EQ(
+          HexEncode(mac, kSha256DigestLength),
+          HexEncode(expected, expected_size))
+          << key_size << ", " << data_size;
+
+      ASSERT_NE(
+          HMAC(
+              EVP_sha512(), key_data, static_cast<int>(key.size()),
+              data.data(), data.size(), expected, &expected_size),
+          nullptr);
+      ASSERT_TRUE(sha512_key.Mac(data.data(), data.size(), mac));
+      EXPECT_EQ(
+          HexEncode(mac, kSha512DigestLength),
+          HexEncode(expected, expected_size))
+          << key_size << ", " << data_size;
+    }
+  }
+}
+
+TEST_F(HmacTest, Invalid) {
+  HmacSha256Key key;
+  EXPECT_FALSE(key.SetKey(nullptr, 1));
+  uint8_t mac[kSha512DigestLength];
+  EXPECT_FALSE(key.Mac(nullptr, 1, mac));
+  EXPECT_TRUE(key.Mac(nullptr, 0, mac));
+  EXPECT_FALSE(HmacSha512(nullptr, 1, nullptr, 0, mac));
+
+  const std::string password = "password";
+  EXPECT_FALSE(Pbkdf2HmacSha256(
+      Bytes(password), password.size(), nullptr, 0, 0, mac, 32));
+  EXPECT_FALSE(Pbkdf2HmacSha512(nullptr, 1, nullptr, 0, 1, mac, 64));
+  const Pbkdf2Input input = {Bytes(password), password.size(), nullptr, 4};
+  EXPECT_FALSE(Pbkdf2HmacSha512Batch(&input, 1, 1, mac, 64));
+}
+
+TEST_F(HmacTest, Bip39Seed) {
+  // First BIP39 test vector, with the passphrase "TREZOR".
+  const std::string mnemonic =
+      "abandon abandon abandon abandon abandon abandon abandon abandon "
+      "abandon abandon abandon about";
+  const std::string salt = "mnemonicTREZOR";
+  uint8_t seed[kSha512DigestLength];
+  ASSERT_TRUE(Pbkdf2HmacSha512(
+      Bytes(mnemonic), mnemonic.size(), Bytes(salt), salt.size(), 2048, seed,
+      sizeof(seed)));
+  EXPECT_EQ(
+      HexEncode(seed, sizeof(seed)),
+      "c55257c360c07c72029aebc1b53c05ed0362ada38ead3e3e9efa3708e5349553"
+      "1f09a6987599d18264c1e1c92f2cf141630c7a3c4ab7c81b2f001698e7463b04");
+}
+
+TEST_F(HmacTest, Pbkdf2MatchesOpenSsl) {
+  const std::vector<uint8_t> password = MakeTestData(20, 3);
+  const std::vector<uint8_t> salt = MakeTestData(16, 4);
+  // Keys shorter than, equal to and spanning several digests.
+  for (const size_t key_size : {20, 32, 64, 100}) {
+    for (const size_t iterations : {1, 2, 100}) {
+      std::vector<uint8_t> key(key_size);
+      ASSERT_TRUE(Pbkdf2HmacSha256(
+          password.data(), password.size(), salt.data(), salt.size(),
+          iterations, key.data(), key_size));
+      EXPECT_EQ(
+          key,
+          OpenSslPbkdf2(EVP_sha256(), password, salt, iterations, key_size))
+          << key_size << ", " << iterations;
+      ASSERT_TRUE(Pbkdf2HmacSha512(
+          password.data(), password.size(), salt.data(), salt.size(),
+          iterations, key.data(), key_size));
+      EXPECT_EQ(
+          key,
+          OpenSslPbkdf2(EVP_sha512(), password, salt, iterations, key_size))
+          << key_size << ", " << iterations;
+    }
+  }
+}
+
+TEST_F(HmacTest, Pbkdf2Batch) {
+  // Enough keys for full and partial groups of every lane count.
+  const size_t kCount = 21;
+  const size_t kIterations = 50;
+  std::vector<std::vector<uint8_t>> passwords;
+  std::vector<std::vector<uint8_t>> salts;
+  std::vector<Pbkdf2Input> inputs;
+  for (size_t i = 0; i < kCount; i++) {
+    passwords.push_back(MakeTestData(i * 7, 10 + i));
+    salts.push_back(MakeTestData(8 + i, 100 + i));
+  }
+  for (size_t i = 0; i < kCount; i++) {
+    inputs.push_back(
+        {passwords[i].data(), passwords[i].size(), salts[i].data(),
+         salts[i].size()});
+  }
+  for (const Sha256BatchKernel kernel : kAllSha256BatchKernels) {
+    if (!SetSha256BatchKernel(kernel)) continue;
+    for (const size_t key_size : {32, 80}) {
+      for (const size_t threads : {1, 3}) {
+        std::vector<uint8_t> keys(kCount * key_size);
+        ASSERT_TRUE(Pbkdf2HmacSha256Batch(
+            inputs.data(), kCount, kIterations, keys.data(), key_size,
+            threads));
+        for (size_t i = 0; i < kCount; i++) {
+          EXPECT_EQ(
+              std::vector<uint8_t>(
+                  keys.begin() + i * key_size,
+                  keys.begin() + (i + 1) * key_size),
+              OpenSslPbkdf2(
+                  EVP_sha256(), passwords[i], salts[i], kIterations,
+                  key_size))
+              << Sha256BatchKernelToString(kernel) << ": " << i;
+        }
+      }
+    }
+  }
+  for (const Sha512BatchKernel kernel : kAllSha512BatchKernels) {
+    if (!SetSha512BatchKernel(kernel)) continue;
+    for (const size_t key_size : {32, 80}) {
+      for (const size_t threads : {1, 3}) {
+        std::vector<uint8_t> keys(kCount * key_size);
+        ASSERT_TRUE(Pbkdf2HmacSha512Batch(
+            inputs.data(), kCount, kIterations, keys.data(), key_size,
+            threads));
+        for (size_t i = 0; i < kCount; i++) {
+          EXPECT_EQ(
+              std::vector<uint8_t>(
+                  keys.begin() + i * key_size,
+                  keys.begin() + (i + 1) * key_size),
+              OpenSslPbkdf2(
+                  EVP_sha512(), passwords[i], salts[i], kIterations,
+                  key_size))
+              << Sha512BatchKernelToString(kernel) << ": " << i;
+        }
+      }
+    }
+  }
+}
+
+TEST_F(HmacTest, Sha512BatchSupported) {
+  EXPECT_TRUE(IsSha512BatchKernelSupported(kSha512BatchKernelScalar));
+  EXPECT_TRUE(IsSha512BatchKernelSupported(GetSha512BatchKernel()));
+  for (const Sha512BatchKernel kernel : kAllSha512BatchKernels) {
+    EXPECT_EQ(
+        IsSha512BatchKernelSupported(kernel), SetSha512BatchKernel(kernel))
+        << Sha512BatchKernelToString(kernel);
+  }
+}
+}  // namespace test
+}  // namespace crypto
+}  // namespace btc
@@ -0,0 +1,62 @@
+// Bitcoin Info - Encoders - Fixed Length Base58 Encoder
+//
+// Copyright (c) 2022 Alex Dale
+// This project is licensed under the terms of the MIT license.
+// See LICENSE for details.
+#ifndef _BTC_ENCODE_BASE58_FIXED_HPP_
+#define _BTC_ENCODE_BASE58_FIXED_HPP_
+
+#include <array>
+
+#include "btc/cc/attr.h"
+#include "btc/cc/base.h"
+#include "btc/encode/base58.hpp"
+
+namespace btc {
+namespace encode {
+// Base58 codec specialized for a fixed number of bytes.  All limb
+// arithmetic has compile time bounds and is fully unrolled, the output
+// is a fixed size array and no memory is allocated.
+//
+// Implemented for the common Bitcoin payload lengths:
+//  25 bytes - P2PKH / P2SH addresses (with checksum)
+//  32 bytes - raw keys and hashes
+//  37 bytes - WIF private keys (with checksum)
+//  38 bytes - WIF private keys for compressed public keys
+//  82 bytes - BIP32 extended keys (with checksum)
+// Base58Encode() uses these automatically when the input size matches.
+template<size_t kSize>
+class Base58Fixed {
+public:
+  static constexpr size_t kMaxEncodedLength = Base58EncodedMaxLength(kSize);
+  using EncodedArray = std::array<char, kMaxEncodedLength>;
+  using DecodedArray = std::array<uint8_t, kSize>;
+
+  // Encodes |data| (exactly |kSize| bytes) to the front of |b58|.
+  // Returns the length of the encoding.
+  static size_t Encode(const uint8_t *data, EncodedArray *b58)
+      __NOT_NULL(1, 2);
+  // Decodes |b58| into |data|.  Fails if |b58| is not Base58 or does not
+  // decode to exactly |kSize| bytes.
+  static bool Decode(const char *b58, size_t b58_size, DecodedArray *data)
+      __NOT_NULL(1, 3);
+};  // class Base58Fixed
+
+extern template class Base58Fixed<25>;
+extern template class Base58Fixed<32>;
+extern template class Base58Fixed<37>;
+extern template class Base58Fixed<38>;
+extern template class Base58Fixed<82>;
+
+namespace internal {
+// Encodes using a fixed length specialization, if one exists for
+// |size|.  Returns false if there is none, otherwise sets |length| to
+// the result of the encoding (0 if |b58_size| is too small).
+bool Base58EncodeFixedSize(
+    const uint8_t *data, size_t size, char *b58, size_t b58_size,
+    size_t *length) __NOT_NULL(1, 3, 5);
+}  // namespace internal
+}  // namespace encode
+}  // namespace btc
+
+#endif  // _BTC_ENCODE_BASE58_FIXED_HPP_
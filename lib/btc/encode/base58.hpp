@@ -10,6 +10,7 @@
 
 #include "btc/cc/attr.h"
 #include "btc/cc/base.h"
+#include "btc/encode/batch.hpp"
 
 namespace btc {
 namespace encode {
@@ -17,14 +18,43 @@ bool IsBase58Character(char c);
 uint8_t Base58CharToValue(char c);
 char ValueToBase58Char(uint8_t v);
 
+// Output size limits, allows for preallocating buffers.  The exact
+// length of a Base58 encoding depends on the value being encoded; the
+// encoders and decoders below return the exact length produced.
+constexpr size_t Base58EncodedMaxLength(size_t size) {
+  // log(256) / log(58) ~= 1.3657
+  return size * 138 / 100 + 1;
+}
+constexpr size_t Base58DecodedMaxLength(size_t b58_size) {
+  // Each leading '1' is a zero byte, all other characters carry less
+  // than 8 bits.
+  return b58_size;
+}
+
+// Exact lengths, computed by performing the conversion without
+// storing the result.  Returns 0 if |b58| is not Base58.
+size_t Base58EncodedLength(const uint8_t *data, size_t size) __NOT_NULL(1);
+size_t Base58DecodedLength(const char *b58, size_t b58_size) __NOT_NULL(1);
+
 // Checks if the provided string a correctly formatted base58 string.
 bool IsBase58String(const std::string &b58);
+bool IsBase58String(const char *b58, size_t b58_size);
 
 // Bytes to Base58.
 std::string Base58Encode(const uint8_t *data, size_t size) __NOT_NULL(1);
 std::string Base58Encode(const std::vector<uint8_t> &data);
 // Input string is treated as raw bytes.
 std::string Base58Encode(const std::string &data);
+// Encodes into a caller provided buffer, without a null terminator.
+// Returns the number of characters written, or zero if |b58_size| is
+// too small.  A buffer of Base58EncodedMaxLength(size) is always
+// large enough.
+size_t Base58Encode(
+    const uint8_t *data, size_t size, char *b58, size_t b58_size)
+    __NOT_NULL(1, 3);
+// Appends the encoding to the end of |b58|.
+bool Base58EncodeAppend(const uint8_t *data, size_t size, std::string *b58)
+    __NOT_NULL(1, 3);
 
 // Base58 to bytes.
 //
@@ -35,8 +65,70 @@ std::string Base58Encode(const std::string &data);
 // decoded value.
 size_t Base58Decode(const std::string &b58, uint8_t *buffer, size_t buffer_size)
     __NOT_NULL(2);
+size_t Base58Decode(
+    const char *b58, size_t b58_size, uint8_t *buffer, size_t buffer_size)
+    __NOT_NULL(3);
 std::vector<uint8_t> Base58Decode(const std::string &b58);
 std::string Base58DecodeToString(const std::string &b58);
+// Appends the decoded bytes to the end of |data|.  On failure, |data|
+// is left unchanged.
+bool Base58DecodeAppend(
+    const char *b58, size_t b58_size, std::vector<uint8_t> *data)
+    __NOT_NULL(3);
+
+// Base58Check, Base58 with a 4 byte checksum appended to the data.  The
+// checksum is the first 4 bytes of SHA-256(SHA-256(data)).
+constexpr size_t kBase58CheckChecksumLength = 4;
+constexpr size_t Base58CheckEncodedMaxLength(size_t size) {
+  return Base58EncodedMaxLength(size + kBase58CheckChecksumLength);
+}
+// Encodes |data| and its checksum into |b58|, without a null terminator.
+// Returns the number of characters written, or zero on failure.
+size_t Base58CheckEncode(
+    const uint8_t *data, size_t size, char *b58, size_t b58_size)
+    __NOT_NULL(1, 3);
+std::string Base58CheckEncode(const std::vector<uint8_t> &data);
+// Validates, decodes and verifies the checksum of |b58| in one pass,
+// writing the data without the checksum into |data|.  Returns the
+// length of the data, or zero if |b58| is not valid Base58Check, the
+// data is empty or |data_size| is too small.
+size_t Base58CheckDecode(
+    const char *b58, size_t b58_size, uint8_t *data, size_t data_size)
+    __NOT_NULL(1, 3);
+std::vector<uint8_t> Base58CheckDecode(const std::string &b58);
+
+// Batch conversions, for bulk import and export.
+//
+// Item |i| of the input is the |items[i]| slice of the input arena.
+// Each result is written to its own slot of the output arena; slots
+// are laid out back to back, each sized for the longest possible
+// result, and the Base58*BatchArenaSize() functions return the total.
+// On return, |results[i]| locates the result of item |i| within the
+// output arena and bit |i| of |valid| (BatchBitmapWords(count) words)
+// is set if the item was converted.  Items whose slot does not fit in
+// the output arena are marked invalid.
+// The work is split across |threads| threads (0 for the default).
+// Returns the number of valid items.
+size_t Base58EncodeBatchArenaSize(const BatchItem *items, size_t count);
+size_t Base58EncodeBatch(
+    const uint8_t *data, const BatchItem *items, size_t count,
+    char *b58, size_t b58_size, BatchItem *results, uint64_t *valid,
+    size_t threads = 1);
+size_t Base58DecodeBatchArenaSize(const BatchItem *items, size_t count);
+size_t Base58DecodeBatch(
+    const char *b58, const BatchItem *items, size_t count,
+    uint8_t *data, size_t data_size, BatchItem *results, uint64_t *valid,
+    size_t threads = 1);
+size_t Base58CheckEncodeBatchArenaSize(const BatchItem *items, size_t count);
+size_t Base58CheckEncodeBatch(
+    const uint8_t *data, const BatchItem *items, size_t count,
+    char *b58, size_t b58_size, BatchItem *results, uint64_t *valid,
+    size_t threads = 1);
+size_t Base58CheckDecodeBatchArenaSize(const BatchItem *items, size_t count);
+size_t Base58CheckDecodeBatch(
+    const char *b58, const BatchItem *items, size_t count,
+    uint8_t *data, size_t data_size, BatchItem *results, uint64_t *valid,
+    size_t threads = 1);
 }  // namespace encode
 }  // namespace btc
 
@@ -0,0 +1,55 @@
+// Bitcoin Info - Encoders - Base58 Kernels
+//
+// Copyright (c) 2022 Alex Dale
+// This project is licensed under the terms of the MIT license.
+// See LICENSE for details.
+#ifndef _BTC_ENCODE_BASE58_KERNEL_HPP_
+#define _BTC_ENCODE_BASE58_KERNEL_HPP_
+
+#ifndef _BTC_ENCODE_BASE58_INTERNAL_
+#  error Header should only be included internally
+#endif  // _BTC_ENCODE_BASE58_INTERNAL_
+
+#include "btc/cc/base.h"
+
+namespace btc {
+namespace encode {
+namespace internal {
+constexpr char kBase58CharSet[] =
+    "123456789ABCDEFGHJKLMNPQRSTUVWXYZabcdefghijkmnopqrstuvwxyz";
+constexpr uint32_t kBase58Radix = 58;
+
+// The native codecs work on 32-bit limbs.  Base58 values are held in
+// limbs of five digits (base 58^5), binary values in base 2^32 limbs.
+// All divisions are by compile time constants.
+constexpr size_t kDigitsPerLimb = 5;
+constexpr uint64_t kBase58LimbRadix = 58ull * 58 * 58 * 58 * 58;
+static_assert(kBase58LimbRadix < (1ull << 32), "Limb must fit 32 bits");
+
+// Powers of 58 for partial limbs.
+constexpr uint32_t kBase58Powers[kDigitsPerLimb + 1] = {
+    1, 58, 58 * 58, 58 * 58 * 58, 58 * 58 * 58 * 58, 58 * 58 * 58 * 58 * 58};
+
+constexpr uint8_t kInvalidBase58Value = 0xff;
+
+// Value of each character, kInvalidBase58Value for those outside the
+// character set.
+struct Base58ValueTable {
+  uint8_t values[256];
+};
+
+constexpr Base58ValueTable MakeBase58ValueTable() {
+  Base58ValueTable table = {};
+  for (size_t c = 0; c < 256; c++) table.values[c] = kInvalidBase58Value;
+  for (uint8_t v = 0; v < kBase58Radix; v++) {
+    table.values[static_cast<uint8_t>(kBase58CharSet[v])] = v;
+  }
+  return table;
+}
+
+constexpr Base58ValueTable kBase58Values = MakeBase58ValueTable();
+}  // namespace internal
+}  // namespace encode
+}  // namespace btc
+
+#endif  // _BTC_ENCODE_BASE58_KERNEL_HPP_
@@ -0,0 +1,42 @@
+// Bitcoin Info - Encoders - OpenSSL Base58 Encoder
+//
+// Copyright (c) 2022 Alex Dale
+// This project is licensed under the terms of the MIT license.
+// See LICENSE for details.
+#ifndef _BTC_ENCODE_OPENSSL_BASE58_HPP_
+#define _BTC_ENCODE_OPENSSL_BASE58_HPP_
+
+#ifndef _BTC_ENCODE_BASE58_INTERNAL_
+#  error Header should only be included internally
+#endif  // _BTC_ENCODE_BASE58_INTERNAL_
+
+#include "btc/cc/attr.h"
+#include "btc/cc/base.h"
+
+namespace btc {
+namespace encode {
+namespace internal {
+// Reference implementation of the Base58 codec using OpenSSL BIGNUMs.
+// Slow, but simple enough to serve as an oracle for the native codec.
+
+// Converts |data| to Base58 characters.  If |b58| is null, only the
+// length of the encoding is computed.
+// Returns the length of the encoding, or 0 if |b58_size| is too small
+// or the conversion failed.
+size_t OpenSslBase58Encode(
+    const uint8_t *data, size_t size, char *b58, size_t b58_size)
+    __NOT_NULL(1);
+
+// Converts |b58| to bytes.  If |buffer| is null, only the length of the
+// decoded value is computed.  If |buffer_size| is too small, the output
+// is truncated.
+// Returns the length of the decoded value, or 0 if |b58| is not Base58
+// or the conversion failed.
+size_t OpenSslBase58Decode(
+    const char *b58, size_t b58_size, uint8_t *buffer, size_t buffer_size)
+    __NOT_NULL(1);
+}  // namespace internal
+}  // namespace encode
+}  // namespace btc
+
+#endif  // _BTC_ENCODE_OPENSSL_BASE58_HPP_
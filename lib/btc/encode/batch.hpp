@@ -0,0 +1,32 @@
+// Bitcoin Info - Encoders - Batch Helpers
+//
+// Copyright (c) 2022 Alex Dale
+// This project is licensed under the terms of the MIT license.
+// See LICENSE for details.
+#ifndef _BTC_ENCODE_BATCH_HPP_
+#define _BTC_ENCODE_BATCH_HPP_
+
+#include "btc/cc/base.h"
+
+namespace btc {
+namespace encode {
+// Location of one item within a contiguous arena.
+struct BatchItem {
+  size_t offset;
+  size_t length;
+};
+
+// Per-item results of batch operations are returned as a bitmap, one
+// bit per item, least significant bit first.
+constexpr size_t kBatchBitmapWordBits = 64;
+constexpr size_t BatchBitmapWords(size_t count) {
+  return (count + kBatchBitmapWordBits - 1) / kBatchBitmapWordBits;
+}
+inline bool IsBatchItemValid(const uint64_t *bitmap, size_t index) {
+  return (bitmap[index / kBatchBitmapWordBits]
+          >> (index % kBatchBitmapWordBits)) & 1;
+}
+}  // namespace encode
+}  // namespace btc
+
+#endif  // _BTC_ENCODE_BATCH_HPP_
@@ -0,0 +1,118 @@
+// Bitcoin Info - Encoders - Bech32 Encoder
+//
+// Copyright (c) 2022 Alex Dale
+// This project is licensed under the terms of the MIT license.
+// See LICENSE for details.
+#ifndef _BTC_ENCODE_BECH32_HPP_
+#define _BTC_ENCODE_BECH32_HPP_
+#include <string>
+#include <vector>
+
+#include "btc/cc/attr.h"
+#include "btc/cc/base.h"
+#include "btc/encode/batch.hpp"
+
+namespace btc {
+namespace encode {
+// Bech32 (BIP-173) and Bech32m (BIP-350) differ only in the checksum
+// constant.
+enum Bech32Encoding {
+  kBech32Invalid = 0,
+  kBech32 = 1,
+  kBech32m = 2,
+};  // enum Bech32Encoding
+
+const char *Bech32EncodingToString(Bech32Encoding encoding)
+    __RETURN_NOT_NULL;
+
+constexpr size_t kBech32MaxLength = 90;
+constexpr size_t kBech32ChecksumLength = 6;
+constexpr size_t kBech32MaxValuesLength =
+    kBech32MaxLength - kBech32ChecksumLength - 2;
+
+bool IsBech32Character(char c);
+// Converts a lowercase or uppercase Bech32 character to its 5-bit value.
+uint8_t Bech32CharToValue(char c);
+char ValueToBech32Char(uint8_t v);
+
+// Regroups 8-bit bytes to 5-bit values, padding the last value with
+// zero bits.
+constexpr size_t Bech32ValuesLength(size_t size) {
+  return (size * 8 + 4) / 5;
+}
+bool Bech32BytesToValues(
+    const uint8_t *data, size_t size, uint8_t *values, size_t values_size,
+    size_t *values_length) __NOT_NULL(3, 5);
+// Regroups 5-bit values to 8-bit bytes.  Fails if a value has more than
+// 5 bits, or if the padding is more than 4 bits or not zero.
+bool Bech32ValuesToBytes(
+    const uint8_t *values, size_t values_size, uint8_t *data,
+    size_t data_size, size_t *length) __NOT_NULL(3, 5);
+
+// Encodes |hrp| (human readable part) and 5-bit |values| to a lowercase
+// Bech32 string, without a null terminator.  Returns the number of
+// characters written, or zero if the input is not valid or |b32_size|
+// is too small.
+size_t Bech32Encode(
+    Bech32Encoding encoding, const char *hrp, size_t hrp_size,
+    const uint8_t *values, size_t values_size, char *b32, size_t b32_size)
+    __NOT_NULL(2, 6);
+std::string Bech32Encode(
+    Bech32Encoding encoding, const std::string &hrp,
+    const std::vector<uint8_t> &values);
+
+// A decoded Bech32 string.  Sizes are bounded by kBech32MaxLength, so
+// decoding does not allocate.  |hrp| is lowercase and null terminated.
+struct Bech32Decoded {
+  Bech32Encoding encoding;
+  size_t hrp_length;
+  char hrp[kBech32MaxLength];
+  size_t values_length;
+  uint8_t values[kBech32MaxValuesLength];
+};
+// Decodes and verifies the checksum of |b32|.  Returns the encoding
+// used, or kBech32Invalid if |b32| is not valid Bech32 or Bech32m.
+Bech32Encoding Bech32Decode(
+    const char *b32, size_t b32_size, Bech32Decoded *decoded)
+    __NOT_NULL(1, 3);
+
+// SegWit addresses (BIP-173, BIP-350).  Version 0 programs use Bech32,
+// later versions use Bech32m.
+constexpr uint8_t kSegwitMaxVersion = 16;
+constexpr size_t kSegwitProgramMinLength = 2;
+constexpr size_t kSegwitProgramMaxLength = 40;
+
+// Returns the number of characters written, or zero on failure.
+size_t SegwitAddressEncode(
+    const char *hrp, size_t hrp_size, uint8_t version,
+    const uint8_t *program, size_t program_size, char *address,
+    size_t address_size) __NOT_NULL(1, 4, 6);
+std::string SegwitAddressEncode(
+    const std::string &hrp, uint8_t version,
+    const std::vector<uint8_t> &program);
+// Decodes an address for the network identified by |hrp|.
+// |program| must hold kSegwitProgramMaxLength bytes.
+bool SegwitAddressDecode(
+    const char *hrp, size_t hrp_size, const char *address,
+    size_t address_size, uint8_t *version, uint8_t *program,
+    size_t *program_size) __NOT_NULL(1, 3, 5, 6, 7);
+
+// Batch SegWit address conversions, matching the Base58 batch API.
+// Payload items are the witness version byte followed by the witness
+// program.  Every item gets a fixed size slot in the output arena, see
+// the *ArenaSize() functions.
+size_t SegwitAddressEncodeBatchArenaSize(size_t count);
+size_t SegwitAddressEncodeBatch(
+    const char *hrp, size_t hrp_size, const uint8_t *data,
+    const BatchItem *items, size_t count, char *addresses,
+    size_t addresses_size, BatchItem *results, uint64_t *valid,
+    size_t threads = 1);
+size_t SegwitAddressDecodeBatchArenaSize(size_t count);
+size_t SegwitAddressDecodeBatch(
+    const char *hrp, size_t hrp_size, const char *addresses,
+    const BatchItem *items, size_t count, uint8_t *data, size_t data_size,
+    BatchItem *results, uint64_t *valid, size_t threads = 1);
+}  // namespace encode
+}  // namespace btc
+
+#endif  // _BTC_ENCODE_BECH32_HPP_
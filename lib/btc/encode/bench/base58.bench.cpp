@@ -0,0 +1,108 @@
+// Bitcoin Info - Encoders - Base58 Encoder - Benchmarks
+//
+// Copyright (c) 2022 Alex Dale
+// This project is licensed under the terms of the MIT license.
+// See LICENSE for details.
+#include <vector>
+
+#include "btc/bench/bench.hpp"
+#include "btc/encode/base58.hpp"
+#include "btc/encode/bech32.hpp"
+#include "btc/test/test_data.hpp"
+
+namespace btc {
+namespace encode {
+namespace bench {
+namespace {
+using ::btc::bench::DoNotOptimize;
+using ::btc::bench::State;
+using ::btc::test::MakeTestData;
+
+constexpr size_t kBatchCount = 10000;
+
+void BM_Base58Encode(State *state) {
+  const std::vector<uint8_t> data = MakeTestData(state->size());
+  std::vector<char> b58(Base58EncodedMaxLength(data.size()));
+  while (state->KeepRunning()) {
+    DoNotOptimize(
+        Base58Encode(data.data(), data.size(), b58.data(), b58.size()));
+  }
+  state->SetBytesPerOp(data.size());
+}
+
+void BM_Base58Decode(State *state) {
+  const std::string b58 = Base58Encode(MakeTestData(state->size()));
+  std::vector<uint8_t> data(state->size());
+  while (state->KeepRunning()) {
+    DoNotOptimize(Base58Decode(b58, data.data(), data.size()));
+  }
+  state->SetBytesPerOp(b58.size());
+}
+
+void BM_Base58CheckDecode(State *state) {
+  const std::string b58 = Base58CheckEncode(MakeTestData(state->size()));
+  std::vector<uint8_t> data(state->size());
+  while (state->KeepRunning()) {
+    DoNotOptimize(
+        Base58CheckDecode(b58.data(), b58.size(), data.data(), data.size()));
+  }
+  state->SetBytesPerOp(b58.size());
+}
+
+// |kBatchCount| items of size() bytes per operation.
+void BM_Base58CheckEncodeBatch(State *state) {
+  const std::vector<uint8_t> data = MakeTestData(state->size() * kBatchCount);
+  std::vector<BatchItem> items(kBatchCount);
+  for (size_t i = 0; i < kBatchCount; i++) {
+    items[i] = {i * state->size(), state->size()};
+  }
+  std::vector<char> b58(
+      Base58CheckEncodeBatchArenaSize(items.data(), kBatchCount));
+  std::vector<BatchItem> results(kBatchCount);
+  std::vector<uint64_t> valid(BatchBitmapWords(kBatchCount));
+  while (state->KeepRunning()) {
+    DoNotOptimize(Base58CheckEncodeBatch(
+        data.data(), items.data(), kBatchCount, b58.data(), b58.size(),
+        results.data(), valid.data(), state->threads()));
+  }
+  state->SetItemsPerOp(kBatchCount);
+  state->SetBytesPerOp(data.size());
+}
+
+void BM_SegwitAddressEncode(State *state) {
+  const std::vector<uint8_t> program = MakeTestData(state->size());
+  const uint8_t version = state->size() == 20 ? 0 : 1;
+  char address[kBech32MaxLength];
+  while (state->KeepRunning()) {
+    DoNotOptimize(SegwitAddressEncode(
+        "bc", 2, version, program.data(), program.size(), address,
+        sizeof(address)));
+  }
+  state->SetBytesPerOp(program.size());
+}
+
+void BM_SegwitAddressDecode(State *state) {
+  const uint8_t version = state->size() == 20 ? 0 : 1;
+  const std::string address =
+      SegwitAddressEncode("bc", version, MakeTestData(state->size()));
+  uint8_t decoded_version = 0;
+  uint8_t program[kSegwitProgramMaxLength];
+  size_t program_size = 0;
+  while (state->KeepRunning()) {
+    DoNotOptimize(SegwitAddressDecode(
+        "bc", 2, address.data(), address.size(), &decoded_version, program,
+        &program_size));
+  }
+  state->SetBytesPerOp(address.size());
+}
+}  // namespace
+
+BTC_BENCHMARK(BM_Base58Encode, {25, 32, 82, 256});
+BTC_BENCHMARK(BM_Base58Decode, {25, 32, 82, 256});
+BTC_BENCHMARK(BM_Base58CheckDecode, {21, 78});
+BTC_BENCHMARK(BM_Base58CheckEncodeBatch, {21}, {1, 2, 4});
+BTC_BENCHMARK(BM_SegwitAddressEncode, {20, 32});
+BTC_BENCHMARK(BM_SegwitAddressDecode, {20, 32});
+}  // namespace bench
+}  // namespace encode
+}  // namespace btc
@@ -0,0 +1,57 @@
+// Bitcoin Info - Encoders - Hexadecimal Encoder - Benchmarks
+//
+// Copyright (c) 2022 Alex Dale
+// This project is licensed under the terms of the MIT license.
+// See LICENSE for details.
+#include <vector>
+
+#include "btc/bench/bench.hpp"
+#include "btc/encode/hex.hpp"
+#include "btc/test/test_data.hpp"
+
+namespace btc {
+namespace encode {
+namespace bench {
+namespace {
+using ::btc::bench::DoNotOptimize;
+using ::btc::bench::State;
+using ::btc::test::MakeTestData;
+
+void BM_HexEncode(State *state) {
+  const std::vector<uint8_t> data = MakeTestData(state->size());
+  std::vector<char> hex(HexEncodedLength(data.size()));
+  while (state->KeepRunning()) {
+    DoNotOptimize(HexEncode(data.data(), data.size(), hex.data(), hex.size()));
+  }
+  state->SetBytesPerOp(data.size());
+}
+
+void BM_HexDecode(State *state) {
+  const std::string hex = HexEncode(MakeTestData(state->size()));
+  std::vector<uint8_t> data(state->size());
+  while (state->KeepRunning()) {
+    DoNotOptimize(HexDecode(hex, data.data(), data.size()));
+  }
+  state->SetBytesPerOp(hex.size());
+}
+
+void BM_HexEncodeString(State *state) {
+  const std::vector<uint8_t> data = MakeTestData(state->size());
+  while (state->KeepRunning()) DoNotOptimize(HexEncode(data));
+  state->SetBytesPerOp(data.size());
+}
+
+void BM_IsHexString(State *state) {
+  const std::string hex = HexEncode(MakeTestData(state->size()));
+  while (state->KeepRunning()) DoNotOptimize(IsHexString(hex));
+  state->SetBytesPerOp(hex.size());
+}
+}  // namespace
+
+BTC_BENCHMARK(BM_HexEncode, {32, 1024, 1 << 20});
+BTC_BENCHMARK(BM_HexDecode, {32, 1024, 1 << 20});
+BTC_BENCHMARK(BM_HexEncodeString, {32, 1024});
+BTC_BENCHMARK(BM_IsHexString, {64, 1 << 20});
+}  // namespace bench
+}  // namespace encode
+}  // namespace btc
@@ -13,8 +13,42 @@
 
 namespace btc {
 namespace encode {
+// Implementations of the hexadecimal codec.  The fastest kernel
+// supported by the CPU is selected the first time the codec is used.
+enum HexKernel {
+  // One byte at a time, table lookups.
+  kHexKernelScalar = 0,
+  // Portable SIMD-within-a-register, 8 bytes per step.
+  kHexKernelSwar = 1,
+  // x86 SSSE3, 16 bytes per step.
+  kHexKernelSsse3 = 2,
+  // x86 AVX2, 32 bytes per step.
+  kHexKernelAvx2 = 3,
+};  // enum HexKernel
+
+const char *HexKernelToString(HexKernel kernel) __RETURN_NOT_NULL;
+bool IsHexKernelSupported(HexKernel kernel);
+// Currently active kernel.
+HexKernel GetHexKernel();
+// Overrides the automatically selected kernel.  Intended for testing
+// and benchmarking.  Fails if the kernel is not supported by the CPU.
+bool SetHexKernel(HexKernel kernel);
+
+// Exact output sizes, allows for preallocating buffers.
+constexpr size_t HexEncodedLength(size_t size) {
+  return size * 2;
+}
+constexpr size_t HexDecodedLength(size_t hex_size) {
+  return hex_size / 2;
+}
+
 // Checks if the provided string a correctly formatted hexadecimal string.
 bool IsHexString(const std::string &hex);
+bool IsHexString(const char *hex, size_t hex_size);
+// Returns the offset of the first character of |hex| which is not a
+// hexadecimal digit, or |hex.size()| if all characters are digits.
+size_t FindInvalidHexCharacter(const std::string &hex);
+size_t FindInvalidHexCharacter(const char *hex, size_t hex_size);
 
 // Bytes to Hexadecimal.
 std::string HexEncode(const uint8_t *data, size_t size, bool reverse = false)
@@ -22,15 +56,36 @@ std::string HexEncode(const uint8_t *data, size_t size, bool reverse = false)
 std::string HexEncode(const std::vector<uint8_t> &data, bool reverse = false);
 // Input string is treated as raw bytes.
 std::string HexEncode(const std::string &data, bool reverse = false);
+// Encodes into a caller provided buffer, without a null terminator.
+// Returns the number of characters written, HexEncodedLength(size), or
+// zero if |hex_size| is too small.
+size_t HexEncode(
+    const uint8_t *data, size_t size, char *hex, size_t hex_size,
+    bool reverse = false) __NOT_NULL(1, 3);
+// Appends the encoding to the end of |hex|.
+void HexEncodeAppend(
+    const uint8_t *data, size_t size, std::string *hex, bool reverse = false)
+    __NOT_NULL(1, 3);
 
 // Hexadecimal to bytes.
 // Returns the number of bytes deserialized, or the number of bytes
 // required to decode the whole string.
+// On failure, returns 0 and sets |error_offset| (if provided) to the
+// offset of the first invalid character; the last character for odd
+// length strings.  Validation and conversion is done in a single pass.
 size_t HexDecode(
     const std::string &hex, uint8_t *buffer, size_t buffer_size,
-    bool reverse = false) __NOT_NULL(2);
+    bool reverse = false, size_t *error_offset = nullptr) __NOT_NULL(2);
+size_t HexDecode(
+    const char *hex, size_t hex_size, uint8_t *buffer, size_t buffer_size,
+    bool reverse = false, size_t *error_offset = nullptr) __NOT_NULL(3);
 std::vector<uint8_t> HexDecode(const std::string &hex, bool reverse = false);
 std::string HexDecodeToString(const std::string &hex, bool reverse = false);
+// Appends the decoded bytes to the end of |data|.  On failure, |data|
+// is left unchanged.
+bool HexDecodeAppend(
+    const char *hex, size_t hex_size, std::vector<uint8_t> *data,
+    bool reverse = false) __NOT_NULL(3);
 }  // namespace encode
 }  // namespace btc
 
@@ -0,0 +1,51 @@
+// Bitcoin Info - Encoders - Hexadecimal Kernels
+//
+// Copyright (c) 2022 Alex Dale
+// This project is licensed under the terms of the MIT license.
+// See LICENSE for details.
+#ifndef _BTC_ENCODE_HEX_KERNEL_HPP_
+#define _BTC_ENCODE_HEX_KERNEL_HPP_
+
+#ifndef _BTC_ENCODE_HEX_INTERNAL_
+#  error Header should only be included internally
+#endif  // _BTC_ENCODE_HEX_INTERNAL_
+
+#include "btc/cc/attr.h"
+#include "btc/cc/base.h"
+#include "btc/encode/hex.hpp"
+
+namespace btc {
+namespace encode {
+namespace internal {
+// Encodes |size| bytes of |data| into |size| * 2 characters of |hex|.
+// If |reverse| is set, the bytes are encoded last to first.
+using HexEncodeKernel = void (*)(
+    const uint8_t *data, size_t size, char *hex, bool reverse);
+// Validates and decodes |hex_size| characters of |hex| (must be even)
+// into |hex_size| / 2 bytes of |data|.  If |reverse| is set, the
+// decoded bytes are stored last to first.
+// Returns |hex_size| on success, otherwise the offset of the first
+// character that is not a hexadecimal digit.  The content of |data|
+// is unspecified on failure.
+using HexDecodeKernel = size_t (*)(
+    const char *hex, size_t hex_size, uint8_t *data, bool reverse);
+// Returns |hex_size| if all characters are hexadecimal digits, otherwise
+// the offset of the first which is not.
+using HexValidateKernel = size_t (*)(const char *hex, size_t hex_size);
+
+struct HexKernelTable {
+  HexKernel kernel;
+  HexEncodeKernel encode;
+  HexDecodeKernel decode;
+  HexValidateKernel validate;
+};  // struct HexKernelTable
+
+// Returns null if the |kernel| is not supported by the CPU.
+const HexKernelTable *GetHexKernelTable(HexKernel kernel);
+// Fastest supported kernel.
+const HexKernelTable *SelectHexKernelTable() __RETURN_NOT_NULL;
+}  // namespace internal
+}  // namespace encode
+}  // namespace btc
+
+#endif  // _BTC_ENCODE_HEX_KERNEL_HPP_
@@ -0,0 +1,83 @@
+// Bitcoin Info - Encoders - Hexadecimal Literals
+//
+// Copyright (c) 2022 Alex Dale
+// This project is licensed under the terms of the MIT license.
+// See LICENSE for details.
+#ifndef _BTC_ENCODE_HEX_LITERAL_HPP_
+#define _BTC_ENCODE_HEX_LITERAL_HPP_
+
+#include <array>
+#include <type_traits>
+
+#include "btc/cc/base.h"
+
+namespace btc {
+namespace encode {
+namespace internal {
+constexpr int HexLiteralDigit(char c) {
+  if (c >= '0' && c <= '9') return c - '0';
+  if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+  if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+  return -1;
+}
+
+template<char... kChars>
+struct HexLiteral {
+  static constexpr size_t kHexSize = sizeof...(kChars);
+  static constexpr size_t kSize = kHexSize / 2;
+  // Terminated, so that the empty literal is not a zero length array.
+  static constexpr char kHex[kHexSize + 1] = {kChars..., '\0'};
+
+  static constexpr bool IsValid() {
+    for (size_t i = 0; i < kHexSize; i++) {
+      if (HexLiteralDigit(kHex[i]) < 0) return false;
+    }
+    return true;
+  }
+
+  static constexpr std::array<uint8_t, kSize> Decode(bool reverse) {
+    std::array<uint8_t, kSize> data = {};
+    for (size_t i = 0; i < kSize; i++) {
+      const size_t j = reverse ? kSize - 1 - i : i;
+      data[j] = static_cast<uint8_t>(
+          HexLiteralDigit(kHex[i * 2]) << 4 | HexLiteralDigit(kHex[i * 2 + 1]));
+    }
+    return data;
+  }
+};  // struct HexLiteral
+}  // namespace internal
+
+// Hexadecimal decoded by the compiler, for constants which would
+// otherwise be decoded with HexDecode() at startup.  Digits are
+// checked at compile time.  Uses the GCC string literal operator
+// template extension.
+//
+//   using namespace ::btc::encode::literals;
+//   constexpr auto kMagic = "f9beb4d9"_hex;  // std::array<uint8_t, 4>
+//   // Block and transaction IDs are displayed in reverse byte order.
+//   constexpr Hash256 kGenesisHash(
+//     "000000000019d6689c085ae165831e934ff763ae46a2a6c172b3f1b60a8ce26f"_rhex);
+namespace literals {
+template<typename Char, Char... kChars>
+constexpr std::array<uint8_t, sizeof...(kChars) / 2> operator""_hex() {
+  static_assert(std::is_same<Char, char>::value, "Hex literals must be narrow");
+  using Literal = internal::HexLiteral<kChars...>;
+  static_assert(Literal::kHexSize % 2 == 0, "Odd number of hex digits");
+  static_assert(Literal::IsValid(), "Invalid hex digit");
+  return Literal::Decode(/* reverse = */ false);
+}
+
+// As above, with the bytes in reverse order of the digits.
+template<typename Char, Char... kChars>
+constexpr std::array<uint8_t, sizeof...(kChars) / 2> operator""_rhex() {
+  static_assert(std::is_same<Char, char>::value, "Hex literals must be narrow");
+  using Literal = internal::HexLiteral<kChars...>;
+  static_assert(Literal::kHexSize % 2 == 0, "Odd number of hex digits");
+  static_assert(Literal::IsValid(), "Invalid hex digit");
+  return Literal::Decode(/* reverse = */ true);
+}
+}  // namespace literals
+}  // namespace encode
+}  // namespace btc
+
+#endif  // _BTC_ENCODE_HEX_LITERAL_HPP_
@@ -0,0 +1,109 @@
+// Bitcoin Info - Encoders - Streaming Hexadecimal Encoder
+//
+// Copyright (c) 2022 Alex Dale
+// This project is licensed under the terms of the MIT license.
+// See LICENSE for details.
+#ifndef _BTC_ENCODE_HEX_STREAM_HPP_
+#define _BTC_ENCODE_HEX_STREAM_HPP_
+
+#include <functional>
+#include <memory>
+#include <ostream>
+
+#include "btc/cc/attr.h"
+#include "btc/cc/base.h"
+#include "btc/cc/classy.hpp"
+
+namespace btc {
+namespace encode {
+// Destination for the output of the streaming codecs.
+class StreamSink {
+public:
+  using Callback = std::function<bool(const uint8_t *data, size_t size)>;
+
+  // Writes to a file descriptor, which is not closed by the sink.
+  static std::unique_ptr<StreamSink> FromFd(int fd);
+  // Passes each block of output to |callback|, which returns false to
+  // stop the stream.
+  static std::unique_ptr<StreamSink> FromCallback(Callback callback);
+  // Writes to |stream|, which must outlive the sink.
+  static std::unique_ptr<StreamSink> FromOstream(std::ostream *stream)
+      __NOT_NULL(1);
+
+  BTC_DISALLOW_COPY_AND_MOVE(StreamSink);
+  StreamSink() {}
+  virtual ~StreamSink() {}
+
+  // Writes all of |data|, returns false on failure.
+  virtual bool Write(const uint8_t *data, size_t size) = 0;
+};  // class StreamSink
+
+// Encodes bytes to hexadecimal in chunks of any size, writing the
+// output to a sink through a fixed size working buffer.
+class HexStreamEncoder {
+public:
+  static constexpr size_t kBufferSize = 4096;
+
+  BTC_DISALLOW_COPY_AND_MOVE(HexStreamEncoder);
+  // |sink| must outlive the encoder.
+  explicit HexStreamEncoder(StreamSink *sink) __NOT_NULL(2);
+
+  bool Update(const uint8_t *data, size_t size) __NOT_NULL(2);
+  // Flushes buffered output to the sink.
+  bool Finalize();
+
+  // Number of bytes encoded so far.
+  size_t Count() const { return _count; }
+  bool failed() const { return _failed; }
+
+private:
+  bool Flush();
+
+  StreamSink *_sink;
+  size_t _count = 0;
+  size_t _buffered = 0;
+  bool _failed = false;
+  char _buffer[kBufferSize];
+};  // class HexStreamEncoder
+
+// Decodes hexadecimal in chunks of any size, including chunks which
+// split a byte, writing the output to a sink through a fixed size
+// working buffer.  Once a chunk fails, all later calls fail.
+class HexStreamDecoder {
+public:
+  static constexpr size_t kBufferSize = 4096;
+
+  BTC_DISALLOW_COPY_AND_MOVE(HexStreamDecoder);
+  // |sink| must outlive the decoder.
+  explicit HexStreamDecoder(StreamSink *sink) __NOT_NULL(2);
+
+  bool Update(const char *hex, size_t hex_size) __NOT_NULL(2);
+  // Flushes buffered output to the sink.  Fails if the stream ended on
+  // half a byte.
+  bool Finalize();
+
+  // Number of characters consumed so far.
+  size_t Count() const { return _count; }
+  bool failed() const { return _failed; }
+  // Offset of the first invalid character within the whole stream.
+  // Only meaningful if decoding failed on an invalid character.
+  size_t error_offset() const { return _error_offset; }
+
+private:
+  bool Flush();
+  bool Fail(size_t error_offset);
+
+  StreamSink *_sink;
+  size_t _count = 0;
+  size_t _buffered = 0;
+  size_t _error_offset = 0;
+  bool _failed = false;
+  // High nibble left over from a chunk with an odd number of digits.
+  bool _has_nibble = false;
+  char _nibble = '0';
+  uint8_t _buffer[kBufferSize];
+};  // class HexStreamDecoder
+}  // namespace encode
+}  // namespace btc
+
+#endif  // _BTC_ENCODE_HEX_STREAM_HPP_
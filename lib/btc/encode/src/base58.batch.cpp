@@ -0,0 +1,181 @@
+// Bitcoin Info - Encoders - Base58 Encoder - Batch Conversions
+//
+// Copyright (c) 2022 Alex Dale
+// This project is licensed under the terms of the MIT license.
+// See LICENSE for details.
+#include <algorithm>
+#include <atomic>
+
+#include "btc/cc/debug.h"
+#include "btc/encode/base58.hpp"
+#include "btc/task/parallel.hpp"
+
+namespace btc {
+namespace encode {
+namespace {
+using ::btc::task::ParallelFor;
+
+using SlotLength = size_t (*)(size_t);
+// Converts one item into |output| (of |output_size|), returns false
+// if the item is not valid.
+template<typename InputType, typename OutputType>
+using ItemConverter = bool (*)(
+    const InputType *input, size_t size, OutputType *output,
+    size_t output_size, size_t *length);
+
+// Assigns each item a slot of |slot_length(item.length)| in the output
+// arena.
+void LayoutBatchSlots(
+    const BatchItem *items, size_t count, SlotLength slot_length,
+    BatchItem *results) {
+  size_t offset = 0;
+  for (size_t i = 0; i < count; i++) {
+    results[i].offset = offset;
+    results[i].length = slot_length(items[i].length);
+    offset += results[i].length;
+  }
+}
+
+template<typename InputType, typename OutputType>
+size_t ConvertBatch(
+    const InputType *input, const BatchItem *items, size_t count,
+    OutputType *output, size_t output_size, BatchItem *results,
+    uint64_t *valid, size_t threads, SlotLength slot_length,
+    ItemConverter<InputType, OutputType> converter) {
+  LayoutBatchSlots(items, count, slot_length, results);
+  std::fill_n(valid, BatchBitmapWords(count), 0);
+  std::atomic<size_t> valid_count(0);
+  // Workers own whole bitmap words.
+  ParallelFor(count, threads, [&](size_t begin, size_t end) {
+    size_t local_count = 0;
+    for (size_t i = begin; i < end; i++) {
+      BatchItem &result = results[i];
+      const size_t slot_end = result.offset + result.length;
+      size_t length = 0;
+      const bool ok = slot_end <= output_size && converter(
+          input + items[i].offset, items[i].length, output + result.offset,
+          result.length, &length);
+      result.length = ok ? length : 0;
+      if (!ok) continue;
+      valid[i / kBatchBitmapWordBits] |=
+          uint64_t(1) << (i % kBatchBitmapWordBits);
+      local_count++;
+    }
+    valid_count += local_count;
+  }, kBatchBitmapWordBits);
+  return valid_count.load();
+}
+
+bool EncodeItem(
+    const uint8_t *data, size_t size, char *b58, size_t b58_size,
+    size_t *length) {
+  if (size == 0) {
+    *length = 0;
+    return true;
+  }
+  *length = Base58Encode(data, size, b58, b58_size);
+  return *length > 0;
+}
+
+bool DecodeItem(
+    const char *b58, size_t b58_size, uint8_t *data, size_t data_size,
+    size_t *length) {
+  if (b58_size == 0) {
+    *length = 0;
+    return true;
+  }
+  *length = Base58Decode(b58, b58_size, data, data_size);
+  return *length > 0 && *length <= data_size;
+}
+
+bool CheckEncodeItem(
+    const uint8_t *data, size_t size, char *b58, size_t b58_size,
+    size_t *length) {
+  *length = Base58CheckEncode(data, size, b58, b58_size);
+  return *length > 0;
+}
+
+bool CheckDecodeItem(
+    const char *b58, size_t b58_size, uint8_t *data, size_t data_size,
+    size_t *length) {
+  *length = Base58CheckDecode(b58, b58_size, data, data_size);
+  return *length > 0;
+}
+
+size_t BatchArenaSize(
+    const BatchItem *items, size_t count, SlotLength slot_length) {
+  size_t size = 0;
+  for (size_t i = 0; i < count; i++) size += slot_length(items[i].length);
+  return size;
+}
+}  // namespace
+
+size_t Base58EncodeBatchArenaSize(const BatchItem *items, size_t count) {
+  DASSERT(items != nullptr || count == 0);
+  return BatchArenaSize(items, count, Base58EncodedMaxLength);
+}
+
+size_t Base58EncodeBatch(
+    const uint8_t *data, const BatchItem *items, size_t count,
+    char *b58, size_t b58_size, BatchItem *results, uint64_t *valid,
+    size_t threads) {
+  if (count == 0) return 0;
+  DASSERT(data != nullptr && items != nullptr && b58 != nullptr);
+  DASSERT(results != nullptr && valid != nullptr);
+  return ConvertBatch<uint8_t, char>(
+      data, items, count, b58, b58_size, results, valid, threads,
+      Base58EncodedMaxLength, EncodeItem);
+}
+
+size_t Base58DecodeBatchArenaSize(const BatchItem *items, size_t count) {
+  DASSERT(items != nullptr || count == 0);
+  return BatchArenaSize(items, count, Base58DecodedMaxLength);
+}
+
+size_t Base58DecodeBatch(
+    const char *b58, const BatchItem *items, size_t count,
+    uint8_t *data, size_t data_size, BatchItem *results, uint64_t *valid,
+    size_t threads) {
+  if (count == 0) return 0;
+  DASSERT(b58 != nullptr && items != nullptr && data != nullptr);
+  DASSERT(results != nullptr && valid != nullptr);
+  return ConvertBatch<char, uint8_t>(
+      b58, items, count, data, data_size, results, valid, threads,
+      Base58DecodedMaxLength, DecodeItem);
+}
+
+size_t Base58CheckEncodeBatchArenaSize(const BatchItem *items, size_t count) {
+  DASSERT(items != nullptr || count == 0);
+  return BatchArenaSize(items, count, Base58CheckEncodedMaxLength);
+}
+
+size_t Base58CheckEncodeBatch(
+    const uint8_t *data, const BatchItem *items, size_t count,
+    char *b58, size_t b58_size, BatchItem *results, uint64_t *valid,
+    size_t threads) {
+  if (count == 0) return 0;
+  DASSERT(data != nullptr && items != nullptr && b58 != nullptr);
+  DASSERT(results != nullptr && valid != nullptr);
+  return ConvertBatch<uint8_t, char>(
+      data, items, count, b58, b58_size, results, valid, threads,
+      Base58CheckEncodedMaxLength, CheckEncodeItem);
+}
+
+size_t Base58CheckDecodeBatchArenaSize(const BatchItem *items, size_t count) {
+  DASSERT(items != nullptr || count == 0);
+  return BatchArenaSize(items, count, Base58DecodedMaxLength);
+}
+
+size_t Base58CheckDecodeBatch(
+    const char *b58, const BatchItem *items, size_t count,
+    uint8_t *data, size_t data_size, BatchItem *results, uint64_t *valid,
+    size_t threads) {
+  if (count == 0) return 0;
+  DASSERT(b58 != nullptr && items != nullptr && data != nullptr);
+  DASSERT(results != nullptr && valid != nullptr);
+  return ConvertBatch<char, uint8_t>(
+      b58, items, count, data, data_size, results, valid, threads,
+      Base58DecodedMaxLength, CheckDecodeItem);
+}
+}  // namespace encode
+}  // namespace btc
@@ -0,0 +1,105 @@
+// Bitcoin Info - Encoders - Base58 Encoder - Base58Check
+//
+// Copyright (c) 2022 Alex Dale
+// This project is licensed under the terms of the MIT license.
+// See LICENSE for details.
+#include <algorithm>
+#include <memory>
+
+#include "btc/cc/classy.hpp"
+#include "btc/cc/debug.h"
+#include "btc/crypto/digest.hpp"
+#include "btc/encode/base58.hpp"
+#include "btc/log.h"
+
+namespace btc {
+namespace encode {
+namespace {
+using ::btc::crypto::kSha256DigestLength;
+using ::btc::crypto::Sha256Sha256;
+
+// Scratch space for data and checksum; on the stack for typical
+// payloads (addresses, WIF and extended keys).
+class CheckBuffer {
+public:
+  BTC_DISALLOW_COPY_AND_MOVE(CheckBuffer);
+  explicit CheckBuffer(size_t size):
+      _heap(size > sizeof(_stack) ? new uint8_t[size] : nullptr) {}
+
+  uint8_t *data() { return _heap ? _heap.get() : _stack; }
+
+private:
+  uint8_t _stack[128];
+  std::unique_ptr<uint8_t[]> _heap;
+};  // class CheckBuffer
+
+bool CalculateChecksum(const uint8_t *data, size_t size, uint8_t *checksum) {
+  uint8_t digest[kSha256DigestLength];
+  if (!Sha256Sha256(data, size, digest)) return false;
+  std::copy_n(digest, kBase58CheckChecksumLength, checksum);
+  return true;
+}
+}  // namespace
+
+size_t Base58CheckEncode(
+    const uint8_t *data, size_t size, char *b58, size_t b58_size) {
+  DASSERT(data != nullptr);
+  DASSERT(b58 != nullptr);
+  const size_t check_size = size + kBase58CheckChecksumLength;
+  CheckBuffer buffer(check_size);
+  uint8_t *check_data = buffer.data();
+  std::copy_n(data, size, check_data);
+  if (!CalculateChecksum(data, size, check_data + size)) {
+    LOG_ERROR("Failed to calculate checksum");
+    return 0;
+  }
+  return Base58Encode(check_data, check_size, b58, b58_size);
+}
+
+std::string Base58CheckEncode(const std::vector<uint8_t> &data) {
+  std::string result(Base58CheckEncodedMaxLength(data.size()), '1');
+  const size_t length =
+      Base58CheckEncode(data.data(), data.size(), &result[0], result.size());
+  result.resize(length);
+  return result;
+}
+
+size_t Base58CheckDecode(
+    const char *b58, size_t b58_size, uint8_t *data, size_t data_size) {
+  DASSERT(b58 != nullptr);
+  DASSERT(data != nullptr);
+  if (b58_size == 0) return 0;
+  const size_t max_size = Base58DecodedMaxLength(b58_size);
+  CheckBuffer buffer(max_size);
+  uint8_t *check_data = buffer.data();
+  const size_t check_size = Base58Decode(b58, b58_size, check_data, max_size);
+  if (check_size <= kBase58CheckChecksumLength) return 0;
+  const size_t size = check_size - kBase58CheckChecksumLength;
+  if (size > data_size) return 0;
+  uint8_t checksum[kBase58CheckChecksumLength];
+  if (!CalculateChecksum(check_data, size, checksum)) {
+    LOG_ERROR("Failed to calculate checksum");
+    return 0;
+  }
+  if (!std::equal(
+          checksum, checksum + kBase58CheckChecksumLength,
+          check_data + size)) {
+    return 0;
+  }
+  std::copy_n(check_data, size, data);
+  return size;
+}
+
+std::vector<uint8_t> Base58CheckDecode(const std::string &b58) {
+  std::vector<uint8_t> result(Base58DecodedMaxLength(b58.size()));
+  if (result.empty()) return result;
+  const size_t size =
+      Base58CheckDecode(b58.data(), b58.size(), result.data(), result.size());
+  if (size == 0) {
+    LOG_DEBUG("String is not base58check encoded");
+  }
+  result.resize(size);
+  return result;
+}
+}  // namespace encode
+}  // namespace btc
@@ -7,12 +7,13 @@
 
 #include "btc/encode/base58.hpp"
 
+#define _BTC_ENCODE_BASE58_INTERNAL_
+#include "btc/encode/base58.kernel.hpp"
+#undef _BTC_ENCODE_BASE58_INTERNAL_
+
 namespace btc {
 namespace encode {
-namespace {
-const char kBase58CharSet[] =
-    "123456789ABCDEFGHJKLMNPQRSTUVWXYZabcdefghijkmnopqrstuvwxyz";
-}  // namespace
+using internal::kBase58CharSet;
 
 bool IsBase58Character(char c) {
   if (c >= '1' && c <= '9') return true;
@@ -55,8 +56,12 @@ char ValueToBase58Char(uint8_t v) {
 }
 
 bool IsBase58String(const std::string &b58) {
-  if (b58.empty()) return true;
-  return std::all_of(b58.begin(), b58.end(), IsBase58Character);
+  return IsBase58String(b58.data(), b58.size());
+}
+
+bool IsBase58String(const char *b58, size_t b58_size) {
+  if (b58_size == 0) return true;
+  return std::all_of(b58, b58 + b58_size, IsBase58Character);
 }
 }  // namespace encode
 }  // namespace btc
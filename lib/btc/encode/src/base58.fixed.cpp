@@ -0,0 +1,187 @@
+// Bitcoin Info - Encoders - Fixed Length Base58 Encoder
+//
+// Copyright (c) 2022 Alex Dale
+// This project is licensed under the terms of the MIT license.
+// See LICENSE for details.
+#include <algorithm>
+
+#include "btc/cc/debug.h"
+#include "btc/encode/base58.fixed.hpp"
+
+#define _BTC_ENCODE_BASE58_INTERNAL_
+#include "btc/encode/base58.kernel.hpp"
+#undef _BTC_ENCODE_BASE58_INTERNAL_
+
+namespace btc {
+namespace encode {
+using internal::kBase58CharSet;
+using internal::kBase58LimbRadix;
+using internal::kBase58Powers;
+using internal::kBase58Radix;
+using internal::kBase58Values;
+using internal::kDigitsPerLimb;
+using internal::kInvalidBase58Value;
+
+namespace {
+// Number of base 58^5 limbs which can be non-zero after |bits| bits
+// of input.  log2(58^5) ~= 29.28996
+constexpr size_t ActiveBase58Limbs(size_t bits, size_t limb_count) {
+  const size_t limbs = bits * 1000 / 29289 + 1;
+  return limbs < limb_count ? limbs : limb_count;
+}
+}  // namespace
+
+template<size_t kSize>
+size_t Base58Fixed<kSize>::Encode(const uint8_t *data, EncodedArray *b58) {
+  DASSERT(data != nullptr);
+  DASSERT(b58 != nullptr);
+  constexpr size_t kHead = kSize % 4;
+  constexpr size_t kWords = kSize / 4;
+  constexpr size_t kLimbs = kMaxEncodedLength / kDigitsPerLimb + 1;
+  constexpr size_t kDigits = kLimbs * kDigitsPerLimb;
+
+  // Horner's method, 32 bits at a time.  Loop bounds are constant once
+  // unrolled, so only the limbs which may be non-zero are updated.
+  uint32_t limbs[kLimbs] = {};
+  if (kHead != 0) {
+    uint32_t word = 0;
+    for (size_t i = 0; i < kHead; i++) word = (word << 8) | data[i];
+    limbs[0] = static_cast<uint32_t>(word % kBase58LimbRadix);
+    limbs[1] = static_cast<uint32_t>(word / kBase58LimbRadix);
+  }
+#pragma GCC unroll 32
+  for (size_t w = 0; w < kWords; w++) {
+    const uint8_t *bytes = data + kHead + w * 4;
+    uint64_t carry = (static_cast<uint32_t>(bytes[0]) << 24)
+                   | (static_cast<uint32_t>(bytes[1]) << 16)
+                   | (static_cast<uint32_t>(bytes[2]) << 8)
+                   | static_cast<uint32_t>(bytes[3]);
+    const size_t active = ActiveBase58Limbs(8 * kHead + 32 * (w + 1), kLimbs);
+#pragma GCC unroll 32
+    for (size_t l = 0; l < active; l++) {
+      const uint64_t x = (static_cast<uint64_t>(limbs[l]) << 32) + carry;
+      limbs[l] = static_cast<uint32_t>(x % kBase58LimbRadix);
+      carry = x / kBase58LimbRadix;
+    }
+    DASSERT(carry == 0);
+  }
+
+  // Expand to digits, most significant first.
+  uint8_t digits[kDigits];
+#pragma GCC unroll 32
+  for (size_t l = 0; l < kLimbs; l++) {
+    uint32_t limb = limbs[kLimbs - l - 1];
+#pragma GCC unroll 5
+    for (size_t d = kDigitsPerLimb; d > 0; d--) {
+      digits[l * kDigitsPerLimb + d - 1] =
+          static_cast<uint8_t>(limb % kBase58Radix);
+      limb /= kBase58Radix;
+    }
+  }
+  size_t skip = 0;
+  while (skip < kDigits && digits[skip] == 0) skip++;
+  size_t leading_zeros = 0;
+  while (leading_zeros < kSize && data[leading_zeros] == 0) leading_zeros++;
+
+  const size_t length = leading_zeros + (kDigits - skip);
+  DASSERT(length <= kMaxEncodedLength);
+  char *out = b58->data();
+  std::fill_n(out, leading_zeros, '1');
+  for (size_t d = skip; d < kDigits; d++) {
+    out[leading_zeros + d - skip] = kBase58CharSet[digits[d]];
+  }
+  return length;
+}
+
+template<size_t kSize>
+bool Base58Fixed<kSize>::Decode(
+    const char *b58, size_t b58_size, DecodedArray *data) {
+  DASSERT(b58 != nullptr);
+  DASSERT(data != nullptr);
+  constexpr size_t kHead = kSize % 4;
+  constexpr size_t kWords = (kSize + 3) / 4;
+  if (b58_size == 0 || b58_size > kMaxEncodedLength) return false;
+
+  // Horner's method, 5 digits at a time, with one extra limb to detect
+  // values which are too large.
+  uint32_t limbs[kWords + 1] = {};
+  size_t chunk = b58_size % kDigitsPerLimb;
+  if (chunk == 0) chunk = kDigitsPerLimb;
+  for (size_t i = 0; i < b58_size; chunk = kDigitsPerLimb) {
+    uint32_t value = 0;
+    for (const size_t end = i + chunk; i < end; i++) {
+      const uint8_t digit = kBase58Values.values[static_cast<uint8_t>(b58[i])];
+      if (digit == kInvalidBase58Value) return false;
+      value = value * kBase58Radix + digit;
+    }
+    uint64_t carry = value;
+#pragma GCC unroll 32
+    for (size_t l = 0; l < kWords + 1; l++) {
+      const uint64_t x =
+          static_cast<uint64_t>(limbs[l]) * kBase58Powers[chunk] + carry;
+      limbs[l] = static_cast<uint32_t>(x);
+      carry = x >> 32;
+    }
+    if (carry != 0) return false;
+  }
+  if (limbs[kWords] != 0) return false;
+  if (kHead != 0 && (limbs[kWords - 1] >> (8 * kHead)) != 0) return false;
+
+  // Write out big-endian.
+  uint8_t *out = data->data();
+#pragma GCC unroll 32
+  for (size_t i = 0; i < kSize; i++) {
+    const size_t byte = kSize - i - 1;
+    out[i] = static_cast<uint8_t>(limbs[byte / 4] >> (8 * (byte % 4)));
+  }
+  // Each leading '1' must match exactly one leading zero byte.
+  size_t leading_ones = 0;
+  while (leading_ones < b58_size && b58[leading_ones] == '1') leading_ones++;
+  size_t leading_zeros = 0;
+  while (leading_zeros < kSize && out[leading_zeros] == 0) leading_zeros++;
+  return leading_ones == leading_zeros;
+}
+
+template class Base58Fixed<25>;
+template class Base58Fixed<32>;
+template class Base58Fixed<37>;
+template class Base58Fixed<38>;
+template class Base58Fixed<82>;
+
+namespace internal {
+namespace {
+template<size_t kSize>
+size_t EncodeFixed(const uint8_t *data, char *b58, size_t b58_size) {
+  typename Base58Fixed<kSize>::EncodedArray encoded;
+  const size_t length = Base58Fixed<kSize>::Encode(data, &encoded);
+  if (length > b58_size) return 0;
+  std::copy_n(encoded.begin(), length, b58);
+  return length;
+}
+}  // namespace
+
+bool Base58EncodeFixedSize(
+    const uint8_t *data, size_t size, char *b58, size_t b58_size,
+    size_t *length) {
+  switch (size) {
+    case 25:
+      *length = EncodeFixed<25>(data, b58, b58_size);
+      return true;
+    case 32:
+      *length = EncodeFixed<32>(data, b58, b58_size);
+      return true;
+    case 37:
+      *length = EncodeFixed<37>(data, b58, b58_size);
+      return true;
+    case 38:
+      *length = EncodeFixed<38>(data, b58, b58_size);
+      return true;
+    case 82:
+      *length = EncodeFixed<82>(data, b58, b58_size);
+      return true;
+  }
+  return false;
+}
+}  // namespace internal
+}  // namespace encode
+}  // namespace btc
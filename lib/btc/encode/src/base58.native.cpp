@@ -0,0 +1,313 @@
+// Bitcoin Info - Encoders - Native Base58 Encoder
+//
+// Copyright (c) 2022 Alex Dale
+// This project is licensed under the terms of the MIT license.
+// See LICENSE for details.
+#include <algorithm>
+#include <memory>
+
+#include "btc/cc/classy.hpp"
+#include "btc/cc/debug.h"
+#include "btc/encode/base58.fixed.hpp"
+#include "btc/encode/base58.hpp"
+#include "btc/log.h"
+
+#define _BTC_ENCODE_BASE58_INTERNAL_
+#include "btc/encode/base58.kernel.hpp"
+#undef _BTC_ENCODE_BASE58_INTERNAL_
+
+namespace btc {
+namespace encode {
+using internal::kBase58CharSet;
+using internal::kBase58LimbRadix;
+using internal::kBase58Powers;
+using internal::kBase58Radix;
+using internal::kBase58Values;
+using internal::kDigitsPerLimb;
+using internal::kInvalidBase58Value;
+
+namespace {
+// Inputs up to this many limbs (about 2KB of input) are converted
+// without any heap allocation.
+constexpr size_t kStackLimbCount = 512;
+
+// Scratch space for limbs, on the stack unless too large.
+class LimbBuffer {
+public:
+  BTC_DISALLOW_COPY_AND_MOVE(LimbBuffer);
+  explicit LimbBuffer(size_t count) {
+    if (count > kStackLimbCount) {
+      _heap.reset(new uint32_t[count]);
+      _limbs = _heap.get();
+    }
+  }
+
+  uint32_t *limbs() { return _limbs; }
+
+private:
+  uint32_t _stack[kStackLimbCount];
+  std::unique_ptr<uint32_t[]> _heap = nullptr;
+  uint32_t *_limbs = _stack;
+};  // class LimbBuffer
+
+// Number of base 58^5 limbs needed to hold |size| bytes.
+constexpr size_t Base58LimbCount(size_t size) {
+  return Base58EncodedMaxLength(size) / kDigitsPerLimb + 1;
+}
+
+// Number of base 2^32 limbs needed to hold |b58_size| digits.
+constexpr size_t BinaryLimbCount(size_t b58_size) {
+  return b58_size / 4 + 1;
+}
+
+// |limbs| (least significant first) = |limbs| * 2^|bits| + |value|.
+// Returns the new number of used limbs.
+inline size_t Base58MultiplyAdd(
+    uint32_t *limbs, size_t used, unsigned bits, uint32_t value) {
+  uint64_t carry = value;
+  for (size_t i = 0; i < used; i++) {
+    const uint64_t x = (static_cast<uint64_t>(limbs[i]) << bits) + carry;
+    limbs[i] = static_cast<uint32_t>(x % kBase58LimbRadix);
+    carry = x / kBase58LimbRadix;
+  }
+  while (carry != 0) {
+    limbs[used++] = static_cast<uint32_t>(carry % kBase58LimbRadix);
+    carry /= kBase58LimbRadix;
+  }
+  return used;
+}
+
+// |limbs| (least significant first) = |limbs| * |multiplier| + |value|.
+// Returns the new number of used limbs.
+inline size_t BinaryMultiplyAdd(
+    uint32_t *limbs, size_t used, uint32_t multiplier, uint32_t value) {
+  uint64_t carry = value;
+  for (size_t i = 0; i < used; i++) {
+    const uint64_t x = static_cast<uint64_t>(limbs[i]) * multiplier + carry;
+    limbs[i] = static_cast<uint32_t>(x);
+    carry = x >> 32;
+  }
+  if (carry != 0) limbs[used++] = static_cast<uint32_t>(carry);
+  return used;
+}
+
+// Converts |data| to Base58 characters.  If |b58| is null, only the
+// length of the encoding is computed.
+// Returns the length of the encoding, or 0 if |b58_size| is too small.
+size_t Base58EncodeInternal(
+    const uint8_t *data, size_t size, char *b58, size_t b58_size) {
+  DASSERT(data != nullptr);
+  DASSERT(size > 0);
+  size_t fixed_length = 0;
+  if (b58 != nullptr && internal::Base58EncodeFixedSize(
+          data, size, b58, b58_size, &fixed_length)) {
+    return fixed_length;
+  }
+  size_t leading_zeros = 0;
+  while (leading_zeros < size && data[leading_zeros] == 0) leading_zeros++;
+  if (b58 != nullptr && b58_size < leading_zeros) return 0;
+  if (leading_zeros == size) {
+    if (b58 != nullptr) std::fill_n(b58, size, '1');
+    return size;
+  }
+
+  // Convert 32 bits at a time, starting with the partial word so that
+  // the rest are aligned.
+  const uint8_t *value = data + leading_zeros;
+  const size_t value_size = size - leading_zeros;
+  LimbBuffer buffer(Base58LimbCount(value_size));
+  uint32_t *limbs = buffer.limbs();
+  size_t used = 0;
+  const size_t head = value_size % 4;
+  size_t i = 0;
+  if (head != 0) {
+    uint32_t word = 0;
+    for (; i < head; i++) word = (word << 8) | value[i];
+    used = Base58MultiplyAdd(limbs, used, 8 * head, word);
+  }
+  for (; i < value_size; i += 4) {
+    const uint32_t word = (static_cast<uint32_t>(value[i]) << 24)
+                        | (static_cast<uint32_t>(value[i + 1]) << 16)
+                        | (static_cast<uint32_t>(value[i + 2]) << 8)
+                        | static_cast<uint32_t>(value[i + 3]);
+    used = Base58MultiplyAdd(limbs, used, 32, word);
+  }
+  DASSERT(used > 0);
+
+  // Most significant limb may have fewer than five digits.
+  size_t top_digits = 0;
+  for (uint32_t top = limbs[used - 1]; top != 0; top /= kBase58Radix) {
+    top_digits++;
+  }
+  const size_t length =
+      leading_zeros + top_digits + (used - 1) * kDigitsPerLimb;
+  if (b58 == nullptr) return length;
+  if (b58_size < length) return 0;
+
+  std::fill_n(b58, leading_zeros, '1');
+  // Write digits from the end, least significant first.
+  char *out = b58 + length;
+  for (size_t l = 0; l < used; l++) {
+    uint32_t limb = limbs[l];
+    const size_t digits = (l + 1 == used) ? top_digits : kDigitsPerLimb;
+    for (size_t d = 0; d < digits; d++) {
+      *--out = kBase58CharSet[limb % kBase58Radix];
+      limb /= kBase58Radix;
+    }
+  }
+  DASSERT(out == b58 + leading_zeros);
+  return length;
+}
+
+// Converts |b58| to bytes.  If |buffer| is null, only the length of the
+// decoded value is computed.  If |buffer_size| is too small, the output
+// is truncated.
+// Returns the length of the decoded value, or 0 if |b58| is not Base58.
+size_t Base58DecodeInternal(
+    const char *b58, size_t b58_size, uint8_t *buffer, size_t buffer_size) {
+  DASSERT(b58 != nullptr);
+  DASSERT(b58_size > 0);
+  size_t leading_zeros = 0;
+  while (leading_zeros < b58_size && b58[leading_zeros] == '1')
+    leading_zeros++;
+
+  // Convert five digits at a time, starting with the partial chunk.
+  const char *digits = b58 + leading_zeros;
+  const size_t digit_count = b58_size - leading_zeros;
+  LimbBuffer limb_buffer(BinaryLimbCount(digit_count));
+  uint32_t *limbs = limb_buffer.limbs();
+  size_t used = 0;
+  size_t i = 0;
+  size_t chunk = digit_count % kDigitsPerLimb;
+  if (chunk == 0) chunk = kDigitsPerLimb;
+  while (i < digit_count) {
+    uint32_t value = 0;
+    for (size_t end = i + chunk; i < end; i++) {
+      const uint8_t digit =
+          kBase58Values.values[static_cast<uint8_t>(digits[i])];
+      if (digit == kInvalidBase58Value) return 0;
+      value = value * kBase58Radix + digit;
+    }
+    used = BinaryMultiplyAdd(limbs, used, kBase58Powers[chunk], value);
+    chunk = kDigitsPerLimb;
+  }
+
+  // Most significant limb may have fewer than four bytes.
+  size_t top_bytes = 0;
+  if (used > 0) {
+    for (uint32_t top = limbs[used - 1]; top != 0; top >>= 8) top_bytes++;
+  }
+  const size_t value_length = used > 0 ? top_bytes + (used - 1) * 4 : 0;
+  const size_t length = leading_zeros + value_length;
+  if (buffer == nullptr) return length;
+
+  // Write bytes most significant first, stopping at |buffer_size|.
+  size_t o = 0;
+  for (; o < leading_zeros && o < buffer_size; o++) buffer[o] = 0;
+  for (size_t l = used; l > 0 && o < buffer_size; l--) {
+    const uint32_t limb = limbs[l - 1];
+    for (size_t b = (l == used) ? top_bytes : 4; b > 0 && o < buffer_size;
+         b--) {
+      buffer[o++] = static_cast<uint8_t>(limb >> (8 * (b - 1)));
+    }
+  }
+  return length;
+}
+}  // namespace
+
+// == Encoding ==
+
+size_t Base58EncodedLength(const uint8_t *data, size_t size) {
+  DASSERT(data != nullptr);
+  if (size == 0) return 0;
+  return Base58EncodeInternal(data, size, nullptr, 0);
+}
+
+std::string Base58Encode(const uint8_t *data, size_t size) {
+  DASSERT(data != nullptr);
+  if (size == 0) return "";
+  std::string result(Base58EncodedMaxLength(size), '1');
+  const size_t length =
+      Base58EncodeInternal(data, size, &result.front(), result.size());
+  result.resize(length);
+  return result;
+}
+
+std::string Base58Encode(const std::vector<uint8_t> &data) {
+  if (data.empty()) return "";
+  return Base58Encode(data.data(), data.size());
+}
+
+std::string Base58Encode(const std::string &data) {
+  if (data.empty()) return "";
+  return Base58Encode(
+      reinterpret_cast<const uint8_t *>(data.data()), data.size());
+}
+
+size_t Base58Encode(
+    const uint8_t *data, size_t size, char *b58, size_t b58_size) {
+  DASSERT(data != nullptr);
+  DASSERT(b58 != nullptr);
+  if (size == 0) return 0;
+  return Base58EncodeInternal(data, size, b58, b58_size);
+}
+
+bool Base58EncodeAppend(const uint8_t *data, size_t size, std::string *b58) {
+  DASSERT(data != nullptr);
+  DASSERT(b58 != nullptr);
+  if (size == 0) return true;
+  const size_t offset = b58->size();
+  b58->resize(offset + Base58EncodedMaxLength(size));
+  const size_t length = Base58EncodeInternal(
+      data, size, &(*b58)[offset], Base58EncodedMaxLength(size));
+  b58->resize(offset + length);
+  return length > 0;
+}
+
+// == Decoding ==
+
+size_t Base58DecodedLength(const char *b58, size_t b58_size) {
+  DASSERT(b58 != nullptr);
+  if (b58_size == 0) return 0;
+  return Base58DecodeInternal(b58, b58_size, nullptr, 0);
+}
+
+size_t Base58Decode(
+    const std::string &b58, uint8_t *buffer, size_t buffer_size) {
+  return Base58Decode(b58.data(), b58.size(), buffer, buffer_size);
+}
+
+size_t Base58Decode(
+    const char *b58, size_t b58_size, uint8_t *buffer, size_t buffer_size) {
+  DASSERT(buffer != nullptr);
+  if (b58_size == 0) return 0;
+  return Base58DecodeInternal(b58, b58_size, buffer, buffer_size);
+}
+
+std::vector<uint8_t> Base58Decode(const std::string &b58) {
+  std::vector<uint8_t> result;
+  if (!Base58DecodeAppend(b58.data(), b58.size(), &result)) {
+    LOG_DEBUG("String is not base58 encoded");
+  }
+  return result;
+}
+
+std::string Base58DecodeToString(const std::string &b58) {
+  const std::vector<uint8_t> res = Base58Decode(b58);
+  if (res.empty()) return "";
+  return std::string(res.begin(), res.end());
+}
+
+bool Base58DecodeAppend(
+    const char *b58, size_t b58_size, std::vector<uint8_t> *data) {
+  DASSERT(data != nullptr);
+  if (b58_size == 0) return true;
+  const size_t offset = data->size();
+  data->resize(offset + Base58DecodedMaxLength(b58_size));
+  const size_t length = Base58DecodeInternal(
+      b58, b58_size, data->data() + offset, Base58DecodedMaxLength(b58_size));
+  data->resize(offset + length);
+  return length > 0;
+}
+}  // namespace encode
+}  // namespace btc
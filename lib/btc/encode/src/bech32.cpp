@@ -0,0 +1,439 @@
+// Bitcoin Info - Encoders - Bech32 Encoder
+//
+// Copyright (c) 2022 Alex Dale
+// This project is licensed under the terms of the MIT license.
+// See LICENSE for details.
+#include <algorithm>
+#include <atomic>
+
+#include "btc/cc/debug.h"
+#include "btc/encode/bech32.hpp"
+#include "btc/task/parallel.hpp"
+
+namespace btc {
+namespace encode {
+namespace {
+using ::btc::task::ParallelFor;
+
+const char kBech32CharSet[] = "qpzry9x8gf2tvdw0s3jn54khce6mua7l";
+constexpr uint8_t kInvalidBech32Value = 0xff;
+constexpr char kBech32Separator = '1';
+constexpr size_t kBech32MaxHrpLength = 83;
+
+constexpr uint32_t kBech32Constant = 1;
+constexpr uint32_t kBech32mConstant = 0x2bc830a3;
+
+struct Bech32ValueTable {
+  uint8_t values[256];
+};
+
+constexpr Bech32ValueTable MakeBech32ValueTable() {
+  Bech32ValueTable table = {};
+  for (size_t c = 0; c < 256; c++) table.values[c] = kInvalidBech32Value;
+  for (uint8_t v = 0; v < 32; v++) {
+    const char c = kBech32CharSet[v];
+    table.values[static_cast<uint8_t>(c)] = v;
+    if (c >= 'a' && c <= 'z') {
+      table.values[static_cast<uint8_t>(c - 'a' + 'A')] = v;
+    }
+  }
+  return table;
+}
+
+constexpr Bech32ValueTable kBech32Values = MakeBech32ValueTable();
+
+// == Checksum ==
+//
+// The BCH checksum is a polynomial remainder over GF(32).  The
+// reference implementation feeds one 5-bit value at a time and XORs in
+// a generator for each of the top 5 bits.  The step is linear, so two
+// steps are combined into one lookup on the top 10 bits.
+
+constexpr uint32_t kPolymodGenerators[5] = {
+    0x3b6a57b2, 0x26508e6d, 0x1ea119fa, 0x3d4233dd, 0x2a1462b3};
+
+constexpr uint32_t PolymodStep(uint32_t chk, uint8_t value) {
+  const uint32_t top = chk >> 25;
+  chk = ((chk & 0x1ffffff) << 5) ^ value;
+  for (size_t i = 0; i < 5; i++) {
+    if ((top >> i) & 1) chk ^= kPolymodGenerators[i];
+  }
+  return chk;
+}
+
+struct PolymodTable {
+  uint32_t values[1024];
+};
+
+constexpr PolymodTable MakePolymodTable() {
+  PolymodTable table = {};
+  for (uint32_t top = 0; top < 1024; top++) {
+    table.values[top] = PolymodStep(PolymodStep(top << 20, 0), 0);
+  }
+  return table;
+}
+
+constexpr PolymodTable kPolymodTable = MakePolymodTable();
+
+class Polymod {
+public:
+  // Feeds two values at once.
+  void Update(uint8_t high, uint8_t low) {
+    _chk = ((_chk & 0xfffff) << 10) ^ (static_cast<uint32_t>(high) << 5)
+         ^ low ^ kPolymodTable.values[_chk >> 20];
+  }
+  void Update(uint8_t value) { _chk = PolymodStep(_chk, value); }
+  void Update(const uint8_t *values, size_t size) {
+    size_t i = 0;
+    for (; i + 2 <= size; i += 2) Update(values[i], values[i + 1]);
+    if (i < size) Update(values[i]);
+  }
+  // Expanded human readable part: high bits, zero, then low bits.
+  void UpdateHrp(const char *hrp, size_t hrp_size) {
+    for (size_t i = 0; i < hrp_size; i++) {
+      Update(static_cast<uint8_t>(hrp[i]) >> 5);
+    }
+    Update(0);
+    for (size_t i = 0; i < hrp_size; i++) {
+      Update(static_cast<uint8_t>(hrp[i]) & 31);
+    }
+  }
+  uint32_t value() const { return _chk; }
+
+private:
+  uint32_t _chk = 1;
+};  // class Polymod
+
+uint32_t EncodingConstant(Bech32Encoding encoding) {
+  return encoding == kBech32m ? kBech32mConstant : kBech32Constant;
+}
+
+char ToLower(char c) {
+  return (c >= 'A' && c <= 'Z') ? static_cast<char>(c - 'A' + 'a') : c;
+}
+
+bool IsValidHrp(const char *hrp, size_t hrp_size) {
+  if (hrp_size == 0 || hrp_size > kBech32MaxHrpLength) return false;
+  for (size_t i = 0; i < hrp_size; i++) {
+    if (hrp[i] < 33 || hrp[i] > 126) return false;
+    if (hrp[i] >= 'A' && hrp[i] <= 'Z') return false;
+  }
+  return true;
+}
+
+bool IsValidSegwitProgram(uint8_t version, size_t program_size) {
+  if (version > kSegwitMaxVersion) return false;
+  if (program_size < kSegwitProgramMinLength ||
+      program_size > kSegwitProgramMaxLength) {
+    return false;
+  }
+  // Version 0 is either P2WPKH or P2WSH.
+  return version != 0 || program_size == 20 || program_size == 32;
+}
+}  // namespace
+
+const char *Bech32EncodingToString(Bech32Encoding encoding) {
+  switch (encoding) {
+    case kBech32Invalid:
+      return "invalid";
+    case kBech32:
+      return "bech32";
+    case kBech32m:
+      return "bech32m";
+  }
+  return "unknown";
+}
+
+bool IsBech32Character(char c) {
+  return kBech32Values.values[static_cast<uint8_t>(c)] != kInvalidBech32Value;
+}
+
+uint8_t Bech32CharToValue(char c) {
+  return kBech32Values.values[static_cast<uint8_t>(c)];
+}
+
+char ValueToBech32Char(uint8_t v) {
+  DASSERT(v < 32);
+  return kBech32CharSet[v & 31];
+}
+
+// == Regrouping ==
+
+bool Bech32BytesToValues(
+    const uint8_t *data, size_t size, uint8_t *values, size_t values_size,
+    size_t *values_length) {
+  DASSERT(data != nullptr || size == 0);
+  const size_t length = Bech32ValuesLength(size);
+  if (length > values_size) return false;
+  uint32_t acc = 0;
+  size_t bits = 0;
+  size_t o = 0;
+  for (size_t i = 0; i < size; i++) {
+    acc = (acc << 8) | data[i];
+    bits += 8;
+    while (bits >= 5) {
+      bits -= 5;
+      values[o++] = (acc >> bits) & 31;
+    }
+  }
+  if (bits > 0) values[o++] = (acc << (5 - bits)) & 31;
+  DASSERT(o == length);
+  *values_length = length;
+  return true;
+}
+
+bool Bech32ValuesToBytes(
+    const uint8_t *values, size_t values_size, uint8_t *data,
+    size_t data_size, size_t *length) {
+  DASSERT(values != nullptr || values_size == 0);
+  if (values_size * 5 / 8 > data_size) return false;
+  uint32_t acc = 0;
+  size_t bits = 0;
+  size_t o = 0;
+  for (size_t i = 0; i < values_size; i++) {
+    if (values[i] >> 5) return false;
+    acc = (acc << 5) | values[i];
+    bits += 5;
+    if (bits >= 8) {
+      bits -= 8;
+      data[o++] = static_cast<uint8_t>(acc >> bits);
+    }
+  }
+  if (bits >= 5 || ((acc << (8 - bits)) & 0xff) != 0) return false;
+  *length = o;
+  return true;
+}
+
+// == Bech32 ==
+
+size_t Bech32Encode(
+    Bech32Encoding encoding, const char *hrp, size_t hrp_size,
+    const uint8_t *values, size_t values_size, char *b32, size_t b32_size) {
+  DASSERT(hrp != nullptr);
+  DASSERT(values != nullptr || values_size == 0);
+  DASSERT(b32 != nullptr);
+  if (encoding != kBech32 && encoding != kBech32m) return 0;
+  if (!IsValidHrp(hrp, hrp_size)) return 0;
+  const size_t length = hrp_size + 1 + values_size + kBech32ChecksumLength;
+  if (length > kBech32MaxLength || length > b32_size) return 0;
+
+  Polymod polymod;
+  polymod.UpdateHrp(hrp, hrp_size);
+  char *out = std::copy_n(hrp, hrp_size, b32);
+  *out++ = kBech32Separator;
+  for (size_t i = 0; i < values_size; i++) {
+    if (values[i] >> 5) return 0;
+    out[i] = kBech32CharSet[values[i]];
+  }
+  out += values_size;
+  polymod.Update(values, values_size);
+  const uint8_t zeros[kBech32ChecksumLength] = {};
+  polymod.Update(zeros, kBech32ChecksumLength);
+  const uint32_t checksum = polymod.value() ^ EncodingConstant(encoding);
+  for (size_t i = 0; i < kBech32ChecksumLength; i++) {
+    out[i] = kBech32CharSet[(checksum >> (5 * (5 - i))) & 31];
+  }
+  return length;
+}
+
+std::string Bech32Encode(
+    Bech32Encoding encoding, const std::string &hrp,
+    const std::vector<uint8_t> &values) {
+  char b32[kBech32MaxLength];
+  const size_t length = Bech32Encode(
+      encoding, hrp.data(), hrp.size(), values.data(), values.size(), b32,
+      sizeof(b32));
+  return std::string(b32, length);
+}
+
+Bech32Encoding Bech32Decode(
+    const char *b32, size_t b32_size, Bech32Decoded *decoded) {
+  DASSERT(b32 != nullptr);
+  DASSERT(decoded != nullptr);
+  decoded->encoding = kBech32Invalid;
+  if (b32_size > kBech32MaxLength) return kBech32Invalid;
+  // Must be all lowercase or all uppercase.
+  bool has_lower = false;
+  bool has_upper = false;
+  for (size_t i = 0; i < b32_size; i++) {
+    if (b32[i] < 33 || b32[i] > 126) return kBech32Invalid;
+    has_lower |= (b32[i] >= 'a' && b32[i] <= 'z');
+    has_upper |= (b32[i] >= 'A' && b32[i] <= 'Z');
+  }
+  if (has_lower && has_upper) return kBech32Invalid;
+  // Separator is the last '1'.
+  size_t separator = b32_size;
+  while (separator > 0 && b32[separator - 1] != kBech32Separator) {
+    separator--;
+  }
+  if (separator <= 1) return kBech32Invalid;
+  const size_t hrp_size = separator - 1;
+  const size_t data_size = b32_size - separator;
+  if (data_size < kBech32ChecksumLength) return kBech32Invalid;
+
+  for (size_t i = 0; i < hrp_size; i++) decoded->hrp[i] = ToLower(b32[i]);
+  decoded->hrp[hrp_size] = '\0';
+  decoded->hrp_length = hrp_size;
+  uint8_t values[kBech32MaxLength];
+  for (size_t i = 0; i < data_size; i++) {
+    values[i] = kBech32Values.values[static_cast<uint8_t>(b32[separator + i])];
+    if (values[i] == kInvalidBech32Value) return kBech32Invalid;
+  }
+
+  Polymod polymod;
+  polymod.UpdateHrp(decoded->hrp, hrp_size);
+  polymod.Update(values, data_size);
+  Bech32Encoding encoding = kBech32Invalid;
+  if (polymod.value() == kBech32Constant) {
+    encoding = kBech32;
+  } else if (polymod.value() == kBech32mConstant) {
+    encoding = kBech32m;
+  } else {
+    return kBech32Invalid;
+  }
+  decoded->values_length = data_size - kBech32ChecksumLength;
+  std::copy_n(values, decoded->values_length, decoded->values);
+  decoded->encoding = encoding;
+  return encoding;
+}
+
+// == SegWit Addresses ==
+
+size_t SegwitAddressEncode(
+    const char *hrp, size_t hrp_size, uint8_t version,
+    const uint8_t *program, size_t program_size, char *address,
+    size_t address_size) {
+  if (!IsValidSegwitProgram(version, program_size)) return 0;
+  uint8_t values[kBech32MaxValuesLength];
+  values[0] = version;
+  size_t values_length = 0;
+  if (!Bech32BytesToValues(
+          program, program_size, values + 1, sizeof(values) - 1,
+          &values_length)) {
+    return 0;
+  }
+  return Bech32Encode(
+      version == 0 ? kBech32 : kBech32m, hrp, hrp_size, values,
+      values_length + 1, address, address_size);
+}
+
+std::string SegwitAddressEncode(
+    const std::string &hrp, uint8_t version,
+    const std::vector<uint8_t> &program) {
+  char address[kBech32MaxLength];
+  const size_t length = SegwitAddressEncode(
+      hrp.data(), hrp.size(), version, program.data(), program.size(),
+      address, sizeof(address));
+  return std::string(address, length);
+}
+
+bool SegwitAddressDecode(
+    const char *hrp, size_t hrp_size, const char *address,
+    size_t address_size, uint8_t *version, uint8_t *program,
+    size_t *program_size) {
+  Bech32Decoded decoded;
+  if (Bech32Decode(address, address_size, &decoded) == kBech32Invalid) {
+    return false;
+  }
+  if (decoded.hrp_length != hrp_size ||
+      !std::equal(hrp, hrp + hrp_size, decoded.hrp)) {
+    return false;
+  }
+  if (decoded.values_length == 0) return false;
+  const uint8_t witness_version = decoded.values[0];
+  if (witness_version > kSegwitMaxVersion) return false;
+  const Bech32Encoding expected = witness_version == 0 ? kBech32 : kBech32m;
+  if (decoded.encoding != expected) return false;
+  size_t length = 0;
+  if (!Bech32ValuesToBytes(
+          decoded.values + 1, decoded.values_length - 1, program,
+          kSegwitProgramMaxLength, &length)) {
+    return false;
+  }
+  if (!IsValidSegwitProgram(witness_version, length)) return false;
+  *version = witness_version;
+  *program_size = length;
+  return true;
+}
+
+// == Batch ==
+
+namespace {
+constexpr size_t kSegwitEncodeSlot = kBech32MaxLength;
+constexpr size_t kSegwitDecodeSlot = 1 + kSegwitProgramMaxLength;
+
+// Runs |convert(i, slot)| for each item, with |slot| the item's offset
+// in the output arena.  Returns the number of valid items.
+template<typename Converter>
+size_t ConvertSegwitBatch(
+    size_t count, size_t slot_size, size_t output_size, BatchItem *results,
+    uint64_t *valid, size_t threads, const Converter &convert) {
+  std::fill_n(valid, BatchBitmapWords(count), 0);
+  std::atomic<size_t> valid_count(0);
+  ParallelFor(count, threads, [&](size_t begin, size_t end) {
+    size_t local_count = 0;
+    for (size_t i = begin; i < end; i++) {
+      const size_t offset = i * slot_size;
+      results[i] = {offset, 0};
+      if (offset + slot_size > output_size) continue;
+      results[i].length = convert(i, offset);
+      if (results[i].length == 0) continue;
+      valid[i / kBatchBitmapWordBits] |=
+          uint64_t(1) << (i % kBatchBitmapWordBits);
+      local_count++;
+    }
+    valid_count += local_count;
+  }, kBatchBitmapWordBits);
+  return valid_count.load();
+}
+}  // namespace
+
+size_t SegwitAddressEncodeBatchArenaSize(size_t count) {
+  return count * kSegwitEncodeSlot;
+}
+
+size_t SegwitAddressEncodeBatch(
+    const char *hrp, size_t hrp_size, const uint8_t *data,
+    const BatchItem *items, size_t count, char *addresses,
+    size_t addresses_size, BatchItem *results, uint64_t *valid,
+    size_t threads) {
+  if (count == 0) return 0;
+  DASSERT(hrp != nullptr && data != nullptr && items != nullptr);
+  DASSERT(addresses != nullptr && results != nullptr && valid != nullptr);
+  return ConvertSegwitBatch(
+      count, kSegwitEncodeSlot, addresses_size, results, valid, threads,
+      [&](size_t i, size_t offset) -> size_t {
+        if (items[i].length == 0) return 0;
+        const uint8_t *item = data + items[i].offset;
+        return SegwitAddressEncode(
+            hrp, hrp_size, item[0], item + 1, items[i].length - 1,
+            addresses + offset, kSegwitEncodeSlot);
+      });
+}
+
+size_t SegwitAddressDecodeBatchArenaSize(size_t count) {
+  return count * kSegwitDecodeSlot;
+}
+
+size_t SegwitAddressDecodeBatch(
+    const char *hrp, size_t hrp_size, const char *addresses,
+    const BatchItem *items, size_t count, uint8_t *data, size_t data_size,
+    BatchItem *results, uint64_t *valid, size_t threads) {
+  if (count == 0) return 0;
+  DASSERT(hrp != nullptr && addresses != nullptr && items != nullptr);
+  DASSERT(data != nullptr && results != nullptr && valid != nullptr);
+  return ConvertSegwitBatch(
+      count, kSegwitDecodeSlot, data_size, results, valid, threads,
+      [&](size_t i, size_t offset) -> size_t {
+        uint8_t *item = data + offset;
+        size_t program_size = 0;
+        if (!SegwitAddressDecode(
+                hrp, hrp_size, addresses + items[i].offset, items[i].length,
+                item, item + 1, &program_size)) {
+          return 0;
+        }
+        return program_size + 1;
+      });
+}
+}  // namespace encode
+}  // namespace btc
@@ -3,18 +3,33 @@
 // Copyright (c) 2022 Alex Dale
 // This project is licensed under the terms of the MIT license.
 // See LICENSE for details.
-#include <ctype.h>
-
 #include <algorithm>
+#include <atomic>
 
 #include "btc/cc/debug.h"
 #include "btc/encode/hex.hpp"
 #include "btc/log.h"
 
+#define _BTC_ENCODE_HEX_INTERNAL_
+#include "btc/encode/hex.kernel.hpp"
+#undef _BTC_ENCODE_HEX_INTERNAL_
+
 namespace btc {
 namespace encode {
 namespace {
-const char kLowerHexSet[] = "0123456789abcdef";
+using internal::HexKernelTable;
+
+// Selected lazily; constant initialized so that the codec may be used
+// during static initialization of other modules.
+std::atomic<const HexKernelTable *> g_hex_kernel{nullptr};
+
+const HexKernelTable *ActiveHexKernel() {
+  const HexKernelTable *table = g_hex_kernel.load(std::memory_order_relaxed);
+  if (table != nullptr) return table;
+  table = internal::SelectHexKernelTable();
+  g_hex_kernel.store(table, std::memory_order_relaxed);
+  return table;
+}
 
 // Internal hexadecimal encoder.
 // Assumes that the buffer pointed to by |hex| is two times |size|.  The
@@ -24,68 +39,73 @@ bool HexEncodeInternal(
   DASSERT(data != nullptr);
   DASSERT(size > 0);
   DASSERT(hex != nullptr);
-  if (reverse) {
-    for (size_t i = 0; i < size; i++) {
-      hex[i * 2] = kLowerHexSet[(data[size - i - 1] >> 4) & 0xF];
-      hex[i * 2 + 1] = kLowerHexSet[data[size - i - 1] & 0xF];
-    }
-  } else {
-    for (size_t i = 0; i < size; i++) {
-      hex[i * 2] = kLowerHexSet[(data[i] >> 4) & 0xF];
-      hex[i * 2 + 1] = kLowerHexSet[data[i] & 0xF];
-    }
-  }
-  return true;
-}
-
-bool HexDecodeCharacter(char c, uint8_t *nibble, bool high) {
-  DASSERT(nibble != nullptr);
-  uint8_t value = 0;
-  if (isdigit(c)) {
-    value = c - '0';
-  } else if (c >= 'A' && c <= 'F') {
-    value = (c - 'A') + 10;
-  } else if (c >= 'a' && c <= 'f') {
-    value = (c - 'a') + 10;
-  } else {
-    return false;  // Not a hex character.
-  }
-  if (high) {
-    *nibble = (*nibble & 0xF) | ((value << 4) & 0xF0);
-  } else {
-    *nibble = (*nibble & 0xF0) | (value & 0xF);
-  }
+  ActiveHexKernel()->encode(data, size, hex, reverse);
   return true;
 }
 
 // Internal hexadecimal decoder.
 // Assumes that the buffer pointed to by |data| is at least half the
-// size of |hex_size|.
-bool HexDecodeInternal(
+// size of |hex_size|.  Returns |hex_size| on success, otherwise the
+// offset of the first invalid character.
+size_t HexDecodeInternal(
     const char *hex, size_t hex_size, uint8_t *data, bool reverse) {
   DASSERT(hex != nullptr);
   DASSERT((hex_size & 1) == 0);
   DASSERT(data != nullptr);
-  const size_t data_size = hex_size / 2;
-  for (size_t i = 0; i < hex_size; i += 2) {
-    const size_t didx = reverse ? (data_size - (i / 2) - 1) : (i / 2);
-    if (!HexDecodeCharacter(hex[i], &data[didx], true)) {
-      LOG_DEBUG("Not a hex digit: c = 0x%02x, index = %zu", hex[i], i);
-      return false;
-    }
-    if (!HexDecodeCharacter(hex[i + 1], &data[didx], false)) {
-      LOG_DEBUG("Not a hex digit: c = 0x%02x, index = %zu", hex[i + 1], i + 1);
-      return false;
-    }
+  return ActiveHexKernel()->decode(hex, hex_size, data, reverse);
+}
+}  // namespace
+
+const char *HexKernelToString(HexKernel kernel) {
+  switch (kernel) {
+    case kHexKernelScalar:
+      return "scalar";
+    case kHexKernelSwar:
+      return "swar";
+    case kHexKernelSsse3:
+      return "ssse3";
+    case kHexKernelAvx2:
+      return "avx2";
+  }
+  LOG_ERROR("Unknown hex kernel: %d", kernel);
+  return "<error>";
+}
+
+bool IsHexKernelSupported(HexKernel kernel) {
+  return internal::GetHexKernelTable(kernel) != nullptr;
+}
+
+HexKernel GetHexKernel() {
+  return ActiveHexKernel()->kernel;
+}
+
+bool SetHexKernel(HexKernel kernel) {
+  const HexKernelTable *table = internal::GetHexKernelTable(kernel);
+  if (table == nullptr) {
+    LOG_WARN("Hex kernel not supported: %s", HexKernelToString(kernel));
+    return false;
   }
+  g_hex_kernel.store(table, std::memory_order_relaxed);
   return true;
 }
-}  // namespace
 
 bool IsHexString(const std::string &hex) {
-  if (hex.empty()) return true;
-  if (hex.size() & 1) return false;
-  return std::all_of(hex.cbegin(), hex.cend(), ::isxdigit);
+  return IsHexString(hex.data(), hex.size());
+}
+
+bool IsHexString(const char *hex, size_t hex_size) {
+  if (hex_size == 0) return true;
+  if (hex_size & 1) return false;
+  return ActiveHexKernel()->validate(hex, hex_size) == hex_size;
+}
+
+size_t FindInvalidHexCharacter(const std::string &hex) {
+  return FindInvalidHexCharacter(hex.data(), hex.size());
+}
+
+size_t FindInvalidHexCharacter(const char *hex, size_t hex_size) {
+  if (hex_size == 0) return 0;
+  return ActiveHexKernel()->validate(hex, hex_size);
 }
 
 std::string HexEncode(const uint8_t *data, size_t size, bool reverse) {
@@ -122,18 +142,51 @@ std::string HexEncode(const std::string &data, bool reverse) {
   return hex;
 }
 
+size_t HexEncode(
+    const uint8_t *data, size_t size, char *hex, size_t hex_size,
+    bool reverse) {
+  DASSERT(data != nullptr);
+  DASSERT(hex != nullptr);
+  if (size == 0) return 0;
+  if (hex_size < HexEncodedLength(size)) return 0;
+  HexEncodeInternal(data, size, hex, reverse);
+  return HexEncodedLength(size);
+}
+
+void HexEncodeAppend(
+    const uint8_t *data, size_t size, std::string *hex, bool reverse) {
+  DASSERT(data != nullptr);
+  DASSERT(hex != nullptr);
+  if (size == 0) return;
+  const size_t offset = hex->size();
+  hex->resize(offset + HexEncodedLength(size));
+  HexEncodeInternal(data, size, &(*hex)[offset], reverse);
+}
+
+size_t HexDecode(
+    const std::string &hex, uint8_t *buffer, size_t buffer_size, bool reverse,
+    size_t *error_offset) {
+  return HexDecode(
+      hex.data(), hex.size(), buffer, buffer_size, reverse, error_offset);
+}
+
 size_t HexDecode(
-    const std::string &hex, uint8_t *buffer, size_t buffer_size, bool reverse) {
+    const char *hex, size_t hex_size, uint8_t *buffer, size_t buffer_size,
+    bool reverse, size_t *error_offset) {
   DASSERT(buffer != nullptr);
-  if (hex.size() & 1) {
-    LOG_DEBUG("Provided string is odd length: %zu", hex.size());
+  if (hex_size & 1) {
+    if (error_offset != nullptr) *error_offset = hex_size - 1;
+    return 0;
+  }
+  if (hex_size == 0) return 0;
+  if (buffer_size == 0) return HexDecodedLength(hex_size);
+  const size_t decode_size = std::min(hex_size, buffer_size * 2);
+  const size_t res = HexDecodeInternal(hex, decode_size, buffer, reverse);
+  if (res != decode_size) {
+    if (error_offset != nullptr) *error_offset = res;
     return 0;
   }
-  if (hex.empty()) return 0;
-  if (buffer_size == 0) return hex.size() / 2;
-  const size_t decode_size = std::min(hex.size(), buffer_size * 2);
-  const bool res = HexDecodeInternal(hex.data(), decode_size, buffer, reverse);
-  return res ? hex.size() / 2 : 0;
+  return HexDecodedLength(hex_size);
 }
 
 std::vector<uint8_t> HexDecode(const std::string &hex, bool reverse) {
@@ -144,9 +197,9 @@ std::vector<uint8_t> HexDecode(const std::string &hex, bool reverse) {
     return data;
   }
   data.resize(hex.size() / 2);
-  const bool res =
+  const size_t res =
       HexDecodeInternal(hex.data(), hex.size(), data.data(), reverse);
-  if (!res) data.clear();
+  if (res != hex.size()) data.clear();
   return data;
 }
 
@@ -158,11 +211,28 @@ std::string HexDecodeToString(const std::string &hex, bool reverse) {
     return data;
   }
   data.assign(hex.size() / 2, ' ');
-  const bool res = HexDecodeInternal(
+  const size_t res = HexDecodeInternal(
       hex.data(), hex.size(), reinterpret_cast<uint8_t *>(&data.front()),
       reverse);
-  if (!res) data.clear();
+  if (res != hex.size()) data.clear();
   return data;
 }
+
+bool HexDecodeAppend(
+    const char *hex, size_t hex_size, std::vector<uint8_t> *data,
+    bool reverse) {
+  DASSERT(data != nullptr);
+  if (hex_size == 0) return true;
+  if (hex_size & 1) return false;
+  const size_t offset = data->size();
+  data->resize(offset + HexDecodedLength(hex_size));
+  const size_t res =
+      HexDecodeInternal(hex, hex_size, data->data() + offset, reverse);
+  if (res != hex_size) {
+    data->resize(offset);
+    return false;
+  }
+  return true;
+}
 }  // namespace encode
 }  // namespace btc
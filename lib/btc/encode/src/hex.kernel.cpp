@@ -0,0 +1,475 @@
+// Bitcoin Info - Encoders - Hexadecimal Kernels
+//
+// Copyright (c) 2022 Alex Dale
+// This project is licensed under the terms of the MIT license.
+// See LICENSE for details.
+#include <endian.h>
+#include <string.h>
+
+#include "btc/cc/debug.h"
+#include "btc/cc/platform.h"
+#include "btc/cpu.h"
+
+#define _BTC_ENCODE_HEX_INTERNAL_
+#include "btc/encode/hex.kernel.hpp"
+#undef _BTC_ENCODE_HEX_INTERNAL_
+
+#ifdef BTC_ARCH_X86
+#  include <immintrin.h>
+#endif
+
+namespace btc {
+namespace encode {
+namespace internal {
+namespace {
+const char kLowerHexSet[] = "0123456789abcdef";
+
+constexpr uint8_t kInvalidHexValue = 0xff;
+
+struct HexValueTable {
+  uint8_t values[256];
+};
+
+constexpr HexValueTable MakeHexValueTable() {
+  HexValueTable table = {};
+  for (size_t c = 0; c < 256; c++) {
+    if (c >= '0' && c <= '9') {
+      table.values[c] = static_cast<uint8_t>(c - '0');
+    } else if (c >= 'a' && c <= 'f') {
+      table.values[c] = static_cast<uint8_t>(c - 'a' + 10);
+    } else if (c >= 'A' && c <= 'F') {
+      table.values[c] = static_cast<uint8_t>(c - 'A' + 10);
+    } else {
+      table.values[c] = kInvalidHexValue;
+    }
+  }
+  return table;
+}
+
+constexpr HexValueTable kHexValues = MakeHexValueTable();
+
+inline uint8_t HexValue(char c) {
+  return kHexValues.values[static_cast<uint8_t>(c)];
+}
+
+// == Scalar ==
+
+void HexEncodeScalar(
+    const uint8_t *data, size_t size, char *hex, bool reverse) {
+  for (size_t i = 0; i < size; i++) {
+    const uint8_t byte = reverse ? data[size - i - 1] : data[i];
+    hex[i * 2] = kLowerHexSet[byte >> 4];
+    hex[i * 2 + 1] = kLowerHexSet[byte & 0xF];
+  }
+}
+
+size_t HexDecodeScalar(
+    const char *hex, size_t hex_size, uint8_t *data, bool reverse) {
+  const size_t data_size = hex_size / 2;
+  for (size_t i = 0; i < data_size; i++) {
+    const uint8_t high = HexValue(hex[i * 2]);
+    const uint8_t low = HexValue(hex[i * 2 + 1]);
+    if ((high | low) > 0xf) return high > 0xf ? i * 2 : i * 2 + 1;
+    data[reverse ? data_size - i - 1 : i] =
+        static_cast<uint8_t>((high << 4) | low);
+  }
+  return hex_size;
+}
+
+size_t HexValidateScalar(const char *hex, size_t hex_size) {
+  for (size_t i = 0; i < hex_size; i++) {
+    if (HexValue(hex[i]) == kInvalidHexValue) return i;
+  }
+  return hex_size;
+}
+
+// Encodes the bytes not covered by a vectorized kernel.  The first
+// |done| bytes (or last, if reversed) have already been encoded.
+inline void HexEncodeRemainder(
+    const uint8_t *data, size_t size, size_t done, char *hex, bool reverse) {
+  DASSERT(done <= size);
+  if (done == size) return;
+  HexEncodeScalar(
+      reverse ? data : data + done, size - done, hex + done * 2, reverse);
+}
+
+// Decodes the characters not covered by a vectorized kernel.  The
+// first |done| characters have already been decoded.
+inline size_t HexDecodeRemainder(
+    const char *hex, size_t hex_size, size_t done, uint8_t *data,
+    bool reverse) {
+  DASSERT(done <= hex_size);
+  if (done == hex_size) return hex_size;
+  const size_t remaining = hex_size - done;
+  const size_t res = HexDecodeScalar(
+      hex + done, remaining, reverse ? data : data + done / 2, reverse);
+  return done + res;
+}
+
+inline size_t HexValidateRemainder(
+    const char *hex, size_t hex_size, size_t done) {
+  if (done == hex_size) return hex_size;
+  return done + HexValidateScalar(hex + done, hex_size - done);
+}
+
+// Position of the lowest set bit, as a byte offset.
+inline size_t FirstMarkedLane(uint64_t marks, size_t bits_per_lane) {
+  DASSERT(marks != 0);
+  return static_cast<size_t>(__builtin_ctzll(marks)) / bits_per_lane;
+}
+
+// Pointer to the |index|th block of |block_size| bytes.  Reversed
+// blocks are taken from the end of |data|.
+inline const uint8_t *HexEncodeBlock(
+    const uint8_t *data, size_t size, size_t index, size_t block_size,
+    bool reverse) {
+  return reverse ? data + size - (index + 1) * block_size
+                 : data + index * block_size;
+}
+
+// == SWAR ==
+
+// Spreads 4 bytes into 8 nibbles, one per byte lane, high nibble
+// first.
+inline uint64_t SwarSpreadNibbles(uint32_t bytes) {
+  uint64_t x = bytes;
+  x = ((x & 0xffff0000ull) << 16) | (x & 0x0000ffffull);
+  x = ((x & 0x0000ff000000ff00ull) << 8) | (x & 0x000000ff000000ffull);
+  const uint64_t high = (x >> 4) & 0x000f000f000f000full;
+  const uint64_t low = (x & 0x000f000f000f000full) << 8;
+  return high | low;
+}
+
+// Converts 8 nibble lanes to 8 lowercase hex characters.
+inline uint64_t SwarNibblesToHex(uint64_t nibbles) {
+  // Lanes with values 10-15 carry into bit 4 when adding 6.
+  const uint64_t letters =
+      ((nibbles + 0x0606060606060606ull) >> 4) & 0x0101010101010101ull;
+  return nibbles + 0x3030303030303030ull + letters * ('a' - '0' - 10);
+}
+
+void HexEncodeSwar(const uint8_t *data, size_t size, char *hex, bool reverse) {
+  const size_t blocks = size / 8;
+  for (size_t i = 0; i < blocks; i++) {
+    uint64_t word;
+    memcpy(&word, HexEncodeBlock(data, size, i, 8, reverse), sizeof(word));
+    word = le64toh(word);
+    if (reverse) word = __builtin_bswap64(word);
+    const uint64_t first = htole64(
+        SwarNibblesToHex(SwarSpreadNibbles(static_cast<uint32_t>(word))));
+    const uint64_t second = htole64(
+        SwarNibblesToHex(SwarSpreadNibbles(static_cast<uint32_t>(word >> 32))));
+    memcpy(hex + i * 16, &first, sizeof(first));
+    memcpy(hex + i * 16 + 8, &second, sizeof(second));
+  }
+  HexEncodeRemainder(data, size, blocks * 8, hex, reverse);
+}
+
+constexpr uint64_t kSwarHighBits = 0x8080808080808080ull;
+constexpr uint64_t kSwarLowNibbles = 0x0f0f0f0f0f0f0f0full;
+
+// Classifies 8 characters.  Returns the high bit of each lane set if
+// the character is a hexadecimal digit.  |letters| receives the high
+// bit of each lane containing 'a'-'f' or 'A'-'F'.
+inline uint64_t SwarHexValid(uint64_t chars, uint64_t *letters) {
+  // Lanes are reduced to 7 bits so that additions cannot carry into
+  // the next lane; characters 0x80-0xff are rejected at the end.
+  const uint64_t low7 = chars & ~kSwarHighBits;
+  // '0' <= c <= '9'
+  const uint64_t digits = (low7 + 0x5050505050505050ull)
+                        & ~(low7 + 0x4646464646464646ull) & kSwarHighBits;
+  // 'a' <= (c | 0x20) <= 'f'
+  const uint64_t folded = low7 | 0x2020202020202020ull;
+  const uint64_t alpha = (folded + 0x1f1f1f1f1f1f1f1full)
+                       & ~(folded + 0x1919191919191919ull) & kSwarHighBits;
+  *letters = alpha & ~chars;
+  return (digits | alpha) & ~chars & kSwarHighBits;
+}
+
+// Converts 8 valid hex characters to 4 bytes, first byte lowest.
+inline uint32_t SwarHexPack(uint64_t chars, uint64_t letters) {
+  const uint64_t nibbles = (chars & kSwarLowNibbles) + (letters >> 7) * 9;
+  uint64_t x = ((nibbles & 0x000f000f000f000full) << 4)
+             | ((nibbles >> 8) & 0x000f000f000f000full);
+  x = (x | (x >> 8)) & 0x0000ffff0000ffffull;
+  x = (x | (x >> 16)) & 0x00000000ffffffffull;
+  return static_cast<uint32_t>(x);
+}
+
+size_t HexDecodeSwar(
+    const char *hex, size_t hex_size, uint8_t *data, bool reverse) {
+  const size_t data_size = hex_size / 2;
+  const size_t blocks = hex_size / 8;
+  for (size_t i = 0; i < blocks; i++) {
+    uint64_t chars;
+    memcpy(&chars, hex + i * 8, sizeof(chars));
+    chars = le64toh(chars);
+    uint64_t letters;
+    const uint64_t invalid = ~SwarHexValid(chars, &letters) & kSwarHighBits;
+    if (invalid) return i * 8 + FirstMarkedLane(invalid, 8);
+    uint32_t bytes = SwarHexPack(chars, letters);
+    if (reverse) bytes = __builtin_bswap32(bytes);
+    bytes = htole32(bytes);
+    memcpy(
+        reverse ? data + data_size - (i + 1) * 4 : data + i * 4, &bytes,
+        sizeof(bytes));
+  }
+  return HexDecodeRemainder(hex, hex_size, blocks * 8, data, reverse);
+}
+
+size_t HexValidateSwar(const char *hex, size_t hex_size) {
+  const size_t blocks = hex_size / 8;
+  for (size_t i = 0; i < blocks; i++) {
+    uint64_t chars;
+    memcpy(&chars, hex + i * 8, sizeof(chars));
+    chars = le64toh(chars);
+    uint64_t letters;
+    const uint64_t invalid = ~SwarHexValid(chars, &letters) & kSwarHighBits;
+    if (invalid) return i * 8 + FirstMarkedLane(invalid, 8);
+  }
+  return HexValidateRemainder(hex, hex_size, blocks * 8);
+}
+
+#ifdef BTC_ARCH_X86
+// == SSSE3 ==
+
+__TARGET("ssse3")
+void HexEncodeSsse3(const uint8_t *data, size_t size, char *hex, bool reverse) {
+  const __m128i lut = _mm_setr_epi8(
+      '0', '1', '2', '3', '4', '5', '6', '7', '8', '9', 'a', 'b', 'c', 'd',
+      'e', 'f');
+  const __m128i nibble_mask = _mm_set1_epi8(0x0f);
+  // Byte order of each block; reversing is a single shuffle.
+  const __m128i order =
+      reverse ? _mm_setr_epi8(15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2,
+                              1, 0)
+              : _mm_setr_epi8(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13,
+                              14, 15);
+  const size_t blocks = size / 16;
+  for (size_t i = 0; i < blocks; i++) {
+    __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i *>(
+        HexEncodeBlock(data, size, i, 16, reverse)));
+    bytes = _mm_shuffle_epi8(bytes, order);
+    const __m128i high = _mm_shuffle_epi8(
+        lut, _mm_and_si128(_mm_srli_epi16(bytes, 4), nibble_mask));
+    const __m128i low =
+        _mm_shuffle_epi8(lut, _mm_and_si128(bytes, nibble_mask));
+    __m128i *out = reinterpret_cast<__m128i *>(hex + i * 32);
+    _mm_storeu_si128(out, _mm_unpacklo_epi8(high, low));
+    _mm_storeu_si128(out + 1, _mm_unpackhi_epi8(high, low));
+  }
+  HexEncodeRemainder(data, size, blocks * 16, hex, reverse);
+}
+
+// Converts 16 characters to nibble values.  |valid| receives a bit
+// mask of the lanes which contained hexadecimal digits.
+__TARGET("ssse3")
+inline __m128i HexNibblesSsse3(__m128i chars, uint32_t *valid) {
+  const __m128i digits = _mm_sub_epi8(chars, _mm_set1_epi8('0'));
+  const __m128i is_digit =
+      _mm_cmpeq_epi8(_mm_min_epu8(digits, _mm_set1_epi8(9)), digits);
+  const __m128i letters = _mm_sub_epi8(
+      _mm_or_si128(chars, _mm_set1_epi8(0x20)), _mm_set1_epi8('a'));
+  const __m128i is_letter =
+      _mm_cmpeq_epi8(_mm_min_epu8(letters, _mm_set1_epi8(5)), letters);
+  *valid = static_cast<uint32_t>(
+      _mm_movemask_epi8(_mm_or_si128(is_digit, is_letter)));
+  return _mm_or_si128(
+      _mm_and_si128(is_digit, digits),
+      _mm_and_si128(is_letter, _mm_add_epi8(letters, _mm_set1_epi8(10))));
+}
+
+__TARGET("ssse3")
+size_t HexDecodeSsse3(
+    const char *hex, size_t hex_size, uint8_t *data, bool reverse) {
+  const size_t data_size = hex_size / 2;
+  // Each pair of nibbles becomes (high * 16 + low).
+  const __m128i weights = _mm_set1_epi16(0x0110);
+  const __m128i order =
+      reverse ? _mm_setr_epi8(15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2,
+                              1, 0)
+              : _mm_setr_epi8(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13,
+                              14, 15);
+  const size_t blocks = hex_size / 32;
+  for (size_t i = 0; i < blocks; i++) {
+    const __m128i *in = reinterpret_cast<const __m128i *>(hex + i * 32);
+    uint32_t first_valid, second_valid;
+    const __m128i first =
+        HexNibblesSsse3(_mm_loadu_si128(in), &first_valid);
+    const __m128i second =
+        HexNibblesSsse3(_mm_loadu_si128(in + 1), &second_valid);
+    const uint64_t invalid =
+        ~(first_valid | (second_valid << 16)) & 0xffffffffull;
+    if (invalid) return i * 32 + FirstMarkedLane(invalid, 1);
+    const __m128i bytes = _mm_packus_epi16(
+        _mm_maddubs_epi16(first, weights), _mm_maddubs_epi16(second, weights));
+    _mm_storeu_si128(
+        reinterpret_cast<__m128i *>(
+            reverse ? data + data_size - (i + 1) * 16 : data + i * 16),
+        _mm_shuffle_epi8(bytes, order));
+  }
+  return HexDecodeRemainder(hex, hex_size, blocks * 32, data, reverse);
+}
+
+__TARGET("ssse3")
+size_t HexValidateSsse3(const char *hex, size_t hex_size) {
+  const size_t blocks = hex_size / 16;
+  for (size_t i = 0; i < blocks; i++) {
+    uint32_t valid;
+    HexNibblesSsse3(
+        _mm_loadu_si128(reinterpret_cast<const __m128i *>(hex + i * 16)),
+        &valid);
+    const uint64_t invalid = ~valid & 0xffffull;
+    if (invalid) return i * 16 + FirstMarkedLane(invalid, 1);
+  }
+  return HexValidateRemainder(hex, hex_size, blocks * 16);
+}
+
+// == AVX2 ==
+
+__TARGET("avx2")
+void HexEncodeAvx2(const uint8_t *data, size_t size, char *hex, bool reverse) {
+  const __m256i lut = _mm256_setr_epi8(
+      '0', '1', '2', '3', '4', '5', '6', '7', '8', '9', 'a', 'b', 'c', 'd',
+      'e', 'f', '0', '1', '2', '3', '4', '5', '6', '7', '8', '9', 'a', 'b',
+      'c', 'd', 'e', 'f');
+  const __m256i nibble_mask = _mm256_set1_epi8(0x0f);
+  const __m256i lane_reverse = _mm256_setr_epi8(
+      15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0, 15, 14, 13, 12, 11,
+      10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0);
+  const size_t blocks = size / 32;
+  for (size_t i = 0; i < blocks; i++) {
+    __m256i bytes = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(
+        HexEncodeBlock(data, size, i, 32, reverse)));
+    if (reverse) {
+      // Reverse within each 128-bit lane, then swap the lanes.
+      bytes = _mm256_permute4x64_epi64(
+          _mm256_shuffle_epi8(bytes, lane_reverse), 0x4e);
+    }
+    const __m256i high = _mm256_shuffle_epi8(
+        lut, _mm256_and_si256(_mm256_srli_epi16(bytes, 4), nibble_mask));
+    const __m256i low =
+        _mm256_shuffle_epi8(lut, _mm256_and_si256(bytes, nibble_mask));
+    // Unpacking interleaves within 128-bit lanes.
+    const __m256i first = _mm256_unpacklo_epi8(high, low);
+    const __m256i second = _mm256_unpackhi_epi8(high, low);
+    __m256i *out = reinterpret_cast<__m256i *>(hex + i * 64);
+    _mm256_storeu_si256(out, _mm256_permute2x128_si256(first, second, 0x20));
+    _mm256_storeu_si256(
+        out + 1, _mm256_permute2x128_si256(first, second, 0x31));
+  }
+  HexEncodeRemainder(data, size, blocks * 32, hex, reverse);
+}
+
+__TARGET("avx2")
+inline __m256i HexNibblesAvx2(__m256i chars, uint32_t *valid) {
+  const __m256i digits = _mm256_sub_epi8(chars, _mm256_set1_epi8('0'));
+  const __m256i is_digit =
+      _mm256_cmpeq_epi8(_mm256_min_epu8(digits, _mm256_set1_epi8(9)), digits);
+  const __m256i letters = _mm256_sub_epi8(
+      _mm256_or_si256(chars, _mm256_set1_epi8(0x20)), _mm256_set1_epi8('a'));
+  const __m256i is_letter =
+      _mm256_cmpeq_epi8(_mm256_min_epu8(letters, _mm256_set1_epi8(5)), letters);
+  *valid = static_cast<uint32_t>(
+      _mm256_movemask_epi8(_mm256_or_si256(is_digit, is_letter)));
+  return _mm256_or_si256(
+      _mm256_and_si256(is_digit, digits),
+      _mm256_and_si256(
+          is_letter, _mm256_add_epi8(letters, _mm256_set1_epi8(10))));
+}
+
+__TARGET("avx2")
+size_t HexDecodeAvx2(
+    const char *hex, size_t hex_size, uint8_t *data, bool reverse) {
+  const size_t data_size = hex_size / 2;
+  const __m256i weights = _mm256_set1_epi16(0x0110);
+  const __m256i lane_reverse = _mm256_setr_epi8(
+      15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0, 15, 14, 13, 12, 11,
+      10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0);
+  const size_t blocks = hex_size / 64;
+  for (size_t i = 0; i < blocks; i++) {
+    const __m256i *in = reinterpret_cast<const __m256i *>(hex + i * 64);
+    uint32_t first_valid, second_valid;
+    const __m256i first =
+        HexNibblesAvx2(_mm256_loadu_si256(in), &first_valid);
+    const __m256i second =
+        HexNibblesAvx2(_mm256_loadu_si256(in + 1), &second_valid);
+    const uint64_t invalid =
+        ~(first_valid | (static_cast<uint64_t>(second_valid) << 32));
+    if (invalid) return i * 64 + FirstMarkedLane(invalid, 1);
+    // Packing works within 128-bit lanes; restore the order of the
+    // 64-bit quarters afterwards.
+    __m256i bytes = _mm256_permute4x64_epi64(
+        _mm256_packus_epi16(
+            _mm256_maddubs_epi16(first, weights),
+            _mm256_maddubs_epi16(second, weights)),
+        0xd8);
+    if (reverse) {
+      bytes = _mm256_permute4x64_epi64(
+          _mm256_shuffle_epi8(bytes, lane_reverse), 0x4e);
+    }
+    _mm256_storeu_si256(
+        reinterpret_cast<__m256i *>(
+            reverse ? data + data_size - (i + 1) * 32 : data + i * 32),
+        bytes);
+  }
+  return HexDecodeRemainder(hex, hex_size, blocks * 64, data, reverse);
+}
+
+__TARGET("avx2")
+size_t HexValidateAvx2(const char *hex, size_t hex_size) {
+  const size_t blocks = hex_size / 32;
+  for (size_t i = 0; i < blocks; i++) {
+    uint32_t valid;
+    HexNibblesAvx2(
+        _mm256_loadu_si256(reinterpret_cast<const __m256i *>(hex + i * 32)),
+        &valid);
+    const uint64_t invalid = ~valid & 0xffffffffull;
+    if (invalid) return i * 32 + FirstMarkedLane(invalid, 1);
+  }
+  return HexValidateRemainder(hex, hex_size, blocks * 32);
+}
+#endif  // BTC_ARCH_X86
+
+const HexKernelTable kScalarTable = {
+    kHexKernelScalar, HexEncodeScalar, HexDecodeScalar, HexValidateScalar};
+const HexKernelTable kSwarTable = {
+    kHexKernelSwar, HexEncodeSwar, HexDecodeSwar, HexValidateSwar};
+#ifdef BTC_ARCH_X86
+const HexKernelTable kSsse3Table = {
+    kHexKernelSsse3, HexEncodeSsse3, HexDecodeSsse3, HexValidateSsse3};
+const HexKernelTable kAvx2Table = {
+    kHexKernelAvx2, HexEncodeAvx2, HexDecodeAvx2, HexValidateAvx2};
+#endif  // BTC_ARCH_X86
+}  // namespace
+
+const HexKernelTable *GetHexKernelTable(HexKernel kernel) {
+  switch (kernel) {
+    case kHexKernelScalar:
+      return &kScalarTable;
+    case kHexKernelSwar:
+      return &kSwarTable;
+#ifdef BTC_ARCH_X86
+    case kHexKernelSsse3:
+      return btc_cpu_has(BTC_CPU_SSSE3) ? &kSsse3Table : nullptr;
+    case kHexKernelAvx2:
+      return btc_cpu_has(BTC_CPU_AVX2) ? &kAvx2Table : nullptr;
+#else
+    case kHexKernelSsse3:
+    case kHexKernelAvx2:
+      return nullptr;
+#endif  // BTC_ARCH_X86
+  }
+  return nullptr;
+}
+
+const HexKernelTable *SelectHexKernelTable() {
+  for (const HexKernel kernel : {kHexKernelAvx2, kHexKernelSsse3}) {
+    const HexKernelTable *table = GetHexKernelTable(kernel);
+    if (table != nullptr) return table;
+  }
+  return &kSwarTable;
+}
+}  // namespace internal
+}  // namespace encode
+}  // namespace btc
@@ -0,0 +1,215 @@
+// Bitcoin Info - Encoders - Streaming Hexadecimal Encoder
+//
+// Copyright (c) 2022 Alex Dale
+// This project is licensed under the terms of the MIT license.
+// See LICENSE for details.
+#include <errno.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <algorithm>
+
+#include "btc/cc/debug.h"
+#include "btc/encode/hex.hpp"
+#include "btc/encode/hex_stream.hpp"
+#include "btc/log.h"
+
+namespace btc {
+namespace encode {
+namespace {
+
+// == Sinks ==
+
+class FdStreamSink: public StreamSink {
+public:
+  BTC_DISALLOW_COPY_AND_MOVE(FdStreamSink);
+  explicit FdStreamSink(int fd): _fd(fd) {}
+
+  bool Write(const uint8_t *data, size_t size) override {
+    while (size > 0) {
+      const ssize_t written = write(_fd, data, size);
+      if (written < 0) {
+        if (errno == EINTR) continue;
+        LOG_ERROR("Failed to write to fd %d: %s", _fd, strerror(errno));
+        return false;
+      }
+      data += written;
+      size -= static_cast<size_t>(written);
+    }
+    return true;
+  }
+
+private:
+  int _fd;
+};  // class FdStreamSink
+
+class CallbackStreamSink: public StreamSink {
+public:
+  BTC_DISALLOW_COPY_AND_MOVE(CallbackStreamSink);
+  explicit CallbackStreamSink(Callback callback):
+      _callback(std::move(callback)) {}
+
+  bool Write(const uint8_t *data, size_t size) override {
+    return _callback(data, size);
+  }
+
+private:
+  Callback _callback;
+};  // class CallbackStreamSink
+
+class OstreamStreamSink: public StreamSink {
+public:
+  BTC_DISALLOW_COPY_AND_MOVE(OstreamStreamSink);
+  explicit OstreamStreamSink(std::ostream *stream): _stream(stream) {}
+
+  bool Write(const uint8_t *data, size_t size) override {
+    _stream->write(
+        reinterpret_cast<const char *>(data),
+        static_cast<std::streamsize>(size));
+    return _stream->good();
+  }
+
+private:
+  std::ostream *_stream;
+};  // class OstreamStreamSink
+
+constexpr bool IsHexDigit(char c) {
+  return (c >= '0' && c <= '9') || (c >= 'a' && c <= 'f') ||
+         (c >= 'A' && c <= 'F');
+}
+}  // namespace
+
+// static
+std::unique_ptr<StreamSink> StreamSink::FromFd(int fd) {
+  if (fd < 0) {
+    LOG_ERROR("Invalid file descriptor: %d", fd);
+    return nullptr;
+  }
+  return std::make_unique<FdStreamSink>(fd);
+}
+
+// static
+std::unique_ptr<StreamSink> StreamSink::FromCallback(Callback callback) {
+  if (!callback) {
+    LOG_ERROR("Callback is empty");
+    return nullptr;
+  }
+  return std::make_unique<CallbackStreamSink>(std::move(callback));
+}
+
+// static
+std::unique_ptr<StreamSink> StreamSink::FromOstream(std::ostream *stream) {
+  DASSERT(stream != nullptr);
+  return std::make_unique<OstreamStreamSink>(stream);
+}
+
+// == Encoder ==
+
+HexStreamEncoder::HexStreamEncoder(StreamSink *sink): _sink(sink) {
+  DASSERT(_sink != nullptr);
+}
+
+bool HexStreamEncoder::Update(const uint8_t *data, size_t size) {
+  if (_failed) return false;
+  while (size > 0) {
+    if (_buffered == kBufferSize && !Flush()) return false;
+    const size_t room = HexDecodedLength(kBufferSize - _buffered);
+    const size_t chunk = std::min(room, size);
+    _buffered += HexEncode(
+        data, chunk, _buffer + _buffered, kBufferSize - _buffered);
+    data += chunk;
+    size -= chunk;
+    _count += chunk;
+  }
+  return true;
+}
+
+bool HexStreamEncoder::Finalize() {
+  if (_failed) return false;
+  return Flush();
+}
+
+bool HexStreamEncoder::Flush() {
+  if (_buffered == 0) return true;
+  if (!_sink->Write(reinterpret_cast<const uint8_t *>(_buffer), _buffered)) {
+    LOG_ERROR("Failed to write to sink");
+    _failed = true;
+    return false;
+  }
+  _buffered = 0;
+  return true;
+}
+
+// == Decoder ==
+
+HexStreamDecoder::HexStreamDecoder(StreamSink *sink): _sink(sink) {
+  DASSERT(_sink != nullptr);
+}
+
+bool HexStreamDecoder::Update(const char *hex, size_t hex_size) {
+  if (_failed) return false;
+  if (hex_size == 0) return true;
+  // Complete the byte split across the previous chunk.
+  if (_has_nibble) {
+    if (_buffered == kBufferSize && !Flush()) return false;
+    // The carried nibble was checked when stored.
+    const char pair[2] = {_nibble, hex[0]};
+    if (HexDecode(pair, sizeof(pair), _buffer + _buffered, 1) != 1) {
+      return Fail(_count);
+    }
+    _buffered++;
+    _has_nibble = false;
+    hex++;
+    hex_size--;
+    _count++;
+  }
+  while (hex_size > 1) {
+    if (_buffered == kBufferSize && !Flush()) return false;
+    const size_t room = HexEncodedLength(kBufferSize - _buffered);
+    const size_t chunk = std::min(room, hex_size & ~size_t(1));
+    size_t error_offset = 0;
+    const size_t length = HexDecode(
+        hex, chunk, _buffer + _buffered, kBufferSize - _buffered, false,
+        &error_offset);
+    if (length == 0) return Fail(_count + error_offset);
+    _buffered += length;
+    hex += chunk;
+    hex_size -= chunk;
+    _count += chunk;
+  }
+  if (hex_size == 1) {
+    if (!IsHexDigit(hex[0])) return Fail(_count);
+    _nibble = hex[0];
+    _has_nibble = true;
+    _count++;
+  }
+  return true;
+}
+
+bool HexStreamDecoder::Finalize() {
+  if (_failed) return false;
+  if (_has_nibble) {
+    LOG_DEBUG("Hex stream ended on half a byte");
+    return Fail(_count - 1);
+  }
+  return Flush();
+}
+
+bool HexStreamDecoder::Flush() {
+  if (_buffered == 0) return true;
+  if (!_sink->Write(_buffer, _buffered)) {
+    LOG_ERROR("Failed to write to sink");
+    _failed = true;
+    return false;
+  }
+  _buffered = 0;
+  return true;
+}
+
+bool HexStreamDecoder::Fail(size_t error_offset) {
+  _error_offset = error_offset;
+  _failed = true;
+  return false;
+}
+}  // namespace encode
+}  // namespace btc
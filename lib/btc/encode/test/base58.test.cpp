@@ -5,14 +5,23 @@
 // See LICENSE for details.
 #include <string.h>
 
+#include <algorithm>
+
 #include <gtest/gtest.h>
 
+#include "btc/encode/base58.fixed.hpp"
 #include "btc/encode/base58.hpp"
 #include "btc/encode/hex.hpp"
+#include "btc/test/test_data.hpp"
+
+#define _BTC_ENCODE_BASE58_INTERNAL_
+#include "btc/encode/base58.openssl.hpp"
+#undef _BTC_ENCODE_BASE58_INTERNAL_
 
 namespace btc {
 namespace encode {
 namespace test {
+using ::btc::test::TestDataGenerator;
 namespace {
 const std::string kSampleWalletAddressHex =
     "00f54a5851e9372b87810a8e60cdd2e7cfd80b6e31c7f18fe8";
@@ -20,6 +29,27 @@ const std::vector<uint8_t> kSampleWalletAddress =
     HexDecode(kSampleWalletAddressHex);
 const std::string kSampleWalletAddressBase58 =
     "1PMycacnJaSqwwJqjawXBErnLsZ7RkXUAs";
+
+// Test data with |zeros| leading zero bytes.
+std::vector<uint8_t> MakeTestData(size_t size, size_t zeros, uint32_t seed) {
+  std::vector<uint8_t> data = ::btc::test::MakeTestData(size, seed);
+  std::fill_n(data.begin(), std::min(zeros, size), 0);
+  return data;
+}
+
+std::string OpenSslEncode(const std::vector<uint8_t> &data) {
+  std::string b58(Base58EncodedMaxLength(data.size()), ' ');
+  b58.resize(internal::OpenSslBase58Encode(
+      data.data(), data.size(), &b58.front(), b58.size()));
+  return b58;
+}
+
+std::vector<uint8_t> OpenSslDecode(const std::string &b58) {
+  std::vector<uint8_t> data(Base58DecodedMaxLength(b58.size()));
+  data.resize(internal::OpenSslBase58Decode(
+      b58.data(), b58.size(), data.data(), data.size()));
+  return data;
+}
 }  // namespace
 
 TEST(Base58Test, IsBase58String) {
@@ -112,6 +142,296 @@ TEST(Base58Test, TruncatedDecode) {
     ASSERT_EQ(result, expected_result) << "buffer_size = " << buffer_size;
   }
 }
+
+TEST(Base58Test, EncodeToBuffer) {
+  char buffer[64];
+  const size_t max_length =
+      Base58EncodedMaxLength(kSampleWalletAddress.size());
+  ASSERT_LE(max_length, sizeof(buffer));
+  EXPECT_GE(max_length, kSampleWalletAddressBase58.size());
+  EXPECT_EQ(
+      kSampleWalletAddressBase58.size(),
+      Base58EncodedLength(
+          kSampleWalletAddress.data(), kSampleWalletAddress.size()));
+
+  size_t res = Base58Encode(
+      kSampleWalletAddress.data(), kSampleWalletAddress.size(), buffer,
+      sizeof(buffer));
+  EXPECT_EQ(res, kSampleWalletAddressBase58.size());
+  EXPECT_EQ(std::string(buffer, res), kSampleWalletAddressBase58);
+  // Exact fit and too small.
+  res = Base58Encode(
+      kSampleWalletAddress.data(), kSampleWalletAddress.size(), buffer,
+      kSampleWalletAddressBase58.size());
+  EXPECT_EQ(res, kSampleWalletAddressBase58.size());
+  res = Base58Encode(
+      kSampleWalletAddress.data(), kSampleWalletAddress.size(), buffer,
+      kSampleWalletAddressBase58.size() - 1);
+  EXPECT_EQ(res, 0);
+
+  std::string appended = "address: ";
+  EXPECT_TRUE(Base58EncodeAppend(
+      kSampleWalletAddress.data(), kSampleWalletAddress.size(), &appended));
+  EXPECT_EQ(appended, "address: " + kSampleWalletAddressBase58);
+
+  // Upper bounds hold for all zeros and all ones.
+  for (size_t size = 1; size < 50; size++) {
+    const std::vector<uint8_t> zeros(size, 0x00);
+    const std::vector<uint8_t> ones(size, 0xff);
+    EXPECT_LE(Base58Encode(zeros).size(), Base58EncodedMaxLength(size));
+    EXPECT_LE(Base58Encode(ones).size(), Base58EncodedMaxLength(size));
+    EXPECT_EQ(
+        Base58Encode(ones).size(), Base58EncodedLength(ones.data(), size));
+  }
+}
+
+TEST(Base58Test, DecodeFromPointer) {
+  uint8_t buffer[64];
+  const std::string &b58 = kSampleWalletAddressBase58;
+  EXPECT_EQ(
+      kSampleWalletAddress.size(), Base58DecodedLength(b58.data(), b58.size()));
+  EXPECT_LE(kSampleWalletAddress.size(), Base58DecodedMaxLength(b58.size()));
+  EXPECT_EQ(0, Base58DecodedLength("JxF12TOwUP45BMd", 15));
+
+  const size_t res = Base58Decode(b58.data(), b58.size(), buffer, 64);
+  EXPECT_EQ(res, kSampleWalletAddress.size());
+  EXPECT_EQ(kSampleWalletAddress, std::vector<uint8_t>(buffer, buffer + res));
+
+  std::vector<uint8_t> appended = {0x42};
+  EXPECT_TRUE(Base58DecodeAppend(b58.data(), b58.size(), &appended));
+  std::vector<uint8_t> expected = {0x42};
+  expected.insert(
+      expected.end(), kSampleWalletAddress.begin(), kSampleWalletAddress.end());
+  EXPECT_EQ(appended, expected);
+  // Failures leave the output unchanged.
+  EXPECT_FALSE(Base58DecodeAppend("JxF12TOwUP45BMd", 15, &appended));
+  EXPECT_EQ(appended, expected);
+}
+
+TEST(Base58Test, MatchesOpenSsl) {
+  for (size_t size = 1; size <= 100; size++) {
+    for (const size_t zeros : {size_t(0), size_t(1), size_t(3), size}) {
+      if (zeros > size) continue;
+      const std::vector<uint8_t> data =
+          MakeTestData(size, zeros, static_cast<uint32_t>(size * 7 + zeros));
+      const std::string expected = OpenSslEncode(data);
+      ASSERT_FALSE(expected.empty());
+      ASSERT_EQ(expected, Base58Encode(data))
+          << "size = " << size << ", zeros = " << zeros;
+      ASSERT_EQ(
+          expected.size(), Base58EncodedLength(data.data(), data.size()));
+      ASSERT_EQ(OpenSslDecode(expected), Base58Decode(expected))
+          << "size = " << size << ", zeros = " << zeros;
+      ASSERT_EQ(data, Base58Decode(expected));
+    }
+  }
+  // Large inputs use heap scratch space.
+  const std::vector<uint8_t> large = MakeTestData(4000, 2, 42);
+  const std::string large_b58 = Base58Encode(large);
+  EXPECT_EQ(OpenSslEncode(large), large_b58);
+  EXPECT_EQ(large, Base58Decode(large_b58));
+}
+
+template<size_t kSize>
+void CheckFixedCodec() {
+  using Codec = Base58Fixed<kSize>;
+  std::vector<std::vector<uint8_t>> samples = {
+      std::vector<uint8_t>(kSize, 0x00), std::vector<uint8_t>(kSize, 0xff)};
+  for (size_t zeros = 0; zeros <= 4; zeros++) {
+    samples.push_back(MakeTestData(kSize, zeros, kSize + zeros));
+  }
+  for (const std::vector<uint8_t> &data : samples) {
+    const std::string expected = OpenSslEncode(data);
+    typename Codec::EncodedArray encoded;
+    const size_t length = Codec::Encode(data.data(), &encoded);
+    ASSERT_EQ(expected, std::string(encoded.data(), length));
+
+    typename Codec::DecodedArray decoded;
+    ASSERT_TRUE(Codec::Decode(expected.data(), expected.size(), &decoded));
+    EXPECT_TRUE(std::equal(decoded.begin(), decoded.end(), data.begin()));
+  }
+  // Wrong decoded length.
+  typename Codec::DecodedArray decoded;
+  const std::string shorter =
+      OpenSslEncode(MakeTestData(kSize - 1, 1, kSize));
+  EXPECT_FALSE(Codec::Decode(shorter.data(), shorter.size(), &decoded));
+  const std::string longer = OpenSslEncode(MakeTestData(kSize + 1, 0, kSize));
+  EXPECT_FALSE(Codec::Decode(longer.data(), longer.size(), &decoded));
+  const std::string padded = "1" + OpenSslEncode(MakeTestData(kSize, 0, 3));
+  EXPECT_FALSE(Codec::Decode(padded.data(), padded.size(), &decoded));
+  EXPECT_FALSE(Codec::Decode("1O", 2, &decoded));
+}
+
+TEST(Base58Test, FixedLength) {
+  CheckFixedCodec<25>();
+  CheckFixedCodec<32>();
+  CheckFixedCodec<37>();
+  CheckFixedCodec<38>();
+  CheckFixedCodec<82>();
+
+  using AddressCodec = Base58Fixed<25>;
+  AddressCodec::DecodedArray address;
+  ASSERT_TRUE(AddressCodec::Decode(
+      kSampleWalletAddressBase58.data(), kSampleWalletAddressBase58.size(),
+      &address));
+  EXPECT_TRUE(std::equal(
+      address.begin(), address.end(), kSampleWalletAddress.begin()));
+}
+
+TEST(Base58Test, Batch) {
+  // Pack items of varying sizes into one arena, including an empty one.
+  std::vector<uint8_t> data;
+  std::vector<BatchItem> items;
+  for (size_t i = 0; i < 150; i++) {
+    const size_t size = i == 7 ? 0 : 1 + i % 40;
+    const std::vector<uint8_t> item = MakeTestData(size, i % 3, i);
+    items.push_back({data.size(), size});
+    data.insert(data.end(), item.begin(), item.end());
+  }
+  const size_t count = items.size();
+
+  for (const size_t threads : {1, 3}) {
+    std::string b58(Base58EncodeBatchArenaSize(items.data(), count), ' ');
+    std::vector<BatchItem> encoded(count);
+    std::vector<uint64_t> valid(BatchBitmapWords(count));
+    ASSERT_EQ(count, Base58EncodeBatch(
+        data.data(), items.data(), count, &b58[0], b58.size(),
+        encoded.data(), valid.data(), threads));
+
+    std::vector<BatchItem> b58_items(count);
+    for (size_t i = 0; i < count; i++) {
+      ASSERT_TRUE(IsBatchItemValid(valid.data(), i));
+      const std::string expected =
+          items[i].length == 0 ? "" : Base58Encode(
+              data.data() + items[i].offset, items[i].length);
+      ASSERT_EQ(expected, b58.substr(encoded[i].offset, encoded[i].length));
+      b58_items[i] = encoded[i];
+    }
+    // Corrupt one item.
+    b58[b58_items[5].offset] = '0';
+
+    std::vector<uint8_t> decoded(
+        Base58DecodeBatchArenaSize(b58_items.data(), count));
+    std::vector<BatchItem> decoded_items(count);
+    EXPECT_EQ(count - 1, Base58DecodeBatch(
+        b58.data(), b58_items.data(), count, decoded.data(), decoded.size(),
+        decoded_items.data(), valid.data(), threads));
+    for (size_t i = 0; i < count; i++) {
+      if (i == 5) {
+        EXPECT_FALSE(IsBatchItemValid(valid.data(), i));
+        continue;
+      }
+      ASSERT_TRUE(IsBatchItemValid(valid.data(), i));
+      ASSERT_EQ(items[i].length, decoded_items[i].length);
+      ASSERT_TRUE(std::equal(
+          decoded.begin() + decoded_items[i].offset,
+          decoded.begin() + decoded_items[i].offset + items[i].length,
+          data.begin() + items[i].offset));
+    }
+  }
+
+  // Arena too small, trailing items fail.
+  std::string small(10, ' ');
+  std::vector<BatchItem> encoded(count);
+  std::vector<uint64_t> valid(BatchBitmapWords(count));
+  const size_t encoded_count = Base58EncodeBatch(
+      data.data(), items.data(), count, &small[0], small.size(),
+      encoded.data(), valid.data());
+  EXPECT_LT(encoded_count, count);
+  EXPECT_FALSE(IsBatchItemValid(valid.data(), count - 1));
+}
+
+TEST(Base58Test, Base58Check) {
+  const std::vector<uint8_t> payload(
+      kSampleWalletAddress.begin(), kSampleWalletAddress.end() - 4);
+  EXPECT_EQ(kSampleWalletAddressBase58, Base58CheckEncode(payload));
+  EXPECT_EQ(payload, Base58CheckDecode(kSampleWalletAddressBase58));
+
+  char b58[Base58CheckEncodedMaxLength(21)];
+  EXPECT_EQ(kSampleWalletAddressBase58.size(), Base58CheckEncode(
+      payload.data(), payload.size(), b58, sizeof(b58)));
+  EXPECT_EQ(0, Base58CheckEncode(payload.data(), payload.size(), b58, 10));
+
+  uint8_t decoded[21];
+  EXPECT_EQ(21, Base58CheckDecode(
+      kSampleWalletAddressBase58.data(), kSampleWalletAddressBase58.size(),
+      decoded, sizeof(decoded)));
+  EXPECT_TRUE(std::equal(decoded, decoded + 21, payload.begin()));
+  // Buffer too small.
+  EXPECT_EQ(0, Base58CheckDecode(
+      kSampleWalletAddressBase58.data(), kSampleWalletAddressBase58.size(),
+      decoded, 20));
+  // Bad checksum.
+  std::string corrupt = kSampleWalletAddressBase58;
+  corrupt[10] = corrupt[10] == 'a' ? 'b' : 'a';
+  EXPECT_TRUE(Base58CheckDecode(corrupt).empty());
+  // Not Base58.
+  EXPECT_TRUE(Base58CheckDecode("1PMycacnJaSqwwJqjawXBErnLsZ7RkXUA0").empty());
+  // Too short to carry a checksum.
+  EXPECT_TRUE(Base58CheckDecode("1111").empty());
+  EXPECT_TRUE(Base58CheckDecode("").empty());
+
+  // Large payloads use heap scratch space.
+  const std::vector<uint8_t> large = MakeTestData(500, 3, 11);
+  EXPECT_EQ(large, Base58CheckDecode(Base58CheckEncode(large)));
+}
+
+TEST(Base58Test, Base58CheckBatch) {
+  std::vector<uint8_t> data;
+  std::vector<BatchItem> items;
+  for (size_t i = 0; i < 70; i++) {
+    const std::vector<uint8_t> item = MakeTestData(1 + i % 33, i % 2, i);
+    items.push_back({data.size(), item.size()});
+    data.insert(data.end(), item.begin(), item.end());
+  }
+  const size_t count = items.size();
+  std::string b58(Base58CheckEncodeBatchArenaSize(items.data(), count), ' ');
+  std::vector<BatchItem> encoded(count);
+  std::vector<uint64_t> valid(BatchBitmapWords(count));
+  ASSERT_EQ(count, Base58CheckEncodeBatch(
+      data.data(), items.data(), count, &b58[0], b58.size(), encoded.data(),
+      valid.data(), 2));
+  // Corrupt one checksum.
+  b58[encoded[3].offset + encoded[3].length - 1] =
+      b58[encoded[3].offset + encoded[3].length - 1] == 'z' ? 'y' : 'z';
+
+  std::vector<uint8_t> decoded(
+      Base58CheckDecodeBatchArenaSize(encoded.data(), count));
+  std::vector<BatchItem> decoded_items(count);
+  EXPECT_EQ(count - 1, Base58CheckDecodeBatch(
+      b58.data(), encoded.data(), count, decoded.data(), decoded.size(),
+      decoded_items.data(), valid.data(), 2));
+  for (size_t i = 0; i < count; i++) {
+    ASSERT_EQ(i != 3, IsBatchItemValid(valid.data(), i));
+    if (i == 3) continue;
+    const std::vector<uint8_t> expected(
+        data.begin() + items[i].offset,
+        data.begin() + items[i].offset + items[i].length);
+    ASSERT_EQ(expected, std::vector<uint8_t>(
+        decoded.begin() + decoded_items[i].offset,
+        decoded.begin() + decoded_items[i].offset + decoded_items[i].length));
+  }
+}
+
+TEST(Base58Test, DecodeMatchesOpenSsl) {
+  // Arbitrary strings, not produced by the encoder.
+  const char kCharSet[] =
+      "123456789ABCDEFGHJKLMNPQRSTUVWXYZabcdefghijkmnopqrstuvwxyz";
+  TestDataGenerator generator(7);
+  for (size_t length = 1; length <= 80; length++) {
+    std::string b58(length, '1');
+    for (char &c : b58) c = kCharSet[generator.Next() % 58];
+    const std::vector<uint8_t> expected = OpenSslDecode(b58);
+    ASSERT_EQ(expected, Base58Decode(b58)) << b58;
+    ASSERT_EQ(
+        expected.size(), Base58DecodedLength(b58.data(), b58.size()));
+    // Truncated output matches the prefix.
+    uint8_t buffer[8];
+    const size_t truncated_size = std::min(sizeof(buffer), expected.size());
+    ASSERT_EQ(expected.size(), Base58Decode(b58, buffer, sizeof(buffer)));
+    ASSERT_TRUE(std::equal(buffer, buffer + truncated_size, expected.begin()));
+  }
+}
 }  // namespace test
 }  // namespace encode
 }  // namespace btc
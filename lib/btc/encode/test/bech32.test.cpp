@@ -0,0 +1,260 @@
+// Bitcoin Info - Encoders - Bech32 Encoder - Unittest
+//
+// Copyright (c) 2022 Alex Dale
+// This project is licensed under the terms of the MIT license.
+// See LICENSE for details.
+#include <string.h>
+
+#include <gtest/gtest.h>
+
+#include "btc/encode/bech32.hpp"
+#include "btc/encode/hex.hpp"
+
+namespace btc {
+namespace encode {
+namespace test {
+namespace {
+// BIP-173 and BIP-350 test vectors.
+const std::vector<std::string> kValidBech32 = {
+    "A12UEL5L",
+    "a12uel5l",
+    "an83characterlonghumanreadablepartthatcontainsthenumber1andtheexcluded"
+    "charactersbio1tt5tgs",
+    "abcdef1qpzry9x8gf2tvdw0s3jn54khce6mua7lmqqqxw",
+    "11" + std::string(82, 'q') + "c8247j",
+    "split1checkupstagehandshakeupstreamerranterredcaperred2y9e3w",
+    "?1ezyfcl",
+};
+
+const std::vector<std::string> kValidBech32m = {
+    "A1LQFN3A",
+    "a1lqfn3a",
+    "an83characterlonghumanreadablepartthatcontainsthetheexcludedcharacters"
+    "bioandnumber11sg7hg6",
+    "abcdef1l7aum6echk45nj3s0wdvt2fg8x9yrzpqzd3ryx",
+    "11" + std::string(82, 'l') + "ludsr8",
+    "split1checkupstagehandshakeupstreamerranterredcaperredlc445v",
+    "?1v759aa",
+};
+
+const std::vector<std::string> kInvalidBech32 = {
+    // Character out of range.
+    std::string("\x20") + "1nwldj5",
+    "\x7f" "1axkwrx",
+    // Overall max length exceeded.
+    "an84characterslonghumanreadablepartthatcontainsthenumber1andtheexcluded"
+    "charactersbio1569pvx",
+    // No separator.
+    "pzry9x0s0muk",
+    // Empty HRP.
+    "1pzry9x0s0muk",
+    // Invalid data character.
+    "x1b4n0q5v",
+    // Too short checksum.
+    "li1dgmt3",
+    // Invalid character in checksum.
+    "A1G7SGD8",
+    // Mixed case.
+    "a12UEL5L",
+    // Checksum calculated with uppercase HRP.
+    "A12uEL5L",
+};
+
+struct SegwitVector {
+  std::string address;
+  uint8_t version;
+  std::string program_hex;
+};
+
+const std::vector<SegwitVector> kValidSegwit = {
+    {"BC1QW508D6QEJXTDG4Y5R3ZARVARY0C5XW7KV8F3T4", 0,
+     "751e76e8199196d454941c45d1b3a323f1433bd6"},
+    {"tb1qrp33g0q5c5txsp9arysrx4k6zdkfs4nce4xj0gdcccefvpysxf3q0sl5k7", 0,
+     "1863143c14c5166804bd19203356da136c985678cd4d27a1b8c6329604903262"},
+    {"bc1pw508d6qejxtdg4y5r3zarvary0c5xw7kw508d6qejxtdg4y5r3zarvary0c5xw7kt5"
+     "nd6y", 1,
+     "751e76e8199196d454941c45d1b3a323f1433bd6751e76e8199196d454941c45d1b3a3"
+     "23f1433bd6"},
+    {"BC1SW50QGDZ25J", 16, "751e"},
+    {"bc1zw508d6qejxtdg4y5r3zarvaryvaxxpcs", 2,
+     "751e76e8199196d454941c45d1b3a323"},
+    {"bc1p0xlxvlhemja6c4dqv22uapctqupfhlxm9h8z3k2e72q4k9hcz7vqzk5jj0", 1,
+     "79be667ef9dcbbac55a06295ce870b07029bfcdb2dce28d959f2815b16f81798"},
+};
+
+const std::vector<std::string> kInvalidSegwit = {
+    // Version 0 with Bech32m.
+    "bc1qw508d6qejxtdg4y5r3zarvary0c5xw7kemeawh",
+    // Version 1 with Bech32.
+    "tb1q0xlxvlhemja6c4dqv22uapctqupfhlxm9h8z3k2e72q4k9hcz7vq24jc47",
+    // Invalid character.
+    "bc1p38j9r5y49hruaue7wxjce0updqjuyyx0kh56v8s25huc6995vvpql3jow4",
+    // Invalid version.
+    "BC130XLXVLHEMJA6C4DQV22UAPCTQUPFHLXM9H8Z3K2E72Q4K9HCZ7VQ7ZWS8R",
+    // Program too short.
+    "bc1pw5dgrnzv",
+    // Invalid version 0 program length.
+    "BC1QR508D6QEJXTDG4Y5R3ZARVARYV98GJ9P",
+    // Mixed case.
+    "tb1p0xlxvlhemja6c4dqv22uapctqupfhlxm9h8z3k2e72q4k9hcz7vq47Zagq",
+    // Empty program.
+    "bc1gmk9yu",
+};
+
+std::string Hrp(const std::string &address) {
+  std::string hrp = address.substr(0, address.rfind('1'));
+  for (char &c : hrp) c = static_cast<char>(tolower(c));
+  return hrp;
+}
+
+std::string ToLower(std::string s) {
+  for (char &c : s) c = static_cast<char>(tolower(c));
+  return s;
+}
+}  // namespace
+
+TEST(Bech32Test, RegroupBits) {
+  const std::vector<uint8_t> data = HexDecode("00ff10807fc3");
+  uint8_t values[16];
+  size_t values_length = 0;
+  ASSERT_TRUE(Bech32BytesToValues(
+      data.data(), data.size(), values, sizeof(values), &values_length));
+  EXPECT_EQ(Bech32ValuesLength(data.size()), values_length);
+  uint8_t bytes[16];
+  size_t length = 0;
+  ASSERT_TRUE(Bech32ValuesToBytes(
+      values, values_length, bytes, sizeof(bytes), &length));
+  EXPECT_EQ(data, std::vector<uint8_t>(bytes, bytes + length));
+
+  // Output too small.
+  EXPECT_FALSE(Bech32BytesToValues(
+      data.data(), data.size(), values, values_length - 1, &values_length));
+  // Non-zero padding.
+  const uint8_t bad_padding[] = {0x1f, 0x1f};
+  EXPECT_FALSE(Bech32ValuesToBytes(
+      bad_padding, sizeof(bad_padding), bytes, sizeof(bytes), &length));
+  // Value out of range.
+  const uint8_t bad_value[] = {0x20, 0x00};
+  EXPECT_FALSE(Bech32ValuesToBytes(
+      bad_value, sizeof(bad_value), bytes, sizeof(bytes), &length));
+}
+
+TEST(Bech32Test, Decode) {
+  for (const auto &vectors : {std::make_pair(kBech32, &kValidBech32),
+                              std::make_pair(kBech32m, &kValidBech32m)}) {
+    for (const std::string &b32 : *vectors.second) {
+      Bech32Decoded decoded;
+      ASSERT_EQ(vectors.first, Bech32Decode(b32.data(), b32.size(), &decoded))
+          << b32;
+      EXPECT_EQ(Hrp(b32), std::string(decoded.hrp));
+      // Re-encoding produces the lowercase string.
+      const std::vector<uint8_t> values(
+          decoded.values, decoded.values + decoded.values_length);
+      EXPECT_EQ(ToLower(b32), Bech32Encode(vectors.first, decoded.hrp, values));
+      // Bech32 and Bech32m checksums are distinct.
+      const Bech32Encoding other =
+          vectors.first == kBech32 ? kBech32m : kBech32;
+      EXPECT_NE(ToLower(b32), Bech32Encode(other, decoded.hrp, values));
+    }
+  }
+  for (const std::string &b32 : kInvalidBech32) {
+    Bech32Decoded decoded;
+    EXPECT_EQ(kBech32Invalid, Bech32Decode(b32.data(), b32.size(), &decoded))
+        << b32;
+  }
+}
+
+TEST(Bech32Test, Encode) {
+  const std::vector<uint8_t> values = {0, 1, 2, 31};
+  char b32[kBech32MaxLength];
+  // Uppercase HRP is not valid for encoding.
+  EXPECT_EQ(0, Bech32Encode(
+      kBech32, "BC", 2, values.data(), values.size(), b32, sizeof(b32)));
+  EXPECT_EQ(0, Bech32Encode(
+      kBech32, "", 0, values.data(), values.size(), b32, sizeof(b32)));
+  // Buffer too small.
+  EXPECT_EQ(0, Bech32Encode(
+      kBech32, "bc", 2, values.data(), values.size(), b32, 12));
+  EXPECT_EQ(13, Bech32Encode(
+      kBech32, "bc", 2, values.data(), values.size(), b32, 13));
+  // Values must be 5 bits.
+  const uint8_t bad_values[] = {32};
+  EXPECT_EQ(0, Bech32Encode(kBech32, "bc", 2, bad_values, 1, b32, sizeof(b32)));
+}
+
+TEST(Bech32Test, SegwitAddress) {
+  for (const SegwitVector &vector : kValidSegwit) {
+    const std::string hrp = Hrp(vector.address);
+    uint8_t version = 0xff;
+    uint8_t program[kSegwitProgramMaxLength];
+    size_t program_size = 0;
+    ASSERT_TRUE(SegwitAddressDecode(
+        hrp.data(), hrp.size(), vector.address.data(), vector.address.size(),
+        &version, program, &program_size)) << vector.address;
+    EXPECT_EQ(vector.version, version);
+    EXPECT_EQ(vector.program_hex, HexEncode(program, program_size));
+    EXPECT_EQ(
+        ToLower(vector.address),
+        SegwitAddressEncode(hrp, version, HexDecode(vector.program_hex)));
+    // Wrong network.
+    EXPECT_FALSE(SegwitAddressDecode(
+        "ltc", 3, vector.address.data(), vector.address.size(), &version,
+        program, &program_size));
+  }
+  for (const std::string &address : kInvalidSegwit) {
+    const std::string hrp = Hrp(address);
+    uint8_t version = 0;
+    uint8_t program[kSegwitProgramMaxLength];
+    size_t program_size = 0;
+    EXPECT_FALSE(SegwitAddressDecode(
+        hrp.data(), hrp.size(), address.data(), address.size(), &version,
+        program, &program_size)) << address;
+  }
+  // Invalid programs are not encoded.
+  EXPECT_TRUE(SegwitAddressEncode("bc", 0, HexDecode("751e")).empty());
+  EXPECT_TRUE(SegwitAddressEncode("bc", 17, HexDecode("751e")).empty());
+  EXPECT_TRUE(SegwitAddressEncode("bc", 1, HexDecode("75")).empty());
+}
+
+TEST(Bech32Test, SegwitAddressBatch) {
+  // Items are the witness version followed by the program.
+  std::vector<uint8_t> data;
+  std::vector<BatchItem> items;
+  for (size_t i = 0; i < 100; i++) {
+    const SegwitVector &vector = kValidSegwit[i % kValidSegwit.size()];
+    const std::vector<uint8_t> program = HexDecode(vector.program_hex);
+    items.push_back({data.size(), program.size() + 1});
+    data.push_back(vector.version);
+    data.insert(data.end(), program.begin(), program.end());
+  }
+  // Invalid version.
+  data[items[4].offset] = 17;
+  const size_t count = items.size();
+
+  std::string addresses(SegwitAddressEncodeBatchArenaSize(count), ' ');
+  std::vector<BatchItem> encoded(count);
+  std::vector<uint64_t> valid(BatchBitmapWords(count));
+  EXPECT_EQ(count - 1, SegwitAddressEncodeBatch(
+      "bc", 2, data.data(), items.data(), count, &addresses[0],
+      addresses.size(), encoded.data(), valid.data(), 2));
+  EXPECT_FALSE(IsBatchItemValid(valid.data(), 4));
+  encoded[4] = encoded[3];
+
+  std::vector<uint8_t> decoded(SegwitAddressDecodeBatchArenaSize(count));
+  std::vector<BatchItem> decoded_items(count);
+  EXPECT_EQ(count, SegwitAddressDecodeBatch(
+      "bc", 2, addresses.data(), encoded.data(), count, decoded.data(),
+      decoded.size(), decoded_items.data(), valid.data(), 2));
+  for (size_t i = 0; i < count; i++) {
+    if (i == 4) continue;
+    ASSERT_TRUE(IsBatchItemValid(valid.data(), i));
+    ASSERT_EQ(items[i].length, decoded_items[i].length);
+    ASSERT_TRUE(std::equal(
+        decoded.begin() + decoded_items[i].offset,
+        decoded.begin() + decoded_items[i].offset + decoded_items[i].length,
+        data.begin() + items[i].offset));
+  }
+}
+}  // namespace test
+}  // namespace encode
+}  // namespace btc
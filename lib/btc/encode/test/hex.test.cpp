@@ -6,10 +6,13 @@
 #include <gtest/gtest.h>
 
 #include "btc/encode/hex.hpp"
+#include "btc/encode/hex.literal.hpp"
+#include "btc/test/test_data.hpp"
 
 namespace btc {
 namespace encode {
 namespace test {
+using ::btc::test::MakeTestData;
 namespace {
 const std::string kEmptyString = "";
 const std::string kHelloWorld = "Hello, World!";
@@ -25,6 +28,19 @@ constexpr size_t kHelloWorldSize = 13;
 
 constexpr bool kForward = false;
 constexpr bool kReverse = true;
+
+const HexKernel kAllHexKernels[] = {
+    kHexKernelScalar, kHexKernelSwar, kHexKernelSsse3, kHexKernelAvx2};
+
+// Restores the automatically selected kernel.
+class HexKernelTest: public ::testing::Test {
+protected:
+  void SetUp() override { _kernel = GetHexKernel(); }
+  void TearDown() override { SetHexKernel(_kernel); }
+
+private:
+  HexKernel _kernel = kHexKernelScalar;
+};
 }  // namespace
 
 TEST(HexTest, IsHexString) {
@@ -107,6 +123,172 @@ TEST(HexTest, Decode) {
   EXPECT_EQ(kHelloWorld, HexDecodeToString(kHexHelloWorldUpper));
   EXPECT_EQ(kHelloWorld, HexDecodeToString(kHexHelloWorldReverse, kReverse));
 }
+
+TEST_F(HexKernelTest, Supported) {
+  EXPECT_TRUE(IsHexKernelSupported(kHexKernelScalar));
+  EXPECT_TRUE(IsHexKernelSupported(kHexKernelSwar));
+  EXPECT_TRUE(IsHexKernelSupported(GetHexKernel()));
+  for (const HexKernel kernel : kAllHexKernels) {
+    EXPECT_EQ(IsHexKernelSupported(kernel), SetHexKernel(kernel))
+        << HexKernelToString(kernel);
+  }
+}
+
+TEST_F(HexKernelTest, EncodeMatchesScalar) {
+  const std::vector<uint8_t> data = MakeTestData(300, 0x12345678);
+  for (const HexKernel kernel : kAllHexKernels) {
+    if (!IsHexKernelSupported(kernel)) continue;
+    // Sizes around each of the kernel block boundaries.
+    for (size_t size = 1; size <= data.size(); size++) {
+      for (const bool reverse : {kForward, kReverse}) {
+        ASSERT_TRUE(SetHexKernel(kHexKernelScalar));
+        const std::string expected = HexEncode(data.data(), size, reverse);
+        ASSERT_TRUE(SetHexKernel(kernel));
+        ASSERT_EQ(expected, HexEncode(data.data(), size, reverse))
+            << HexKernelToString(kernel) << ": size = " << size
+            << ", reverse = " << reverse;
+      }
+    }
+  }
+}
+
+TEST(HexTest, EncodeToBuffer) {
+  static_assert(HexEncodedLength(kHelloWorldSize) == 26, "Bad length");
+  char buffer[64];
+  EXPECT_EQ(
+      kHexHelloWorld.size(),
+      HexEncode(
+          kHelloWorldVector.data(), kHelloWorldSize, buffer, sizeof(buffer)));
+  EXPECT_EQ(kHexHelloWorld, std::string(buffer, kHexHelloWorld.size()));
+  EXPECT_EQ(
+      kHexHelloWorld.size(),
+      HexEncode(
+          kHelloWorldVector.data(), kHelloWorldSize, buffer,
+          kHexHelloWorld.size(), kReverse));
+  EXPECT_EQ(kHexHelloWorldReverse, std::string(buffer, kHexHelloWorld.size()));
+  // Too small.
+  EXPECT_EQ(
+      0, HexEncode(
+             kHelloWorldVector.data(), kHelloWorldSize, buffer,
+             kHexHelloWorld.size() - 1));
+
+  std::string appended = "0x";
+  HexEncodeAppend(kHelloWorldVector.data(), kHelloWorldSize, &appended);
+  EXPECT_EQ("0x" + kHexHelloWorld, appended);
+  HexEncodeAppend(
+      kHelloWorldVector.data(), kHelloWorldSize, &appended, kReverse);
+  EXPECT_EQ("0x" + kHexHelloWorld + kHexHelloWorldReverse, appended);
+}
+
+TEST(HexTest, DecodeFromPointer) {
+  static_assert(HexDecodedLength(26) == kHelloWorldSize, "Bad length");
+  uint8_t buffer[64];
+  EXPECT_EQ(
+      kHelloWorldSize, HexDecode(
+                           kHexHelloWorld.data(), kHexHelloWorld.size(), buffer,
+                           sizeof(buffer)));
+  EXPECT_EQ(kHelloWorldVector, std::vector<uint8_t>(buffer, buffer + 13));
+  EXPECT_TRUE(IsHexString(kHexHelloWorld.data(), kHexHelloWorld.size()));
+  EXPECT_FALSE(IsHexString(kNotHex.data(), kNotHex.size()));
+
+  std::vector<uint8_t> appended = {0xff};
+  EXPECT_TRUE(HexDecodeAppend(
+      kHexHelloWorldReverse.data(), kHexHelloWorldReverse.size(), &appended,
+      kReverse));
+  std::vector<uint8_t> expected = {0xff};
+  expected.insert(
+      expected.end(), kHelloWorldVector.begin(), kHelloWorldVector.end());
+  EXPECT_EQ(expected, appended);
+  // Failures leave the output unchanged.
+  EXPECT_FALSE(HexDecodeAppend(kNotHex.data(), kNotHex.size(), &appended));
+  EXPECT_FALSE(HexDecodeAppend("abc", 3, &appended));
+  EXPECT_EQ(expected, appended);
+}
+
+TEST(HexTest, DecodeErrorOffset) {
+  uint8_t buffer[64];
+  size_t error_offset = 0;
+  EXPECT_EQ(
+      0, HexDecode("abcde", buffer, sizeof(buffer), kForward, &error_offset));
+  EXPECT_EQ(4, error_offset);
+  EXPECT_EQ(
+      0, HexDecode("abcdxf", buffer, sizeof(buffer), kForward, &error_offset));
+  EXPECT_EQ(4, error_offset);
+  EXPECT_EQ(
+      0, HexDecode(kNotHex, buffer, sizeof(buffer), kReverse, &error_offset));
+  EXPECT_EQ(0, error_offset);
+
+  EXPECT_EQ(0, FindInvalidHexCharacter(kNotHex));
+  EXPECT_EQ(kHexHelloWorld.size(), FindInvalidHexCharacter(kHexHelloWorld));
+  EXPECT_EQ(5, FindInvalidHexCharacter("12345g7"));
+  EXPECT_EQ(3, FindInvalidHexCharacter("abc"));
+}
+
+TEST_F(HexKernelTest, DecodeMatchesScalar) {
+  const std::vector<uint8_t> data = MakeTestData(300, 0x12345678);
+  for (const HexKernel kernel : kAllHexKernels) {
+    if (!IsHexKernelSupported(kernel)) continue;
+    ASSERT_TRUE(SetHexKernel(kernel));
+    for (size_t size = 1; size <= data.size(); size++) {
+      const std::vector<uint8_t> expected(data.begin(), data.begin() + size);
+      std::string hex = HexEncode(expected, kForward);
+      ASSERT_EQ(expected, HexDecode(hex, kForward))
+          << HexKernelToString(kernel) << ": size = " << size;
+      ASSERT_EQ(expected, HexDecode(HexEncode(expected, kReverse), kReverse))
+          << HexKernelToString(kernel) << ": size = " << size;
+      // Mixed case.
+      for (size_t i = 0; i < hex.size(); i += 3) hex[i] = toupper(hex[i]);
+      ASSERT_EQ(expected, HexDecode(hex, kForward))
+          << HexKernelToString(kernel) << ": size = " << size;
+      ASSERT_TRUE(IsHexString(hex));
+    }
+  }
+}
+
+TEST_F(HexKernelTest, DecodeRejectsEveryPosition) {
+  const std::string valid = HexEncode(MakeTestData(80, 0x12345678));
+  // Boundary characters of the accepted ranges, and bytes with the
+  // high bit set.
+  const char kBadCharacters[] = {
+      '/', ':', '@', 'G', '`', 'g', ' ', '\x80', '\xb0', '\xe1'};
+  uint8_t buffer[80];
+  for (const HexKernel kernel : kAllHexKernels) {
+    if (!IsHexKernelSupported(kernel)) continue;
+    ASSERT_TRUE(SetHexKernel(kernel));
+    for (size_t offset = 0; offset < valid.size(); offset++) {
+      for (const char bad : kBadCharacters) {
+        std::string hex = valid;
+        hex[offset] = bad;
+        size_t error_offset = 0;
+        for (const bool reverse : {kForward, kReverse}) {
+          ASSERT_EQ(
+              0,
+              HexDecode(hex, buffer, sizeof(buffer), reverse, &error_offset));
+          ASSERT_EQ(offset, error_offset)
+              << HexKernelToString(kernel) << ": bad = " << int(bad);
+        }
+        ASSERT_FALSE(IsHexString(hex));
+        ASSERT_EQ(offset, FindInvalidHexCharacter(hex));
+      }
+    }
+  }
+}
+
+TEST(HexTest, Literal) {
+  using namespace ::btc::encode::literals;
+  constexpr auto kHello = "48656c6c6f2c20576F726C6421"_hex;
+  static_assert(kHello.size() == kHelloWorldSize, "");
+  static_assert(kHello[0] == 'H' && kHello[12] == '!', "");
+  EXPECT_EQ(
+      std::vector<uint8_t>(kHello.begin(), kHello.end()), kHelloWorldVector);
+
+  constexpr auto kReversed = "48656c6c6f2c20576f726c6421"_rhex;
+  static_assert(kReversed[0] == '!' && kReversed[12] == 'H', "");
+  EXPECT_EQ(
+      HexEncode(kReversed.data(), kReversed.size()), kHexHelloWorldReverse);
+
+  static_assert(""_hex.size() == 0, "");
+}
 }  // namespace test
 }  // namespace encode
 }  // namespace btc
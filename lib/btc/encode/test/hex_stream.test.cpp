@@ -0,0 +1,152 @@
+// Bitcoin Info - Encoders - Streaming Hexadecimal Encoder - Unittest
+//
+// Copyright (c) 2022 Alex Dale
+// This project is licensed under the terms of the MIT license.
+// See LICENSE for details.
+#include <stdio.h>
+#include <unistd.h>
+
+#include <sstream>
+
+#include <gtest/gtest.h>
+
+#include "btc/encode/hex.hpp"
+#include "btc/encode/hex_stream.hpp"
+#include "btc/test/test_data.hpp"
+
+namespace btc {
+namespace encode {
+namespace test {
+using ::btc::test::MakeTestData;
+namespace {
+// Collects sink output, counting writes.
+struct Collector {
+  std::string output = {};
+  size_t writes = 0;
+  size_t max_write = 0;
+
+  std::unique_ptr<StreamSink> Sink() {
+    return StreamSink::FromCallback([this](const uint8_t *data, size_t size) {
+      output.append(reinterpret_cast<const char *>(data), size);
+      writes++;
+      max_write = std::max(max_write, size);
+      return true;
+    });
+  }
+};
+}  // namespace
+
+TEST(HexStreamTest, Encode) {
+  // Larger than the working buffer.
+  const std::vector<uint8_t> data = MakeTestData(20000);
+  const std::string expected = HexEncode(data);
+  for (const size_t chunk : {1, 7, 1000, 2048, 20000}) {
+    Collector collector;
+    auto sink = collector.Sink();
+    HexStreamEncoder encoder(sink.get());
+    for (size_t i = 0; i < data.size(); i += chunk) {
+      ASSERT_TRUE(encoder.Update(
+          data.data() + i, std::min(chunk, data.size() - i)));
+    }
+    ASSERT_TRUE(encoder.Finalize());
+    EXPECT_EQ(expected, collector.output) << "chunk = " << chunk;
+    EXPECT_EQ(data.size(), encoder.Count());
+    EXPECT_LE(collector.max_write, HexStreamEncoder::kBufferSize);
+  }
+}
+
+TEST(HexStreamTest, Decode) {
+  const std::vector<uint8_t> data = MakeTestData(10000);
+  const std::string hex = HexEncode(data);
+  // Odd chunk sizes split bytes across chunks.
+  for (const size_t chunk : {1, 3, 7, 1001, 8192, 20000}) {
+    Collector collector;
+    auto sink = collector.Sink();
+    HexStreamDecoder decoder(sink.get());
+    for (size_t i = 0; i < hex.size(); i += chunk) {
+      ASSERT_TRUE(decoder.Update(
+          hex.data() + i, std::min(chunk, hex.size() - i)));
+    }
+    ASSERT_TRUE(decoder.Finalize());
+    EXPECT_EQ(std::string(data.begin(), data.end()), collector.output)
+        << "chunk = " << chunk;
+    EXPECT_EQ(hex.size(), decoder.Count());
+    EXPECT_LE(collector.max_write, HexStreamDecoder::kBufferSize);
+  }
+}
+
+TEST(HexStreamTest, DecodeErrors) {
+  Collector collector;
+  auto sink = collector.Sink();
+  {
+    HexStreamDecoder decoder(sink.get());
+    EXPECT_TRUE(decoder.Update("abc", 3));
+    EXPECT_FALSE(decoder.Update("g0", 2));
+    EXPECT_EQ(3, decoder.error_offset());
+    // Errors are sticky.
+    EXPECT_FALSE(decoder.Update("00", 2));
+    EXPECT_FALSE(decoder.Finalize());
+  }
+  {
+    HexStreamDecoder decoder(sink.get());
+    EXPECT_TRUE(decoder.Update("abcd", 4));
+    EXPECT_FALSE(decoder.Update("0123x5", 6));
+    EXPECT_EQ(8, decoder.error_offset());
+  }
+  {
+    // Invalid digit left over at the end of a chunk.
+    HexStreamDecoder decoder(sink.get());
+    EXPECT_FALSE(decoder.Update("abx", 3));
+    EXPECT_EQ(2, decoder.error_offset());
+  }
+  {
+    HexStreamDecoder decoder(sink.get());
+    EXPECT_TRUE(decoder.Update("abc", 3));
+    EXPECT_FALSE(decoder.Finalize());
+    EXPECT_EQ(2, decoder.error_offset());
+  }
+}
+
+TEST(HexStreamTest, SinkFailure) {
+  auto sink = StreamSink::FromCallback(
+      [](const uint8_t *, size_t) { return false; });
+  ASSERT_TRUE(sink);
+  HexStreamEncoder encoder(sink.get());
+  const std::vector<uint8_t> data = MakeTestData(10);
+  EXPECT_TRUE(encoder.Update(data.data(), data.size()));
+  EXPECT_FALSE(encoder.Finalize());
+  EXPECT_TRUE(encoder.failed());
+  EXPECT_FALSE(encoder.Update(data.data(), data.size()));
+
+  EXPECT_FALSE(StreamSink::FromCallback(nullptr));
+  EXPECT_FALSE(StreamSink::FromFd(-1));
+}
+
+TEST(HexStreamTest, OstreamAndFdSinks) {
+  const std::vector<uint8_t> data = MakeTestData(5000);
+  const std::string hex = HexEncode(data);
+
+  std::ostringstream stream;
+  auto ostream_sink = StreamSink::FromOstream(&stream);
+  HexStreamEncoder encoder(ostream_sink.get());
+  ASSERT_TRUE(encoder.Update(data.data(), data.size()));
+  ASSERT_TRUE(encoder.Finalize());
+  EXPECT_EQ(hex, stream.str());
+
+  FILE *file = tmpfile();
+  ASSERT_NE(file, nullptr);
+  auto fd_sink = StreamSink::FromFd(fileno(file));
+  ASSERT_TRUE(fd_sink);
+  HexStreamDecoder decoder(fd_sink.get());
+  ASSERT_TRUE(decoder.Update(hex.data(), hex.size()));
+  ASSERT_TRUE(decoder.Finalize());
+  std::vector<uint8_t> read_back(data.size() + 1);
+  ASSERT_EQ(0, fseek(file, 0, SEEK_SET));
+  EXPECT_EQ(data.size(), fread(read_back.data(), 1, read_back.size(), file));
+  read_back.resize(data.size());
+  EXPECT_EQ(data, read_back);
+  fclose(file);
+}
+}  // namespace test
+}  // namespace encode
+}  // namespace btc
@@ -0,0 +1,111 @@
+// Bitcoin Info - CPU Features
+//
+// Copyright (c) 2022 Alex Dale
+// This project is licensed under the terms of the MIT license.
+// See LICENSE for details.
+#include "btc/cpu.h"
+
+#ifdef BTC_ARCH_X86
+#  include <cpuid.h>
+#endif
+
+// Marks that detection has completed, allows for caching a result
+// of zero features.
+#define BTC_CPU_DETECTED (1u << 31)
+
+static uint32_t g_cpu_features = 0;
+
+#ifdef BTC_ARCH_X86
+// CPUID.1:ECX
+#  define CPUID_1_ECX_SSSE3 (1u << 9)
+#  define CPUID_1_ECX_SSE41 (1u << 19)
+#  define CPUID_1_ECX_OSXSAVE (1u << 27)
+#  define CPUID_1_ECX_AVX (1u << 28)
+// CPUID.7.0:EBX
+#  define CPUID_7_EBX_AVX2 (1u << 5)
+#  define CPUID_7_EBX_BMI2 (1u << 8)
+#  define CPUID_7_EBX_AVX512F (1u << 16)
+#  define CPUID_7_EBX_SHA (1u << 29)
+#  define CPUID_7_EBX_AVX512BW (1u << 30)
+#  define CPUID_7_EBX_AVX512VL (1u << 31)
+// XCR0 register state components.
+#  define XCR0_SSE_AVX 0x06u
+#  define XCR0_AVX512 0xe0u
+
+static uint32_t read_xcr0(void) {
+  uint32_t eax, edx;
+  __asm__ volatile("xgetbv" : "=a"(eax), "=d"(edx) : "c"(0));
+  return eax;
+}
+
+static uint32_t detect_features(void) {
+  uint32_t eax, ebx, ecx, edx;
+  uint32_t features = 0;
+  if (!__get_cpuid(1, &eax, &ebx, &ecx, &edx)) return 0;
+  if (ecx & CPUID_1_ECX_SSSE3) features |= BTC_CPU_SSSE3;
+  if (ecx & CPUID_1_ECX_SSE41) features |= BTC_CPU_SSE41;
+  // AVX registers must be enabled by the OS as well.
+  uint32_t xcr0 = 0;
+  if (ecx & CPUID_1_ECX_OSXSAVE) xcr0 = read_xcr0();
+  const bool os_avx = (xcr0 & XCR0_SSE_AVX) == XCR0_SSE_AVX;
+  const bool os_avx512 = os_avx && (xcr0 & XCR0_AVX512) == XCR0_AVX512;
+  if (os_avx && (ecx & CPUID_1_ECX_AVX)) features |= BTC_CPU_AVX;
+
+  if (!__get_cpuid_count(7, 0, &eax, &ebx, &ecx, &edx)) return features;
+  if (ebx & CPUID_7_EBX_BMI2) features |= BTC_CPU_BMI2;
+  if (ebx & CPUID_7_EBX_SHA) features |= BTC_CPU_SHA;
+  if (os_avx && (ebx & CPUID_7_EBX_AVX2)) features |= BTC_CPU_AVX2;
+  if (os_avx512 && (ebx & CPUID_7_EBX_AVX512F)) {
+    features |= BTC_CPU_AVX512F;
+    if (ebx & CPUID_7_EBX_AVX512BW) features |= BTC_CPU_AVX512BW;
+    if (ebx & CPUID_7_EBX_AVX512VL) features |= BTC_CPU_AVX512VL;
+  }
+  return features;
+}
+#else
+static uint32_t detect_features(void) {
+  return 0;
+}
+#endif  // BTC_ARCH_X86
+
+uint32_t btc_cpu_features(void) {
+  // Detection is idempotent, racing threads will store the same value.
+  uint32_t features = __atomic_load_n(&g_cpu_features, __ATOMIC_RELAXED);
+  if (features & BTC_CPU_DETECTED) return features & ~BTC_CPU_DETECTED;
+  features = detect_features();
+  __atomic_store_n(
+      &g_cpu_features, features | BTC_CPU_DETECTED, __ATOMIC_RELAXED);
+  return features;
+}
+
+bool btc_cpu_has(btc_cpu_feature_t feature) {
+  return (btc_cpu_features() & ((uint32_t) feature)) != 0;
+}
+
+bool btc_cpu_has_all(uint32_t features) {
+  return (btc_cpu_features() & features) == features;
+}
+
+const char *btc_cpu_feature_to_string(btc_cpu_feature_t feature) {
+  switch (feature) {
+    case BTC_CPU_SSSE3:
+      return "SSSE3";
+    case BTC_CPU_SSE41:
+      return "SSE4.1";
+    case BTC_CPU_AVX:
+      return "AVX";
+    case BTC_CPU_AVX2:
+      return "AVX2";
+    case BTC_CPU_BMI2:
+      return "BMI2";
+    case BTC_CPU_AVX512F:
+      return "AVX-512F";
+    case BTC_CPU_AVX512BW:
+      return "AVX-512BW";
+    case BTC_CPU_AVX512VL:
+      return "AVX-512VL";
+    case BTC_CPU_SHA:
+      return "SHA";
+  }
+  return "<unknown>";
+}
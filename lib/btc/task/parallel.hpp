@@ -0,0 +1,30 @@
+// Bitcoin Info - Tasks - Parallel Loops
+//
+// Copyright (c) 2022 Alex Dale
+// This project is licensed under the terms of the MIT license.
+// See LICENSE for details.
+#ifndef _BTC_TASK_PARALLEL_HPP_
+#define _BTC_TASK_PARALLEL_HPP_
+
+#include <functional>
+
+#include "btc/cc/base.h"
+
+namespace btc {
+namespace task {
+// Number of threads used when a caller requests 0 threads.  Based on
+// the hardware concurrency, never less than 1.
+size_t DefaultThreadCount();
+
+// Splits [0, count) into contiguous ranges and calls |body| with each
+// [begin, end) range, using up to |threads| threads (0 for the
+// default).  Ranges begin on multiples of |grain|, which allows
+// workers to own whole words of a shared bitmap.  The calling thread
+// does part of the work; returns once all ranges are complete.
+using ParallelBody = std::function<void(size_t begin, size_t end)>;
+void ParallelFor(
+    size_t count, size_t threads, const ParallelBody &body, size_t grain = 1);
+}  // namespace task
+}  // namespace btc
+
+#endif  // _BTC_TASK_PARALLEL_HPP_
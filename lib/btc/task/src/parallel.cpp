@@ -0,0 +1,46 @@
+// Bitcoin Info - Tasks - Parallel Loops
+//
+// Copyright (c) 2022 Alex Dale
+// This project is licensed under the terms of the MIT license.
+// See LICENSE for details.
+#include <algorithm>
+#include <thread>
+#include <vector>
+
+#include "btc/cc/debug.h"
+#include "btc/task/parallel.hpp"
+
+namespace btc {
+namespace task {
+
+size_t DefaultThreadCount() {
+  const size_t hardware = std::thread::hardware_concurrency();
+  return hardware > 0 ? hardware : 1;
+}
+
+void ParallelFor(
+    size_t count, size_t threads, const ParallelBody &body, size_t grain) {
+  DASSERT(body);
+  if (count == 0) return;
+  if (grain == 0) grain = 1;
+  if (threads == 0) threads = DefaultThreadCount();
+  // Each worker gets at least one grain.
+  const size_t grains = (count + grain - 1) / grain;
+  threads = std::min(threads, grains);
+  if (threads <= 1) {
+    body(0, count);
+    return;
+  }
+  const size_t grains_per_thread = (grains + threads - 1) / threads;
+  const size_t chunk = grains_per_thread * grain;
+  std::vector<std::thread> workers;
+  workers.reserve(threads - 1);
+  for (size_t begin = chunk; begin < count; begin += chunk) {
+    const size_t end = std::min(begin + chunk, count);
+    workers.emplace_back(body, begin, end);
+  }
+  body(0, std::min(chunk, count));
+  for (std::thread &worker : workers) worker.join();
+}
+}  // namespace task
+}  // namespace btc
@@ -0,0 +1,47 @@
+// Bitcoin Info - Tasks - Parallel Loops - Unittest
+//
+// Copyright (c) 2022 Alex Dale
+// This project is licensed under the terms of the MIT license.
+// See LICENSE for details.
+#include <atomic>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "btc/task/parallel.hpp"
+
+namespace btc {
+namespace task {
+namespace test {
+
+TEST(ParallelTest, DefaultThreadCount) {
+  EXPECT_GE(DefaultThreadCount(), 1);
+}
+
+TEST(ParallelTest, CoversRangeOnce) {
+  for (const size_t threads : {0, 1, 2, 3, 8}) {
+    for (const size_t count : {0, 1, 5, 64, 100, 1000}) {
+      std::vector<std::atomic<int>> hits(count);
+      ParallelFor(count, threads, [&hits](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++) hits[i]++;
+      });
+      for (size_t i = 0; i < count; i++) {
+        ASSERT_EQ(hits[i].load(), 1)
+            << "threads = " << threads << ", count = " << count;
+      }
+    }
+  }
+}
+
+TEST(ParallelTest, RangesAlignedToGrain) {
+  std::atomic<size_t> total(0);
+  ParallelFor(1000, 4, [&total](size_t begin, size_t end) {
+    EXPECT_EQ(begin % 64, 0);
+    EXPECT_LE(end, 1000);
+    total += end - begin;
+  }, 64);
+  EXPECT_EQ(total.load(), 1000);
+}
+}  // namespace test
+}  // namespace task
+}  // namespace btc
@@ -0,0 +1,46 @@
+// Bitcoin Info - Test Data
+//
+// Copyright (c) 2022 Alex Dale
+// This project is licensed under the terms of the MIT license.
+// See LICENSE for details.
+#ifndef _BTC_TEST_TEST_DATA_HPP_
+#define _BTC_TEST_TEST_DATA_HPP_
+
+#include <vector>
+
+#include "btc/cc/base.h"
+
+namespace btc {
+namespace test {
+// Deterministic pseudo-random values for unittests and benchmarks, so
+// that failures reproduce.  A linear congruential generator; not
+// suitable for anything else.
+class TestDataGenerator {
+public:
+  explicit TestDataGenerator(uint32_t seed = 1): _state(seed) {}
+
+  // 16 bits.
+  uint32_t Next() {
+    _state = _state * 1103515245 + 12345;
+    return _state >> 16;
+  }
+  uint8_t NextByte() { return static_cast<uint8_t>(Next()); }
+
+private:
+  uint32_t _state;
+};  // class TestDataGenerator
+
+inline void FillTestData(uint8_t *data, size_t size, uint32_t seed = 1) {
+  TestDataGenerator generator(seed);
+  for (size_t i = 0; i < size; i++) data[i] = generator.NextByte();
+}
+
+inline std::vector<uint8_t> MakeTestData(size_t size, uint32_t seed = 1) {
+  std::vector<uint8_t> data(size);
+  FillTestData(data.data(), size, seed);
+  return data;
+}
+}  // namespace test
+}  // namespace btc
+
+#endif  // _BTC_TEST_TEST_DATA_HPP_
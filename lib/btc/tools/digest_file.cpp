@@ -0,0 +1,129 @@
+// Bitcoin Info - Tools - File Digests
+//
+// Copyright (c) 2022 Alex Dale
+// This project is licensed under the terms of the MIT license.
+// See LICENSE for details.
+//
+// Digests files, such as the blk*.dat files of a node, and reports the
+// digest of each file and the overall throughput.
+//
+//   btc.digest_file.exe --threads=0 ~/.bitcoin/blocks/blk*.dat
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "btc/crypto/digest_file.hpp"
+#include "btc/encode/hex.hpp"
+
+namespace btc {
+namespace tools {
+namespace {
+using ::btc::crypto::DigestAlgorithm;
+using ::btc::crypto::FileDigest;
+using ::btc::crypto::FileDigestStats;
+using ::btc::crypto::FileReadMode;
+using ::btc::encode::HexEncode;
+
+constexpr double kBytesPerMiB = 1 << 20;
+constexpr double kNsPerSecond = 1e9;
+
+struct Options {
+  DigestAlgorithm algorithm = ::btc::crypto::kSha256;
+  size_t threads = 1;
+  FileReadMode mode = ::btc::crypto::kFileReadMmap;
+  std::vector<std::string> paths = {};
+};
+
+bool ParseAlgorithm(const char *name, DigestAlgorithm *algorithm) {
+  if (strcmp(name, "sha256") == 0) {
+    *algorithm = ::btc::crypto::kSha256;
+  } else if (strcmp(name, "sha256d") == 0) {
+    *algorithm = ::btc::crypto::kSha256Sha256;
+  } else if (strcmp(name, "hash160") == 0) {
+    *algorithm = ::btc::crypto::kSha256RipeMd160;
+  } else {
+    return false;
+  }
+  return true;
+}
+
+bool ParseThreads(const char *value, size_t *threads) {
+  if (*value < '0' || *value > '9') return false;
+  char *end = nullptr;
+  errno = 0;
+  const unsigned long long count = strtoull(value, &end, 10);
+  if (errno != 0 || *end != '\0') return false;
+  *threads = static_cast<size_t>(count);
+  return true;
+}
+
+void PrintUsage(const char *program) {
+  std::cerr << "Usage: " << program
+            << " [--algorithm=sha256|sha256d|hash160] [--threads=<n>]"
+            << " [--read] <file>..." << std::endl
+            << "  --threads=0 uses every hardware thread; --read uses"
+            << " read() instead of mmap()." << std::endl;
+}
+
+bool ParseOptions(int argc, char **argv, Options *options) {
+  for (int i = 1; i < argc; i++) {
+    const char *arg = argv[i];
+    if (strncmp(arg, "--algorithm=", 12) == 0) {
+      if (!ParseAlgorithm(arg + 12, &options->algorithm)) {
+        std::cerr << "Unknown algorithm: " << arg + 12 << std::endl;
+        return false;
+      }
+    } else if (strncmp(arg, "--threads=", 10) == 0) {
+      if (!ParseThreads(arg + 10, &options->threads)) {
+        std::cerr << "Invalid thread count: " << arg + 10 << std::endl;
+        return false;
+      }
+    } else if (strcmp(arg, "--read") == 0) {
+      options->mode = ::btc::crypto::kFileReadBuffered;
+    } else if (strncmp(arg, "--", 2) == 0) {
+      std::cerr << "Unknown option: " << arg << std::endl;
+      return false;
+    } else {
+      options->paths.push_back(arg);
+    }
+  }
+  return !options->paths.empty();
+}
+}  // namespace
+
+int Main(int argc, char **argv) {
+  Options options;
+  if (!ParseOptions(argc, argv, &options)) {
+    PrintUsage(argv[0]);
+    return EXIT_FAILURE;
+  }
+  FileDigestStats stats;
+  const std::vector<FileDigest> results = ::btc::crypto::DigestFiles(
+      options.algorithm, options.paths, options.threads, &stats,
+      options.mode);
+  // Same layout as sha256sum.
+  for (const FileDigest &result : results) {
+    if (result.ok) {
+      std::cout << HexEncode(result.digest) << "  " << result.path
+                << std::endl;
+    } else {
+      std::cerr << "Failed to digest " << result.path << std::endl;
+    }
+  }
+  std::cerr << ::btc::crypto::DigestAlgorithmToString(options.algorithm)
+            << " (" << ::btc::crypto::FileReadModeToString(options.mode)
+            << "): " << stats.files << " files, "
+            << static_cast<double>(stats.bytes) / kBytesPerMiB << " MiB in "
+            << static_cast<double>(stats.elapsed_ns) / kNsPerSecond
+            << " s, " << stats.BytesPerSecond() / kBytesPerMiB << " MiB/s"
+            << std::endl;
+  return stats.failed == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+}  // namespace tools
+}  // namespace btc
+
+int main(int argc, char **argv) { return ::btc::tools::Main(argc, argv); }
@@ -12,6 +12,7 @@
 #include "btc/cc/base.h"
 #include "btc/cc/classy.hpp"
 #include "btc/crypto/ecc_key.hpp"
+#include "btc/crypto/hash.hpp"
 
 namespace btc {
 namespace wallet {
@@ -42,11 +43,11 @@ public:
   bool Parse(const std::vector<uint8_t> &address_raw);
   bool ParseBase58(const std::string &address_b58);
 
-  bool IsSet() const { return !_key_hash.empty(); }
+  bool IsSet() const { return _is_set; }
   explicit operator bool() { return IsSet(); }
 
   NetworkId network_id() const { return _network_id; }
-  const std::vector<uint8_t> &key_hash() const { return _key_hash; }
+  const ::btc::crypto::Hash160 &key_hash() const { return _key_hash; }
 
   std::vector<uint8_t> Serialize() const;
   std::string SerializeBase58() const;
@@ -55,7 +56,8 @@ public:
 
 private:
   NetworkId _network_id = kMainNetwork;
-  std::vector<uint8_t> _key_hash = {};
+  ::btc::crypto::Hash160 _key_hash = {};
+  bool _is_set = false;
 };  // class PkhAddress
 }  // namespace wallet
 }  // namespace btc
@@ -0,0 +1,51 @@
+// Bitcoin Info - Wallet - Address - Benchmarks
+//
+// Copyright (c) 2022 Alex Dale
+// This project is licensed under the terms of the MIT license.
+// See LICENSE for details.
+#include "btc/bench/bench.hpp"
+#include "btc/crypto/ecc_key.hpp"
+#include "btc/wallet/address.hpp"
+
+namespace btc {
+namespace wallet {
+namespace bench {
+namespace {
+using ::btc::bench::DoNotOptimize;
+using ::btc::bench::State;
+using ::btc::crypto::EccPrivateKey;
+
+// size() is the length of the hashed public key, 33 or 65.
+void BM_PkhAddressFromKey(State *state) {
+  const auto key = EccPrivateKey::New();
+  if (!key) return;
+  while (state->KeepRunning()) {
+    DoNotOptimize(PkhAddress(kMainNetwork, *key, state->size() == 33));
+  }
+}
+
+void BM_PkhAddressSerializeBase58(State *state) {
+  const auto key = EccPrivateKey::New();
+  if (!key) return;
+  const PkhAddress address(kMainNetwork, *key, true);
+  while (state->KeepRunning()) DoNotOptimize(address.SerializeBase58());
+}
+
+void BM_PkhAddressParseBase58(State *state) {
+  const auto key = EccPrivateKey::New();
+  if (!key) return;
+  const std::string address_b58 =
+      PkhAddress(kMainNetwork, *key, true).SerializeBase58();
+  PkhAddress address;
+  while (state->KeepRunning()) {
+    DoNotOptimize(address.ParseBase58(address_b58));
+  }
+}
+}  // namespace
+
+BTC_BENCHMARK(BM_PkhAddressFromKey, {33, 65});
+BTC_BENCHMARK(BM_PkhAddressSerializeBase58, {25});
+BTC_BENCHMARK(BM_PkhAddressParseBase58, {25});
+}  // namespace bench
+}  // namespace wallet
+}  // namespace btc
@@ -10,59 +10,60 @@
 
 #include "btc/cc/debug.h"
 #include "btc/crypto/digest.hpp"
-#include "btc/crypto/digester.hpp"
 #include "btc/encode/base58.hpp"
 #include "btc/log.h"
 #include "btc/wallet/address.hpp"
 
 namespace btc {
 namespace wallet {
-using ::btc::crypto::Digester;
 using ::btc::crypto::EccPublicKey;
+using ::btc::crypto::Hash160;
 using ::btc::crypto::kSha256DigestLength;
-using ::btc::crypto::kSha256Sha256;
 using ::btc::crypto::Sha256RipeMd160;
 using ::btc::crypto::Sha256Sha256;
-using ::btc::encode::Base58Decode;
-using ::btc::encode::Base58Encode;
-using ::btc::encode::IsBase58String;
+using ::btc::encode::Base58CheckDecode;
+using ::btc::encode::Base58CheckEncode;
+using ::btc::encode::Base58CheckEncodedMaxLength;
 namespace {
-static constexpr size_t kKeyHashLength = 20;
+static constexpr size_t kKeyHashLength = Hash160::size();
 constexpr size_t kChecksumOffset = 1 + kKeyHashLength;
 constexpr size_t kChecksumLength = 4;
 using checksum_t = uint8_t[kChecksumLength];
 
+constexpr size_t kPayloadLength = kRawPkhAddressLength - kChecksumLength;
+static_assert(kChecksumLength == ::btc::encode::kBase58CheckChecksumLength,
+              "Address checksum must be the Base58Check checksum");
+
+// Address payload (network ID and key hash) without the checksum.
+void WritePayload(
+    NetworkId network_id, const Hash160 &key_hash, uint8_t *payload) {
+  payload[0] = network_id;
+  std::copy(key_hash.begin(), key_hash.end(), payload + 1);
+}
+
 bool CalculateChecksum(
-    NetworkId network_id, const std::vector<uint8_t> &key_hash,
-    uint8_t *checksum) {
-  DASSERT(key_hash.size() == kKeyHashLength);
+    NetworkId network_id, const Hash160 &key_hash, uint8_t *checksum) {
   DASSERT(checksum != nullptr);
-  auto digester = Digester::New(kSha256Sha256);
-  if (!digester) {
-    LOG_ERROR("Failed to create a SHA-256-SHA-256 digester");
-    return false;
-  }
-  if (!digester->Update(network_id) || !digester->Update(key_hash)) {
-    LOG_ERROR("Failed to update digest for checksum");
-    return false;
-  }
+  uint8_t payload[kPayloadLength];
+  WritePayload(network_id, key_hash, payload);
   uint8_t digest[kSha256DigestLength];
-  if (!digester->Finalize(digest)) {
-    LOG_ERROR("Failed to finalize checksum");
+  if (!Sha256Sha256(payload, kPayloadLength, digest)) {
+    LOG_ERROR("Failed to calculate SHA-256-SHA-256 digest");
     return false;
   }
   memcpy(checksum, digest, kChecksumLength);
   return true;
 }
 
-std::vector<uint8_t> HashPublicKey(const EccPublicKey &pub_key, bool compress) {
+bool HashPublicKey(
+    const EccPublicKey &pub_key, bool compress, Hash160 *key_hash) {
   const std::vector<uint8_t> serialized_key =
       pub_key.SerializeAsPublicPoint(compress);
   if (serialized_key.empty()) {
     LOG_ERROR("Failed to serialize public key");
-    return {};
+    return false;
   }
-  return Sha256RipeMd160(serialized_key);
+  return Sha256RipeMd160(serialized_key, key_hash->data());
 }
 }  // namespace
 
@@ -95,17 +96,20 @@ bool PkhAddress::IsValidAddressBase58(const std::string &address) {
     LOG_DEBUG("Base58 address is empty");
     return false;
   }
-  if (!IsBase58String(address)) {
-    LOG_DEBUG("Address is not base58 encoded");
+  uint8_t payload[kPayloadLength];
+  if (Base58CheckDecode(address.data(), address.size(), payload,
+                        kPayloadLength) != kPayloadLength) {
+    LOG_DEBUG("Address is not a base58check encoded P2PKH address");
     return false;
   }
-  return IsValidAddress(Base58Decode(address));
+  return true;
 }
 
 PkhAddress::PkhAddress(
     NetworkId network, const EccPublicKey &pub_key, bool compress):
-    _network_id(network), _key_hash(HashPublicKey(pub_key, compress)) {
-  DASSERT(!_key_hash.empty());
+    _network_id(network) {
+  _is_set = HashPublicKey(pub_key, compress, &_key_hash);
+  DASSERT(_is_set);
 }
 
 bool PkhAddress::Parse(const std::vector<uint8_t> &address_raw) {
@@ -114,8 +118,8 @@ bool PkhAddress::Parse(const std::vector<uint8_t> &address_raw) {
     return false;
   }
   _network_id = address_raw[0];
-  const auto key_hash_begin = address_raw.begin() + 1;
-  _key_hash.assign(key_hash_begin, key_hash_begin + kKeyHashLength);
+  _key_hash = Hash160(address_raw.data() + 1);
+  _is_set = true;
   return true;
 }
 
@@ -124,11 +128,16 @@ bool PkhAddress::ParseBase58(const std::string &address_b58) {
     LOG_DEBUG("Base58 address is empty");
     return false;
   }
-  if (!IsBase58String(address_b58)) {
-    LOG_DEBUG("Address is not base58 encoded");
+  uint8_t payload[kPayloadLength];
+  if (Base58CheckDecode(address_b58.data(), address_b58.size(), payload,
+                        kPayloadLength) != kPayloadLength) {
+    LOG_DEBUG("Address is not a base58check encoded P2PKH address");
     return false;
   }
-  return Parse(Base58Decode(address_b58));
+  _network_id = payload[0];
+  _key_hash = Hash160(payload + 1);
+  _is_set = true;
+  return true;
 }
 
 std::vector<uint8_t> PkhAddress::Serialize() const {
@@ -148,12 +157,16 @@ std::vector<uint8_t> PkhAddress::Serialize() const {
 
 std::string PkhAddress::SerializeBase58() const {
   if (!IsSet()) return "";
-  const std::vector<uint8_t> address_raw = Serialize();
-  if (address_raw.empty()) {
-    LOG_ERROR("Failed to serialize key");
+  uint8_t payload[kPayloadLength];
+  WritePayload(_network_id, _key_hash, payload);
+  char address_b58[Base58CheckEncodedMaxLength(kPayloadLength)];
+  const size_t length = Base58CheckEncode(
+      payload, kPayloadLength, address_b58, sizeof(address_b58));
+  if (length == 0) {
+    LOG_ERROR("Failed to encode address");
     return "";
   }
-  return Base58Encode(address_raw);
+  return std::string(address_b58, length);
 }
 
 std::vector<uint8_t> PkhAddress::GenerateChecksum() const {
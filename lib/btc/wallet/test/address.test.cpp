@@ -48,7 +48,7 @@ TEST(WalletAddressTest, KnownPkhAddress) {
   EXPECT_TRUE(address.IsSet());
   EXPECT_EQ(kMainNetwork, address.network_id());
 
-  const std::string key_hash = HexEncode(address.key_hash());
+  const std::string key_hash = address.key_hash().ToHex();
   EXPECT_EQ(key_hash, "f54a5851e9372b87810a8e60cdd2e7cfd80b6e31");
 
   const std::string checksum = HexEncode(address.GenerateChecksum());
@@ -72,7 +72,7 @@ TEST(WalletAddressTest, ParsePkhAddressRaw) {
   EXPECT_TRUE(address.IsSet());
   EXPECT_EQ(kMainNetwork, address.network_id());
 
-  const std::string key_hash = HexEncode(address.key_hash());
+  const std::string key_hash = address.key_hash().ToHex();
   EXPECT_EQ(key_hash, "f54a5851e9372b87810a8e60cdd2e7cfd80b6e31");
 
   const std::string checksum = HexEncode(address.GenerateChecksum());
@@ -93,7 +93,7 @@ TEST(WalletAddressTest, ParsePkhAddressBase58) {
   EXPECT_TRUE(address.IsSet());
   EXPECT_EQ(kMainNetwork, address.network_id());
 
-  const std::string key_hash = HexEncode(address.key_hash());
+  const std::string key_hash = address.key_hash().ToHex();
   EXPECT_EQ(key_hash, "f54a5851e9372b87810a8e60cdd2e7cfd80b6e31");
 
   const std::string checksum = HexEncode(address.GenerateChecksum());